@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+
+# searches for the multiplier used by reservedHash in src/main/lexer/lexer.c,
+# and generates RESERVED_MULTIPLIER and the RESERVED_WORDS table
+#
+# the key packing and the hash must match reservedHash. The search is seeded,
+# so rerunning this with an unchanged word list reproduces the current table.
+# 64 slots are tried first - no multiplier was found for them, so the table
+# has 128 slots
+
+import random
+
+KEYWORDS = [
+    "module", "import", "opaque", "struct", "union", "enum", "typedef", "if",
+    "else", "while", "do", "for", "switch", "case", "default", "break",
+    "continue", "return", "cast", "sizeof", "true", "false", "null", "void",
+    "ubyte", "byte", "char", "ushort", "short", "uint", "int", "wchar",
+    "ulong", "long", "float", "double", "bool", "const", "volatile",
+]
+MAGIC = {
+    "__FILE__": "MTT_FILE",
+    "__LINE__": "MTT_LINE",
+    "__VERSION__": "MTT_VERSION",
+}
+WORDS = KEYWORDS + list(MAGIC)
+
+SEED = 1
+TRIES = 2000000
+
+
+def key(word):
+    return (len(word) | ord(word[0]) << 8 | ord(word[len(word) // 2]) << 16 |
+            ord(word[-1]) << 24)
+
+
+def slot(word, multiplier, bits):
+    return ((key(word) * multiplier) & 0xffffffff) >> (32 - bits)
+
+
+def search():
+    keys = [key(word) for word in WORDS]
+    assert len(set(keys)) == len(keys), "two reserved words share a key"
+
+    rng = random.Random(SEED)
+    for bits in (6, 7):
+        for _ in range(TRIES):
+            multiplier = rng.getrandbits(32) | 1
+            slots = set()
+            for k in keys:
+                s = ((k * multiplier) & 0xffffffff) >> (32 - bits)
+                if s in slots:
+                    break
+                slots.add(s)
+            else:
+                return bits, multiplier
+    raise SystemExit("no multiplier found")
+
+
+def main():
+    bits, multiplier = search()
+    table = sorted((slot(word, multiplier, bits), word) for word in WORDS)
+
+    print("/** length of the longest reserved word */")
+    print(f"#define MAX_RESERVED_LENGTH {max(len(word) for word in WORDS)}")
+    print("/** multiplier for reservedHash */")
+    print(f"#define RESERVED_MULTIPLIER {multiplier:#010x}U")
+    print(f"// reservedHash must shift right by {32 - bits}")
+    print()
+    print(f"static ReservedWord const RESERVED_WORDS[{1 << bits}] = {{")
+    for index, word in table:
+        if word in MAGIC:
+            kind, magic = "TT_ID", MAGIC[word]
+        else:
+            kind, magic = f"TT_{word.upper()}", "MTT_NONE"
+        print(f'    [{index}] = {{"{word}", {len(word)}, {kind}, {magic}}},')
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
@@ -77,10 +77,11 @@ IROperand *generateFunctionCall(IRBlock *b, IROperand *fun, IROperand **args,
   }
 }
 
-int validateIRArchSpecific(char const *phase, bool blocked) {
+int validateIRArchSpecific(char const *phase, bool blocked,
+                           FileListEntry *file) {
   switch (options.arch) {
     case OPTION_A_X86_64_LINUX: {
-      return x86_64LinuxValidateIRArchSpecific(phase, blocked);
+      return x86_64LinuxValidateIRArchSpecific(phase, blocked, file);
     }
     default: {
       error(__FILE__, __LINE__, "unrecognized architecture");
@@ -88,14 +89,35 @@ int validateIRArchSpecific(char const *phase, bool blocked) {
   }
 }
 
-void backend(void) {
+void backend(size_t fileIdx) {
+  switch (options.arch) {
+    case OPTION_A_X86_64_LINUX: {
+      x86_64LinuxBackend(fileIdx);
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__, "unrecognized architecture");
+    }
+  }
+}
+void serializeAsmFile(FILE *out, void const *asmFile) {
   switch (options.arch) {
     case OPTION_A_X86_64_LINUX: {
-      x86_64LinuxBackend();
+      x86_64LinuxFileSerialize(out, asmFile);
       break;
     }
     default: {
       error(__FILE__, __LINE__, "unrecognized architecture");
     }
   }
-}
\ No newline at end of file
+}
+void *deserializeAsmFile(FILE *in) {
+  switch (options.arch) {
+    case OPTION_A_X86_64_LINUX: {
+      return x86_64LinuxFileDeserialize(in);
+    }
+    default: {
+      error(__FILE__, __LINE__, "unrecognized architecture");
+    }
+  }
+}
@@ -25,6 +25,8 @@
 #ifndef TLC_ARCH_INTERFACE_H_
 #define TLC_ARCH_INTERFACE_H_
 
+#include <stdio.h>
+
 #include "ast/symbolTable.h"
 #include "ir/ir.h"
 
@@ -77,17 +79,39 @@ IROperand *generateFunctionCall(IRBlock *b, IROperand *fun, IROperand **args,
                                 Type const *funType, FileListEntry *file);
 
 /**
- * validate generated IR
+ * validate a file's generated IR
  *
  * @param phase phase to blame for errors
  * @param blocked is the IR in basic blocks?
+ * @param file file to validate
  * @returns -1 on failure, 0 on success
  */
-int validateIRArchSpecific(char const *phase, bool blocked);
+int validateIRArchSpecific(char const *phase, bool blocked,
+                           FileListEntry *file);
 
 /**
- * run the backend
+ * run the backend on the file at the given index, freeing its IR and assembly
+ * once done
+ *
+ * Other files may be run through the backend concurrently
+ *
+ * @param fileIdx index of the file in the file list
+ */
+void backend(size_t fileIdx);
+
+/**
+ * write a file's generated assembly to a stream
+ *
+ * @param out stream to write to
+ * @param asmFile assembly to write
+ */
+void serializeAsmFile(FILE *out, void const *asmFile);
+/**
+ * read generated assembly written by serializeAsmFile
+ *
+ * @param in stream to read from
+ * @returns assembly, or NULL if the stream didn't hold valid assembly
  */
-void backend(void);
+void *deserializeAsmFile(FILE *in);
 
 #endif  // TLC_ARCH_INTERFACE_H_
\ No newline at end of file
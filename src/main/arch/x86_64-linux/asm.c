@@ -21,10 +21,12 @@
 
 #include "fileList.h"
 #include "ir/ir.h"
+#include "timeReport.h"
 #include "translation/translation.h"
 #include "util/container/stringBuilder.h"
 #include "util/internalError.h"
 #include "util/numericSizing.h"
+#include "util/serialize.h"
 
 size_t const X86_64_LINUX_REGISTER_WIDTH = 8;
 size_t const X86_64_LINUX_STACK_ALIGNMENT = 16;
@@ -332,6 +334,260 @@ static void DONE(X86_64LinuxFrag *assembly, X86_64LinuxInstruction *i) {
   insertNodeEnd(&assembly->data.text.instructions, i);
 }
 
+static void x86_64LinuxOperandSerialize(FILE *out,
+                                        X86_64LinuxOperand const *o) {
+  serializeNumber(out, o->kind);
+  switch (o->kind) {
+    case X86_64_LINUX_OK_REG: {
+      serializeNumber(out, o->data.reg.reg);
+      serializeNumber(out, o->data.reg.size);
+      break;
+    }
+    case X86_64_LINUX_OK_TEMP: {
+      serializeNumber(out, o->data.temp.name);
+      serializeNumber(out, o->data.temp.alignment);
+      serializeNumber(out, o->data.temp.size);
+      serializeNumber(out, o->data.temp.kind);
+      serializeNumber(out, o->data.temp.escapes);
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid X86_64LinuxOperand");
+    }
+  }
+}
+static void x86_64LinuxOperandsSerialize(FILE *out, Vector const *operands) {
+  serializeNumber(out, operands->size);
+  for (size_t idx = 0; idx < operands->size; ++idx)
+    x86_64LinuxOperandSerialize(out, operands->elements[idx]);
+}
+/**
+ * write the index of an operand in a vector, plus one, or zero if it's NULL
+ */
+static void x86_64LinuxOperandIndexSerialize(FILE *out,
+                                             X86_64LinuxOperand const *o,
+                                             Vector const *operands) {
+  size_t index = 0;
+  for (size_t idx = 0; idx < operands->size && o != NULL; ++idx) {
+    if (operands->elements[idx] == o) {
+      index = idx + 1;
+      break;
+    }
+  }
+  serializeNumber(out, index);
+}
+static void x86_64LinuxInstructionSerialize(FILE *out,
+                                            X86_64LinuxInstruction const *i) {
+  serializeNumber(out, i->kind);
+  serializeString(out, i->skeleton);
+  x86_64LinuxOperandsSerialize(out, &i->defines);
+  x86_64LinuxOperandsSerialize(out, &i->uses);
+  switch (i->kind) {
+    case X86_64_LINUX_IK_JUMP:
+    case X86_64_LINUX_IK_JUMPTABLE:
+    case X86_64_LINUX_IK_CJUMP: {
+      serializeNumber(out, i->data.jumpTargets.size);
+      for (size_t idx = 0; idx < i->data.jumpTargets.size; ++idx)
+        serializeNumber(out, i->data.jumpTargets.elements[idx]);
+      break;
+    }
+    case X86_64_LINUX_IK_LABEL: {
+      serializeNumber(out, i->data.labelName);
+      break;
+    }
+    case X86_64_LINUX_IK_REGULAR: {
+      x86_64LinuxOperandIndexSerialize(out, i->data.move.from, &i->uses);
+      x86_64LinuxOperandIndexSerialize(out, i->data.move.to, &i->defines);
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+static void x86_64LinuxFragSerialize(FILE *out, X86_64LinuxFrag const *frag) {
+  serializeNumber(out, frag->kind);
+  switch (frag->kind) {
+    case X86_64_LINUX_FK_TEXT: {
+      serializeString(out, frag->data.text.header);
+      serializeString(out, frag->data.text.footer);
+      LinkedList const *instructions = &frag->data.text.instructions;
+      for (ListNode *curr = instructions->head->next;
+           curr != instructions->tail; curr = curr->next) {
+        // each instruction is preceded by a one, and the list is ended by a
+        // zero
+        serializeNumber(out, 1);
+        x86_64LinuxInstructionSerialize(out, curr->data);
+      }
+      serializeNumber(out, 0);
+      break;
+    }
+    case X86_64_LINUX_FK_DATA: {
+      serializeString(out, frag->data.data.data);
+      break;
+    }
+    default: {
+      error(__FILE__, __LINE__, "invalid X86_64LinuxFrag");
+    }
+  }
+}
+void x86_64LinuxFileSerialize(FILE *out, X86_64LinuxFile const *file) {
+  serializeString(out, file->header);
+  serializeString(out, file->footer);
+  serializeNumber(out, file->frags.size);
+  for (size_t idx = 0; idx < file->frags.size; ++idx)
+    x86_64LinuxFragSerialize(out, file->frags.elements[idx]);
+}
+
+static X86_64LinuxOperand *x86_64LinuxOperandDeserialize(FILE *in,
+                                                         bool *errored) {
+  switch (deserializeNumber(in, errored)) {
+    case X86_64_LINUX_OK_REG: {
+      uint64_t reg = deserializeNumber(in, errored);
+      uint64_t size = deserializeNumber(in, errored);
+      if (*errored || reg > X86_64_LINUX_RFLAGS) break;
+      X86_64LinuxOperand *o = x86_64LinuxOperandCreateBase(X86_64_LINUX_OK_REG);
+      o->data.reg.reg = (X86_64LinuxRegister)reg;
+      o->data.reg.size = (size_t)size;
+      return o;
+    }
+    case X86_64_LINUX_OK_TEMP: {
+      X86_64LinuxOperand *o =
+          x86_64LinuxOperandCreateBase(X86_64_LINUX_OK_TEMP);
+      o->data.temp.name = (size_t)deserializeNumber(in, errored);
+      o->data.temp.alignment = (size_t)deserializeNumber(in, errored);
+      o->data.temp.size = (size_t)deserializeNumber(in, errored);
+      uint64_t kind = deserializeNumber(in, errored);
+      o->data.temp.kind = (AllocHint)kind;
+      o->data.temp.escapes = deserializeNumber(in, errored) != 0;
+      if (!*errored && kind <= AH_FP) return o;
+      free(o);
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+  *errored = true;
+  return NULL;
+}
+static void x86_64LinuxOperandsDeserialize(FILE *in, Vector *operands,
+                                           bool *errored) {
+  uint64_t numOperands = deserializeNumber(in, errored);
+  for (uint64_t idx = 0; idx < numOperands && !*errored; ++idx) {
+    X86_64LinuxOperand *o = x86_64LinuxOperandDeserialize(in, errored);
+    if (o != NULL) vectorInsert(operands, o);
+  }
+}
+/**
+ * read an operand index written by x86_64LinuxOperandIndexSerialize
+ */
+static X86_64LinuxOperand *x86_64LinuxOperandIndexDeserialize(
+    FILE *in, Vector const *operands, bool *errored) {
+  uint64_t index = deserializeNumber(in, errored);
+  if (index == 0) return NULL;
+  if (index > operands->size) {
+    *errored = true;
+    return NULL;
+  }
+  return operands->elements[index - 1];
+}
+static X86_64LinuxInstruction *x86_64LinuxInstructionDeserialize(
+    FILE *in, bool *errored) {
+  uint64_t kind = deserializeNumber(in, errored);
+  char *skeleton = deserializeString(in, errored);
+  if (*errored || kind > X86_64_LINUX_IK_LABEL) {
+    free(skeleton);
+    *errored = true;
+    return NULL;
+  }
+
+  X86_64LinuxInstruction *i = INST((X86_64LinuxInstructionKind)kind, skeleton);
+  x86_64LinuxOperandsDeserialize(in, &i->defines, errored);
+  x86_64LinuxOperandsDeserialize(in, &i->uses, errored);
+  switch (i->kind) {
+    case X86_64_LINUX_IK_JUMP:
+    case X86_64_LINUX_IK_JUMPTABLE:
+    case X86_64_LINUX_IK_CJUMP: {
+      uint64_t numTargets = deserializeNumber(in, errored);
+      for (uint64_t idx = 0; idx < numTargets && !*errored; ++idx)
+        sizeVectorInsert(&i->data.jumpTargets,
+                         (size_t)deserializeNumber(in, errored));
+      break;
+    }
+    case X86_64_LINUX_IK_LABEL: {
+      i->data.labelName = (size_t)deserializeNumber(in, errored);
+      break;
+    }
+    case X86_64_LINUX_IK_REGULAR: {
+      i->data.move.from =
+          x86_64LinuxOperandIndexDeserialize(in, &i->uses, errored);
+      i->data.move.to =
+          x86_64LinuxOperandIndexDeserialize(in, &i->defines, errored);
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+
+  if (!*errored) return i;
+  x86_64LinuxInstructionFree(i);
+  return NULL;
+}
+static X86_64LinuxFrag *x86_64LinuxFragDeserialize(FILE *in, bool *errored) {
+  switch (deserializeNumber(in, errored)) {
+    case X86_64_LINUX_FK_TEXT: {
+      char *header = deserializeString(in, errored);
+      char *footer = deserializeString(in, errored);
+      if (*errored) {
+        free(header);
+        free(footer);
+        return NULL;
+      }
+      X86_64LinuxFrag *frag = x86_64LinuxTextFragCreate(header, footer);
+      while (!*errored && deserializeNumber(in, errored) != 0) {
+        X86_64LinuxInstruction *i =
+            x86_64LinuxInstructionDeserialize(in, errored);
+        if (i != NULL) DONE(frag, i);
+      }
+      if (!*errored) return frag;
+      x86_64LinuxFragFree(frag);
+      return NULL;
+    }
+    case X86_64_LINUX_FK_DATA: {
+      char *data = deserializeString(in, errored);
+      if (*errored) return NULL;
+      return x86_64LinuxDataFragCreate(data);
+    }
+    default: {
+      *errored = true;
+      return NULL;
+    }
+  }
+}
+X86_64LinuxFile *x86_64LinuxFileDeserialize(FILE *in) {
+  bool errored = false;
+  char *header = deserializeString(in, &errored);
+  char *footer = deserializeString(in, &errored);
+  if (errored) {
+    free(header);
+    free(footer);
+    return NULL;
+  }
+
+  X86_64LinuxFile *file = x86_64LinuxFileCreate(header, footer);
+  uint64_t numFrags = deserializeNumber(in, &errored);
+  for (uint64_t idx = 0; idx < numFrags && !errored; ++idx) {
+    X86_64LinuxFrag *frag = x86_64LinuxFragDeserialize(in, &errored);
+    if (frag != NULL) vectorInsert(&file->frags, frag);
+  }
+
+  if (!errored) return file;
+  x86_64LinuxFileFree(file);
+  return NULL;
+}
+
 static bool isGpReg(IROperand const *o) {
   return o->kind == OK_REG && /* X86_64_LINUX_RAX <= o->data.reg.name && */
          o->data.reg.name <= X86_64_LINUX_R15;
@@ -1395,29 +1651,29 @@ static X86_64LinuxFrag *x86_64LinuxGenerateTextAsm(IRFrag *frag,
   }
   return assembly;
 }
-void x86_64LinuxGenerateAsm(void) {
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *file = &fileList.entries[fileIdx];
-    X86_64LinuxFile *asmFile = file->asmFile =
-        x86_64LinuxFileCreate(format("lprefix .\n"), strdup(""));
+void x86_64LinuxGenerateAsm(size_t fileIdx) {
+  timeReportFileBegin(TRP_BACKEND, fileIdx);
+  FileListEntry *file = &fileList.entries[fileIdx];
+  X86_64LinuxFile *asmFile = file->asmFile =
+      x86_64LinuxFileCreate(format("lprefix .\n"), strdup(""));
 
-    for (size_t fragIdx = 0; fragIdx < file->irFrags.size; ++fragIdx) {
-      IRFrag *frag = file->irFrags.elements[fragIdx];
-      switch (frag->type) {
-        case FT_BSS:
-        case FT_RODATA:
-        case FT_DATA: {
-          vectorInsert(&asmFile->frags, x86_64LinuxGenerateDataAsm(frag));
-          break;
-        }
-        case FT_TEXT: {
-          vectorInsert(&asmFile->frags, x86_64LinuxGenerateTextAsm(frag, file));
-          break;
-        }
-        default: {
-          error(__FILE__, __LINE__, "invalid fragment type");
-        }
+  for (size_t fragIdx = 0; fragIdx < file->irFrags.size; ++fragIdx) {
+    IRFrag *frag = file->irFrags.elements[fragIdx];
+    switch (frag->type) {
+      case FT_BSS:
+      case FT_RODATA:
+      case FT_DATA: {
+        vectorInsert(&asmFile->frags, x86_64LinuxGenerateDataAsm(frag));
+        break;
+      }
+      case FT_TEXT: {
+        vectorInsert(&asmFile->frags, x86_64LinuxGenerateTextAsm(frag, file));
+        break;
+      }
+      default: {
+        error(__FILE__, __LINE__, "invalid fragment type");
       }
     }
   }
+  timeReportFileEnd(TRP_BACKEND, fileIdx);
 }
\ No newline at end of file
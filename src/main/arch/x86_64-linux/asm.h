@@ -27,6 +27,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "ast/ast.h"
 #include "ir/ir.h"
@@ -171,8 +172,25 @@ typedef struct {
 void x86_64LinuxFileFree(X86_64LinuxFile *file);
 
 /**
- * generate assembly from IR
+ * write a file's assembly to a stream, for use by x86_64LinuxFileDeserialize
+ *
+ * @param out stream to write to
+ * @param file assembly to write
  */
-void x86_64LinuxGenerateAsm(void);
+void x86_64LinuxFileSerialize(FILE *out, X86_64LinuxFile const *file);
+/**
+ * read a file's assembly from a stream
+ *
+ * @param in stream to read from
+ * @returns assembly, or NULL if the stream didn't hold valid assembly
+ */
+X86_64LinuxFile *x86_64LinuxFileDeserialize(FILE *in);
+
+/**
+ * generate assembly from the IR of the file at the given index
+ *
+ * @param fileIdx index of the file in the file list
+ */
+void x86_64LinuxGenerateAsm(size_t fileIdx);
 
 #endif  // TLC_ARCH_X86_64_LINUX_ASM_H_
\ No newline at end of file
@@ -20,16 +20,21 @@
 #include "arch/x86_64-linux/backend.h"
 
 #include "arch/x86_64-linux/asm.h"
+#include "cache.h"
 #include "fileList.h"
 #include "ir/ir.h"
 
-void x86_64LinuxBackend(void) {
-  // assembly generation
-  x86_64LinuxGenerateAsm();
+void x86_64LinuxBackend(size_t fileIdx) {
+  FileListEntry *file = &fileList.entries[fileIdx];
+
+  // assembly generation - files loaded from the cache already have assembly
+  if (file->asmFile == NULL) {
+    x86_64LinuxGenerateAsm(fileIdx);
+    cacheStore(fileIdx);
+  }
 
   // done with IR
-  for (size_t idx = 0; idx < fileList.size; ++idx)
-    vectorUninit(&fileList.entries[idx].irFrags, (void (*)(void *))irFragFree);
+  vectorUninit(&file->irFrags, (void (*)(void *))irFragFree);
 
   // assembly optimization 1
   // TODO
@@ -44,6 +49,6 @@ void x86_64LinuxBackend(void) {
   // TODO
 
   // cleanup
-  for (size_t idx = 0; idx < fileList.size; ++idx)
-    x86_64LinuxFileFree(fileList.entries[idx].asmFile);
+  x86_64LinuxFileFree(file->asmFile);
+  file->asmFile = NULL;
 }
\ No newline at end of file
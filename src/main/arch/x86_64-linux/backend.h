@@ -25,6 +25,14 @@
 #ifndef TLC_ARCH_X86_64_LINUX_BACKEND_H_
 #define TLC_ARCH_X86_64_LINUX_BACKEND_H_
 
-void x86_64LinuxBackend(void);
+#include <stddef.h>
+
+/**
+ * runs the backend on the file at the given index, freeing its IR and
+ * assembly once done
+ *
+ * @param fileIdx index of the file in the file list
+ */
+void x86_64LinuxBackend(size_t fileIdx);
 
 #endif  // TLC_ARCH_X86_64_LINUX_BACKEND_H_
\ No newline at end of file
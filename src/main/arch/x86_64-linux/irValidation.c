@@ -27,63 +27,56 @@
 #include "fileList.h"
 #include "ir/ir.h"
 
-int x86_64LinuxValidateIRArchSpecific(char const *phase, bool blocked) {
-  bool errored = false;
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *file = &fileList.entries[fileIdx];
-    for (size_t fragIdx = 0; fragIdx < file->irFrags.size; ++fragIdx) {
-      IRFrag const *frag = file->irFrags.elements[fragIdx];
-      if (frag->type == FT_TEXT) {
-        LinkedList const *blocks = &frag->data.text.blocks;
-        for (ListNode *currBlock = blocks->head->next;
-             currBlock != blocks->tail; currBlock = currBlock->next) {
-          IRBlock *block = currBlock->data;
-          for (ListNode *currInst = block->instructions.head->next;
-               currInst != block->instructions.tail;
-               currInst = currInst->next) {
-            IRInstruction const *i = currInst->data;
-            for (size_t argIdx = 0; argIdx < irOperatorArity(i->op); ++argIdx) {
-              IROperand const *arg = i->args[argIdx];
-              switch (arg->kind) {
-                case OK_REG: {
-                  if (arg->data.reg.size != 1 && arg->data.reg.size != 2 &&
-                      arg->data.reg.size != 4 && arg->data.reg.size != 8) {
-                    fprintf(
-                        stderr,
-                        "%s: internal compiler error: x86_64-linux specific IR "
-                        "validation after %s failed - invalid register size "
-                        "(%zu) encountered\n",
-                        file->inputFilename, phase, arg->data.reg.size);
-                    file->errored = true;
-                  }
-                  break;
+int x86_64LinuxValidateIRArchSpecific(char const *phase, bool blocked,
+                                      FileListEntry *file) {
+  for (size_t fragIdx = 0; fragIdx < file->irFrags.size; ++fragIdx) {
+    IRFrag const *frag = file->irFrags.elements[fragIdx];
+    if (frag->type == FT_TEXT) {
+      LinkedList const *blocks = &frag->data.text.blocks;
+      for (ListNode *currBlock = blocks->head->next;
+           currBlock != blocks->tail; currBlock = currBlock->next) {
+        IRBlock *block = currBlock->data;
+        for (ListNode *currInst = block->instructions.head->next;
+             currInst != block->instructions.tail;
+             currInst = currInst->next) {
+          IRInstruction const *i = currInst->data;
+          for (size_t argIdx = 0; argIdx < irOperatorArity(i->op); ++argIdx) {
+            IROperand const *arg = i->args[argIdx];
+            switch (arg->kind) {
+              case OK_REG: {
+                if (arg->data.reg.size != 1 && arg->data.reg.size != 2 &&
+                    arg->data.reg.size != 4 && arg->data.reg.size != 8) {
+                  fprintf(
+                      stderr,
+                      "%s: internal compiler error: x86_64-linux specific IR "
+                      "validation after %s failed - invalid register size "
+                      "(%zu) encountered\n",
+                      file->inputFilename, phase, arg->data.reg.size);
+                  file->errored = true;
                 }
-                case OK_TEMP: {
-                  if (arg->data.temp.alignment > 16) {
-                    fprintf(
-                        stderr,
-                        "%s: internal compiler error: x86_64-linux specific IR "
-                        "validation after %s failed - invalid temp alignment "
-                        "(%zu) encountered\n",
-                        file->inputFilename, phase, arg->data.temp.alignment);
-                    file->errored = true;
-                  }
-                  break;
-                }
-                default: {
-                  break;  // nothing to check
+                break;
+              }
+              case OK_TEMP: {
+                if (arg->data.temp.alignment > 16) {
+                  fprintf(
+                      stderr,
+                      "%s: internal compiler error: x86_64-linux specific IR "
+                      "validation after %s failed - invalid temp alignment "
+                      "(%zu) encountered\n",
+                      file->inputFilename, phase, arg->data.temp.alignment);
+                  file->errored = true;
                 }
+                break;
+              }
+              default: {
+                break;  // nothing to check
               }
             }
           }
         }
       }
     }
-
-    errored = errored || file->errored;
   }
 
-  if (errored) return -1;
-
-  return 0;
+  return file->errored ? -1 : 0;
 }
\ No newline at end of file
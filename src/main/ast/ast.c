@@ -24,167 +24,13 @@
 
 #include "fileList.h"
 #include "lexer/lexer.h"
-#include "util/container/stringBuilder.h"
 #include "util/conversions.h"
+#include "util/diagnostics.h"
 #include "util/format.h"
+#include "util/functional.h"
 #include "util/internalError.h"
 #include "util/numericSizing.h"
 
-BinOpType assignmentTokenToBinop(TokenType token) {
-  switch (token) {
-    case TT_ASSIGN: {
-      return BO_ASSIGN;
-    }
-    case TT_MULASSIGN: {
-      return BO_MULASSIGN;
-    }
-    case TT_DIVASSIGN: {
-      return BO_DIVASSIGN;
-    }
-    case TT_MODASSIGN: {
-      return BO_MODASSIGN;
-    }
-    case TT_ADDASSIGN: {
-      return BO_ADDASSIGN;
-    }
-    case TT_SUBASSIGN: {
-      return BO_SUBASSIGN;
-    }
-    case TT_LSHIFTASSIGN: {
-      return BO_LSHIFTASSIGN;
-    }
-    case TT_ARSHIFTASSIGN: {
-      return BO_ARSHIFTASSIGN;
-    }
-    case TT_LRSHIFTASSIGN: {
-      return BO_LRSHIFTASSIGN;
-    }
-    case TT_BITANDASSIGN: {
-      return BO_BITANDASSIGN;
-    }
-    case TT_BITXORASSIGN: {
-      return BO_BITXORASSIGN;
-    }
-    case TT_BITORASSIGN: {
-      return BO_BITORASSIGN;
-    }
-    case TT_LANDASSIGN: {
-      return BO_LANDASSIGN;
-    }
-    case TT_LORASSIGN: {
-      return BO_LORASSIGN;
-    }
-    default: {
-      error(__FILE__, __LINE__, "invalid assign binop token given");
-    }
-  }
-}
-BinOpType logicalTokenToBinop(TokenType token) {
-  switch (token) {
-    case TT_LAND: {
-      return BO_LAND;
-    }
-    case TT_LOR: {
-      return BO_LOR;
-    }
-    default: {
-      error(__FILE__, __LINE__, "invalid logical binop token given");
-    }
-  }
-}
-BinOpType bitwiseTokenToBinop(TokenType token) {
-  switch (token) {
-    case TT_AMP: {
-      return BO_BITAND;
-    }
-    case TT_BAR: {
-      return BO_BITOR;
-    }
-    case TT_CARET: {
-      return BO_BITXOR;
-    }
-    default: {
-      error(__FILE__, __LINE__, "invalid logical binop token given");
-    }
-  }
-}
-BinOpType equalityTokenToBinop(TokenType token) {
-  switch (token) {
-    case TT_EQ: {
-      return BO_EQ;
-    }
-    case TT_NEQ: {
-      return BO_NEQ;
-    }
-    default: {
-      error(__FILE__, __LINE__, "invalid equality binop token given");
-    }
-  }
-}
-BinOpType comparisonTokenToBinop(TokenType token) {
-  switch (token) {
-    case TT_LANGLE: {
-      return BO_LT;
-    }
-    case TT_RANGLE: {
-      return BO_GT;
-    }
-    case TT_LTEQ: {
-      return BO_LTEQ;
-    }
-    case TT_GTEQ: {
-      return BO_GTEQ;
-    }
-    default: {
-      error(__FILE__, __LINE__, "invalid comparison binop token given");
-    }
-  }
-}
-BinOpType shiftTokenToBinop(TokenType token) {
-  switch (token) {
-    case TT_LSHIFT: {
-      return BO_LSHIFT;
-    }
-    case TT_ARSHIFT: {
-      return BO_ARSHIFT;
-    }
-    case TT_LRSHIFT: {
-      return BO_LRSHIFT;
-    }
-    default: {
-      error(__FILE__, __LINE__, "invalid shift binop token given");
-    }
-  }
-}
-BinOpType additionTokenToBinop(TokenType token) {
-  switch (token) {
-    case TT_PLUS: {
-      return BO_ADD;
-    }
-    case TT_MINUS: {
-      return BO_SUB;
-    }
-    default: {
-      error(__FILE__, __LINE__, "invalid addition binop token given");
-    }
-  }
-}
-BinOpType multiplicationTokenToBinop(TokenType token) {
-  switch (token) {
-    case TT_STAR: {
-      return BO_MUL;
-    }
-    case TT_SLASH: {
-      return BO_DIV;
-    }
-    case TT_PERCENT: {
-      return BO_MOD;
-    }
-    default: {
-      error(__FILE__, __LINE__, "invalid multiplication binop token given");
-    }
-  }
-}
 BinOpType accessorTokenToBinop(TokenType token) {
   switch (token) {
     case TT_DOT: {
@@ -250,36 +96,80 @@ UnOpType postfixTokenToUnop(TokenType token) {
   }
 }
 
+/** arena this thread's nodes are allocated in */
+static _Thread_local Arena *currentArena = NULL;
+
+void nodeArenaSet(Arena *arena) { currentArena = arena; }
+
+/**
+ * allocates space in the current arena
+ *
+ * @param size number of bytes to allocate
+ */
+static void *nodeAllocate(size_t size) {
+  if (currentArena == NULL)
+    error(__FILE__, __LINE__, "node created without an arena");
+  return arenaAllocate(currentArena, size);
+}
+
 /**
  * create a partially initialized node
  *
  * @param type type of node to indicate
- * @param line line to attribute node to
- * @param character character to attribute node to
+ * @param offset offset to attribute node to
  */
-static Node *createNode(NodeType type, size_t line, size_t character) {
-  Node *n = malloc(sizeof(Node));
+static Node *createNode(NodeType type, uint32_t offset) {
+  Node *n = nodeAllocate(sizeof(Node));
   n->type = type;
-  n->line = line;
-  n->character = character;
+  n->offset = offset;
   return n;
 }
 
-Node *fileNodeCreate(Node *module, Vector *imports, Vector *bodies) {
-  Node *n = createNode(NT_FILE, module->line, module->character);
+/**
+ * moves a vector of nodes into the current arena, as a single span holding
+ * both the vector and its elements
+ *
+ * @param v vector to move, freed
+ * @returns vector in the arena, which may not be grown
+ */
+static Vector *freezeNodeVector(Vector *v) {
+  Vector *frozen = nodeAllocate(sizeof(Vector) + v->size * sizeof(void *));
+  frozen->size = v->size;
+  frozen->capacity = v->size;
+  frozen->elements = (void **)(frozen + 1);
+  memcpy(frozen->elements, v->elements, v->size * sizeof(void *));
+  free(v->elements);
+  free(v);
+  return frozen;
+}
+
+Scope *nodeScopeFreeze(Scope *scope) {
+  if (scope == NULL || scope->size == 0) return NULL;
+
+  Scope *frozen = nodeAllocate(sizeof(Scope));
+  *frozen = *scope;
+  return frozen;
+}
+
+Node *fileNodeCreate(Node *module, Vector *imports, Vector *bodies,
+                     Arena *arena) {
+  Node *n = createNode(NT_FILE, module->offset);
+  n->data.file.arena = arena;
   n->data.file.stab = hashMapCreate();
+  n->data.file.importIndex = NULL;
   n->data.file.module = module;
-  n->data.file.imports = imports;
-  n->data.file.bodies = bodies;
+  n->data.file.imports = freezeNodeVector(imports);
+  n->data.file.bodies = freezeNodeVector(bodies);
+  n->data.file.bodyTokens = NULL;
   return n;
 }
 Node *moduleNodeCreate(Token const *keyword, Node *id) {
-  Node *n = createNode(NT_MODULE, keyword->line, keyword->character);
+  Node *n = createNode(NT_MODULE, keyword->offset);
   n->data.module.id = id;
   return n;
 }
 Node *importNodeCreate(Token const *keyword, Node *id) {
-  Node *n = createNode(NT_IMPORT, keyword->line, keyword->character);
+  Node *n = createNode(NT_IMPORT, keyword->offset);
   n->data.import.id = id;
   n->data.import.referenced = NULL;
   return n;
@@ -287,173 +177,171 @@ Node *importNodeCreate(Token const *keyword, Node *id) {
 
 Node *funDefnNodeCreate(Node *returnType, Node *name, Vector *argTypes,
                         Vector *argNames, Node *body) {
-  Node *n = createNode(NT_FUNDEFN, returnType->line, returnType->character);
+  Node *n = createNode(NT_FUNDEFN, returnType->offset);
   n->data.funDefn.returnType = returnType;
   n->data.funDefn.name = name;
-  n->data.funDefn.argTypes = argTypes;
-  n->data.funDefn.argNames = argNames;
-  n->data.funDefn.argStab = hashMapCreate();
+  n->data.funDefn.argTypes = freezeNodeVector(argTypes);
+  n->data.funDefn.argNames = freezeNodeVector(argNames);
+  n->data.funDefn.argStab = NULL;
   n->data.funDefn.body = body;
   return n;
 }
 Node *varDefnNodeCreate(Node *type, Vector *names, Vector *initializers) {
-  Node *n = createNode(NT_VARDEFN, type->line, type->character);
+  Node *n = createNode(NT_VARDEFN, type->offset);
   n->data.varDefn.type = type;
-  n->data.varDefn.names = names;
-  n->data.varDefn.initializers = initializers;
+  n->data.varDefn.names = freezeNodeVector(names);
+  n->data.varDefn.initializers = freezeNodeVector(initializers);
   return n;
 }
 
 Node *funDeclNodeCreate(Node *returnType, Node *name, Vector *argTypes,
                         Vector *argNames) {
-  Node *n = createNode(NT_FUNDECL, returnType->line, returnType->character);
+  Node *n = createNode(NT_FUNDECL, returnType->offset);
   n->data.funDecl.returnType = returnType;
   n->data.funDecl.name = name;
-  n->data.funDecl.argTypes = argTypes;
-  n->data.funDecl.argNames = argNames;
+  n->data.funDecl.argTypes = freezeNodeVector(argTypes);
+  n->data.funDecl.argNames = freezeNodeVector(argNames);
   return n;
 }
 Node *varDeclNodeCreate(Node *type, Vector *names) {
-  Node *n = createNode(NT_VARDECL, type->line, type->character);
+  Node *n = createNode(NT_VARDECL, type->offset);
   n->data.varDecl.type = type;
-  n->data.varDecl.names = names;
+  n->data.varDecl.names = freezeNodeVector(names);
   return n;
 }
 Node *opaqueDeclNodeCreate(Token const *keyword, Node *name) {
-  Node *n = createNode(NT_OPAQUEDECL, keyword->line, keyword->character);
+  Node *n = createNode(NT_OPAQUEDECL, keyword->offset);
   n->data.opaqueDecl.name = name;
   return n;
 }
 Node *structDeclNodeCreate(Token const *keyword, Node *name, Vector *fields) {
-  Node *n = createNode(NT_STRUCTDECL, keyword->line, keyword->character);
+  Node *n = createNode(NT_STRUCTDECL, keyword->offset);
   n->data.structDecl.name = name;
-  n->data.structDecl.fields = fields;
+  n->data.structDecl.fields = freezeNodeVector(fields);
   return n;
 }
 Node *unionDeclNodeCreate(Token const *keyword, Node *name, Vector *options) {
-  Node *n = createNode(NT_UNIONDECL, keyword->line, keyword->character);
+  Node *n = createNode(NT_UNIONDECL, keyword->offset);
   n->data.unionDecl.name = name;
-  n->data.unionDecl.options = options;
+  n->data.unionDecl.options = freezeNodeVector(options);
   return n;
 }
 Node *enumDeclNodeCreate(Token const *keyword, Node *name,
                          Vector *constantNames, Vector *constantValues) {
-  Node *n = createNode(NT_ENUMDECL, keyword->line, keyword->character);
+  Node *n = createNode(NT_ENUMDECL, keyword->offset);
   n->data.enumDecl.name = name;
-  n->data.enumDecl.constantNames = constantNames;
-  n->data.enumDecl.constantValues = constantValues;
+  n->data.enumDecl.constantNames = freezeNodeVector(constantNames);
+  n->data.enumDecl.constantValues = freezeNodeVector(constantValues);
   return n;
 }
 Node *typedefDeclNodeCreate(Token const *keyword, Node *originalType,
                             Node *name) {
-  Node *n = createNode(NT_TYPEDEFDECL, keyword->line, keyword->character);
+  Node *n = createNode(NT_TYPEDEFDECL, keyword->offset);
   n->data.typedefDecl.originalType = originalType;
   n->data.typedefDecl.name = name;
   return n;
 }
 
-Node *compoundStmtNodeCreate(Token const *lbrace, Vector *stmts,
-                             HashMap *stab) {
-  Node *n = createNode(NT_COMPOUNDSTMT, lbrace->line, lbrace->character);
-  n->data.compoundStmt.stab = stab;
-  n->data.compoundStmt.stmts = stmts;
+Node *compoundStmtNodeCreate(Token const *lbrace, Vector *stmts, Scope *stab) {
+  Node *n = createNode(NT_COMPOUNDSTMT, lbrace->offset);
+  n->data.compoundStmt.stab = nodeScopeFreeze(stab);
+  n->data.compoundStmt.stmts = freezeNodeVector(stmts);
   return n;
 }
 Node *ifStmtNodeCreate(Token const *keyword, Node *predicate, Node *consequent,
-                       HashMap *consequentStab, Node *alternative,
-                       HashMap *alternativeStab) {
-  Node *n = createNode(NT_IFSTMT, keyword->line, keyword->character);
+                       Scope *consequentStab, Node *alternative,
+                       Scope *alternativeStab) {
+  Node *n = createNode(NT_IFSTMT, keyword->offset);
   n->data.ifStmt.predicate = predicate;
   n->data.ifStmt.consequent = consequent;
-  n->data.ifStmt.consequentStab = consequentStab;
+  n->data.ifStmt.consequentStab = nodeScopeFreeze(consequentStab);
   n->data.ifStmt.alternative = alternative;
-  n->data.ifStmt.alternativeStab = alternativeStab;
+  n->data.ifStmt.alternativeStab = nodeScopeFreeze(alternativeStab);
   return n;
 }
 Node *whileStmtNodeCreate(Token const *keyword, Node *condition, Node *body,
-                          HashMap *bodyStab) {
-  Node *n = createNode(NT_WHILESTMT, keyword->line, keyword->character);
+                          Scope *bodyStab) {
+  Node *n = createNode(NT_WHILESTMT, keyword->offset);
   n->data.whileStmt.condition = condition;
   n->data.whileStmt.body = body;
-  n->data.whileStmt.bodyStab = bodyStab;
+  n->data.whileStmt.bodyStab = nodeScopeFreeze(bodyStab);
   return n;
 }
-Node *doWhileStmtNodeCreate(Token const *keyword, Node *body, HashMap *bodyStab,
+Node *doWhileStmtNodeCreate(Token const *keyword, Node *body, Scope *bodyStab,
                             Node *condition) {
-  Node *n = createNode(NT_DOWHILESTMT, keyword->line, keyword->character);
+  Node *n = createNode(NT_DOWHILESTMT, keyword->offset);
   n->data.doWhileStmt.body = body;
-  n->data.doWhileStmt.bodyStab = bodyStab;
+  n->data.doWhileStmt.bodyStab = nodeScopeFreeze(bodyStab);
   n->data.doWhileStmt.condition = condition;
   return n;
 }
-Node *forStmtNodeCreate(Token const *keyword, HashMap *loopStab,
+Node *forStmtNodeCreate(Token const *keyword, Scope *loopStab,
                         Node *initializer, Node *condition, Node *increment,
-                        Node *body, HashMap *bodyStab) {
-  Node *n = createNode(NT_FORSTMT, keyword->line, keyword->character);
-  n->data.forStmt.loopStab = loopStab;
+                        Node *body, Scope *bodyStab) {
+  Node *n = createNode(NT_FORSTMT, keyword->offset);
+  n->data.forStmt.loopStab = nodeScopeFreeze(loopStab);
   n->data.forStmt.initializer = initializer;
   n->data.forStmt.condition = condition;
   n->data.forStmt.increment = increment;
   n->data.forStmt.body = body;
-  n->data.forStmt.bodyStab = bodyStab;
+  n->data.forStmt.bodyStab = nodeScopeFreeze(bodyStab);
   return n;
 }
 Node *switchStmtNodeCreate(Token const *keyword, Node *condition,
                            Vector *cases) {
-  Node *n = createNode(NT_SWITCHSTMT, keyword->line, keyword->character);
+  Node *n = createNode(NT_SWITCHSTMT, keyword->offset);
   n->data.switchStmt.condition = condition;
-  n->data.switchStmt.cases = cases;
+  n->data.switchStmt.cases = freezeNodeVector(cases);
   return n;
 }
 Node *breakStmtNodeCreate(Token const *keyword) {
-  Node *n = createNode(NT_BREAKSTMT, keyword->line, keyword->character);
+  Node *n = createNode(NT_BREAKSTMT, keyword->offset);
   return n;
 }
 Node *continueStmtNodeCreate(Token const *keyword) {
-  Node *n = createNode(NT_CONTINUESTMT, keyword->line, keyword->character);
+  Node *n = createNode(NT_CONTINUESTMT, keyword->offset);
   return n;
 }
 Node *returnStmtNodeCreate(Token const *keyword, Node *value) {
-  Node *n = createNode(NT_RETURNSTMT, keyword->line, keyword->character);
+  Node *n = createNode(NT_RETURNSTMT, keyword->offset);
   n->data.returnStmt.value = value;
   return n;
 }
 Node *varDefnStmtNodeCreate(Node *type, Vector *names, Vector *initializers) {
-  Node *n = createNode(NT_VARDEFNSTMT, type->line, type->character);
+  Node *n = createNode(NT_VARDEFNSTMT, type->offset);
   n->data.varDefnStmt.type = type;
-  n->data.varDefnStmt.names = names;
-  n->data.varDefnStmt.initializers = initializers;
+  n->data.varDefnStmt.names = freezeNodeVector(names);
+  n->data.varDefnStmt.initializers = freezeNodeVector(initializers);
   return n;
 }
 Node *expressionStmtNodeCreate(Node *expression) {
-  Node *n =
-      createNode(NT_EXPRESSIONSTMT, expression->line, expression->character);
+  Node *n = createNode(NT_EXPRESSIONSTMT, expression->offset);
   n->data.expressionStmt.expression = expression;
   return n;
 }
 Node *nullStmtNodeCreate(Token const *semicolon) {
-  Node *n = createNode(NT_NULLSTMT, semicolon->line, semicolon->character);
+  Node *n = createNode(NT_NULLSTMT, semicolon->offset);
   return n;
 }
 
 Node *switchCaseNodeCreate(Token const *keyword, Vector *values, Node *body,
-                           HashMap *bodyStab) {
-  Node *n = createNode(NT_SWITCHCASE, keyword->line, keyword->character);
-  n->data.switchCase.values = values;
+                           Scope *bodyStab) {
+  Node *n = createNode(NT_SWITCHCASE, keyword->offset);
+  n->data.switchCase.values = freezeNodeVector(values);
   n->data.switchCase.body = body;
-  n->data.switchCase.bodyStab = bodyStab;
+  n->data.switchCase.bodyStab = nodeScopeFreeze(bodyStab);
   return n;
 }
 Node *switchDefaultNodeCreate(Token const *keyword, Node *body,
-                              HashMap *bodyStab) {
-  Node *n = createNode(NT_SWITCHDEFAULT, keyword->line, keyword->character);
+                              Scope *bodyStab) {
+  Node *n = createNode(NT_SWITCHDEFAULT, keyword->offset);
   n->data.switchDefault.body = body;
-  n->data.switchDefault.bodyStab = bodyStab;
+  n->data.switchDefault.bodyStab = nodeScopeFreeze(bodyStab);
   return n;
 }
 
 Node *binOpExpNodeCreate(BinOpType op, Node *lhs, Node *rhs) {
-  Node *n = createNode(NT_BINOPEXP, lhs->line, lhs->character);
+  Node *n = createNode(NT_BINOPEXP, lhs->offset);
   n->data.binOpExp.op = op;
   n->data.binOpExp.lhs = lhs;
   n->data.binOpExp.rhs = rhs;
@@ -463,7 +351,7 @@ Node *binOpExpNodeCreate(BinOpType op, Node *lhs, Node *rhs) {
 }
 Node *castExpNodeCreate(Token const *opToken, Node *type, Type *parsedType,
                         Node *target) {
-  Node *n = createNode(NT_BINOPEXP, opToken->line, opToken->character);
+  Node *n = createNode(NT_BINOPEXP, opToken->offset);
   n->data.binOpExp.op = BO_CAST;
   n->data.binOpExp.lhs = type;
   n->data.binOpExp.rhs = target;
@@ -473,7 +361,7 @@ Node *castExpNodeCreate(Token const *opToken, Node *type, Type *parsedType,
 }
 Node *ternaryExpNodeCreate(Node *predicate, Node *consequent,
                            Node *alternative) {
-  Node *n = createNode(NT_TERNARYEXP, predicate->line, predicate->character);
+  Node *n = createNode(NT_TERNARYEXP, predicate->offset);
   n->data.ternaryExp.predicate = predicate;
   n->data.ternaryExp.consequent = consequent;
   n->data.ternaryExp.alternative = alternative;
@@ -481,14 +369,14 @@ Node *ternaryExpNodeCreate(Node *predicate, Node *consequent,
   return n;
 }
 Node *prefixUnOpExpNodeCreate(UnOpType op, Token const *opToken, Node *target) {
-  Node *n = createNode(NT_UNOPEXP, opToken->line, opToken->character);
+  Node *n = createNode(NT_UNOPEXP, opToken->offset);
   n->data.unOpExp.op = op;
   n->data.unOpExp.target = target;
   n->data.unOpExp.type = NULL;
   return n;
 }
 Node *postfixUnOpExpNodeCreate(UnOpType op, Node *target) {
-  Node *n = createNode(NT_UNOPEXP, target->line, target->character);
+  Node *n = createNode(NT_UNOPEXP, target->offset);
   n->data.unOpExp.op = op;
   n->data.unOpExp.target = target;
   n->data.unOpExp.type = NULL;
@@ -496,28 +384,28 @@ Node *postfixUnOpExpNodeCreate(UnOpType op, Node *target) {
 }
 Node *sizeofTypeExpNodeCreate(Token const *opToken, Node *targetNode,
                               Type *targetType) {
-  Node *n = createNode(NT_SIZEOFTYPEEXP, opToken->line, opToken->character);
+  Node *n = createNode(NT_SIZEOFTYPEEXP, opToken->offset);
   n->data.sizeofTypeExp.targetNode = targetNode;
   n->data.sizeofTypeExp.targetType = targetType;
   n->data.sizeofTypeExp.type = NULL;
   return n;
 }
 Node *funCallExpNodeCreate(Node *function, Vector *arguments) {
-  Node *n = createNode(NT_FUNCALLEXP, function->line, function->character);
+  Node *n = createNode(NT_FUNCALLEXP, function->offset);
   n->data.funCallExp.function = function;
-  n->data.funCallExp.arguments = arguments;
+  n->data.funCallExp.arguments = freezeNodeVector(arguments);
   n->data.funCallExp.type = NULL;
   return n;
 }
 
 Node *literalNodeCreate(LiteralType type, Token const *t) {
-  Node *n = createNode(NT_LITERAL, t->line, t->character);
+  Node *n = createNode(NT_LITERAL, t->offset);
   n->data.literal.literalType = type;
   n->data.literal.type = NULL;
   return n;
 }
 Node *charLiteralNodeCreate(Token *t) {
-  Node *n = createNode(NT_LITERAL, t->line, t->character);
+  Node *n = createNode(NT_LITERAL, t->offset);
   n->data.literal.literalType = LT_CHAR;
   n->data.literal.type = NULL;
 
@@ -569,7 +457,7 @@ Node *charLiteralNodeCreate(Token *t) {
   return n;
 }
 Node *wcharLiteralNodeCreate(Token *t) {
-  Node *n = createNode(NT_LITERAL, t->line, t->character);
+  Node *n = createNode(NT_LITERAL, t->offset);
   n->data.literal.literalType = LT_WCHAR;
   n->data.literal.type = NULL;
 
@@ -628,131 +516,111 @@ Node *wcharLiteralNodeCreate(Token *t) {
   tokenUninit(t);
   return n;
 }
+/**
+ * decodes an escape sequence in a string or wstring literal
+ *
+ * @param string pointer to the character after the backslash, advanced past
+ * the escape sequence
+ * @returns decoded character
+ */
+static uint32_t decodeStringEscape(char const **string) {
+  char const *escape = (*string)++;
+  switch (*escape) {
+    case 'n': {
+      return charToU8('\n');
+    }
+    case 'r': {
+      return charToU8('\r');
+    }
+    case 't': {
+      return charToU8('\t');
+    }
+    case '0': {
+      return charToU8('\0');
+    }
+    case '\\': {
+      return charToU8('\\');
+    }
+    case '"': {
+      return charToU8('"');
+    }
+    case 'x': {
+      *string += 2;
+      return (uint32_t)((nybbleToU8(escape[1]) << 4) +
+                        (nybbleToU8(escape[2]) << 0));
+    }
+    case 'u': {
+      uint32_t value = 0;
+      for (size_t idx = 1; idx <= 8; ++idx) {
+        value <<= 4;
+        value += nybbleToU8(escape[idx]);
+      }
+      *string += 8;
+      return value;
+    }
+    default: {
+      error(__FILE__, __LINE__,
+            "bad escape sequence in string passed to string literal creation");
+    }
+  }
+}
+Node *aggregateInitLiteralNodeCreate(Token const *lsquare, Vector *literals) {
+  Node *n = literalNodeCreate(LT_AGGREGATEINIT, lsquare);
+  n->data.literal.data.aggregateInitVal = freezeNodeVector(literals);
+  return n;
+}
 Node *stringLiteralNodeCreate(Token *t) {
-  Node *n = createNode(NT_LITERAL, t->line, t->character);
+  Node *n = createNode(NT_LITERAL, t->offset);
   n->data.literal.literalType = LT_STRING;
   n->data.literal.type = NULL;
 
-  TStringBuilder sb;
-  tstringBuilderInit(&sb);
-  for (char *string = t->string; *string != '\0'; ++string) {
-    if (*string == '\\') {
-      ++string;
-      // escape sequence
-      switch (*string) {
-        case 'n': {
-          tstringBuilderPush(&sb, charToU8('\n'));
-          break;
-        }
-        case 'r': {
-          tstringBuilderPush(&sb, charToU8('\r'));
-          break;
-        }
-        case 't': {
-          tstringBuilderPush(&sb, charToU8('\t'));
-          break;
-        }
-        case '0': {
-          tstringBuilderPush(&sb, charToU8('\0'));
-          break;
-        }
-        case '\\': {
-          tstringBuilderPush(&sb, charToU8('\\'));
-          break;
-        }
-        case 'x': {
-          char high = *string++;
-          char low = *string;
-          tstringBuilderPush(
-              &sb, (uint8_t)((nybbleToU8(high) << 4) + (nybbleToU8(low) << 0)));
-          break;
-        }
-        case '\'': {
-          tstringBuilderPush(&sb, charToU8('\''));
-          break;
-        }
-        default: {
-          error(__FILE__, __LINE__,
-                "bad string literal string passed to stringLiteralNodeCreate");
-        }
-      }
-    } else {
-      // not an escape statement
-      tstringBuilderPush(&sb, charToU8(*string));
-    }
+  // escapes never decode to more characters than they're written with, so
+  // the literal's length bounds the decoded length
+  char const *string = t->string;
+  uint8_t *decoded = nodeAllocate(strlen(string) + 1);
+  size_t length = 0;
+  while (true) {
+    // copy everything up to the next escape in one go
+    size_t run = strcspn(string, "\\");
+    memcpy(decoded + length, string, run);
+    length += run;
+    string += run;
+
+    if (*string == '\0') break;
+    ++string;
+    decoded[length++] = (uint8_t)decodeStringEscape(&string);
   }
+  decoded[length] = '\0';
 
-  n->data.literal.data.stringVal = tstringBuilderData(&sb);
-  tstringBuilderUninit(&sb);
+  n->data.literal.data.stringVal = decoded;
   tokenUninit(t);
   return n;
 }
 Node *wstringLiteralNodeCreate(Token *t) {
-  Node *n = createNode(NT_LITERAL, t->line, t->character);
+  Node *n = createNode(NT_LITERAL, t->offset);
   n->data.literal.literalType = LT_WSTRING;
   n->data.literal.type = NULL;
 
-  TWStringBuilder sb;
-  twstringBuilderInit(&sb);
-  for (char *string = t->string; *string != '\0'; ++string) {
-    if (*string == '\\') {
-      ++string;
-      // escape sequence
-      switch (*string) {
-        case 'n': {
-          twstringBuilderPush(&sb, charToU8('\n'));
-          break;
-        }
-        case 'r': {
-          twstringBuilderPush(&sb, charToU8('\r'));
-          break;
-        }
-        case 't': {
-          twstringBuilderPush(&sb, charToU8('\t'));
-          break;
-        }
-        case '0': {
-          twstringBuilderPush(&sb, charToU8('\0'));
-          break;
-        }
-        case '\\': {
-          twstringBuilderPush(&sb, charToU8('\\'));
-          break;
-        }
-        case 'x': {
-          char high = *string++;
-          char low = *string;
-          twstringBuilderPush(
-              &sb, (uint8_t)((nybbleToU8(high) << 4) + (nybbleToU8(low) << 0)));
-          break;
-        }
-        case 'u': {
-          uint32_t value = 0;
-          for (size_t idx = 0; idx < 8; ++idx, ++string) {
-            value <<= 4;
-            value += nybbleToU8(*string);
-          }
-          twstringBuilderPush(&sb, value);
-          break;
-        }
-        case '\'': {
-          twstringBuilderPush(&sb, charToU8('\''));
-          break;
-        }
-        default: {
-          error(
-              __FILE__, __LINE__,
-              "bad wstring literal string passed to wstringLiteralNodeCreate");
-        }
-      }
-    } else {
-      // not an escape statement
-      twstringBuilderPush(&sb, charToU8(*string));
-    }
+  // see stringLiteralNodeCreate
+  char const *string = t->string;
+  uint32_t *decoded = nodeAllocate((strlen(string) + 1) * sizeof(uint32_t));
+  size_t length = 0;
+  while (true) {
+    // widen everything up to the next escape - the lexer only lets ASCII
+    // through, so this is a plain zero extension, which the compiler vectorizes
+    size_t run = strcspn(string, "\\");
+    for (size_t idx = 0; idx < run; ++idx)
+      decoded[length + idx] = (uint8_t)string[idx];
+    length += run;
+    string += run;
+
+    if (*string == '\0') break;
+    ++string;
+    decoded[length++] = decodeStringEscape(&string);
   }
+  decoded[length] = 0;
 
-  n->data.literal.data.wstringVal = twstringBuilderData(&sb);
-  twstringBuilderUninit(&sb);
+  n->data.literal.data.wstringVal = decoded;
   tokenUninit(t);
   return n;
 }
@@ -845,53 +713,52 @@ Node *sizedIntegerLiteralNodeCreate(Token *t, int8_t sign, uint64_t magnitude) {
 }
 
 Node *keywordTypeNodeCreate(TypeKeyword keyword, Token const *keywordToken) {
-  Node *n =
-      createNode(NT_KEYWORDTYPE, keywordToken->line, keywordToken->character);
+  Node *n = createNode(NT_KEYWORDTYPE, keywordToken->offset);
   n->data.keywordType.keyword = keyword;
   return n;
 }
 Node *modifiedTypeNodeCreate(TypeModifierKind modifier, Node *baseType) {
-  Node *n = createNode(NT_MODIFIEDTYPE, baseType->line, baseType->character);
+  Node *n = createNode(NT_MODIFIEDTYPE, baseType->offset);
   n->data.modifiedType.modifier = modifier;
   n->data.modifiedType.baseType = baseType;
   return n;
 }
 Node *arrayTypeNodeCreate(Node *baseType, Node *size) {
-  Node *n = createNode(NT_ARRAYTYPE, baseType->line, baseType->character);
+  Node *n = createNode(NT_ARRAYTYPE, baseType->offset);
   n->data.arrayType.baseType = baseType;
   n->data.arrayType.size = size;
   return n;
 }
 Node *funPtrTypeNodeCreate(Node *returnType, Vector *argTypes,
                            Vector *argNames) {
-  Node *n = createNode(NT_FUNPTRTYPE, returnType->line, returnType->character);
+  Node *n = createNode(NT_FUNPTRTYPE, returnType->offset);
   n->data.funPtrType.returnType = returnType;
-  n->data.funPtrType.argTypes = argTypes;
-  n->data.funPtrType.argNames = argNames;
+  n->data.funPtrType.argTypes = freezeNodeVector(argTypes);
+  n->data.funPtrType.argNames = freezeNodeVector(argNames);
   return n;
 }
 
 Node *scopedIdNodeCreate(Vector *components) {
   Node *first = components->elements[0];
-  Node *n = createNode(NT_SCOPEDID, first->line, first->character);
-  n->data.scopedId.components = components;
+  Node *n = createNode(NT_SCOPEDID, first->offset);
+  n->data.scopedId.components = freezeNodeVector(components);
   n->data.scopedId.entry = NULL;
   n->data.scopedId.type = NULL;
   return n;
 }
 Node *idNodeCreate(Token *id) {
-  Node *n = createNode(NT_ID, id->line, id->character);
+  Node *n = createNode(NT_ID, id->offset);
   n->data.id.id = id->string;
   n->data.id.entry = NULL;
   n->data.id.type = NULL;
   return n;
 }
 
-Node *unparsedNodeCreate(Vector *tokens) {
-  Token const *first = tokens->elements[0];
-  Node *n = createNode(NT_UNPARSED, first->line, first->character);
+Node *unparsedNodeCreate(TokenVector *tokens, size_t begin) {
+  Token const *first = &tokens->elements[begin];
+  Node *n = createNode(NT_UNPARSED, first->offset);
   n->data.unparsed.tokens = tokens;
-  n->data.unparsed.curr = 0;
+  n->data.unparsed.curr = begin;
   return n;
 }
 
@@ -920,8 +787,12 @@ char *stringifyId(Node *id) {
 }
 
 static void errorNotPositive(Node *n, Environment *env) {
-  fprintf(stderr, "%s:%zu:%zu: error: array length must be positive",
-          env->currentModuleFile->inputFilename, n->line, n->character);
+  size_t line;
+  size_t character;
+  fileListEntryPosition(env->currentModuleFile, n->offset, &line, &character);
+  fprintf(diagnosticStream(),
+          "%s:%zu:%zu: error: array length must be positive",
+          env->currentModuleFile->inputFilename, line, character);
 }
 /**
  * gets the uint64_t value of the extended int literal
@@ -996,10 +867,14 @@ static uint64_t extendedIntLiteralToArrayLength(Node *n, Environment *env) {
       if (enumConst == NULL) {
         return 0;
       } else if (enumConst->kind != SK_ENUMCONST) {
-        fprintf(stderr,
+        size_t line;
+        size_t character;
+        fileListEntryPosition(env->currentModuleFile, n->offset, &line,
+                              &character);
+        fprintf(diagnosticStream(),
                 "%s:%zu:%zu: error: expected an extended integer "
                 "literal, found %s\n",
-                env->currentModuleFile->inputFilename, n->line, n->character,
+                env->currentModuleFile->inputFilename, line, character,
                 symbolKindToString(enumConst->kind));
         env->currentModuleFile->errored = true;
         return 0;
@@ -1038,8 +913,8 @@ Type *nodeToType(Node *n, Environment *env) {
         case TMK_CONST: {
           Type *inner = nodeToType(n->data.modifiedType.baseType, env);
           if (inner->kind == TK_QUALIFIED) {
-            inner->data.qualified.constQual = true;
-            return inner;
+            return qualifiedTypeCreate(inner->data.qualified.base, true,
+                                       inner->data.qualified.volatileQual);
           } else {
             return qualifiedTypeCreate(inner, true, false);
           }
@@ -1047,8 +922,8 @@ Type *nodeToType(Node *n, Environment *env) {
         case TMK_VOLATILE: {
           Type *inner = nodeToType(n->data.modifiedType.baseType, env);
           if (inner->kind == TK_QUALIFIED) {
-            inner->data.qualified.volatileQual = true;
-            return inner;
+            return qualifiedTypeCreate(inner->data.qualified.base,
+                                       inner->data.qualified.constQual, true);
           } else {
             return qualifiedTypeCreate(inner, false, true);
           }
@@ -1070,20 +945,20 @@ Type *nodeToType(Node *n, Environment *env) {
       Type *inner = nodeToType(n->data.funPtrType.returnType, env);
       if (inner == NULL) return NULL;
 
-      Type *retval = funPtrTypeCreate(inner);
-
+      Vector argTypes;
+      vectorInit(&argTypes);
       for (size_t idx = 0; idx < n->data.funPtrType.argTypes->size; ++idx) {
         Type *argType =
             nodeToType(n->data.funPtrType.argTypes->elements[idx], env);
         if (argType == NULL) {
-          typeFree(retval);
+          vectorUninit(&argTypes, nullDtor);
           return NULL;
         }
 
-        vectorInsert(&retval->data.funPtr.argTypes, argType);
+        vectorInsert(&argTypes, argType);
       }
 
-      return retval;
+      return funPtrTypeCreate(inner, &argTypes);
     }
     case NT_SCOPEDID: {
       SymbolTableEntry *entry = environmentLookup(env, n, false);
@@ -1098,8 +973,12 @@ Type *nodeToType(Node *n, Environment *env) {
         }
         default: {
           char *idString = stringifyId(n);
-          fprintf(stderr, "%s:%zu:%zu: error: '%s' is not a type\n",
-                  env->currentModuleFile->inputFilename, n->line, n->character,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(env->currentModuleFile, n->offset, &line,
+                                &character);
+          fprintf(diagnosticStream(), "%s:%zu:%zu: error: '%s' is not a type\n",
+                  env->currentModuleFile->inputFilename, line, character,
                   idString);
           free(idString);
           return NULL;
@@ -1121,8 +1000,12 @@ Type *nodeToType(Node *n, Environment *env) {
           return referenceTypeCreate(entry);
         }
         default: {
-          fprintf(stderr, "%s:%zu:%zu: error: '%s' is not a type\n",
-                  env->currentModuleFile->inputFilename, n->line, n->character,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(env->currentModuleFile, n->offset, &line,
+                                &character);
+          fprintf(diagnosticStream(), "%s:%zu:%zu: error: '%s' is not a type\n",
+                  env->currentModuleFile->inputFilename, line, character,
                   n->data.id.id);
           return NULL;
         }
@@ -1138,7 +1021,7 @@ bool nameNodeEqual(Node *a, Node *b) {
   if (a->type != b->type) return false;
 
   if (a->type == NT_ID) {
-    return strcmp(a->data.id.id, b->data.id.id) == 0;
+    return a->data.id.id == b->data.id.id;
   } else {
     if (a->data.scopedId.components->size != b->data.scopedId.components->size)
       return false;
@@ -1146,8 +1029,7 @@ bool nameNodeEqual(Node *a, Node *b) {
     for (size_t idx = 0; idx < a->data.scopedId.components->size; ++idx) {
       Node *aComponent = a->data.scopedId.components->elements[idx];
       Node *bComponent = b->data.scopedId.components->elements[idx];
-      if (strcmp(aComponent->data.id.id, bComponent->data.id.id) != 0)
-        return false;
+      if (aComponent->data.id.id != bComponent->data.id.id) return false;
     }
     return true;
   }
@@ -1159,7 +1041,7 @@ bool nameNodeEqualWithDrop(Node *a, Node *b, size_t dropCount) {
   if (a->type == NT_ID) {
     if (compareLength == 1) {
       Node *first = b->data.scopedId.components->elements[0];
-      return strcmp(a->data.id.id, first->data.id.id) == 0;
+      return a->data.id.id == first->data.id.id;
     } else {
       return false;
     }
@@ -1169,126 +1051,146 @@ bool nameNodeEqualWithDrop(Node *a, Node *b, size_t dropCount) {
     for (size_t idx = 0; idx < compareLength; ++idx) {
       Node *aComponent = a->data.scopedId.components->elements[idx];
       Node *bComponent = b->data.scopedId.components->elements[idx];
-      if (strcmp(aComponent->data.id.id, bComponent->data.id.id) != 0)
-        return false;
+      if (aComponent->data.id.id != bComponent->data.id.id) return false;
     }
     return true;
   }
 }
 
-static void nullableTokenFree(Token *token) {
-  if (token != NULL) {
-    tokenUninit(token);
-    free(token);
-  }
+static void nodeRelease(Node *n);
+
+/**
+ * releases what each node in a vector owns outside of its arena
+ *
+ * @param v vector to release the elements of, can have null elements
+ */
+static void nodeVectorRelease(Vector *v) {
+  for (size_t idx = 0; idx < v->size; ++idx) nodeRelease(v->elements[idx]);
 }
-void nodeFree(Node *n) {
+
+/**
+ * releases the entries of a scope in an arena
+ *
+ * @param scope scope to release, may be null
+ */
+static void scopeRelease(Scope *scope) {
+  if (scope != NULL) scopeUninit(scope);
+}
+
+/**
+ * releases what a node and its children own outside of their arena
+ *
+ * @param n node to release, may be null
+ */
+static void nodeRelease(Node *n) {
   if (n == NULL) return;
   switch (n->type) {
     case NT_FILE: {
       stabFree(n->data.file.stab);
-      nodeFree(n->data.file.module);
-      nodeVectorFree(n->data.file.imports);
-      nodeVectorFree(n->data.file.bodies);
+      importIndexFree(n->data.file.importIndex);
+      nodeRelease(n->data.file.module);
+      nodeVectorRelease(n->data.file.imports);
+      nodeVectorRelease(n->data.file.bodies);
+      tokenVectorFree(n->data.file.bodyTokens);
       break;
     }
     case NT_MODULE: {
-      nodeFree(n->data.module.id);
+      nodeRelease(n->data.module.id);
       break;
     }
     case NT_IMPORT: {
-      nodeFree(n->data.import.id);
+      nodeRelease(n->data.import.id);
       break;
     }
     case NT_FUNDEFN: {
-      nodeFree(n->data.funDefn.returnType);
-      nodeFree(n->data.funDefn.name);
-      nodeVectorFree(n->data.funDefn.argTypes);
-      nodeVectorFree(n->data.funDefn.argNames);
-      stabFree(n->data.funDefn.argStab);
-      nodeFree(n->data.funDefn.body);
+      nodeRelease(n->data.funDefn.returnType);
+      nodeRelease(n->data.funDefn.name);
+      nodeVectorRelease(n->data.funDefn.argTypes);
+      nodeVectorRelease(n->data.funDefn.argNames);
+      scopeRelease(n->data.funDefn.argStab);
+      nodeRelease(n->data.funDefn.body);
       break;
     }
     case NT_VARDEFN: {
-      nodeFree(n->data.varDefn.type);
-      nodeVectorFree(n->data.varDefn.names);
-      nodeVectorFree(n->data.varDefn.initializers);
+      nodeRelease(n->data.varDefn.type);
+      nodeVectorRelease(n->data.varDefn.names);
+      nodeVectorRelease(n->data.varDefn.initializers);
       break;
     }
     case NT_FUNDECL: {
-      nodeFree(n->data.funDecl.returnType);
-      nodeFree(n->data.funDecl.name);
-      nodeVectorFree(n->data.funDecl.argTypes);
-      nodeVectorFree(n->data.funDecl.argNames);
+      nodeRelease(n->data.funDecl.returnType);
+      nodeRelease(n->data.funDecl.name);
+      nodeVectorRelease(n->data.funDecl.argTypes);
+      nodeVectorRelease(n->data.funDecl.argNames);
       break;
     }
     case NT_VARDECL: {
-      nodeFree(n->data.varDecl.type);
-      nodeVectorFree(n->data.varDecl.names);
+      nodeRelease(n->data.varDecl.type);
+      nodeVectorRelease(n->data.varDecl.names);
       break;
     }
     case NT_OPAQUEDECL: {
-      nodeFree(n->data.opaqueDecl.name);
+      nodeRelease(n->data.opaqueDecl.name);
       break;
     }
     case NT_STRUCTDECL: {
-      nodeFree(n->data.structDecl.name);
-      nodeVectorFree(n->data.structDecl.fields);
+      nodeRelease(n->data.structDecl.name);
+      nodeVectorRelease(n->data.structDecl.fields);
       break;
     }
     case NT_UNIONDECL: {
-      nodeFree(n->data.unionDecl.name);
-      nodeVectorFree(n->data.unionDecl.options);
+      nodeRelease(n->data.unionDecl.name);
+      nodeVectorRelease(n->data.unionDecl.options);
       break;
     }
     case NT_ENUMDECL: {
-      nodeFree(n->data.enumDecl.name);
-      nodeVectorFree(n->data.enumDecl.constantNames);
-      nodeVectorFree(n->data.enumDecl.constantValues);
+      nodeRelease(n->data.enumDecl.name);
+      nodeVectorRelease(n->data.enumDecl.constantNames);
+      nodeVectorRelease(n->data.enumDecl.constantValues);
       break;
     }
     case NT_TYPEDEFDECL: {
-      nodeFree(n->data.typedefDecl.originalType);
-      nodeFree(n->data.typedefDecl.name);
+      nodeRelease(n->data.typedefDecl.originalType);
+      nodeRelease(n->data.typedefDecl.name);
       break;
     }
     case NT_COMPOUNDSTMT: {
-      nodeVectorFree(n->data.compoundStmt.stmts);
-      stabFree(n->data.compoundStmt.stab);
+      nodeVectorRelease(n->data.compoundStmt.stmts);
+      scopeRelease(n->data.compoundStmt.stab);
       break;
     }
     case NT_IFSTMT: {
-      nodeFree(n->data.ifStmt.predicate);
-      nodeFree(n->data.ifStmt.consequent);
-      stabFree(n->data.ifStmt.consequentStab);
-      nodeFree(n->data.ifStmt.alternative);
-      stabFree(n->data.ifStmt.alternativeStab);
+      nodeRelease(n->data.ifStmt.predicate);
+      nodeRelease(n->data.ifStmt.consequent);
+      scopeRelease(n->data.ifStmt.consequentStab);
+      nodeRelease(n->data.ifStmt.alternative);
+      scopeRelease(n->data.ifStmt.alternativeStab);
       break;
     }
     case NT_WHILESTMT: {
-      nodeFree(n->data.whileStmt.condition);
-      nodeFree(n->data.whileStmt.body);
-      stabFree(n->data.whileStmt.bodyStab);
+      nodeRelease(n->data.whileStmt.condition);
+      nodeRelease(n->data.whileStmt.body);
+      scopeRelease(n->data.whileStmt.bodyStab);
       break;
     }
     case NT_DOWHILESTMT: {
-      nodeFree(n->data.doWhileStmt.body);
-      nodeFree(n->data.doWhileStmt.condition);
-      stabFree(n->data.doWhileStmt.bodyStab);
+      nodeRelease(n->data.doWhileStmt.body);
+      nodeRelease(n->data.doWhileStmt.condition);
+      scopeRelease(n->data.doWhileStmt.bodyStab);
       break;
     }
     case NT_FORSTMT: {
-      stabFree(n->data.forStmt.loopStab);
-      nodeFree(n->data.forStmt.initializer);
-      nodeFree(n->data.forStmt.condition);
-      nodeFree(n->data.forStmt.increment);
-      nodeFree(n->data.forStmt.body);
-      stabFree(n->data.forStmt.bodyStab);
+      scopeRelease(n->data.forStmt.loopStab);
+      nodeRelease(n->data.forStmt.initializer);
+      nodeRelease(n->data.forStmt.condition);
+      nodeRelease(n->data.forStmt.increment);
+      nodeRelease(n->data.forStmt.body);
+      scopeRelease(n->data.forStmt.bodyStab);
       break;
     }
     case NT_SWITCHSTMT: {
-      nodeFree(n->data.switchStmt.condition);
-      nodeVectorFree(n->data.switchStmt.cases);
+      nodeRelease(n->data.switchStmt.condition);
+      nodeVectorRelease(n->data.switchStmt.cases);
       break;
     }
     case NT_BREAKSTMT: {
@@ -1298,121 +1200,104 @@ void nodeFree(Node *n) {
       break;
     }
     case NT_RETURNSTMT: {
-      nodeFree(n->data.returnStmt.value);
+      nodeRelease(n->data.returnStmt.value);
       break;
     }
     case NT_VARDEFNSTMT: {
-      nodeFree(n->data.varDefnStmt.type);
-      nodeVectorFree(n->data.varDefnStmt.names);
-      nodeVectorFree(n->data.varDefnStmt.initializers);
+      nodeRelease(n->data.varDefnStmt.type);
+      nodeVectorRelease(n->data.varDefnStmt.names);
+      nodeVectorRelease(n->data.varDefnStmt.initializers);
       break;
     }
     case NT_EXPRESSIONSTMT: {
-      nodeFree(n->data.expressionStmt.expression);
+      nodeRelease(n->data.expressionStmt.expression);
       break;
     }
     case NT_NULLSTMT: {
       break;
     }
     case NT_SWITCHCASE: {
-      nodeVectorFree(n->data.switchCase.values);
-      nodeFree(n->data.switchCase.body);
-      stabFree(n->data.switchCase.bodyStab);
+      nodeVectorRelease(n->data.switchCase.values);
+      nodeRelease(n->data.switchCase.body);
+      scopeRelease(n->data.switchCase.bodyStab);
       break;
     }
     case NT_SWITCHDEFAULT: {
-      nodeFree(n->data.switchDefault.body);
-      stabFree(n->data.switchDefault.bodyStab);
+      nodeRelease(n->data.switchDefault.body);
+      scopeRelease(n->data.switchDefault.bodyStab);
       break;
     }
     case NT_BINOPEXP: {
-      nodeFree(n->data.binOpExp.lhs);
-      nodeFree(n->data.binOpExp.rhs);
-      typeFree(n->data.binOpExp.type);
-      typeFree(n->data.binOpExp.comparisonType);
+      nodeRelease(n->data.binOpExp.lhs);
+      nodeRelease(n->data.binOpExp.rhs);
       break;
     }
     case NT_TERNARYEXP: {
-      nodeFree(n->data.ternaryExp.predicate);
-      nodeFree(n->data.ternaryExp.consequent);
-      nodeFree(n->data.ternaryExp.alternative);
-      typeFree(n->data.ternaryExp.type);
+      nodeRelease(n->data.ternaryExp.predicate);
+      nodeRelease(n->data.ternaryExp.consequent);
+      nodeRelease(n->data.ternaryExp.alternative);
       break;
     }
     case NT_UNOPEXP: {
-      nodeFree(n->data.unOpExp.target);
-      typeFree(n->data.unOpExp.type);
+      nodeRelease(n->data.unOpExp.target);
       break;
     }
     case NT_SIZEOFTYPEEXP: {
-      nodeFree(n->data.sizeofTypeExp.targetNode);
-      typeFree(n->data.sizeofTypeExp.targetType);
-      typeFree(n->data.sizeofTypeExp.type);
+      nodeRelease(n->data.sizeofTypeExp.targetNode);
       break;
     }
     case NT_FUNCALLEXP: {
-      nodeFree(n->data.funCallExp.function);
-      nodeVectorFree(n->data.funCallExp.arguments);
-      typeFree(n->data.funCallExp.type);
+      nodeRelease(n->data.funCallExp.function);
+      nodeVectorRelease(n->data.funCallExp.arguments);
       break;
     }
     case NT_LITERAL: {
       switch (n->data.literal.literalType) {
-        case LT_STRING: {
-          free(n->data.literal.data.stringVal);
-          break;
-        }
-        case LT_WSTRING: {
-          free(n->data.literal.data.wstringVal);
-          break;
-        }
         case LT_AGGREGATEINIT: {
-          nodeVectorFree(n->data.literal.data.aggregateInitVal);
+          nodeVectorRelease(n->data.literal.data.aggregateInitVal);
           break;
         }
         default: {
           break;
         }
       }
-      typeFree(n->data.literal.type);
       break;
     }
     case NT_KEYWORDTYPE: {
       break;
     }
     case NT_MODIFIEDTYPE: {
-      nodeFree(n->data.modifiedType.baseType);
+      nodeRelease(n->data.modifiedType.baseType);
       break;
     }
     case NT_ARRAYTYPE: {
-      nodeFree(n->data.arrayType.baseType);
-      nodeFree(n->data.arrayType.size);
+      nodeRelease(n->data.arrayType.baseType);
+      nodeRelease(n->data.arrayType.size);
       break;
     }
     case NT_FUNPTRTYPE: {
-      nodeFree(n->data.funPtrType.returnType);
-      nodeVectorFree(n->data.funPtrType.argTypes);
-      nodeVectorFree(n->data.funPtrType.argNames);
+      nodeRelease(n->data.funPtrType.returnType);
+      nodeVectorRelease(n->data.funPtrType.argTypes);
+      nodeVectorRelease(n->data.funPtrType.argNames);
       break;
     }
     case NT_SCOPEDID: {
-      nodeVectorFree(n->data.scopedId.components);
-      typeFree(n->data.scopedId.type);
+      nodeVectorRelease(n->data.scopedId.components);
       break;
     }
     case NT_ID: {
-      free(n->data.id.id);
-      typeFree(n->data.id.type);
       break;
     }
     case NT_UNPARSED: {
-      vectorUninit(n->data.unparsed.tokens,
-                   (void (*)(void *))nullableTokenFree);
-      free(n->data.unparsed.tokens);
-      break;
+      break;  // tokens are owned by the file
     }
   }
-  free(n);
+}
+
+void nodeFree(Node *n) {
+  if (n == NULL) return;
+  nodeRelease(n);
+  if (n->type == NT_FILE) arenaFree(n->data.file.arena);
 }
 
 void nodeVectorFree(Vector *v) {
@@ -26,10 +26,12 @@
 #define TLC_AST_AST_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "ast/environment.h"
 #include "ast/symbolTable.h"
 #include "lexer/lexer.h"
+#include "util/arena.h"
 #include "util/container/vector.h"
 
 /** the type of an AST node */
@@ -129,19 +131,11 @@ typedef enum {
   BO_CAST,
 } BinOpType;
 /**
- * converts tokens to their corresponding binops
+ * converts accessor tokens to their corresponding binops
  *
  * @param token token type of the operator
  * @returns binary operator
  */
-BinOpType assignmentTokenToBinop(TokenType token);
-BinOpType logicalTokenToBinop(TokenType token);
-BinOpType bitwiseTokenToBinop(TokenType token);
-BinOpType equalityTokenToBinop(TokenType token);
-BinOpType comparisonTokenToBinop(TokenType token);
-BinOpType shiftTokenToBinop(TokenType token);
-BinOpType additionTokenToBinop(TokenType token);
-BinOpType multiplicationTokenToBinop(TokenType token);
 BinOpType accessorTokenToBinop(TokenType token);
 
 /** the type of a syntactic unary operation */
@@ -200,15 +194,20 @@ typedef enum {
 /** an AST node */
 typedef struct Node {
   NodeType type;
-  size_t line;
-  size_t character;
+  uint32_t offset; /**< offset of the node's first token */
   union {
     struct {
+      Arena *arena;        /**< arena the file's nodes are in - owning */
       HashMap *stab;       /**< symbol table for file */
       struct Node *module; /**< NT_MODULE */
       Vector *imports;     /**< vector of Nodes, each is an NT_IMPORT */
       Vector
           *bodies; /**< vector of Nodes, each is a definition or declaration */
+      TokenVector *bodyTokens;  /**< tokens of unparsed function bodies -
+                                   nullable, freed once bodies are parsed */
+      ImportIndex *importIndex; /**< names visible through the imports -
+                                   nullable, built once the imported symbol
+                                   tables are complete */
     } file;
 
     struct {
@@ -224,7 +223,7 @@ typedef struct Node {
       struct Node *name;       /**< NT_ID */
       Vector *argTypes;        /**< vector of Nodes, each is a type */
       Vector *argNames;  /**< vector of nullable Nodes, each is an NT_ID */
-      HashMap *argStab;  /**< symbol table for arguments */
+      Scope *argStab;    /**< nullable symbol table for arguments */
       struct Node *body; /**< NT_COMPOUNDSTMT or NT_UNPARSED */
     } funDefn;
     struct {
@@ -266,34 +265,34 @@ typedef struct Node {
     } typedefDecl;
 
     struct {
-      HashMap *stab; /**< symbol table for this scope */
+      Scope *stab;   /**< nullable symbol table for this scope */
       Vector *stmts; /**< vector of Nodes, each is a statement */
     } compoundStmt;
     struct {
       struct Node *predicate;   /**< expression */
       struct Node *consequent;  /**< statement */
-      HashMap *consequentStab;  /**< symbol table */
+      Scope *consequentStab;    /**< nullable symbol table */
       struct Node *alternative; /**< nullable statement */
-      HashMap *alternativeStab; /**< nullable symbol table */
+      Scope *alternativeStab;   /**< nullable symbol table */
     } ifStmt;
     struct {
       struct Node *condition; /**< expression */
       struct Node *body;      /**< statement */
-      HashMap *bodyStab;      /**< symbol table */
+      Scope *bodyStab;        /**< nullable symbol table */
     } whileStmt;
     struct {
       struct Node *body;      /**< statement */
-      HashMap *bodyStab;      /**< symbol table */
+      Scope *bodyStab;        /**< nullable symbol table */
       struct Node *condition; /**< expression */
     } doWhileStmt;
     struct {
-      HashMap *loopStab; /**< symbol table */
+      Scope *loopStab; /**< nullable symbol table */
       struct Node *
           initializer; /**< NT_VARDEFNSTMT, NT_EXPRESSIONSTMT, or NT_NULLSTMT */
       struct Node *condition; /**< expression */
       struct Node *increment; /**< nullable expression */
       struct Node *body;      /**< statement */
-      HashMap *bodyStab;      /**< symbol table */
+      Scope *bodyStab;        /**< nullable symbol table */
     } forStmt;
     struct {
       struct Node *condition; /**< expression */
@@ -322,11 +321,11 @@ typedef struct Node {
     struct {
       Vector *values; /**< vector of Nodes, each is an extended int literal */
       struct Node *body; /**< statement */
-      HashMap *bodyStab; /**< symbol table for the body */
+      Scope *bodyStab;   /**< nullable symbol table for the body */
     } switchCase;
     struct {
       struct Node *body; /**< statement */
-      HashMap *bodyStab; /**< symbol table for the body */
+      Scope *bodyStab;   /**< nullable symbol table for the body */
     } switchDefault;
 
     struct {
@@ -408,23 +407,47 @@ typedef struct Node {
       Type *type;
     } scopedId;
     struct {
-      char *id;
+      char *id; /**< interned */
       SymbolTableEntry *entry; /**< non-owning reference to the stab entry, if
                                   any, this references. Nullable */
       Type *type;
     } id;
 
     struct {
-      Vector *tokens; /**< vector of Tokens */
-      size_t curr;    /**< current token (for lexing-ish purposes) */
+      TokenVector *tokens; /**< the file's body tokens - non-owning */
+      size_t curr; /**< index of current token (for lexing-ish purposes) */
     } unparsed;
   } data;
 } Node;
 
+/**
+ * sets the arena this thread's nodes are allocated in
+ *
+ * nodes, and the vectors of nodes passed to node constructors, are allocated
+ * in the current arena, and live until it is freed - see nodeFree
+ *
+ * @param arena arena to allocate in, or NULL when done creating nodes
+ */
+void nodeArenaSet(Arena *arena);
+
+/**
+ * moves a scope into the current arena
+ *
+ * empty scopes are represented by NULL, and take no space at all
+ *
+ * @param scope scope to move, nullable
+ * @returns scope in the arena, or NULL if scope is null or empty
+ */
+Scope *nodeScopeFreeze(Scope *scope);
+
 /**
  * Node constructors - these create and return initialized nodes
+ *
+ * vectors and scopes passed to a constructor are moved into the node's arena,
+ * and may not be used or grown afterwards
  */
-Node *fileNodeCreate(Node *module, Vector *imports, Vector *bodies);
+Node *fileNodeCreate(Node *module, Vector *imports, Vector *bodies,
+                     Arena *arena);
 Node *moduleNodeCreate(Token const *keyword, Node *id);
 Node *importNodeCreate(Token const *keyword, Node *id);
 Node *funDefnNodeCreate(Node *returnType, Node *name, Vector *argTypes,
@@ -440,17 +463,17 @@ Node *enumDeclNodeCreate(Token const *keyword, Node *name,
                          Vector *constantNames, Vector *constantValues);
 Node *typedefDeclNodeCreate(Token const *keyword, Node *originalType,
                             Node *name);
-Node *compoundStmtNodeCreate(Token const *lbrace, Vector *stmts, HashMap *stab);
+Node *compoundStmtNodeCreate(Token const *lbrace, Vector *stmts, Scope *stab);
 Node *ifStmtNodeCreate(Token const *keyword, Node *predicate, Node *consequent,
-                       HashMap *consequentStab, Node *alternative,
-                       HashMap *alternativeStab);
+                       Scope *consequentStab, Node *alternative,
+                       Scope *alternativeStab);
 Node *whileStmtNodeCreate(Token const *keyword, Node *condition, Node *body,
-                          HashMap *bodyStab);
-Node *doWhileStmtNodeCreate(Token const *keyword, Node *body, HashMap *bodyStab,
+                          Scope *bodyStab);
+Node *doWhileStmtNodeCreate(Token const *keyword, Node *body, Scope *bodyStab,
                             Node *condition);
-Node *forStmtNodeCreate(Token const *keyword, HashMap *loopStab,
+Node *forStmtNodeCreate(Token const *keyword, Scope *loopStab,
                         Node *initializer, Node *condition, Node *increment,
-                        Node *body, HashMap *bodyStab);
+                        Node *body, Scope *bodyStab);
 Node *switchStmtNodeCreate(Token const *keyword, Node *condition,
                            Vector *cases);
 Node *breakStmtNodeCreate(Token const *keyword);
@@ -460,9 +483,9 @@ Node *varDefnStmtNodeCreate(Node *type, Vector *names, Vector *initializers);
 Node *expressionStmtNodeCreate(Node *expression);
 Node *nullStmtNodeCreate(Token const *semicolon);
 Node *switchCaseNodeCreate(Token const *keyword, Vector *values, Node *body,
-                           HashMap *bodyStab);
+                           Scope *bodyStab);
 Node *switchDefaultNodeCreate(Token const *keyword, Node *body,
-                              HashMap *bodyStab);
+                              Scope *bodyStab);
 Node *binOpExpNodeCreate(BinOpType op, Node *lhs, Node *rhs);
 Node *castExpNodeCreate(Token const *opToken, Node *type, Type *parsedType,
                         Node *target);
@@ -474,6 +497,7 @@ Node *sizeofTypeExpNodeCreate(Token const *opToken, Node *targetNode,
                               Type *targetType);
 Node *funCallExpNodeCreate(Node *function, Vector *arguments);
 Node *literalNodeCreate(LiteralType type, Token const *t);
+Node *aggregateInitLiteralNodeCreate(Token const *lsquare, Vector *literals);
 Node *charLiteralNodeCreate(Token *t);
 Node *wcharLiteralNodeCreate(Token *t);
 Node *stringLiteralNodeCreate(Token *t);
@@ -486,7 +510,7 @@ Node *funPtrTypeNodeCreate(Node *returnType, Vector *argTypes,
                            Vector *argNames);
 Node *scopedIdNodeCreate(Vector *components);
 Node *idNodeCreate(Token *id);
-Node *unparsedNodeCreate(Vector *tokens);
+Node *unparsedNodeCreate(TokenVector *tokens, size_t begin);
 
 /**
  * creates a stringified version of a scoped id or plain id
@@ -526,16 +550,19 @@ bool nameNodeEqual(Node *a, Node *b);
 bool nameNodeEqualWithDrop(Node *a, Node *b, size_t dropCount);
 
 /**
- * de-inits and frees a node
+ * releases what a node owns outside of its arena
+ *
+ * the node itself is only reclaimed along with its arena - freeing an NT_FILE
+ * node frees the file's arena, and with it every node in the file
  *
  * @param n node to free, may be null
  */
 void nodeFree(Node *n);
 
 /**
- * deinits a vector of nodes
+ * frees a vector of nodes that hasn't been passed to a node constructor
  *
- * @param v vector to deinit, can have null elements, may not itself be null
+ * @param v vector to free, can have null elements, may not itself be null
  */
 void nodeVectorFree(Vector *v);
 
@@ -59,11 +59,15 @@ static char const *const TYPEMODIFIER_NAMES[] = {
 };
 
 static void stabEntryDump(FILE *where, SymbolTableEntry *entry) {
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry->file, entry->offset, &line, &character);
+
   switch (entry->kind) {
     case SK_VARIABLE: {
       char *typeStr = typeToString(entry->data.variable.type);
       fprintf(where, "VARIABLE(%s, %zu, %zu, %s)", entry->file->inputFilename,
-              entry->line, entry->character, typeStr);
+              line, character, typeStr);
       free(typeStr);
       break;
     }
@@ -71,27 +75,31 @@ static void stabEntryDump(FILE *where, SymbolTableEntry *entry) {
       char *returnType = typeToString(entry->data.function.returnType);
       char *argTypes = typeVectorToString(&entry->data.function.argumentTypes);
       fprintf(where, "FUNCTION(%s, %zu, %zu, %s(%s))",
-              entry->file->inputFilename, entry->line, entry->character,
-              returnType, argTypes);
+              entry->file->inputFilename, line, character, returnType,
+              argTypes);
       free(returnType);
       free(argTypes);
       break;
     }
     case SK_OPAQUE: {
-      if (entry->data.opaqueType.definition == NULL)
+      SymbolTableEntry *definition = entry->data.opaqueType.definition;
+      if (definition == NULL) {
         fprintf(where, "OPAQUE(%s, %zu, %zu, REFERENCES())",
-                entry->file->inputFilename, entry->line, entry->character);
-      else
+                entry->file->inputFilename, line, character);
+      } else {
+        size_t refLine;
+        size_t refCharacter;
+        fileListEntryPosition(definition->file, definition->offset, &refLine,
+                              &refCharacter);
         fprintf(where, "OPAQUE(%s, %zu, %zu, REFERENCES(%s, %zu, %zu))",
-                entry->file->inputFilename, entry->line, entry->character,
-                entry->data.opaqueType.definition->file->inputFilename,
-                entry->data.opaqueType.definition->line,
-                entry->data.opaqueType.definition->character);
+                entry->file->inputFilename, line, character,
+                definition->file->inputFilename, refLine, refCharacter);
+      }
       break;
     }
     case SK_STRUCT: {
-      fprintf(where, "STRUCT(%s, %zu, %zu", entry->file->inputFilename,
-              entry->line, entry->character);
+      fprintf(where, "STRUCT(%s, %zu, %zu", entry->file->inputFilename, line,
+              character);
       for (size_t idx = 0; idx < entry->data.structType.fieldNames.size;
            ++idx) {
         char *typeStr =
@@ -104,8 +112,8 @@ static void stabEntryDump(FILE *where, SymbolTableEntry *entry) {
       break;
     }
     case SK_UNION: {
-      fprintf(where, "UNION(%s, %zu, %zu", entry->file->inputFilename,
-              entry->line, entry->character);
+      fprintf(where, "UNION(%s, %zu, %zu", entry->file->inputFilename, line,
+              character);
       for (size_t idx = 0; idx < entry->data.unionType.optionNames.size;
            ++idx) {
         char *typeStr =
@@ -118,8 +126,8 @@ static void stabEntryDump(FILE *where, SymbolTableEntry *entry) {
       break;
     }
     case SK_ENUM: {
-      fprintf(where, "ENUM(%s, %zu, %zu", entry->file->inputFilename,
-              entry->line, entry->character);
+      fprintf(where, "ENUM(%s, %zu, %zu", entry->file->inputFilename, line,
+              character);
       for (size_t idx = 0; idx < entry->data.enumType.constantNames.size;
            ++idx) {
         SymbolTableEntry *constEntry =
@@ -142,7 +150,7 @@ static void stabEntryDump(FILE *where, SymbolTableEntry *entry) {
     case SK_TYPEDEF: {
       char *typeStr = typeToString(entry->data.typedefType.actual);
       fprintf(where, "TYEPDEF(%s, %zu, %zu, %s)", entry->file->inputFilename,
-              entry->line, entry->character, typeStr);
+              line, character, typeStr);
       free(typeStr);
       break;
     }
@@ -160,339 +168,360 @@ static void stabDump(FILE *where, HashMap *stab) {
 
   fprintf(where, "STAB(");
   bool started = true;
-  for (size_t idx = 0; idx < stab->capacity; ++idx) {
-    if (stab->keys[idx] != NULL) {
-      SymbolTableEntry *entry = stab->values[idx];
-      if (started) {
-        started = false;
-      } else {
-        fprintf(where, ", ");
-      }
-      fprintf(where, "ENTRY(%s, ", stab->keys[idx]);
-      stabEntryDump(where, entry);
-      fprintf(where, ")");
+  for (size_t idx = 0; idx < stab->size; ++idx) {
+    if (started) {
+      started = false;
+    } else {
+      fprintf(where, ", ");
     }
+    fprintf(where, "ENTRY(%s, ", stab->entries[idx].key);
+    stabEntryDump(where, stab->entries[idx].value);
+    fprintf(where, ")");
   }
   fprintf(where, ")");
 }
 
-static void nodeDump(FILE *where, Node *n) {
+static void scopeDump(FILE *where, Scope const *scope) {
+  if (scope != NULL && scope->map != NULL) {
+    stabDump(where, scope->map);
+    return;
+  }
+
+  // empty scopes are null
+  fprintf(where, "STAB(");
+  for (size_t idx = 0; scope != NULL && idx < scope->size; ++idx) {
+    if (idx != 0) fprintf(where, ", ");
+    fprintf(where, "ENTRY(%s, ", scope->ids[idx]);
+    stabEntryDump(where, scope->entries[idx]);
+    fprintf(where, ")");
+  }
+  fprintf(where, ")");
+}
+
+static void nodeDump(FILE *where, FileListEntry *file, Node *n) {
   if (n == NULL) {
     fprintf(where, "(null)");
     return;
   }
 
+  size_t line;
+  size_t character;
+  fileListEntryPosition(file, n->offset, &line, &character);
+
   switch (n->type) {
     case NT_FILE: {
-      fprintf(where, "FILE(%zu, %zu, ", n->line, n->character);
+      fprintf(where, "FILE(%zu, %zu, ", line, character);
       stabDump(where, n->data.file.stab);
       fprintf(where, ", ");
-      nodeDump(where, n->data.file.module);
+      nodeDump(where, file, n->data.file.module);
       for (size_t idx = 0; idx < n->data.file.imports->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.file.imports->elements[idx]);
+        nodeDump(where, file, n->data.file.imports->elements[idx]);
       }
       for (size_t idx = 0; idx < n->data.file.bodies->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.file.bodies->elements[idx]);
+        nodeDump(where, file, n->data.file.bodies->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_MODULE: {
-      fprintf(where, "MODULE(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.module.id);
+      fprintf(where, "MODULE(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.module.id);
       fprintf(where, ")");
       break;
     }
     case NT_IMPORT: {
-      fprintf(where, "IMPORT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.import.id);
+      fprintf(where, "IMPORT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.import.id);
       fprintf(where, ")");
       break;
     }
     case NT_FUNDEFN: {
-      fprintf(where, "FUNDEFN(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.funDefn.returnType);
+      fprintf(where, "FUNDEFN(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.funDefn.returnType);
       fprintf(where, ", ");
-      nodeDump(where, n->data.funDefn.name);
+      nodeDump(where, file, n->data.funDefn.name);
       for (size_t idx = 0; idx < n->data.funDefn.argTypes->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.funDefn.argTypes->elements[idx]);
+        nodeDump(where, file, n->data.funDefn.argTypes->elements[idx]);
       }
       for (size_t idx = 0; idx < n->data.funDefn.argNames->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.funDefn.argNames->elements[idx]);
+        nodeDump(where, file, n->data.funDefn.argNames->elements[idx]);
       }
       fprintf(where, ", ");
-      stabDump(where, n->data.funDefn.argStab);
+      scopeDump(where, n->data.funDefn.argStab);
       fprintf(where, ", ");
-      nodeDump(where, n->data.funDefn.body);
+      nodeDump(where, file, n->data.funDefn.body);
       fprintf(where, ")");
       break;
     }
     case NT_VARDEFN: {
-      fprintf(where, "VARDEFN(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.varDefn.type);
+      fprintf(where, "VARDEFN(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.varDefn.type);
       for (size_t idx = 0; idx < n->data.varDefn.names->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.varDefn.names->elements[idx]);
+        nodeDump(where, file, n->data.varDefn.names->elements[idx]);
       }
       for (size_t idx = 0; idx < n->data.varDefn.initializers->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.varDefn.initializers->elements[idx]);
+        nodeDump(where, file, n->data.varDefn.initializers->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_FUNDECL: {
-      fprintf(where, "FUNDECL(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.funDecl.returnType);
+      fprintf(where, "FUNDECL(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.funDecl.returnType);
       fprintf(where, ", ");
-      nodeDump(where, n->data.funDecl.name);
+      nodeDump(where, file, n->data.funDecl.name);
       for (size_t idx = 0; idx < n->data.funDecl.argTypes->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.funDecl.argTypes->elements[idx]);
+        nodeDump(where, file, n->data.funDecl.argTypes->elements[idx]);
       }
       for (size_t idx = 0; idx < n->data.funDecl.argNames->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.funDecl.argNames->elements[idx]);
+        nodeDump(where, file, n->data.funDecl.argNames->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_VARDECL: {
-      fprintf(where, "VARDECL(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.varDecl.type);
+      fprintf(where, "VARDECL(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.varDecl.type);
       for (size_t idx = 0; idx < n->data.varDecl.names->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.varDecl.names->elements[idx]);
+        nodeDump(where, file, n->data.varDecl.names->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_OPAQUEDECL: {
-      fprintf(where, "OPAQUEDECL(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.opaqueDecl.name);
+      fprintf(where, "OPAQUEDECL(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.opaqueDecl.name);
       fprintf(where, ")");
       break;
     }
     case NT_STRUCTDECL: {
-      fprintf(where, "STRUCTDECL(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.structDecl.name);
+      fprintf(where, "STRUCTDECL(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.structDecl.name);
       for (size_t idx = 0; idx < n->data.structDecl.fields->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.structDecl.fields->elements[idx]);
+        nodeDump(where, file, n->data.structDecl.fields->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_UNIONDECL: {
-      fprintf(where, "UNIONDECL(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.unionDecl.name);
+      fprintf(where, "UNIONDECL(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.unionDecl.name);
       for (size_t idx = 0; idx < n->data.unionDecl.options->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.unionDecl.options->elements[idx]);
+        nodeDump(where, file, n->data.unionDecl.options->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_ENUMDECL: {
-      fprintf(where, "ENUMDECL(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.enumDecl.name);
+      fprintf(where, "ENUMDECL(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.enumDecl.name);
       for (size_t idx = 0; idx < n->data.enumDecl.constantNames->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.enumDecl.constantNames->elements[idx]);
+        nodeDump(where, file, n->data.enumDecl.constantNames->elements[idx]);
       }
       for (size_t idx = 0; idx < n->data.enumDecl.constantValues->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.enumDecl.constantValues->elements[idx]);
+        nodeDump(where, file, n->data.enumDecl.constantValues->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_TYPEDEFDECL: {
-      fprintf(where, "TYPEDEFDECL(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.typedefDecl.name);
+      fprintf(where, "TYPEDEFDECL(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.typedefDecl.name);
       fprintf(where, ", ");
-      nodeDump(where, n->data.typedefDecl.originalType);
+      nodeDump(where, file, n->data.typedefDecl.originalType);
       fprintf(where, ")");
       break;
     }
     case NT_COMPOUNDSTMT: {
-      fprintf(where, "COMPOUNDSTMT(%zu, %zu, ", n->line, n->character);
-      stabDump(where, n->data.compoundStmt.stab);
+      fprintf(where, "COMPOUNDSTMT(%zu, %zu, ", line, character);
+      scopeDump(where, n->data.compoundStmt.stab);
       for (size_t idx = 0; idx < n->data.compoundStmt.stmts->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.compoundStmt.stmts->elements[idx]);
+        nodeDump(where, file, n->data.compoundStmt.stmts->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_IFSTMT: {
-      fprintf(where, "IFSTMT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.ifStmt.predicate);
+      fprintf(where, "IFSTMT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.ifStmt.predicate);
       fprintf(where, ", ");
-      nodeDump(where, n->data.ifStmt.consequent);
+      nodeDump(where, file, n->data.ifStmt.consequent);
       fprintf(where, ", ");
-      stabDump(where, n->data.ifStmt.consequentStab);
+      scopeDump(where, n->data.ifStmt.consequentStab);
       fprintf(where, ", ");
-      nodeDump(where, n->data.ifStmt.alternative);
+      nodeDump(where, file, n->data.ifStmt.alternative);
       fprintf(where, ", ");
-      stabDump(where, n->data.ifStmt.alternativeStab);
+      if (n->data.ifStmt.alternative == NULL)
+        fprintf(where, "(null)");
+      else
+        scopeDump(where, n->data.ifStmt.alternativeStab);
       fprintf(where, ")");
       break;
     }
     case NT_WHILESTMT: {
-      fprintf(where, "WHILESTMT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.whileStmt.condition);
+      fprintf(where, "WHILESTMT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.whileStmt.condition);
       fprintf(where, ", ");
-      nodeDump(where, n->data.whileStmt.body);
+      nodeDump(where, file, n->data.whileStmt.body);
       fprintf(where, ", ");
-      stabDump(where, n->data.whileStmt.bodyStab);
+      scopeDump(where, n->data.whileStmt.bodyStab);
       fprintf(where, ")");
       break;
     }
     case NT_DOWHILESTMT: {
-      fprintf(where, "DOWHILESTMT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.doWhileStmt.body);
+      fprintf(where, "DOWHILESTMT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.doWhileStmt.body);
       fprintf(where, ", ");
-      stabDump(where, n->data.doWhileStmt.bodyStab);
+      scopeDump(where, n->data.doWhileStmt.bodyStab);
       fprintf(where, ", ");
-      nodeDump(where, n->data.doWhileStmt.condition);
+      nodeDump(where, file, n->data.doWhileStmt.condition);
       fprintf(where, ")");
       break;
     }
     case NT_FORSTMT: {
-      fprintf(where, "FORSTMT(%zu, %zu, ", n->line, n->character);
-      stabDump(where, n->data.forStmt.loopStab);
+      fprintf(where, "FORSTMT(%zu, %zu, ", line, character);
+      scopeDump(where, n->data.forStmt.loopStab);
       fprintf(where, ", ");
-      nodeDump(where, n->data.forStmt.initializer);
+      nodeDump(where, file, n->data.forStmt.initializer);
       fprintf(where, ", ");
-      nodeDump(where, n->data.forStmt.condition);
+      nodeDump(where, file, n->data.forStmt.condition);
       fprintf(where, ", ");
-      nodeDump(where, n->data.forStmt.increment);
+      nodeDump(where, file, n->data.forStmt.increment);
       fprintf(where, ", ");
-      nodeDump(where, n->data.forStmt.body);
+      nodeDump(where, file, n->data.forStmt.body);
       fprintf(where, ", ");
-      stabDump(where, n->data.forStmt.bodyStab);
+      scopeDump(where, n->data.forStmt.bodyStab);
       fprintf(where, ")");
       break;
     }
     case NT_SWITCHSTMT: {
-      fprintf(where, "SWITCHSTMT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.switchStmt.condition);
+      fprintf(where, "SWITCHSTMT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.switchStmt.condition);
       for (size_t idx = 0; idx < n->data.switchStmt.cases->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.switchStmt.cases->elements[idx]);
+        nodeDump(where, file, n->data.switchStmt.cases->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_BREAKSTMT: {
-      fprintf(where, "BREAKSTMT(%zu, %zu)", n->line, n->character);
+      fprintf(where, "BREAKSTMT(%zu, %zu)", line, character);
       break;
     }
     case NT_CONTINUESTMT: {
-      fprintf(where, "CONTINUESTMT(%zu, %zu)", n->line, n->character);
+      fprintf(where, "CONTINUESTMT(%zu, %zu)", line, character);
       break;
     }
     case NT_RETURNSTMT: {
-      fprintf(where, "RETURNSTMT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.returnStmt.value);
+      fprintf(where, "RETURNSTMT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.returnStmt.value);
       fprintf(where, ")");
       break;
     }
     case NT_VARDEFNSTMT: {
-      fprintf(where, "VARDEFNSTMT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.varDefnStmt.type);
+      fprintf(where, "VARDEFNSTMT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.varDefnStmt.type);
       for (size_t idx = 0; idx < n->data.varDefnStmt.names->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.varDefnStmt.names->elements[idx]);
+        nodeDump(where, file, n->data.varDefnStmt.names->elements[idx]);
       }
       for (size_t idx = 0; idx < n->data.varDefnStmt.initializers->size;
            ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.varDefnStmt.initializers->elements[idx]);
+        nodeDump(where, file, n->data.varDefnStmt.initializers->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_EXPRESSIONSTMT: {
-      fprintf(where, "EXPRESSIONSTMT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.expressionStmt.expression);
+      fprintf(where, "EXPRESSIONSTMT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.expressionStmt.expression);
       fprintf(where, ")");
       break;
     }
     case NT_NULLSTMT: {
-      fprintf(where, "NULLSTMT(%zu, %zu)", n->line, n->character);
+      fprintf(where, "NULLSTMT(%zu, %zu)", line, character);
       break;
     }
     case NT_SWITCHCASE: {
-      fprintf(where, "SWITCHCASE(%zu, %zu", n->line, n->character);
+      fprintf(where, "SWITCHCASE(%zu, %zu", line, character);
       for (size_t idx = 0; idx < n->data.switchCase.values->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.switchCase.values->elements[idx]);
+        nodeDump(where, file, n->data.switchCase.values->elements[idx]);
       }
       fprintf(where, ", ");
-      nodeDump(where, n->data.switchCase.body);
+      nodeDump(where, file, n->data.switchCase.body);
       fprintf(where, ", ");
-      stabDump(where, n->data.switchCase.bodyStab);
+      scopeDump(where, n->data.switchCase.bodyStab);
       fprintf(where, ")");
       break;
     }
     case NT_SWITCHDEFAULT: {
-      fprintf(where, "SWITCHDEFAULT(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.switchDefault.body);
+      fprintf(where, "SWITCHDEFAULT(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.switchDefault.body);
       fprintf(where, ", ");
-      stabDump(where, n->data.switchDefault.bodyStab);
+      scopeDump(where, n->data.switchDefault.bodyStab);
       fprintf(where, ")");
       break;
     }
     case NT_BINOPEXP: {
-      fprintf(where, "BINOPEXP(%zu, %zu, %s, ", n->line, n->character,
+      fprintf(where, "BINOPEXP(%zu, %zu, %s, ", line, character,
               BINOP_NAMES[n->data.binOpExp.op]);
-      nodeDump(where, n->data.binOpExp.lhs);
+      nodeDump(where, file, n->data.binOpExp.lhs);
       fprintf(where, ", ");
-      nodeDump(where, n->data.binOpExp.rhs);
+      nodeDump(where, file, n->data.binOpExp.rhs);
       fprintf(where, ")");
       break;
     }
     case NT_TERNARYEXP: {
-      fprintf(where, "TERNARYEXP(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.ternaryExp.predicate);
+      fprintf(where, "TERNARYEXP(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.ternaryExp.predicate);
       fprintf(where, ", ");
-      nodeDump(where, n->data.ternaryExp.consequent);
+      nodeDump(where, file, n->data.ternaryExp.consequent);
       fprintf(where, ", ");
-      nodeDump(where, n->data.ternaryExp.alternative);
+      nodeDump(where, file, n->data.ternaryExp.alternative);
       fprintf(where, ")");
       break;
     }
     case NT_UNOPEXP: {
-      fprintf(where, "UNOPEXP(%zu, %zu, %s, ", n->line, n->character,
+      fprintf(where, "UNOPEXP(%zu, %zu, %s, ", line, character,
               UNOP_NAMES[n->data.unOpExp.op]);
-      nodeDump(where, n->data.unOpExp.target);
+      nodeDump(where, file, n->data.unOpExp.target);
       fprintf(where, ")");
       break;
     }
     case NT_SIZEOFTYPEEXP: {
-      fprintf(where, "SIZEOFTYPEEXP(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.sizeofTypeExp.targetNode);
+      fprintf(where, "SIZEOFTYPEEXP(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.sizeofTypeExp.targetNode);
       fprintf(where, ")");
       break;
     }
     case NT_FUNCALLEXP: {
-      fprintf(where, "FUNCALLEXP(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.funCallExp.function);
+      fprintf(where, "FUNCALLEXP(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.funCallExp.function);
       for (size_t idx = 0; idx < n->data.funCallExp.arguments->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.funCallExp.arguments->elements[idx]);
+        nodeDump(where, file, n->data.funCallExp.arguments->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_LITERAL: {
-      fprintf(where, "LITERAL(%zu, %zu, ", n->line, n->character);
+      fprintf(where, "LITERAL(%zu, %zu, ", line, character);
       switch (n->data.literal.literalType) {
         case LT_UBYTE: {
           fprintf(where, "UBYTE(%hhu)", n->data.literal.data.ubyteVal);
@@ -574,7 +603,7 @@ static void nodeDump(FILE *where, Node *n) {
           for (size_t idx = 0;
                idx < n->data.literal.data.aggregateInitVal->size; ++idx) {
             if (idx != 0) fprintf(where, ", ");
-            nodeDump(where,
+            nodeDump(where, file,
                      n->data.literal.data.aggregateInitVal->elements[idx]);
           }
           fprintf(where, ")");
@@ -585,61 +614,71 @@ static void nodeDump(FILE *where, Node *n) {
       break;
     }
     case NT_KEYWORDTYPE: {
-      fprintf(where, "KEYWORDTYPE(%zu, %zu, %s)", n->line, n->character,
+      fprintf(where, "KEYWORDTYPE(%zu, %zu, %s)", line, character,
               TYPEKEYWORD_NAMES[n->data.keywordType.keyword]);
       break;
     }
     case NT_MODIFIEDTYPE: {
-      fprintf(where, "MODIFIEDTYPE(%zu, %zu, %s, ", n->line, n->character,
+      fprintf(where, "MODIFIEDTYPE(%zu, %zu, %s, ", line, character,
               TYPEMODIFIER_NAMES[n->data.modifiedType.modifier]);
-      nodeDump(where, n->data.modifiedType.baseType);
+      nodeDump(where, file, n->data.modifiedType.baseType);
       fprintf(where, ")");
       break;
     }
     case NT_ARRAYTYPE: {
-      fprintf(where, "ARRAYTYPE(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.arrayType.baseType);
+      fprintf(where, "ARRAYTYPE(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.arrayType.baseType);
       fprintf(where, ", ");
-      nodeDump(where, n->data.arrayType.size);
+      nodeDump(where, file, n->data.arrayType.size);
       fprintf(where, ")");
       break;
     }
     case NT_FUNPTRTYPE: {
-      fprintf(where, "FUNPTRTYPE(%zu, %zu, ", n->line, n->character);
-      nodeDump(where, n->data.funPtrType.returnType);
+      fprintf(where, "FUNPTRTYPE(%zu, %zu, ", line, character);
+      nodeDump(where, file, n->data.funPtrType.returnType);
       for (size_t idx = 0; idx < n->data.funPtrType.argTypes->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.funPtrType.argTypes->elements[idx]);
+        nodeDump(where, file, n->data.funPtrType.argTypes->elements[idx]);
       }
       for (size_t idx = 0; idx < n->data.funPtrType.argNames->size; ++idx) {
         fprintf(where, ", ");
-        nodeDump(where, n->data.funPtrType.argNames->elements[idx]);
+        nodeDump(where, file, n->data.funPtrType.argNames->elements[idx]);
       }
       fprintf(where, ")");
       break;
     }
     case NT_SCOPEDID: {
       char *idString = stringifyId(n);
-      if (n->data.scopedId.entry == NULL)
-        fprintf(where, "SCOPEDID(%zu, %zu, %s, REFERENCES())", n->line,
-                n->character, idString);
-      else
-        fprintf(
-            where, "SCOPEDID(%zu, %zu, %s, REFERENCES(%s, %zu, %zu))", n->line,
-            n->character, idString, n->data.scopedId.entry->file->inputFilename,
-            n->data.scopedId.entry->line, n->data.scopedId.entry->character);
+      SymbolTableEntry *referenced = n->data.scopedId.entry;
+      if (referenced == NULL) {
+        fprintf(where, "SCOPEDID(%zu, %zu, %s, REFERENCES())", line,
+                character, idString);
+      } else {
+        size_t refLine;
+        size_t refCharacter;
+        fileListEntryPosition(referenced->file, referenced->offset, &refLine,
+                              &refCharacter);
+        fprintf(where, "SCOPEDID(%zu, %zu, %s, REFERENCES(%s, %zu, %zu))",
+                line, character, idString, referenced->file->inputFilename,
+                refLine, refCharacter);
+      }
       free(idString);
       break;
     }
     case NT_ID: {
-      if (n->data.id.entry == NULL)
-        fprintf(where, "ID(%zu, %zu, %s, REFERENCES())", n->line, n->character,
+      SymbolTableEntry *referenced = n->data.id.entry;
+      if (referenced == NULL) {
+        fprintf(where, "ID(%zu, %zu, %s, REFERENCES())", line, character,
                 n->data.id.id);
-      else
-        fprintf(where, "ID(%zu, %zu, %s, REFERENCES(%s, %zu, %zu))", n->line,
-                n->character, n->data.id.id,
-                n->data.id.entry->file->inputFilename, n->data.id.entry->line,
-                n->data.id.entry->character);
+      } else {
+        size_t refLine;
+        size_t refCharacter;
+        fileListEntryPosition(referenced->file, referenced->offset, &refLine,
+                              &refCharacter);
+        fprintf(where, "ID(%zu, %zu, %s, REFERENCES(%s, %zu, %zu))", line,
+                character, n->data.id.id, referenced->file->inputFilename,
+                refLine, refCharacter);
+      }
       break;
     }
     case NT_UNPARSED: {
@@ -651,6 +690,6 @@ static void nodeDump(FILE *where, Node *n) {
 void astDump(FILE *where, FileListEntry *entry) {
   fprintf(where, "%s (%s):\n", entry->inputFilename,
           entry->isCode ? "code" : "declaration");
-  nodeDump(where, entry->ast);
+  nodeDump(where, entry, entry->ast);
   fprintf(where, "\n");
 }
\ No newline at end of file
@@ -25,7 +25,60 @@
 
 #include "ast/ast.h"
 #include "fileList.h"
+#include "util/container/optimization.h"
+#include "util/diagnostics.h"
 #include "util/functional.h"
+#include "util/internalError.h"
+
+/** starting depth of the local scope stack, enough for most functions */
+#define SCOPES_INIT_CAPACITY 8
+
+ImportIndex *importIndexCreate(FileListEntry *file) {
+  ImportIndex *index = malloc(sizeof(ImportIndex));
+  hashMapInit(&index->entries);
+  hashMapInit(&index->ambiguous);
+
+  Vector *imports = file->ast->data.file.imports;
+  for (size_t importIdx = 0; importIdx < imports->size; ++importIdx) {
+    Node *import = imports->elements[importIdx];
+    HashMap const *stab = import->data.import.referenced->ast->data.file.stab;
+    for (size_t idx = 0; idx < stab->size; ++idx) {
+      char const *name = stab->entries[idx].key;
+      SymbolTableEntry *entry = stab->entries[idx].value;
+      SymbolTableEntry *existing = hashMapGetId(&index->entries, name);
+      if (existing == NULL) {
+        hashMapPutId(&index->entries, name, entry);
+        continue;
+      }
+
+      // declared by an earlier import too - ambiguous
+      Vector *matches = hashMapGetId(&index->ambiguous, name);
+      if (matches == NULL) {
+        matches = vectorCreate();
+        vectorInsert(matches, existing);
+        hashMapPutId(&index->ambiguous, name, matches);
+      }
+      vectorInsert(matches, entry);
+    }
+  }
+
+  return index;
+}
+
+/**
+ * frees a vector of ambiguous matches
+ */
+static void matchesFree(void *matches) {
+  vectorUninit(matches, nullDtor);
+  free(matches);
+}
+
+void importIndexFree(ImportIndex *index) {
+  if (index == NULL) return;
+  hashMapUninit(&index->entries, nullDtor);
+  hashMapUninit(&index->ambiguous, matchesFree);
+  free(index);
+}
 
 void environmentInit(Environment *env, FileListEntry *currentModuleFile) {
   vectorInit(&env->importFiles);
@@ -44,7 +97,12 @@ void environmentInit(Environment *env, FileListEntry *currentModuleFile) {
         currentModuleFile->ast->data.file.module->data.module.id);
     if (declEntry != NULL) env->implicitImport = declEntry->ast->data.file.stab;
   }
-  vectorInit(&env->scopes);
+  env->scopes = NULL;
+  env->numScopes = 0;
+  env->scopesCapacity = 0;
+  env->importIndex = currentModuleFile->ast->data.file.importIndex;
+  if (env->importIndex == NULL)
+    error(__FILE__, __LINE__, "environment created before imports indexed");
 }
 
 /**
@@ -55,13 +113,19 @@ void environmentInit(Environment *env, FileListEntry *currentModuleFile) {
  */
 static void errorNoDecl(FileListEntry *file, Node *node) {
   if (node->type == NT_ID) {
-    fprintf(stderr, "%s:%zu:%zu: error: '%s' was not declared\n",
-            file->inputFilename, node->line, node->character, node->data.id.id);
+    size_t line;
+    size_t character;
+    fileListEntryPosition(file, node->offset, &line, &character);
+    fprintf(diagnosticStream(), "%s:%zu:%zu: error: '%s' was not declared\n",
+            file->inputFilename, line, character, node->data.id.id);
     file->errored = true;
   } else {
     char *str = stringifyId(node);
-    fprintf(stderr, "%s:%zu:%zu: error: '%s' was not declared\n",
-            file->inputFilename, node->line, node->character, str);
+    size_t line;
+    size_t character;
+    fileListEntryPosition(file, node->offset, &line, &character);
+    fprintf(diagnosticStream(), "%s:%zu:%zu: error: '%s' was not declared\n",
+            file->inputFilename, line, character, str);
     file->errored = true;
     free(str);
   }
@@ -71,54 +135,49 @@ static SymbolTableEntry *environmentLookupUnscoped(Environment *env,
                                                    Node *nameNode, bool quiet) {
   char const *name = nameNode->data.id.id;
   SymbolTableEntry *matched;
-  Vector *scopes = &env->scopes;
-  for (size_t idx = 0; idx < scopes->size; ++idx) {
+  for (size_t idx = env->numScopes; idx-- > 0;) {
     // look at local scopes from last to first
-    HashMap *scope = scopes->elements[scopes->size - idx - 1];
-    matched = hashMapGet(scope, name);
+    matched = scopeGet(&env->scopes[idx], name);
     if (matched != NULL) return matched;
   }
   // check the current module then implicit import
-  matched = hashMapGet(env->currentModuleFile->ast->data.file.stab, name);
+  matched = hashMapGetId(env->currentModuleFile->ast->data.file.stab, name);
   if (matched != NULL) return matched;
   if (env->implicitImport != NULL) {
-    matched = hashMapGet(env->implicitImport, name);
+    matched = hashMapGetId(env->implicitImport, name);
     if (matched != NULL) return matched;
   }
 
   // search in the imports
-  Vector *imports = &env->importFiles;
-  SymbolTableEntry **matches =
-      malloc(sizeof(SymbolTableEntry *) * imports->size);
-  size_t numMatches = 0;
-  for (size_t idx = 0; idx < imports->size; ++idx) {
-    FileListEntry *import = imports->elements[idx];
-    matched = hashMapGet(import->ast->data.file.stab, name);
-    if (matched != NULL) matches[numMatches++] = matched;
-  }
-
-  if (numMatches == 0) {
+  matched = hashMapGetId(&env->importIndex->entries, name);
+  if (matched == NULL) {
     if (!quiet) errorNoDecl(env->currentModuleFile, nameNode);
-    free(matches);
     return NULL;
-  } else if (numMatches > 1) {
+  }
+
+  Vector *matches = hashMapGetId(&env->importIndex->ambiguous, name);
+  if (matches != NULL) {
     if (!quiet) {
-      fprintf(stderr,
+      size_t line;
+      size_t character;
+      fileListEntryPosition(env->currentModuleFile, nameNode->offset, &line,
+                            &character);
+      fprintf(diagnosticStream(),
               "%s:%zu:%zu: error: '%s' declared in mutliple imported modules\n",
-              env->currentModuleFile->inputFilename, nameNode->line,
-              nameNode->character, name);
-      for (size_t idx = 0; idx < numMatches; ++idx)
-        fprintf(stderr, "%s:%zu:%zu: note: declared here\n",
-                matches[idx]->file->inputFilename, matches[idx]->line,
-                matches[idx]->character);
+              env->currentModuleFile->inputFilename, line, character, name);
+      for (size_t idx = 0; idx < matches->size; ++idx) {
+        SymbolTableEntry *match = matches->elements[idx];
+        size_t line;
+        size_t character;
+        fileListEntryPosition(match->file, match->offset, &line, &character);
+        fprintf(diagnosticStream(), "%s:%zu:%zu: note: declared here\n",
+                match->file->inputFilename, line, character);
+      }
     }
-    free(matches);
     return NULL;
-  } else {
-    matched = matches[0];
-    free(matches);
-    return matched;
   }
+
+  return matched;
 }
 static FileListEntry *environmentFindModule(Environment *env, Node *name,
                                             size_t dropCount) {
@@ -153,7 +212,7 @@ static SymbolTableEntry *environmentLookupScoped(Environment *env, Node *name,
           name->data.scopedId.components
               ->elements[name->data.scopedId.components->size - 2];
       SymbolTableEntry *parentEnum =
-          hashMapGet(import->ast->data.file.stab, secondLast->data.id.id);
+          hashMapGetId(import->ast->data.file.stab, secondLast->data.id.id);
       if (parentEnum != NULL && parentEnum->kind == SK_ENUM) {
         Node *last = name->data.scopedId.components
                          ->elements[name->data.scopedId.components->size - 1];
@@ -170,7 +229,7 @@ static SymbolTableEntry *environmentLookupScoped(Environment *env, Node *name,
     Node *last = name->data.scopedId.components
                      ->elements[name->data.scopedId.components->size - 1];
     SymbolTableEntry *entry =
-        hashMapGet(import->ast->data.file.stab, last->data.id.id);
+        hashMapGetId(import->ast->data.file.stab, last->data.id.id);
     if (entry != NULL) return entry;
   }
 
@@ -187,7 +246,8 @@ SymbolTableEntry *environmentLookup(Environment *env, Node *name, bool quiet) {
   // the implicit import. If it's still not found, it's looked up in each of the
   // imports and produced only if it's found in only one. If it's found in
   // multiple imports, it's declared as ambiguous, and complained about. If it
-  // still isn't found, it's declared as missing and complained about.
+  // still isn't found, it's declared as missing and complained about. The
+  // imports are searched all at once, through the file's import index.
   //
   // If the name is scoped:
   // There are two possibilities: the name is an enum constant, or it isn't. To
@@ -209,24 +269,30 @@ SymbolTableEntry *environmentLookup(Environment *env, Node *name, bool quiet) {
     return environmentLookupScoped(env, name, quiet);  // is scoped
 }
 
-void environmentPush(Environment *env, HashMap *map) {
-  vectorInsert(&env->scopes, map);
+void environmentPush(Environment *env) {
+  if (env->numScopes == env->scopesCapacity) {
+    env->scopesCapacity =
+        env->scopesCapacity == 0 ? SCOPES_INIT_CAPACITY
+                                 : env->scopesCapacity * VECTOR_GROWTH_FACTOR;
+    env->scopes = realloc(env->scopes, env->scopesCapacity * sizeof(Scope));
+  }
+  scopeInit(&env->scopes[env->numScopes++]);
 }
 
-HashMap *environmentTop(Environment *env) {
-  if (env->scopes.size == 0) {
-    // no scope - return the main scope
-    return env->currentModuleFile->ast->data.file.stab;
-  } else {
-    return env->scopes.elements[env->scopes.size - 1];
-  }
+Scope *environmentTop(Environment *env) {
+  if (env->numScopes == 0)
+    error(__FILE__, __LINE__, "no local scope to add to");
+  return &env->scopes[env->numScopes - 1];
 }
 
-HashMap *environmentPop(Environment *env) {
-  return env->scopes.elements[--env->scopes.size];
+void environmentPop(Environment *env, Scope *scope) {
+  if (env->numScopes == 0) error(__FILE__, __LINE__, "no local scope to end");
+  *scope = env->scopes[--env->numScopes];
 }
 
 void environmentUninit(Environment *env) {
   vectorUninit(&env->importFiles, nullDtor);
-  vectorUninit(&env->scopes, (void (*)(void *))stabFree);
-}
\ No newline at end of file
+  for (size_t idx = 0; idx < env->numScopes; ++idx)
+    scopeUninit(&env->scopes[idx]);
+  free(env->scopes);
+}
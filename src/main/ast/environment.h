@@ -29,21 +29,50 @@
 
 typedef struct Node Node;
 
+/** the names visible through a file's imports, each found with one probe */
+typedef struct {
+  HashMap entries;   /**< map from each imported name to its entry in the first
+                        import declaring it */
+  HashMap ambiguous; /**< map from each name declared by several imports to a
+                        vector of its entries, in import order - owning */
+} ImportIndex;
+
+/**
+ * indexes the names visible through a file's imports
+ *
+ * the symbol tables of the imported files must be complete
+ *
+ * @param file file whose imports to index
+ * @returns index, to be freed with importIndexFree
+ */
+ImportIndex *importIndexCreate(FileListEntry *file);
+
+/**
+ * frees an import index
+ *
+ * @param index index to free, may be null
+ */
+void importIndexFree(ImportIndex *index);
+
 typedef struct {
   FileListEntry
       *currentModuleFile;  /**< FileListEntry reference to current module */
   Vector importFiles;      /**< Vector of FileListEntry, non-owning */
   HashMap *implicitImport; /**< symbol table for the implicit import in code
                               modules */
-  Vector scopes; /**< vector of temporarily owning references to the current
-                    scope (vector of symbol tables) */
+  Scope *scopes;         /**< stack of local scopes, innermost last - owning */
+  size_t numScopes;      /**< number of local scopes */
+  size_t scopesCapacity; /**< number of scopes the stack has room for */
+  ImportIndex const *importIndex; /**< index of importFiles, non-owning */
 } Environment;
 
 /**
  * initialize an environment
  *
- * automatically fills in the currentModule, implicitImport, and importFiles
- * leaves scopes as the empty vector
+ * automatically fills in the currentModule, implicitImport, importFiles, and
+ * importIndex, leaves scopes as the empty stack
+ *
+ * the current module's imports must have been indexed
  *
  * @param env environment to initialize
  * @param currentModuleFile FileListEntry of the current module
@@ -62,26 +91,30 @@ void environmentInit(Environment *env, FileListEntry *currentModuleFile);
 SymbolTableEntry *environmentLookup(Environment *env, Node *name, bool quiet);
 
 /**
- * add a stab to the list of scopes
+ * start a new, empty local scope
  *
- * @param env environment to look in
- * @param map
+ * allocates nothing unless the scopes are nested deeper than ever before
+ *
+ * @param env environment to add to
  */
-void environmentPush(Environment *env, HashMap *map);
+void environmentPush(Environment *env);
 
 /**
- * get the topmost scope
+ * get the innermost local scope
  *
- * @param env environment to look in
+ * @param env environment to look in - must have a local scope
  *
- * @returns scope hashmap
+ * @returns scope, valid until the next push or pop
  */
-HashMap *environmentTop(Environment *env);
+Scope *environmentTop(Environment *env);
 
 /**
- * remove a stab from the list of scopes, and return it
+ * end the innermost local scope, and return it
+ *
+ * @param env environment to remove from - must have a local scope
+ * @param scope scope to move the innermost scope into, now owned by the caller
  */
-HashMap *environmentPop(Environment *env);
+void environmentPop(Environment *env, Scope *scope);
 
 /**
  * deinitialize an environment
@@ -21,6 +21,7 @@
 
 #include "ast/symbolTable.h"
 
+#include <stdatomic.h>
 #include <stdlib.h>
 
 #include "fileList.h"
@@ -46,100 +47,120 @@ char const *symbolKindToString(SymbolKind kind) {
 /**
  * initializes a symbol table entry
  */
-static SymbolTableEntry *stabEntryCreate(FileListEntry *file, size_t line,
-                                         size_t character, char const *id,
-                                         SymbolKind kind) {
+static SymbolTableEntry *stabEntryCreate(FileListEntry *file, uint32_t offset,
+                                         char const *id, SymbolKind kind) {
   SymbolTableEntry *e = malloc(sizeof(SymbolTableEntry));
   e->kind = kind;
   e->file = file;
-  e->line = line;
-  e->character = character;
+  e->offset = offset;
   e->id = id;
   return e;
 }
 
-SymbolTableEntry *opaqueStabEntryCreate(FileListEntry *file, size_t line,
-                                        size_t character, char const *id) {
-  SymbolTableEntry *e = stabEntryCreate(file, line, character, id, SK_OPAQUE);
+SymbolTableEntry *opaqueStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                        char const *id) {
+  SymbolTableEntry *e = stabEntryCreate(file, offset, id, SK_OPAQUE);
   e->data.opaqueType.definition = NULL;
   return e;
 }
-SymbolTableEntry *structStabEntryCreate(FileListEntry *file, size_t line,
-                                        size_t character, char const *id) {
-  SymbolTableEntry *e = stabEntryCreate(file, line, character, id, SK_STRUCT);
+SymbolTableEntry *structStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                        char const *id) {
+  SymbolTableEntry *e = stabEntryCreate(file, offset, id, SK_STRUCT);
   vectorInit(&e->data.structType.fieldNames);
   vectorInit(&e->data.structType.fieldTypes);
+  hashMapInit(&e->data.structType.fieldIndices);
+  atomic_init(&e->data.structType.layout, NULL);
   return e;
 }
-SymbolTableEntry *unionStabEntryCreate(FileListEntry *file, size_t line,
-                                       size_t character, char const *id) {
-  SymbolTableEntry *e = stabEntryCreate(file, line, character, id, SK_UNION);
+SymbolTableEntry *unionStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                       char const *id) {
+  SymbolTableEntry *e = stabEntryCreate(file, offset, id, SK_UNION);
   vectorInit(&e->data.unionType.optionNames);
   vectorInit(&e->data.unionType.optionTypes);
+  hashMapInit(&e->data.unionType.optionIndices);
+  atomic_init(&e->data.unionType.layout, NULL);
   return e;
 }
-SymbolTableEntry *enumStabEntryCreate(FileListEntry *file, size_t line,
-                                      size_t character, char const *id) {
-  SymbolTableEntry *e = stabEntryCreate(file, line, character, id, SK_ENUM);
+SymbolTableEntry *enumStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                      char const *id) {
+  SymbolTableEntry *e = stabEntryCreate(file, offset, id, SK_ENUM);
   vectorInit(&e->data.enumType.constantNames);
   vectorInit(&e->data.enumType.constantValues);
   e->data.enumType.backingType = NULL;
   return e;
 }
-SymbolTableEntry *enumConstStabEntryCreate(FileListEntry *file, size_t line,
-                                           size_t character, char const *id,
+SymbolTableEntry *enumConstStabEntryCreate(FileListEntry *file,
+                                           uint32_t offset, char const *id,
                                            SymbolTableEntry *parent) {
-  SymbolTableEntry *e =
-      stabEntryCreate(file, line, character, id, SK_ENUMCONST);
+  SymbolTableEntry *e = stabEntryCreate(file, offset, id, SK_ENUMCONST);
   e->data.enumConst.parent = parent;
   return e;
 }
-SymbolTableEntry *typedefStabEntryCreate(FileListEntry *file, size_t line,
-                                         size_t character, char const *id) {
-  SymbolTableEntry *e = stabEntryCreate(file, line, character, id, SK_TYPEDEF);
+SymbolTableEntry *typedefStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                         char const *id) {
+  SymbolTableEntry *e = stabEntryCreate(file, offset, id, SK_TYPEDEF);
   e->data.typedefType.actual = NULL;
   return e;
 }
-SymbolTableEntry *variableStabEntryCreate(FileListEntry *file, size_t line,
-                                          size_t character, char const *id) {
-  SymbolTableEntry *e = stabEntryCreate(file, line, character, id, SK_VARIABLE);
+SymbolTableEntry *variableStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                          char const *id) {
+  SymbolTableEntry *e = stabEntryCreate(file, offset, id, SK_VARIABLE);
   e->data.variable.type = NULL;
   e->data.variable.temp = 0;
   e->data.variable.escapes = false;
   return e;
 }
-SymbolTableEntry *functionStabEntryCreate(FileListEntry *file, size_t line,
-                                          size_t character, char const *id) {
-  SymbolTableEntry *e = stabEntryCreate(file, line, character, id, SK_FUNCTION);
+SymbolTableEntry *functionStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                          char const *id) {
+  SymbolTableEntry *e = stabEntryCreate(file, offset, id, SK_FUNCTION);
   e->data.function.returnType = NULL;
   vectorInit(&e->data.function.argumentTypes);
   vectorInit(&e->data.function.argumentEntries);
   return e;
 }
 
+/**
+ * adds a named element to the end of the element vectors and index of a struct
+ * or union
+ */
+static void addElement(Vector *names, Vector *types, HashMap *indices,
+                       char const *name, Type *type) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+  vectorInsert(names, name);
+#pragma GCC diagnostic pop
+  vectorInsert(types, type);
+  hashMapPutId(indices, name, (void *)(uintptr_t)names->size);
+}
+void structAddField(SymbolTableEntry *structEntry, char const *field,
+                    Type *type) {
+  addElement(&structEntry->data.structType.fieldNames,
+             &structEntry->data.structType.fieldTypes,
+             &structEntry->data.structType.fieldIndices, field, type);
+}
+void unionAddOption(SymbolTableEntry *unionEntry, char const *option,
+                    Type *type) {
+  addElement(&unionEntry->data.unionType.optionNames,
+             &unionEntry->data.unionType.optionTypes,
+             &unionEntry->data.unionType.optionIndices, option, type);
+}
+
 Type *structLookupField(SymbolTableEntry *structEntry, char const *field) {
-  for (size_t idx = 0; idx < structEntry->data.structType.fieldNames.size;
-       ++idx) {
-    if (strcmp(structEntry->data.structType.fieldNames.elements[idx], field) ==
-        0)
-      return structEntry->data.structType.fieldTypes.elements[idx];
-  }
-  return NULL;
+  void *index = hashMapGetId(&structEntry->data.structType.fieldIndices, field);
+  if (index == NULL) return NULL;
+  return structEntry->data.structType.fieldTypes
+      .elements[(uintptr_t)index - 1];
 }
 Type *unionLookupOption(SymbolTableEntry *unionEntry, char const *option) {
-  for (size_t idx = 0; idx < unionEntry->data.unionType.optionNames.size;
-       ++idx) {
-    if (strcmp(unionEntry->data.unionType.optionNames.elements[idx], option) ==
-        0)
-      return unionEntry->data.unionType.optionTypes.elements[idx];
-  }
-  return NULL;
+  void *index = hashMapGetId(&unionEntry->data.unionType.optionIndices, option);
+  if (index == NULL) return NULL;
+  return unionEntry->data.unionType.optionTypes.elements[(uintptr_t)index - 1];
 }
 SymbolTableEntry *enumLookupEnumConst(SymbolTableEntry *enumEntry,
                                       char const *name) {
   for (size_t idx = 0; idx < enumEntry->data.enumType.constantNames.size;
        ++idx) {
-    if (strcmp(enumEntry->data.enumType.constantNames.elements[idx], name) == 0)
+    if (enumEntry->data.enumType.constantNames.elements[idx] == name)
       return enumEntry->data.enumType.constantValues.elements[idx];
   }
   return NULL;
@@ -149,32 +170,26 @@ void stabEntryFree(SymbolTableEntry *e) {
   switch (e->kind) {
     case SK_STRUCT: {
       vectorUninit(&e->data.structType.fieldNames, nullDtor);
-      vectorUninit(&e->data.structType.fieldTypes, (void (*)(void *))typeFree);
+      vectorUninit(&e->data.structType.fieldTypes, nullDtor);
+      hashMapUninit(&e->data.structType.fieldIndices, nullDtor);
+      free(atomic_load(&e->data.structType.layout));
       break;
     }
     case SK_UNION: {
       vectorUninit(&e->data.unionType.optionNames, nullDtor);
-      vectorUninit(&e->data.unionType.optionTypes, (void (*)(void *))typeFree);
+      vectorUninit(&e->data.unionType.optionTypes, nullDtor);
+      hashMapUninit(&e->data.unionType.optionIndices, nullDtor);
+      free(atomic_load(&e->data.unionType.layout));
       break;
     }
     case SK_ENUM: {
       vectorUninit(&e->data.enumType.constantNames, nullDtor);
       vectorUninit(&e->data.enumType.constantValues,
                    (void (*)(void *))stabEntryFree);
-      typeFree(e->data.enumType.backingType);
-      break;
-    }
-    case SK_TYPEDEF: {
-      typeFree(e->data.typedefType.actual);
-      break;
-    }
-    case SK_VARIABLE: {
-      typeFree(e->data.variable.type);
       break;
     }
     case SK_FUNCTION: {
-      typeFree(e->data.function.returnType);
-      vectorUninit(&e->data.function.argumentTypes, (void (*)(void *))typeFree);
+      vectorUninit(&e->data.function.argumentTypes, nullDtor);
       vectorUninit(&e->data.function.argumentEntries, nullDtor);
       break;
     }
@@ -183,4 +198,46 @@ void stabEntryFree(SymbolTableEntry *e) {
     }
   }
   free(e);
-}
\ No newline at end of file
+}
+void scopeInit(Scope *scope) {
+  scope->size = 0;
+  scope->map = NULL;
+}
+
+SymbolTableEntry *scopeGet(Scope const *scope, char const *id) {
+  if (scope->map != NULL) return hashMapGetId(scope->map, id);
+
+  for (size_t idx = 0; idx < scope->size; ++idx) {
+    if (scope->ids[idx] == id) return scope->entries[idx];
+  }
+  return NULL;
+}
+
+int scopePut(Scope *scope, char const *id, SymbolTableEntry *entry) {
+  if (scope->map != NULL) {
+    if (hashMapPutId(scope->map, id, entry) != 0) return -1;
+  } else if (scopeGet(scope, id) != NULL) {
+    return -1;
+  } else if (scope->size == SCOPE_INLINE_CAPACITY) {
+    // too many to search linearly - move them all into a map, in order
+    scope->map = hashMapCreate();
+    for (size_t idx = 0; idx < scope->size; ++idx)
+      hashMapPutId(scope->map, scope->ids[idx], scope->entries[idx]);
+    hashMapPutId(scope->map, id, entry);
+  } else {
+    scope->ids[scope->size] = id;
+    scope->entries[scope->size] = entry;
+  }
+
+  ++scope->size;
+  return 0;
+}
+
+void scopeUninit(Scope *scope) {
+  if (scope->map != NULL) {
+    stabFree(scope->map);
+  } else {
+    for (size_t idx = 0; idx < scope->size; ++idx)
+      stabEntryFree(scope->entries[idx]);
+  }
+}
@@ -25,6 +25,8 @@
 #ifndef TLC_AST_SYMBOLTABLE_H_
 #define TLC_AST_SYMBOLTABLE_H_
 
+#include <stdint.h>
+
 #include "ast/type.h"
 #include "util/container/hashMap.h"
 #include "util/container/vector.h"
@@ -34,6 +36,9 @@ typedef struct FileListEntry FileListEntry;
 /**
  * deinits and frees a symbol table
  *
+ * symbol tables are HashMaps keyed by interned ids, and must be accessed with
+ * hashMapGetId and hashMapPutId
+ *
  * @param t table to free
  */
 void stabFree(HashMap *t);
@@ -55,6 +60,17 @@ typedef enum {
  */
 char const *symbolKindToString(SymbolKind kind);
 
+/**
+ * where the fields of a struct or union are, computed when first needed
+ *
+ * a layout may only be computed once every field's type is complete
+ */
+typedef struct {
+  size_t size;      /**< size of the struct or union */
+  size_t alignment; /**< alignment of the struct or union */
+  size_t offsets[]; /**< offset of each field - always zero in a union */
+} AggregateLayout;
+
 /** a symbol */
 typedef struct SymbolTableEntry {
   SymbolKind kind;
@@ -65,15 +81,19 @@ typedef struct SymbolTableEntry {
           *definition; /**< actual definition of this opaque, nullable */
     } opaqueType;
     struct {
-      Vector fieldNames; /**< vector of char * (non-owning) */
-      Vector fieldTypes; /**< vector of types */
+      Vector fieldNames;    /**< vector of interned char * */
+      Vector fieldTypes;    /**< vector of types */
+      HashMap fieldIndices; /**< map from field name to one plus its index */
+      _Atomic(AggregateLayout *) layout; /**< nullable cached layout */
     } structType;
     struct {
-      Vector optionNames; /**< vector of char * (non-owning) */
-      Vector optionTypes; /**< vector of types */
+      Vector optionNames;    /**< vector of interned char * */
+      Vector optionTypes;    /**< vector of types */
+      HashMap optionIndices; /**< map from option name to one plus its index */
+      _Atomic(AggregateLayout *) layout; /**< nullable cached layout */
     } unionType;
     struct {
-      Vector constantNames;  /**< vector of char * (non-owning) */
+      Vector constantNames;  /**< vector of interned char * */
       Vector constantValues; /**< vector of SymbolTableEntry (enum consts) */
       Type *backingType;     /**< type used to store this enum */
     } enumType;
@@ -103,42 +123,57 @@ typedef struct SymbolTableEntry {
     } function;
   } data;
   FileListEntry *file;
-  size_t line; /**< line and character of first declaration */
-  size_t character;
+  uint32_t offset; /**< offset of first declaration */
   char const *id;
 } SymbolTableEntry;
 
 /**
  * initialize symbol table entries
  */
-SymbolTableEntry *opaqueStabEntryCreate(FileListEntry *file, size_t line,
-                                        size_t character, char const *id);
-SymbolTableEntry *structStabEntryCreate(FileListEntry *file, size_t line,
-                                        size_t character, char const *id);
-SymbolTableEntry *unionStabEntryCreate(FileListEntry *file, size_t line,
-                                       size_t character, char const *id);
-SymbolTableEntry *enumStabEntryCreate(FileListEntry *file, size_t line,
-                                      size_t character, char const *id);
-SymbolTableEntry *enumConstStabEntryCreate(FileListEntry *file, size_t line,
-                                           size_t character, char const *id,
+SymbolTableEntry *opaqueStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                        char const *id);
+SymbolTableEntry *structStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                        char const *id);
+SymbolTableEntry *unionStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                       char const *id);
+SymbolTableEntry *enumStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                      char const *id);
+SymbolTableEntry *enumConstStabEntryCreate(FileListEntry *file,
+                                           uint32_t offset, char const *id,
                                            SymbolTableEntry *parent);
-SymbolTableEntry *typedefStabEntryCreate(FileListEntry *file, size_t line,
-                                         size_t character, char const *id);
-SymbolTableEntry *variableStabEntryCreate(FileListEntry *file, size_t line,
-                                          size_t character, char const *id);
-SymbolTableEntry *functionStabEntryCreate(FileListEntry *file, size_t line,
-                                          size_t character, char const *id);
+SymbolTableEntry *typedefStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                         char const *id);
+SymbolTableEntry *variableStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                          char const *id);
+SymbolTableEntry *functionStabEntryCreate(FileListEntry *file, uint32_t offset,
+                                          char const *id);
+
+/**
+ * adds a field to the end of a struct - field must be interned, and not already
+ * in the struct, and type is now owned by the struct
+ */
+void structAddField(SymbolTableEntry *structEntry, char const *field,
+                    Type *type);
+/**
+ * adds an option to the end of a union - option must be interned, and not
+ * already in the union, and type is now owned by the union
+ */
+void unionAddOption(SymbolTableEntry *unionEntry, char const *option,
+                    Type *type);
 
 /**
- * find the type associated with a field, or return NULL
+ * find the type associated with a field, or return NULL - field must be
+ * interned
  */
 Type *structLookupField(SymbolTableEntry *structEntry, char const *field);
 /**
- * find the type associated with an option, or return NULL
+ * find the type associated with an option, or return NULL - option must be
+ * interned
  */
 Type *unionLookupOption(SymbolTableEntry *unionEntry, char const *option);
 /**
- * find the enum const associated with a name, or return NULL
+ * find the enum const associated with a name, or return NULL - name must be
+ * interned
  */
 SymbolTableEntry *enumLookupEnumConst(SymbolTableEntry *enumEntry,
                                       char const *name);
@@ -150,4 +185,55 @@ SymbolTableEntry *enumLookupEnumConst(SymbolTableEntry *enumEntry,
  */
 void stabEntryFree(SymbolTableEntry *e);
 
+/** number of entries a scope holds before moving them into a HashMap */
+#define SCOPE_INLINE_CAPACITY 6
+
+/**
+ * a block's symbol table
+ *
+ * most blocks declare at most a few variables, so a scope keeps its first
+ * entries in its own arrays and searches them linearly; only a scope with more
+ * than SCOPE_INLINE_CAPACITY entries allocates a map
+ */
+typedef struct {
+  size_t size; /**< number of entries */
+  char const *ids[SCOPE_INLINE_CAPACITY]; /**< interned ids, if map is null */
+  SymbolTableEntry
+      *entries[SCOPE_INLINE_CAPACITY]; /**< entries, if map is null - owning */
+  HashMap *map; /**< symbol table with every entry, nullable - owning */
+} Scope;
+
+/**
+ * initializes an empty scope
+ *
+ * @param scope scope to initialize
+ */
+void scopeInit(Scope *scope);
+
+/**
+ * finds an entry in a scope
+ *
+ * @param scope scope to search
+ * @param id interned id to look for
+ * @returns entry, or NULL if the scope doesn't declare id
+ */
+SymbolTableEntry *scopeGet(Scope const *scope, char const *id);
+
+/**
+ * adds an entry to a scope
+ *
+ * @param scope scope to add to
+ * @param id interned id of the entry
+ * @param entry entry to add, owned by the scope if added
+ * @returns 0 if the entry was added, -1 if the scope already declares id
+ */
+int scopePut(Scope *scope, char const *id, SymbolTableEntry *entry);
+
+/**
+ * deinitializes a scope, freeing its entries
+ *
+ * @param scope scope to deinitialize
+ */
+void scopeUninit(Scope *scope);
+
 #endif  // TLC_AST_SYMBOLTABLE_H_
\ No newline at end of file
@@ -18,104 +18,315 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 // type implementation
+//
+// Types are interned in a table split into shards, each behind its own lock,
+// like interned strings. A type's children are interned before it is, so two
+// types are identical exactly when their kind, scalars, and children's
+// pointers are. Keyword types are common enough that they're preallocated.
 
 #include "ast/type.h"
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
 #include "ast/symbolTable.h"
+#include "util/arena.h"
+#include "util/functional.h"
+#include "util/hash.h"
 #include "util/internalError.h"
 #include "util/numericSizing.h"
 
-static Type *typeCreate(TypeKind kind) {
-  Type *t = malloc(sizeof(Type));
-  t->kind = kind;
-  return t;
-}
-Type *keywordTypeCreate(TypeKeyword keyword) {
-  Type *t = typeCreate(TK_KEYWORD);
-  t->data.keyword.keyword = keyword;
-  return t;
-}
-Type *qualifiedTypeCreate(Type *base, bool constQual, bool volatileQual) {
-  Type *t = typeCreate(TK_QUALIFIED);
-  t->data.qualified.constQual = constQual;
-  t->data.qualified.volatileQual = volatileQual;
-  t->data.qualified.base = base;
-  return t;
-}
-Type *pointerTypeCreate(Type *base) {
-  Type *t = typeCreate(TK_POINTER);
-  t->data.pointer.base = base;
-  return t;
-}
-Type *arrayTypeCreate(uint64_t length, Type *type) {
-  Type *t = typeCreate(TK_ARRAY);
-  t->data.array.length = length;
-  t->data.array.type = type;
-  return t;
-}
-Type *funPtrTypeCreate(Type *returnType) {
-  Type *t = typeCreate(TK_FUNPTR);
-  t->data.funPtr.returnType = returnType;
-  vectorInit(&t->data.funPtr.argTypes);
-  return t;
-}
-Type *aggregateTypeCreate(void) {
-  Type *t = typeCreate(TK_AGGREGATE);
-  vectorInit(&t->data.aggregate.types);
-  return t;
-}
-Type *referenceTypeCreate(SymbolTableEntry *entry) {
-  Type *t = typeCreate(TK_REFERENCE);
-  t->data.reference.entry = entry;
-  return t;
+/** number of shards, must be a power of two */
+#define NUM_SHARDS 16
+/** initial number of slots in each shard's table */
+#define SHARD_INIT_CAPACITY 256
+
+/** a slot in a shard's table */
+typedef struct {
+  uint64_t hash; /**< hash of type, avoids rehashing */
+  Type *type;    /**< NULL if the slot is empty */
+} Slot;
+
+/** one independently locked part of the type table */
+typedef struct {
+  pthread_mutex_t lock;
+  size_t size;
+  size_t capacity; /**< always a power of two */
+  Slot *slots;     /**< open addressed table with linear probing */
+  Arena *arena;    /**< owns the shard's types */
+} Shard;
+
+static Shard shards[NUM_SHARDS];
+static pthread_once_t shardsOnce = PTHREAD_ONCE_INIT;
+
+/** the keyword types, indexed by keyword */
+static Type keywordTypes[] = {
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_VOID},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_UBYTE},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_BYTE},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_CHAR},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_USHORT},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_SHORT},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_UINT},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_INT},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_WCHAR},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_ULONG},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_LONG},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_FLOAT},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_DOUBLE},
+    {.kind = TK_KEYWORD, .data.keyword.keyword = TK_BOOL},
+};
+
+static void shardsInit(void) {
+  for (size_t idx = 0; idx < NUM_SHARDS; ++idx) {
+    Shard *shard = &shards[idx];
+    pthread_mutex_init(&shard->lock, NULL);
+    shard->size = 0;
+    shard->capacity = SHARD_INIT_CAPACITY;
+    shard->slots = calloc(shard->capacity, sizeof(Slot));
+    shard->arena = arenaCreate();
+  }
 }
-Type *typeCopy(Type const *t) {
-  if (t == NULL) return NULL;
+
+/**
+ * gets the vector of children of a type, if it has one
+ */
+static Vector const *typeChildren(Type const *t) {
   switch (t->kind) {
-    case TK_KEYWORD: {
-      return keywordTypeCreate(t->data.keyword.keyword);
+    case TK_FUNPTR: {
+      return &t->data.funPtr.argTypes;
+    }
+    case TK_AGGREGATE: {
+      return &t->data.aggregate.types;
     }
+    default: {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * hashes a type whose children are interned
+ */
+static uint64_t typeHash(Type const *t) {
+  uint64_t words[4] = {(uint64_t)t->kind, 0, 0, 0};
+  switch (t->kind) {
     case TK_QUALIFIED: {
-      return qualifiedTypeCreate(typeCopy(t->data.qualified.base),
-                                 t->data.qualified.constQual,
-                                 t->data.qualified.volatileQual);
+      words[1] = (uint64_t)t->data.qualified.constQual |
+                 (uint64_t)t->data.qualified.volatileQual << 1;
+      words[2] = (uint64_t)(uintptr_t)t->data.qualified.base;
+      break;
     }
     case TK_POINTER: {
-      return pointerTypeCreate(typeCopy(t->data.pointer.base));
+      words[1] = (uint64_t)(uintptr_t)t->data.pointer.base;
+      break;
     }
     case TK_ARRAY: {
-      return arrayTypeCreate(t->data.array.length,
-                             typeCopy(t->data.array.type));
+      words[1] = t->data.array.length;
+      words[2] = (uint64_t)(uintptr_t)t->data.array.type;
+      break;
     }
     case TK_FUNPTR: {
-      Type *copy = funPtrTypeCreate(typeCopy(t->data.funPtr.returnType));
-      for (size_t idx = 0; idx < t->data.funPtr.argTypes.size; ++idx)
-        vectorInsert(&copy->data.funPtr.argTypes,
-                     typeCopy(t->data.funPtr.argTypes.elements[idx]));
-      return copy;
+      words[1] = (uint64_t)(uintptr_t)t->data.funPtr.returnType;
+      break;
     }
-    case TK_AGGREGATE: {
-      Type *copy = aggregateTypeCreate();
-      for (size_t idx = 0; idx < t->data.aggregate.types.size; ++idx)
-        vectorInsert(&copy->data.funPtr.argTypes,
-                     typeCopy(t->data.aggregate.types.elements[idx]));
-      return copy;
+    case TK_REFERENCE: {
+      words[1] = (uint64_t)(uintptr_t)t->data.reference.entry;
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+  Vector const *children = typeChildren(t);
+  if (children != NULL && children->size != 0)
+    words[3] = hashBytes(children->elements, children->size * sizeof(void *));
+  return hashBytes(words, sizeof(words));
+}
+
+/**
+ * are two types whose children are interned the same type
+ */
+static bool typeIdentical(Type const *a, Type const *b) {
+  if (a->kind != b->kind) return false;
+  switch (a->kind) {
+    case TK_QUALIFIED: {
+      return a->data.qualified.constQual == b->data.qualified.constQual &&
+             a->data.qualified.volatileQual == b->data.qualified.volatileQual &&
+             a->data.qualified.base == b->data.qualified.base;
+    }
+    case TK_POINTER: {
+      return a->data.pointer.base == b->data.pointer.base;
+    }
+    case TK_ARRAY: {
+      return a->data.array.length == b->data.array.length &&
+             a->data.array.type == b->data.array.type;
+    }
+    case TK_FUNPTR: {
+      if (a->data.funPtr.returnType != b->data.funPtr.returnType) return false;
+      break;
     }
     case TK_REFERENCE: {
-      return referenceTypeCreate(t->data.reference.entry);
+      return a->data.reference.entry == b->data.reference.entry;
     }
     default: {
-      error(__FILE__, __LINE__, "bad type given to typeCopy");
+      break;
+    }
+  }
+  Vector const *aChildren = typeChildren(a);
+  Vector const *bChildren = typeChildren(b);
+  return aChildren->size == bChildren->size &&
+         (aChildren->size == 0 ||
+          memcmp(aChildren->elements, bChildren->elements,
+                 aChildren->size * sizeof(void *)) == 0);
+}
+
+/**
+ * does a type mention a reference type - children may be null, if there was an
+ * error building them
+ */
+static bool typeNamed(Type const *t) { return t != NULL && t->named; }
+
+/**
+ * doubles the capacity of a shard's table
+ */
+static void shardGrow(Shard *shard) {
+  size_t oldCapacity = shard->capacity;
+  Slot *oldSlots = shard->slots;
+  shard->capacity *= 2;
+  shard->slots = calloc(shard->capacity, sizeof(Slot));
+  for (size_t idx = 0; idx < oldCapacity; ++idx) {
+    if (oldSlots[idx].type != NULL) {
+      size_t slot = (size_t)(oldSlots[idx].hash >> 16);
+      while (shard->slots[slot & (shard->capacity - 1)].type != NULL) ++slot;
+      shard->slots[slot & (shard->capacity - 1)] = oldSlots[idx];
+    }
+  }
+  free(oldSlots);
+}
+
+/**
+ * gets the canonical copy of a type, creating it if it doesn't exist yet
+ *
+ * @param key type to look up, whose children are interned - its vector of
+ * children, if any, is taken by the table or freed
+ * @returns interned type
+ */
+static Type *typeIntern(Type *key) {
+  pthread_once(&shardsOnce, shardsInit);
+
+  // the top bits of the hash select the shard, and the middle bits the slot
+  uint64_t hash = typeHash(key);
+  Shard *shard = &shards[hash >> 60];
+
+  pthread_mutex_lock(&shard->lock);
+  Slot *slot;
+  for (size_t idx = (size_t)(hash >> 16);; ++idx) {
+    slot = &shard->slots[idx & (shard->capacity - 1)];
+    if (slot->type == NULL) break;
+    if (slot->hash == hash && typeIdentical(slot->type, key)) {
+      Type *found = slot->type;
+      pthread_mutex_unlock(&shard->lock);
+      if (key->kind == TK_FUNPTR)
+        vectorUninit(&key->data.funPtr.argTypes, nullDtor);
+      else if (key->kind == TK_AGGREGATE)
+        vectorUninit(&key->data.aggregate.types, nullDtor);
+      return found;
     }
   }
+
+  Type *t = arenaAllocate(shard->arena, sizeof(Type));
+  *t = *key;
+  slot->hash = hash;
+  slot->type = t;
+  if (++shard->size * 2 > shard->capacity) shardGrow(shard);
+  pthread_mutex_unlock(&shard->lock);
+  return t;
+}
+
+Type *keywordTypeCreate(TypeKeyword keyword) { return &keywordTypes[keyword]; }
+Type *qualifiedTypeCreate(Type *base, bool constQual, bool volatileQual) {
+  Type key;
+  key.kind = TK_QUALIFIED;
+  key.named = typeNamed(base);
+  key.data.qualified.constQual = constQual;
+  key.data.qualified.volatileQual = volatileQual;
+  key.data.qualified.base = base;
+  return typeIntern(&key);
+}
+Type *pointerTypeCreate(Type *base) {
+  Type key;
+  key.kind = TK_POINTER;
+  key.named = typeNamed(base);
+  key.data.pointer.base = base;
+  return typeIntern(&key);
+}
+Type *arrayTypeCreate(uint64_t length, Type *type) {
+  Type key;
+  key.kind = TK_ARRAY;
+  key.named = typeNamed(type);
+  key.data.array.length = length;
+  key.data.array.type = type;
+  return typeIntern(&key);
+}
+/**
+ * does any type in a vector mention a reference type
+ */
+static bool typeVectorNamed(Vector const *types) {
+  for (size_t idx = 0; idx < types->size; ++idx) {
+    if (typeNamed(types->elements[idx])) return true;
+  }
+  return false;
+}
+Type *funPtrTypeCreate(Type *returnType, Vector *argTypes) {
+  Type key;
+  key.kind = TK_FUNPTR;
+  key.named = typeNamed(returnType) || typeVectorNamed(argTypes);
+  key.data.funPtr.argTypes = *argTypes;
+  key.data.funPtr.returnType = returnType;
+  return typeIntern(&key);
+}
+Type *aggregateTypeCreate(Vector *types) {
+  Type key;
+  key.kind = TK_AGGREGATE;
+  key.named = typeVectorNamed(types);
+  key.data.aggregate.types = *types;
+  return typeIntern(&key);
+}
+Type *referenceTypeCreate(SymbolTableEntry *entry) {
+  Type key;
+  key.kind = TK_REFERENCE;
+  key.named = true;
+  key.data.reference.entry = entry;
+  return typeIntern(&key);
+}
+Type *unresolvedReferenceTypeCreate(void) {
+  pthread_once(&shardsOnce, shardsInit);
+
+  // not in any table, but owned by the first shard's arena
+  Shard *shard = &shards[0];
+  pthread_mutex_lock(&shard->lock);
+  Type *t = arenaAllocate(shard->arena, sizeof(Type));
+  pthread_mutex_unlock(&shard->lock);
+  t->kind = TK_REFERENCE;
+  t->named = true;
+  t->data.reference.entry = NULL;
+  return t;
+}
+Type *typeCopy(Type const *t) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+  return (Type *)t;
+#pragma GCC diagnostic pop
 }
 bool typeEqual(Type const *a, Type const *b) {
-  if (a->kind != b->kind) return false;
+  // interned types are the same type exactly when they're the same pointer,
+  // unless an opaque type or an unresolved reference is involved
+  if (a == b) return true;
+  if (a->kind != b->kind || !a->named || !b->named) return false;
 
   switch (a->kind) {
-    case TK_KEYWORD: {
-      return a->data.keyword.keyword == b->data.keyword.keyword;
-    }
     case TK_QUALIFIED: {
       return a->data.qualified.constQual == b->data.qualified.constQual &&
              a->data.qualified.volatileQual == b->data.qualified.volatileQual &&
@@ -632,6 +843,59 @@ Type *comparisonTypeMerge(Type const *a, Type const *b) {
   }
 }
 
+/**
+ * gets the layout of a struct or union, computing it the first time it's
+ * needed
+ *
+ * threads that race to compute a layout all compute the same one, and all but
+ * the first to finish throw theirs away
+ *
+ * @param entry SK_STRUCT or SK_UNION entry whose field types are complete
+ * @returns layout, owned by the entry
+ */
+static AggregateLayout const *aggregateLayout(SymbolTableEntry *entry) {
+  bool isStruct = entry->kind == SK_STRUCT;
+  _Atomic(AggregateLayout *) *cached = isStruct
+                                           ? &entry->data.structType.layout
+                                           : &entry->data.unionType.layout;
+  AggregateLayout *layout = atomic_load_explicit(cached, memory_order_acquire);
+  if (layout != NULL) return layout;
+
+  Vector const *types = isStruct ? &entry->data.structType.fieldTypes
+                                 : &entry->data.unionType.optionTypes;
+  layout = malloc(sizeof(AggregateLayout) + types->size * sizeof(size_t));
+  layout->alignment = 0;
+  for (size_t idx = 0; idx < types->size; ++idx) {
+    size_t alignment = typeAlignof(types->elements[idx]);
+    if (alignment > layout->alignment) layout->alignment = alignment;
+  }
+
+  layout->size = 0;
+  for (size_t idx = 0; idx < types->size; ++idx) {
+    size_t size = typeSizeof(types->elements[idx]);
+    if (isStruct) {
+      // each field starts at the first multiple of its alignment, and the
+      // struct is padded out to a multiple of its alignment
+      layout->offsets[idx] = layout->size;
+      layout->size = incrementToMultiple(
+          layout->size + size, idx < types->size - 1
+                                   ? typeAlignof(types->elements[idx + 1])
+                                   : layout->alignment);
+    } else {
+      layout->offsets[idx] = 0;
+      if (size > layout->size) layout->size = size;
+    }
+  }
+
+  AggregateLayout *published = NULL;
+  if (atomic_compare_exchange_strong_explicit(cached, &published, layout,
+                                              memory_order_acq_rel,
+                                              memory_order_acquire))
+    return layout;
+  free(layout);
+  return published;
+}
+
 size_t typeSizeof(Type const *t) {
   switch (t->kind) {
     case TK_KEYWORD: {
@@ -689,31 +953,9 @@ size_t typeSizeof(Type const *t) {
     case TK_REFERENCE: {
       SymbolTableEntry *entry = t->data.reference.entry;
       switch (entry->kind) {
-        case SK_STRUCT: {
-          size_t size = 0;
-          for (size_t idx = 0; idx < entry->data.structType.fieldTypes.size;
-               ++idx) {
-            size += typeSizeof(entry->data.structType.fieldTypes.elements[idx]);
-            if (idx < entry->data.structType.fieldTypes.size - 1) {
-              size = incrementToMultiple(
-                  size,
-                  typeAlignof(
-                      entry->data.structType.fieldTypes.elements[idx + 1]));
-            } else {
-              size = incrementToMultiple(size, typeAlignof(t));
-            }
-          }
-          return size;
-        }
+        case SK_STRUCT:
         case SK_UNION: {
-          size_t size = 0;
-          for (size_t idx = 0; idx < entry->data.unionType.optionTypes.size;
-               ++idx) {
-            size_t compare =
-                typeSizeof(entry->data.unionType.optionTypes.elements[idx]);
-            if (compare > size) size = compare;
-          }
-          return size;
+          return aggregateLayout(entry)->size;
         }
         case SK_ENUM: {
           return typeSizeof(entry->data.enumType.backingType);
@@ -731,15 +973,9 @@ size_t typeSizeof(Type const *t) {
     }
   }
 }
-size_t structOffsetof(struct SymbolTableEntry const *e, char const *field) {
-  size_t offset = 0;
-  for (size_t idx = 0;
-       strcmp(e->data.structType.fieldNames.elements[idx], field) != 0; ++idx) {
-    offset += typeSizeof(e->data.structType.fieldTypes.elements[idx]);
-    offset = incrementToMultiple(
-        offset, typeAlignof(e->data.structType.fieldTypes.elements[idx + 1]));
-  }
-  return offset;
+size_t structOffsetof(SymbolTableEntry *e, char const *field) {
+  void *index = hashMapGetId(&e->data.structType.fieldIndices, field);
+  return aggregateLayout(e)->offsets[(uintptr_t)index - 1];
 }
 size_t typeAlignof(Type const *t) {
   switch (t->kind) {
@@ -765,25 +1001,9 @@ size_t typeAlignof(Type const *t) {
     case TK_REFERENCE: {
       SymbolTableEntry *entry = t->data.reference.entry;
       switch (entry->kind) {
-        case SK_STRUCT: {
-          size_t alignment = 0;
-          for (size_t idx = 0; idx < entry->data.structType.fieldTypes.size;
-               ++idx) {
-            size_t compare =
-                typeAlignof(entry->data.structType.fieldTypes.elements[idx]);
-            if (compare > alignment) alignment = compare;
-          }
-          return alignment;
-        }
+        case SK_STRUCT:
         case SK_UNION: {
-          size_t alignment = 0;
-          for (size_t idx = 0; idx < entry->data.unionType.optionTypes.size;
-               ++idx) {
-            size_t compare =
-                typeAlignof(entry->data.unionType.optionTypes.elements[idx]);
-            if (compare > alignment) alignment = compare;
-          }
-          return alignment;
+          return aggregateLayout(entry)->alignment;
         }
         case SK_ENUM: {
           return typeAlignof(entry->data.enumType.backingType);
@@ -1025,39 +1245,22 @@ char *typeToString(Type const *t) {
     }
   }
 }
-void typeFree(Type *t) {
-  if (t == NULL) return;
+void typeTableClear(void) {
+  pthread_once(&shardsOnce, shardsInit);
 
-  switch (t->kind) {
-    case TK_QUALIFIED: {
-      typeFree(t->data.qualified.base);
-      break;
-    }
-    case TK_POINTER: {
-      typeFree(t->data.pointer.base);
-      break;
-    }
-    case TK_ARRAY: {
-      typeFree(t->data.array.type);
-      break;
-    }
-    case TK_FUNPTR: {
-      vectorUninit(&t->data.funPtr.argTypes, (void (*)(void *))typeFree);
-      typeFree(t->data.funPtr.returnType);
-      break;
-    }
-    case TK_AGGREGATE: {
-      vectorUninit(&t->data.aggregate.types, (void (*)(void *))typeFree);
-      break;
-    }
-    default: {
-      break;  // nothing to do
-    }
+  for (size_t idx = 0; idx < NUM_SHARDS; ++idx) {
+    Shard *shard = &shards[idx];
+    for (size_t slot = 0; slot < shard->capacity; ++slot) {
+      Type *t = shard->slots[slot].type;
+      if (t == NULL) continue;
+      if (t->kind == TK_FUNPTR)
+        vectorUninit(&t->data.funPtr.argTypes, nullDtor);
+      else if (t->kind == TK_AGGREGATE)
+        vectorUninit(&t->data.aggregate.types, nullDtor);
+    }
+    memset(shard->slots, 0, shard->capacity * sizeof(Slot));
+    shard->size = 0;
+    arenaFree(shard->arena);
+    shard->arena = arenaCreate();
   }
-  free(t);
-}
-
-void typeVectorFree(Vector *v) {
-  vectorUninit(v, (void (*)(void *))typeFree);
-  free(v);
 }
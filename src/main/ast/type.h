@@ -62,9 +62,16 @@ typedef enum {
 } TypeKind;
 
 struct SymbolTableEntry;
-/** the type of a variable or value */
+/**
+ * the type of a variable or value
+ *
+ * Types are interned: each structurally unique type is created once, and is
+ * shared by everything that uses it. They are never freed individually, and
+ * must not be modified.
+ */
 typedef struct Type {
   TypeKind kind;
+  bool named; /**< does this type mention a reference type */
   union {
     struct {
       TypeKeyword keyword;
@@ -120,25 +127,38 @@ Type *arrayTypeCreate(uint64_t length, Type *type);
 /**
  * create a function pointer type
  *
- * argTypes is initialized as the empty vector
+ * @param returnType return type
+ * @param argTypes vector of Type, whose contents are taken by the type
  */
-Type *funPtrTypeCreate(Type *returnType);
+Type *funPtrTypeCreate(Type *returnType, Vector *argTypes);
 /**
  * create a aggregate init type
  *
- * types is initialized as the empty vector
+ * @param types vector of Type, whose contents are taken by the type
  */
-Type *aggregateTypeCreate(void);
+Type *aggregateTypeCreate(Vector *types);
 /**
  * create a reference type
  */
 Type *referenceTypeCreate(struct SymbolTableEntry *entry);
 /**
- * deep copies a type
+ * create a reference type whose entry is filled in later
+ *
+ * Unlike every other type, this isn't interned, so types built around it are
+ * distinct from otherwise identical types - typeEqual still considers them
+ * equal, though
+ */
+Type *unresolvedReferenceTypeCreate(void);
+/**
+ * gets a type to store where a mutable one is expected - types are immutable,
+ * so this is the type itself
  */
 Type *typeCopy(Type const *);
 /**
  * is a equal to b
+ *
+ * This is a pointer comparison, except for types mentioning named types, since
+ * an opaque type and its definition are different entries
  */
 bool typeEqual(Type const *a, Type const *b);
 /**
@@ -221,7 +241,7 @@ size_t typeSizeof(Type const *t);
 /**
  * produce the offset of a struct field
  */
-size_t structOffsetof(struct SymbolTableEntry const *e, char const *field);
+size_t structOffsetof(struct SymbolTableEntry *e, char const *field);
 /**
  * produce the alignment of a type
  */
@@ -258,16 +278,8 @@ char *typeVectorToString(Vector const *v);
  */
 char *typeToString(Type const *t);
 /**
- * deinitializes a type
- *
- * @param t type to uninit
- */
-void typeFree(Type *t);
-/**
- * deinitializes a vector of types
- *
- * @param v vector to uninit
+ * frees every type - must only be called when no types are in use
  */
-void typeVectorFree(Vector *v);
+void typeTableClear(void);
 
 #endif  // TLC_AST_TYPE_H_
\ No newline at end of file
@@ -0,0 +1,344 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arch/interface.h"
+#include "fileList.h"
+#include "options.h"
+#include "util/container/vector.h"
+#include "util/format.h"
+#include "util/functional.h"
+#include "util/hash.h"
+#include "util/serialize.h"
+#include "version.h"
+
+// Format of a cache entry (numbers and strings as in util/serialize.h):
+//
+// entry := magic version key dependencies asm checksum
+// magic := "TLC-TCC\0"
+// version := number - CACHE_VERSION
+// key := string - see entryKey; guards against hash collisions
+// dependencies := number (string number)* - path and contents hash of each
+//                 declaration file the code file transitively depends on
+// asm := architecture-specific - see serializeAsmFile
+// checksum := fnv1a of everything before it, as eight bytes in host order
+//
+// Entries are named by the hash of their key and are only ever replaced
+// atomically, so compilers sharing a cache directory at worst duplicate work.
+
+/** cache entry magic number */
+static char const CACHE_MAGIC[8] = "TLC-TCC";
+/** cache entry format version - bump whenever the format or assembly changes */
+#define CACHE_VERSION 1
+
+/** is the cache being used for this compilation? */
+static bool active = false;
+/** number of files in the file list, including ones loaded from the cache */
+static size_t fullSize;
+/** hash of the paths of the declaration files given, in order */
+static uint64_t declHash;
+/** vector of FileListEntry - dependencies of each compiled code file */
+static Vector *dependencies = NULL;
+
+/**
+ * maps a file into memory
+ *
+ * @param filename file to map
+ * @param length output parameter for the length of the file
+ * @returns mapped file, or MAP_FAILED if it couldn't be mapped or was empty
+ */
+static char *mapFile(char const *filename, size_t *length) {
+  int fd = open(filename, O_RDONLY);
+  if (fd == -1) return MAP_FAILED;
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) != 0 || statbuf.st_size == 0) {
+    close(fd);
+    return MAP_FAILED;
+  }
+  *length = (size_t)statbuf.st_size;
+  char *map = mmap(NULL, *length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  return map;
+}
+
+/**
+ * produces the key for a code file's entry
+ *
+ * The file's path is part of the key since __FILE__ expands to it, and the set
+ * of declaration files given is since adding one can give a code module a
+ * declaration module it didn't have before
+ *
+ * @param entry code file, with sourceHash set
+ * @returns key (owning)
+ */
+static char *entryKey(FileListEntry const *entry) {
+  return format("%s\n%s\n%016" PRIx64 "\n%016" PRIx64 "\n%d", VERSION_STRING,
+                entry->inputFilename, entry->sourceHash, declHash,
+                options.arch);
+}
+
+/**
+ * produces the path to the entry for a key
+ *
+ * @returns path (owning)
+ */
+static char *entryFilename(char const *key) {
+  return format("%s/%016" PRIx64, options.cacheDir, fnv1a(key, strlen(key)));
+}
+
+/**
+ * finds a declaration file by path
+ *
+ * @returns declaration file, or NULL if it wasn't given
+ */
+static FileListEntry *findDeclFile(char const *filename) {
+  for (size_t idx = 0; idx < fullSize; ++idx) {
+    FileListEntry *entry = &fileList.entries[idx];
+    if (!entry->isCode && strcmp(entry->inputFilename, filename) == 0)
+      return entry;
+  }
+  return NULL;
+}
+
+/**
+ * reads a cache entry
+ *
+ * @param in stream containing the entry, without its checksum
+ * @param key expected key
+ * @returns assembly, or NULL if the entry was malformed or stale
+ */
+static void *readEntry(FILE *in, char const *key) {
+  char magic[sizeof(CACHE_MAGIC)];
+  if (fread(magic, sizeof(magic), 1, in) != 1 ||
+      memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0)
+    return NULL;
+
+  bool errored = false;
+  if (deserializeNumber(in, &errored) != CACHE_VERSION || errored) return NULL;
+
+  char *readKey = deserializeString(in, &errored);
+  bool keyMatches = !errored && strcmp(readKey, key) == 0;
+  free(readKey);
+  if (!keyMatches) return NULL;
+
+  uint64_t numDependencies = deserializeNumber(in, &errored);
+  for (uint64_t idx = 0; idx < numDependencies && !errored; ++idx) {
+    char *filename = deserializeString(in, &errored);
+    uint64_t hash = deserializeNumber(in, &errored);
+    if (errored) break;
+
+    FileListEntry *dependency = findDeclFile(filename);
+    free(filename);
+    if (dependency == NULL || dependency->sourceHash != hash) return NULL;
+  }
+  if (errored) return NULL;
+
+  return deserializeAsmFile(in);
+}
+
+/**
+ * loads a code file's assembly from the cache
+ *
+ * @returns assembly, or NULL if there was no valid entry
+ */
+static void *loadEntry(FileListEntry const *entry) {
+  char *key = entryKey(entry);
+  char *filename = entryFilename(key);
+  size_t length;
+  char *map = mapFile(filename, &length);
+  free(filename);
+
+  void *asmFile = NULL;
+  uint64_t checksum;
+  if (map != MAP_FAILED && length > sizeof(checksum)) {
+    length -= sizeof(checksum);
+    memcpy(&checksum, map + length, sizeof(checksum));
+    if (checksum == fnv1a(map, length)) {
+      FILE *in = fmemopen(map, length, "r");
+      if (in != NULL) {
+        asmFile = readEntry(in, key);
+        fclose(in);
+      }
+    }
+    munmap(map, length + sizeof(checksum));
+  } else if (map != MAP_FAILED) {
+    munmap(map, length);
+  }
+
+  free(key);
+  return asmFile;
+}
+
+void cacheLookup(void) {
+  active = options.cacheDir != NULL && options.dump == OPTION_DD_NONE;
+  if (!active) return;
+
+  fullSize = fileList.size;
+
+  declHash = fnv1a(NULL, 0);
+  for (size_t idx = 0; idx < fullSize; ++idx) {
+    FileListEntry *entry = &fileList.entries[idx];
+    if (!entry->isCode) {
+      // unreadable declaration files are reported by the parser, and never
+      // match a recorded dependency
+      fileListEntryHash(entry);
+      // include the terminator so the paths can't run together
+      declHash = fnv1aExtend(declHash, entry->inputFilename,
+                             strlen(entry->inputFilename) + 1);
+    }
+  }
+
+  // load what we can, moving loaded files to the end of the list
+  FileListEntry *loaded = malloc(sizeof(FileListEntry) * fullSize);
+  size_t numLoaded = 0;
+  size_t numCompiled = 0;
+  for (size_t idx = 0; idx < fullSize; ++idx) {
+    FileListEntry *entry = &fileList.entries[idx];
+    if (entry->isCode && fileListEntryHash(entry) == 0)
+      entry->asmFile = loadEntry(entry);
+
+    if (entry->asmFile != NULL)
+      loaded[numLoaded++] = *entry;
+    else
+      fileList.entries[numCompiled++] = *entry;
+  }
+  memcpy(fileList.entries + numCompiled, loaded,
+         sizeof(FileListEntry) * numLoaded);
+  free(loaded);
+
+  fileList.size = numCompiled;
+}
+
+static void collectDependencies(FileListEntry const *file,
+                                Vector *dependencies);
+/**
+ * adds a declaration module and everything it transitively imports to a
+ * vector, if it isn't already there
+ */
+static void addDependency(FileListEntry *decl, Vector *dependencies) {
+  for (size_t idx = 0; idx < dependencies->size; ++idx) {
+    if (dependencies->elements[idx] == decl) return;
+  }
+  vectorInsert(dependencies, decl);
+  collectDependencies(decl, dependencies);
+}
+/**
+ * adds the declaration modules a file transitively imports to a vector
+ */
+static void collectDependencies(FileListEntry const *file,
+                                Vector *dependencies) {
+  Vector *imports = file->ast->data.file.imports;
+  for (size_t idx = 0; idx < imports->size; ++idx) {
+    Node *import = imports->elements[idx];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    addDependency(import->data.import.referenced, dependencies);
+#pragma GCC diagnostic pop
+  }
+}
+
+void cacheRecordDependencies(void) {
+  if (!active) return;
+
+  dependencies = malloc(sizeof(Vector) * fileList.size);
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    FileListEntry *entry = &fileList.entries[idx];
+    vectorInit(&dependencies[idx]);
+    if (!entry->isCode) continue;
+
+    // a code module implicitly depends on its declaration module, if any
+    FileListEntry *decl =
+        fileListFindDeclName(entry->ast->data.file.module->data.module.id);
+    if (decl != NULL) addDependency(decl, &dependencies[idx]);
+    collectDependencies(entry, &dependencies[idx]);
+  }
+}
+
+/**
+ * writes a code file's assembly to the cache
+ */
+static void storeEntry(FileListEntry const *entry, Vector const *dependencies) {
+  // build the entry in memory, so the checksum can be computed before anything
+  // is written to disk
+  char *buffer;
+  size_t length;
+  FILE *out = open_memstream(&buffer, &length);
+  if (out == NULL) return;
+
+  char *key = entryKey(entry);
+  fwrite(CACHE_MAGIC, sizeof(CACHE_MAGIC), 1, out);
+  serializeNumber(out, CACHE_VERSION);
+  serializeString(out, key);
+  serializeNumber(out, dependencies->size);
+  for (size_t idx = 0; idx < dependencies->size; ++idx) {
+    FileListEntry const *dependency = dependencies->elements[idx];
+    serializeString(out, dependency->inputFilename);
+    serializeNumber(out, dependency->sourceHash);
+  }
+  serializeAsmFile(out, entry->asmFile);
+  bool ok = ferror(out) == 0;
+  if (fclose(out) != 0) ok = false;
+
+  if (ok) {
+    uint64_t checksum = fnv1a(buffer, length);
+    char *filename = entryFilename(key);
+    AtomicFile file;
+    if (atomicFileOpen(&file, filename) == 0) {
+      fwrite(buffer, length, 1, file.stream);
+      fwrite(&checksum, sizeof(checksum), 1, file.stream);
+      atomicFileClose(&file, true);
+    }
+    free(filename);
+  }
+
+  free(key);
+  free(buffer);
+}
+
+void cacheStore(size_t fileIdx) {
+  if (!active || dependencies == NULL) return;
+
+  FileListEntry const *entry = &fileList.entries[fileIdx];
+  if (entry->isCode &&
+      (mkdir(options.cacheDir, 0777) == 0 || errno == EEXIST))
+    storeEntry(entry, &dependencies[fileIdx]);
+}
+
+void cacheFinish(void) {
+  if (!active) return;
+
+  if (dependencies != NULL) {
+    for (size_t idx = 0; idx < fileList.size; ++idx)
+      vectorUninit(&dependencies[idx], nullDtor);
+    free(dependencies);
+    dependencies = NULL;
+  }
+
+  fileList.size = fullSize;
+}
@@ -0,0 +1,67 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * incremental compilation cache, for --cache-dir
+ *
+ * Each code file's generated assembly is cached under a key derived from its
+ * contents and the compiler's configuration. An entry also records the
+ * contents of every declaration module the code file transitively imports, and
+ * is only reused if all of those are unchanged.
+ */
+
+#ifndef TLC_CACHE_H_
+#define TLC_CACHE_H_
+
+#include <stddef.h>
+
+/**
+ * loads cached assembly for unchanged code files
+ *
+ * Code files with a valid cache entry have their asmFile filled in and are
+ * moved past the end of the file list, so the rest of compilation skips them
+ * until cacheFinish puts them back
+ */
+void cacheLookup(void);
+
+/**
+ * records the declaration modules each code file depends on - must be called
+ * after parsing, while the ASTs are still alive
+ */
+void cacheRecordDependencies(void);
+
+/**
+ * writes the cache entry for a code file that was compiled
+ *
+ * must be called once the file's assembly is generated. Other files may be
+ * stored concurrently
+ *
+ * @param fileIdx index of the file in the file list
+ */
+void cacheStore(size_t fileIdx);
+
+/**
+ * restores the code files that were loaded from the cache to the file list
+ *
+ * must be called once every compiled code file has been stored
+ */
+void cacheFinish(void);
+
+#endif  // TLC_CACHE_H_
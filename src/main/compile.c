@@ -0,0 +1,213 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "compile.h"
+
+#include <stdio.h>
+
+#include "arch/interface.h"
+#include "ast/dump.h"
+#include "cache.h"
+#include "fileList.h"
+#include "ir/dump.h"
+#include "ir/ir.h"
+#include "lexer/dump.h"
+#include "lexer/lexer.h"
+#include "optimization/optimization.h"
+#include "options.h"
+#include "parser/declIndex.h"
+#include "parser/parser.h"
+#include "timeReport.h"
+#include "translation/traceSchedule.h"
+#include "translation/translation.h"
+#include "typechecker/typechecker.h"
+#include "util/parallel.h"
+
+/**
+ * finishes compilation, printing the time report, if requested
+ *
+ * @param code return value for main
+ * @returns code
+ */
+static int finishCompilation(int code) {
+  timeReportPrint(stderr);
+  return code;
+}
+
+/**
+ * dumps a file's IR if a debug dump was requested at this point
+ *
+ * @param point point in compilation the IR is at
+ * @param file file to dump
+ */
+static void dumpIrAt(DebugDumpOption point, FileListEntry *file) {
+  if (options.dump == point) irDump(stderr, file);
+}
+
+/**
+ * takes a code file from its typechecked AST through to assembly, freeing its
+ * IR and assembly as soon as they're no longer needed
+ *
+ * failing IR validation marks the file as errored and skips the rest
+ *
+ * @param fileIdx index of the file in the file list
+ */
+static void generateCode(size_t fileIdx) {
+  FileListEntry *file = &fileList.entries[fileIdx];
+
+  // translate to IR
+  translateFile(fileIdx);
+  dumpIrAt(OPTION_DD_TRANSLATION, file);
+  if (options.debugValidateIr &&
+      validateBlockedIrFile("translation", fileIdx) != 0)
+    return;
+
+  // middle-end
+
+  // blocked ir optimization
+  optimizeBlockedIrFile(fileIdx);
+  dumpIrAt(OPTION_DD_BLOCKED_OPTIMIZATION, file);
+  if (options.debugValidateIr &&
+      validateBlockedIrFile("optimization before trace scheduling",
+                            fileIdx) != 0)
+    return;
+
+  // trace scheduling
+  traceScheduleFile(fileIdx);
+  dumpIrAt(OPTION_DD_TRACE_SCHEDULING, file);
+  if (options.debugValidateIr &&
+      validateScheduledIrFile("trace scheduling", fileIdx) != 0)
+    return;
+
+  // scheduled ir optimization
+  optimizeScheduledIrFile(fileIdx);
+  dumpIrAt(OPTION_DD_SCHEDULED_OPTIMIZATION, file);
+  if (options.debugValidateIr &&
+      validateScheduledIrFile("optimization after trace scheduling",
+                              fileIdx) != 0)
+    return;
+
+  // hand off to arch-specific backend
+  backend(fileIdx);
+}
+
+/**
+ * compiles a code file, then frees its AST
+ *
+ * nothing else refers into a code file's AST once it's translated, unlike a
+ * declaration file's, which every code file importing it needs
+ *
+ * @param fileIdx index of the file in the file list
+ * @param ignored unused
+ */
+static void compileFile(size_t fileIdx, void *ignored) {
+  (void)ignored;
+  FileListEntry *file = &fileList.entries[fileIdx];
+  if (!file->isCode) return;
+
+  generateCode(fileIdx);
+
+  if (!file->preparsed) {
+    nodeFree(file->ast);
+    file->ast = NULL;
+  }
+}
+
+/**
+ * runs a code file loaded from the cache through the rest of the backend
+ *
+ * files past the ones compiled are either loaded from the cache, or are
+ * declaration files dropped by lazy loading, which are skipped
+ *
+ * @param idx index of the file among the files past the compiled ones
+ * @param compiledSize pointer to the number of files that were compiled
+ */
+static void finishCachedFile(size_t idx, void *compiledSize) {
+  size_t fileIdx = *(size_t const *)compiledSize + idx;
+  if (fileList.entries[fileIdx].isCode) backend(fileIdx);
+}
+
+int compile(void) {
+  timeReportInit();
+
+  // skip code files that haven't changed since they were cached
+  cacheLookup();
+
+  // debug-dump stop for lexing
+  if (options.dump == OPTION_DD_LEX) {
+    for (size_t idx = 0; idx < fileList.size; ++idx)
+      lexDump(&fileList.entries[idx]);
+  }
+
+  // front-end
+
+  // parse
+  timeReportBegin(TRP_PARSE);
+  int parseStatus = parse();
+  timeReportEnd(TRP_PARSE);
+  if (parseStatus != 0) return finishCompilation(CODE_PARSE_ERROR);
+  cacheRecordDependencies();
+
+  // debug-dump stop for parsing
+  if (options.dump == OPTION_DD_PARSE) {
+    for (size_t idx = 0; idx < fileList.size; ++idx)
+      astDump(stderr, &fileList.entries[idx]);
+  }
+
+  // typecheck
+  timeReportBegin(TRP_TYPECHECK);
+  int typecheckStatus = typecheck();
+  timeReportEnd(TRP_TYPECHECK);
+  if (typecheckStatus != 0) return finishCompilation(CODE_TYPECHECK_ERROR);
+
+  // debug-dump stop for typechecking
+  // TODO: write this
+
+  // additional warnings
+  // TODO: unreachable, reserved-id, const-return, duplicate-decl-specifier
+
+  // source code optimization
+  // TODO: write this
+
+  // code generation - each code file is taken all the way to assembly on its
+  // own, so only the files being worked on hold IR at any one time; debug
+  // dumps are done serially so they stay in file order
+  timeReportBegin(TRP_CODE_GENERATION);
+  parallelFor(options.dump == OPTION_DD_NONE ? options.jobs : 1, fileList.size,
+              compileFile, NULL);
+  size_t compiledSize = fileList.size;
+  cacheFinish();
+  parallelFor(options.jobs, fileList.size - compiledSize, finishCachedFile,
+              &compiledSize);
+  timeReportEnd(TRP_CODE_GENERATION);
+
+  // clean up declaration files' ASTs - code files' were freed once compiled,
+  // and preparsed files belong to the compile server
+  bool irErrored = false;
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    FileListEntry *entry = &fileList.entries[idx];
+    irErrored = irErrored || (entry->isCode && entry->errored);
+    if (entry->preparsed) continue;
+    nodeFree(entry->ast);
+    declIndexUnload(entry);
+  }
+  if (irErrored) return finishCompilation(CODE_IR_ERROR);
+
+  return finishCompilation(CODE_SUCCESS);
+}
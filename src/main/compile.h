@@ -0,0 +1,47 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * the compilation pipeline, from source files to assembly
+ */
+
+#ifndef TLC_COMPILE_H_
+#define TLC_COMPILE_H_
+
+#include <stdlib.h>
+
+/** possible return values for main */
+enum {
+  CODE_SUCCESS = EXIT_SUCCESS,
+  CODE_OPTION_ERROR,
+  CODE_FILE_ERROR,
+  CODE_PARSE_ERROR,
+  CODE_TYPECHECK_ERROR,
+  CODE_IR_ERROR,
+};
+
+/**
+ * compiles the files in the global file list, given the global options
+ *
+ * @returns return value for main
+ */
+int compile(void);
+
+#endif  // TLC_COMPILE_H_
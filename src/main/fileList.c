@@ -19,23 +19,120 @@
 
 #include "fileList.h"
 
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "options.h"
+#include "util/functional.h"
+#include "util/hash.h"
 
 FileList fileList;
 
+/**
+ * adds a line start to an entry's line index, growing it as needed
+ */
+static void lineStartsInsert(FileListEntry *entry, size_t *capacity,
+                             uint32_t start) {
+  if (entry->numLines == *capacity) {
+    *capacity *= 2;
+    entry->lineStarts =
+        realloc(entry->lineStarts, *capacity * sizeof(uint32_t));
+  }
+  entry->lineStarts[entry->numLines++] = start;
+}
+
+void fileListEntryIndexLines(FileListEntry *entry, char const *text,
+                             size_t length) {
+  size_t capacity = 64;
+  free(entry->lineStarts);
+  entry->lineStarts = malloc(capacity * sizeof(uint32_t));
+  entry->numLines = 0;
+  lineStartsInsert(entry, &capacity, 0);
+  if (length == 0) return;
+
+  char const *end = text + length;
+  if (memchr(text, '\r', length) == NULL) {
+    // common case - let memchr do the scanning
+    for (char const *newline = memchr(text, '\n', length); newline != NULL;
+         newline = memchr(newline + 1, '\n', (size_t)(end - newline - 1)))
+      lineStartsInsert(entry, &capacity, (uint32_t)(newline + 1 - text));
+  } else {
+    for (char const *current = text; current != end; ++current) {
+      if (*current == '\r') {
+        if (current + 1 != end && current[1] == '\n') ++current;
+        lineStartsInsert(entry, &capacity, (uint32_t)(current + 1 - text));
+      } else if (*current == '\n') {
+        lineStartsInsert(entry, &capacity, (uint32_t)(current + 1 - text));
+      }
+    }
+  }
+}
+
+void fileListEntryPosition(FileListEntry const *entry, uint32_t offset,
+                           size_t *line, size_t *character) {
+  if (entry->numLines == 0) {
+    // never lexed - treat the file as a single line
+    *line = 1;
+    *character = offset + 1;
+    return;
+  }
+
+  // last line starting at or before offset
+  size_t low = 0;
+  size_t high = entry->numLines;
+  while (high - low > 1) {
+    size_t mid = low + (high - low) / 2;
+    if (entry->lineStarts[mid] <= offset)
+      low = mid;
+    else
+      high = mid;
+  }
+  *line = low + 1;
+  *character = offset - entry->lineStarts[low] + 1;
+}
+
 void fileListEntryInit(FileListEntry *entry, char const *inputName,
                        bool isCode) {
   entry->inputFilename = inputName;
   entry->isCode = isCode;
-  entry->errored = false;
+  atomic_init(&entry->errored, false);
   entry->ast = NULL;
+  entry->sourceHash = 0;
+  entry->declIndex = NULL;
+  entry->preparsed = false;
   entry->nextId = 1;
   vectorInit(&entry->irFrags);
   entry->asmFile = NULL;
+  entry->lineStarts = NULL;
+  entry->numLines = 0;
+}
+
+int fileListEntryHash(FileListEntry *entry) {
+  int fd = open(entry->inputFilename, O_RDONLY);
+  if (fd == -1) return -1;
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  size_t length = (size_t)statbuf.st_size;
+  if (length == 0) {
+    close(fd);
+    entry->sourceHash = fnv1a(NULL, 0);
+    return 0;
+  }
+  void *map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return -1;
+  entry->sourceHash = fnv1a(map, length);
+  munmap(map, length);
+  return 0;
 }
 
 int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
@@ -45,6 +142,10 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
   fileList.size = 0;  // eventually going to be at most numFiles long
   fileList.entries = malloc(sizeof(FileListEntry) * numFiles);
 
+  // paths seen so far, for duplicate detection
+  HashMap paths;
+  hashMapInit(&paths);
+
   // read the args
   bool allFiles = false;
   for (size_t idx = 1; idx < argc; ++idx) {
@@ -80,15 +181,8 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
       }
       if (recognized) {
         // search for duplicates
-        bool duplicate = false;
-        for (size_t searchIdx = 0; searchIdx < fileList.size; ++searchIdx) {
-          if (strcmp(argv[idx], fileList.entries[searchIdx].inputFilename) ==
-              0) {
-            duplicate = true;
-            break;
-          }
-        }
-        if (duplicate) {
+        if (hashMapPut(&paths, argv[idx], fileList.entries + fileList.size) !=
+            0) {
           switch (options.duplicateFile) {
             case OPTION_W_ERROR: {
               fprintf(stderr, "%s: error: duplicated file\n", argv[idx]);
@@ -111,9 +205,14 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
       }
     } else if (strcmp(argv[idx], "--") == 0) {
       allFiles = true;
+    } else if (strcmp(argv[idx], "-j") == 0) {
+      // skip the job count
+      ++idx;
     }
   }
 
+  hashMapUninit(&paths, nullDtor);
+
   // shrink down to size
   fileList.entries =
       realloc(fileList.entries, sizeof(FileListEntry) * fileList.size);
@@ -134,12 +233,34 @@ int parseFiles(size_t argc, char const *const *argv, size_t numFiles) {
   return err;
 }
 
-FileListEntry *fileListFindDeclName(Node *name) {
+void fileListIndexDecls(void) {
+  if (fileList.indexed) {
+    hashMapUninit(&fileList.moduleIndex, nullDtor);
+    vectorUninit(&fileList.moduleNames, free);
+  }
+  hashMapInit(&fileList.moduleIndex);
+  vectorInit(&fileList.moduleNames);
+  fileList.indexed = true;
+
   for (size_t idx = 0; idx < fileList.size; ++idx) {
-    if (!fileList.entries[idx].isCode &&
-        nameNodeEqual(
-            name, fileList.entries[idx].ast->data.file.module->data.module.id))
-      return &fileList.entries[idx];
+    FileListEntry *entry = &fileList.entries[idx];
+    if (entry->isCode) continue;
+
+    char *name = stringifyId(entry->ast->data.file.module->data.module.id);
+    if (hashMapPut(&fileList.moduleIndex, name, entry) == 0)
+      vectorInsert(&fileList.moduleNames, name);
+    else
+      free(name);
   }
-  return NULL;
-}
\ No newline at end of file
+}
+
+FileListEntry *fileListFindDecl(char const *name) {
+  return hashMapGet(&fileList.moduleIndex, name);
+}
+
+FileListEntry *fileListFindDeclName(Node *name) {
+  char *nameString = stringifyId(name);
+  FileListEntry *entry = fileListFindDecl(nameString);
+  free(nameString);
+  return entry;
+}
@@ -25,25 +25,41 @@
 #ifndef TLC_FILE_LIST_H_
 #define TLC_FILE_LIST_H_
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "ast/ast.h"
 #include "lexer/lexer.h"
 #include "util/container/hashMap.h"
 
+typedef struct DeclIndex DeclIndex;
+
 /** an entry in the filelist */
 typedef struct FileListEntry {
-  bool errored;              /**< has an error been signaled for this entry? */
+  atomic_bool errored; /**< has an error been signaled for this entry? - may
+                          be set concurrently by parts of a parallel pass */
   char const *inputFilename; /**< path to the input file */
   bool isCode;           /**< does the input file path point to a code file */
   LexerState lexerState; /**< state of the lexer - cleaned up during parse */
   Node *ast; /**< AST for this file - cleaned up at entry to the middleend */
+  uint64_t sourceHash;  /**< hash of the file's contents - only computed when
+                           precompiled declarations or the cache are used */
+  DeclIndex *declIndex; /**< precompiled declarations the AST was loaded from,
+                           or NULL if it was parsed from source */
+  bool preparsed; /**< was the file parsed, typechecked, and had its symbol
+                     table built before compilation started? - only set for
+                     decl files kept by the compile server */
   size_t nextId;  /**< next IR id for this file */
   Vector irFrags; /**< vector of IRFrag - translated IR fragments - cleaned up
                      at entry to the backend */
   void *asmFile;  /**< architecture-specific ASM data - cleaned up after ir
                      output */
+  uint32_t *lineStarts; /**< offsets at which each line of the file starts,
+                           as of when it was last lexed - see
+                           fileListEntryIndexLines */
+  size_t numLines;      /**< number of elements in lineStarts */
 } FileListEntry;
 
 /**
@@ -56,10 +72,45 @@ typedef struct FileListEntry {
 void fileListEntryInit(FileListEntry *entry, char const *inputName,
                        bool isCode);
 
+/**
+ * sets an entry's sourceHash from the current contents of its file
+ *
+ * @param entry entry to hash
+ * @returns status code (0 = OK)
+ */
+int fileListEntryHash(FileListEntry *entry);
+
+/**
+ * records where each line of an entry's file starts, replacing any previous
+ * record - line breaks are "\n", "\r\n", or a lone "\r", as in the lexer
+ *
+ * @param entry entry to index
+ * @param text contents of the entry's file
+ * @param length length of text
+ */
+void fileListEntryIndexLines(FileListEntry *entry, char const *text,
+                             size_t length);
+
+/**
+ * gets the line and character a byte offset in an entry's file falls on, as of
+ * when the file was last lexed
+ *
+ * @param entry entry the offset is in
+ * @param offset byte offset into the entry's file
+ * @param line output 1-indexed line number
+ * @param character output 1-indexed character number within the line
+ */
+void fileListEntryPosition(FileListEntry const *entry, uint32_t offset,
+                           size_t *line, size_t *character);
+
 /** global file list type */
 typedef struct {
   size_t size;
   FileListEntry *entries;
+  bool indexed;         /**< have moduleIndex and moduleNames been built? */
+  HashMap moduleIndex;  /**< map from module name to the first decl file
+                           declaring it - see fileListIndexDecls */
+  Vector moduleNames;   /**< vector of char *, owning - keys of moduleIndex */
 } FileList;
 
 /**
@@ -72,10 +123,30 @@ typedef struct {
  */
 int parseFiles(size_t argc, char const *const *argv, size_t numFiles);
 
+/**
+ * indexes the declaration files in the file list by module name, replacing
+ * any previous index
+ *
+ * must be called once the top level of every file has been parsed, and before
+ * fileListFindDecl or fileListFindDeclName is used
+ */
+void fileListIndexDecls(void);
+
+/**
+ * finds the declaration file FileListEntry that declares the named module
+ *
+ * if no file declares the module, returns NULL; if multiple declaration files
+ * declare it, returns the first one
+ *
+ * @param name name of the module, as produced by stringifyId
+ */
+FileListEntry *fileListFindDecl(char const *name);
+
 /**
  * finds the declaration file FileListEntry that matches the specified name node
  *
- * if no name was found, return NULL
+ * if no name was found, return NULL; if multiple declaration files declare the
+ * name, returns the first one
  */
 FileListEntry *fileListFindDeclName(Node *name);
 
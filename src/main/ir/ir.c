@@ -1049,707 +1049,738 @@ static void validateArgJumpTarget(IRInstruction const *i, size_t idx,
     }
   }
 }
-static int validateIr(char const *phase, bool blocked) {
-  bool errored = false;
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *file = &fileList.entries[fileIdx];
-    for (size_t fragIdx = 0; fragIdx < file->irFrags.size; ++fragIdx) {
-      IRFrag const *frag = file->irFrags.elements[fragIdx];
-      if (frag->type == FT_TEXT) {
-        LinkedList const *blocks = &frag->data.text.blocks;
-        IROperand **temps = calloc(file->nextId, sizeof(IROperand *));
-
-        // localLabels is the list of existing local labels
-        // TODO: better differentiate between code labels (must be from the
-        // current function) and data labels (may be from anywhere)
-        bool *localLabels = calloc(file->nextId, sizeof(bool));
+/**
+ * checks the arch-neutral parts of a file's IR, marking it errored if invalid
+ */
+static void validateIrFile(char const *phase, bool blocked,
+                           FileListEntry *file) {
+  for (size_t fragIdx = 0; fragIdx < file->irFrags.size; ++fragIdx) {
+    IRFrag const *frag = file->irFrags.elements[fragIdx];
+    if (frag->type == FT_TEXT) {
+      LinkedList const *blocks = &frag->data.text.blocks;
+      IROperand **temps = calloc(file->nextId, sizeof(IROperand *));
+
+      // localLabels is the list of existing local labels
+      // TODO: better differentiate between code labels (must be from the
+      // current function) and data labels (may be from anywhere)
+      bool *localLabels = calloc(file->nextId, sizeof(bool));
+      for (ListNode *currBlock = blocks->head->next;
+           currBlock != blocks->tail; currBlock = currBlock->next) {
+        IRBlock *block = currBlock->data;
+        if (blocked) localLabels[block->label] = true;
+        for (ListNode *currInst = block->instructions.head->next;
+             currInst != block->instructions.tail;
+             currInst = currInst->next) {
+          IRInstruction *i = currInst->data;
+          if (!blocked && i->op == IO_LABEL && irOperandIsLocal(i->args[0]))
+            localLabels[localOperandName(i->args[0])] = true;
+        }
+      }
+      for (size_t dataFragIdx = 0; dataFragIdx < file->irFrags.size;
+           ++dataFragIdx) {
+        IRFrag *dataFrag = file->irFrags.elements[dataFragIdx];
+        if (dataFrag->nameType == FNT_LOCAL)
+          localLabels[dataFrag->name.local] = true;
+      }
+
+      if (blocked) {
         for (ListNode *currBlock = blocks->head->next;
              currBlock != blocks->tail; currBlock = currBlock->next) {
           IRBlock *block = currBlock->data;
-          if (blocked) localLabels[block->label] = true;
-          for (ListNode *currInst = block->instructions.head->next;
-               currInst != block->instructions.tail;
-               currInst = currInst->next) {
-            IRInstruction *i = currInst->data;
-            if (!blocked && i->op == IO_LABEL && irOperandIsLocal(i->args[0]))
-              localLabels[localOperandName(i->args[0])] = true;
+          IRInstruction *last = block->instructions.tail->prev->data;
+          switch (last->op) {
+            case IO_JUMP:
+            case IO_JUMPTABLE:
+            case IO_J2L:
+            case IO_J2LE:
+            case IO_J2E:
+            case IO_J2NE:
+            case IO_J2G:
+            case IO_J2GE:
+            case IO_J2A:
+            case IO_J2AE:
+            case IO_J2B:
+            case IO_J2BE:
+            case IO_J2FL:
+            case IO_J2FLE:
+            case IO_J2FE:
+            case IO_J2FNE:
+            case IO_J2FG:
+            case IO_J2FGE:
+            case IO_J2Z:
+            case IO_J2NZ:
+            case IO_J1L:
+            case IO_J1LE:
+            case IO_J1E:
+            case IO_J1NE:
+            case IO_J1G:
+            case IO_J1GE:
+            case IO_J1A:
+            case IO_J1AE:
+            case IO_J1B:
+            case IO_J1BE:
+            case IO_J1FL:
+            case IO_J1FLE:
+            case IO_J1FE:
+            case IO_J1FNE:
+            case IO_J1FG:
+            case IO_J1FGE:
+            case IO_J1Z:
+            case IO_J1NZ:
+            case IO_RETURN: {
+              break;
+            }
+            default: {
+              fprintf(stderr,
+                      "%s: internal compiler error: IR validation after %s "
+                      "failed - %s instruction encountered at the end of a "
+                      "basic block instead of a jump\n",
+                      file->inputFilename, phase, IROPERATOR_NAMES[last->op]);
+              file->errored = true;
+              break;
+            }
           }
         }
-        for (size_t dataFragIdx = 0; dataFragIdx < file->irFrags.size;
-             ++dataFragIdx) {
-          IRFrag *dataFrag = file->irFrags.elements[dataFragIdx];
-          if (dataFrag->nameType == FNT_LOCAL)
-            localLabels[dataFrag->name.local] = true;
-        }
+      }
+      for (ListNode *currBlock = blocks->head->next;
+           currBlock != blocks->tail; currBlock = currBlock->next) {
+        IRBlock *block = currBlock->data;
+        for (ListNode *currInst = block->instructions.head->next;
+             currInst != block->instructions.tail;
+             currInst = currInst->next) {
+          IRInstruction const *i = currInst->data;
+          if (i->op < IO_LABEL || i->op > IO_RETURN) {
+            fprintf(stderr,
+                    "%s: internal compiler error: IR validation after %s "
+                    "failed "
+                    "- invalid operator (numerically %d) encountered\n",
+                    file->inputFilename, phase, i->op);
+            file->errored = true;
+          }
+          switch (i->op) {
+            case IO_LABEL: {
+              validateArgLocal(i, 0, phase, file);
 
-        if (blocked) {
-          for (ListNode *currBlock = blocks->head->next;
-               currBlock != blocks->tail; currBlock = currBlock->next) {
-            IRBlock *block = currBlock->data;
-            IRInstruction *last = block->instructions.tail->prev->data;
-            switch (last->op) {
-              case IO_JUMP:
-              case IO_JUMPTABLE:
-              case IO_J2L:
-              case IO_J2LE:
-              case IO_J2E:
-              case IO_J2NE:
-              case IO_J2G:
-              case IO_J2GE:
-              case IO_J2A:
-              case IO_J2AE:
-              case IO_J2B:
-              case IO_J2BE:
-              case IO_J2FL:
-              case IO_J2FLE:
-              case IO_J2FE:
-              case IO_J2FNE:
-              case IO_J2FG:
-              case IO_J2FGE:
-              case IO_J2Z:
-              case IO_J2NZ:
-              case IO_J1L:
-              case IO_J1LE:
-              case IO_J1E:
-              case IO_J1NE:
-              case IO_J1G:
-              case IO_J1GE:
-              case IO_J1A:
-              case IO_J1AE:
-              case IO_J1B:
-              case IO_J1BE:
-              case IO_J1FL:
-              case IO_J1FLE:
-              case IO_J1FE:
-              case IO_J1FNE:
-              case IO_J1FG:
-              case IO_J1FGE:
-              case IO_J1Z:
-              case IO_J1NZ:
-              case IO_RETURN: {
-                break;
-              }
-              default: {
+              if (blocked) {
                 fprintf(stderr,
                         "%s: internal compiler error: IR validation after %s "
-                        "failed - %s instruction encountered at the end of a "
-                        "basic block instead of a jump\n",
-                        file->inputFilename, phase, IROPERATOR_NAMES[last->op]);
+                        "failed - label encountered in basic block IR\n",
+                        file->inputFilename, phase);
                 file->errored = true;
-                break;
               }
+              break;
             }
-          }
-        }
-        for (ListNode *currBlock = blocks->head->next;
-             currBlock != blocks->tail; currBlock = currBlock->next) {
-          IRBlock *block = currBlock->data;
-          for (ListNode *currInst = block->instructions.head->next;
-               currInst != block->instructions.tail;
-               currInst = currInst->next) {
-            IRInstruction const *i = currInst->data;
-            if (i->op < IO_LABEL || i->op > IO_RETURN) {
-              fprintf(stderr,
-                      "%s: internal compiler error: IR validation after %s "
-                      "failed "
-                      "- invalid operator (numerically %d) encountered\n",
-                      file->inputFilename, phase, i->op);
-              file->errored = true;
+            case IO_VOLATILE: {
+              if (validateArgKind(i, 0, OK_TEMP, phase, file))
+                validateTempRead(temps, i->args[0], phase, file);
+              break;
             }
-            switch (i->op) {
-              case IO_LABEL: {
-                validateArgLocal(i, 0, phase, file);
+            case IO_UNINITIALIZED: {
+              if (validateArgKind(i, 0, OK_TEMP, phase, file))
+                validateTempWrite(temps, i->args[0], phase, file);
+              break;
+            }
+            case IO_ADDROF: {
+              validateArgPointerWritten(i, 0, temps, phase, file);
 
-                if (blocked) {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - label encountered in basic block IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
-              }
-              case IO_VOLATILE: {
-                if (validateArgKind(i, 0, OK_TEMP, phase, file))
-                  validateTempRead(temps, i->args[0], phase, file);
-                break;
+              if (validateArgKind(i, 1, OK_TEMP, phase, file)) {
+                validateTempMEM(i, 1, phase, file);
+                validateTempRead(temps, i->args[1], phase, file);
               }
-              case IO_UNINITIALIZED: {
-                if (validateArgKind(i, 0, OK_TEMP, phase, file))
-                  validateTempWrite(temps, i->args[0], phase, file);
-                break;
-              }
-              case IO_ADDROF: {
-                validateArgPointerWritten(i, 0, temps, phase, file);
+              break;
+            }
+            case IO_NOP: {
+              break;
+            }
+            case IO_MOVE: {
+              validateArgWritable(i, 0, temps, phase, file);
 
-                if (validateArgKind(i, 1, OK_TEMP, phase, file)) {
-                  validateTempMEM(i, 1, phase, file);
-                  validateTempRead(temps, i->args[1], phase, file);
-                }
-                break;
-              }
-              case IO_NOP: {
-                break;
-              }
-              case IO_MOVE: {
-                validateArgWritable(i, 0, temps, phase, file);
+              validateArgRead(i, 1, temps, localLabels, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
+              validateArgsSameSize(i, 0, 1, phase, file);
+              break;
+            }
+            case IO_MEM_STORE: {
+              validateArgPointerRead(i, 0, temps, localLabels, phase, file);
 
-                validateArgsSameSize(i, 0, 1, phase, file);
-                break;
-              }
-              case IO_MEM_STORE: {
-                validateArgPointerRead(i, 0, temps, localLabels, phase, file);
+              validateArgRead(i, 1, temps, localLabels, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
+              validateArgOffset(i, 2, temps, phase, file);
+              break;
+            }
+            case IO_MEM_LOAD: {
+              validateArgWritable(i, 0, temps, phase, file);
 
-                validateArgOffset(i, 2, temps, phase, file);
-                break;
-              }
-              case IO_MEM_LOAD: {
-                validateArgWritable(i, 0, temps, phase, file);
+              validateArgPointerRead(i, 1, temps, localLabels, phase, file);
 
-                validateArgPointerRead(i, 1, temps, localLabels, phase, file);
+              validateArgOffset(i, 2, temps, phase, file);
+              break;
+            }
+            case IO_STK_STORE: {
+              validateArgOffset(i, 0, temps, phase, file);
 
-                validateArgOffset(i, 2, temps, phase, file);
-                break;
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              break;
+            }
+            case IO_STK_LOAD: {
+              validateArgWritable(i, 0, temps, phase, file);
+
+              validateArgOffset(i, 1, temps, phase, file);
+              break;
+            }
+            case IO_OFFSET_STORE: {
+              if (validateArgKind(i, 0, OK_TEMP, phase, file)) {
+                validateTempMEM(i, 0, phase, file);
+                validateTempWrite(temps, i->args[0], phase, file);
               }
-              case IO_STK_STORE: {
-                validateArgOffset(i, 0, temps, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
-                break;
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+
+              validateArgOffset(i, 2, temps, phase, file);
+              break;
+            }
+            case IO_OFFSET_LOAD: {
+              validateArgWritable(i, 0, temps, phase, file);
+
+              if (validateArgKind(i, 1, OK_TEMP, phase, file)) {
+                validateTempMEM(i, 1, phase, file);
+                validateTempWrite(temps, i->args[1], phase, file);
               }
-              case IO_STK_LOAD: {
-                validateArgWritable(i, 0, temps, phase, file);
 
-                validateArgOffset(i, 1, temps, phase, file);
-                break;
+              validateArgOffset(i, 2, temps, phase, file);
+              break;
+            }
+            case IO_ADD:
+            case IO_SUB:
+            case IO_SMUL:
+            case IO_UMUL:
+            case IO_SDIV:
+            case IO_UDIV:
+            case IO_SMOD:
+            case IO_UMOD:
+            case IO_AND:
+            case IO_XOR:
+            case IO_OR: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP) {
+                validateTempGP(i, 0, phase, file);
+                validateTempWrite(temps, i->args[0], phase, file);
               }
-              case IO_OFFSET_STORE: {
-                if (validateArgKind(i, 0, OK_TEMP, phase, file)) {
-                  validateTempMEM(i, 0, phase, file);
-                  validateTempWrite(temps, i->args[0], phase, file);
-                }
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempGP(i, 1, phase, file);
+
+              validateArgRead(i, 2, temps, localLabels, phase, file);
+              if (i->args[2]->kind == OK_TEMP)
+                validateTempGP(i, 2, phase, file);
 
-                validateArgOffset(i, 2, temps, phase, file);
-                break;
+              validateArgsSameSize(i, 0, 1, phase, file);
+              validateArgsSameSize(i, 0, 2, phase, file);
+              validateArgsSameSize(i, 1, 2, phase, file);
+              break;
+            }
+            case IO_FADD:
+            case IO_FSUB:
+            case IO_FMUL:
+            case IO_FDIV:
+            case IO_FMOD: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP) {
+                validateTempFP(i, 0, phase, file);
+                validateTempWrite(temps, i->args[0], phase, file);
               }
-              case IO_OFFSET_LOAD: {
-                validateArgWritable(i, 0, temps, phase, file);
 
-                if (validateArgKind(i, 1, OK_TEMP, phase, file)) {
-                  validateTempMEM(i, 1, phase, file);
-                  validateTempWrite(temps, i->args[1], phase, file);
-                }
+              validateArgReadNoPtr(i, 1, temps, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempFP(i, 1, phase, file);
 
-                validateArgOffset(i, 2, temps, phase, file);
-                break;
+              validateArgReadNoPtr(i, 2, temps, phase, file);
+              if (i->args[2]->kind == OK_TEMP)
+                validateTempFP(i, 2, phase, file);
+
+              validateArgsSameSize(i, 0, 1, phase, file);
+              validateArgsSameSize(i, 0, 2, phase, file);
+              validateArgsSameSize(i, 1, 2, phase, file);
+              break;
+            }
+            case IO_NEG:
+            case IO_NOT: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP) {
+                validateTempGP(i, 0, phase, file);
+                validateTempWrite(temps, i->args[0], phase, file);
               }
-              case IO_ADD:
-              case IO_SUB:
-              case IO_SMUL:
-              case IO_UMUL:
-              case IO_SDIV:
-              case IO_UDIV:
-              case IO_SMOD:
-              case IO_UMOD:
-              case IO_AND:
-              case IO_XOR:
-              case IO_OR: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP) {
-                  validateTempGP(i, 0, phase, file);
-                  validateTempWrite(temps, i->args[0], phase, file);
-                }
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempGP(i, 1, phase, file);
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempGP(i, 1, phase, file);
 
-                validateArgRead(i, 2, temps, localLabels, phase, file);
-                if (i->args[2]->kind == OK_TEMP)
-                  validateTempGP(i, 2, phase, file);
+              validateArgsSameSize(i, 0, 1, phase, file);
+              break;
+            }
+            case IO_FNEG: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP) {
+                validateTempFP(i, 0, phase, file);
+                validateTempWrite(temps, i->args[0], phase, file);
+              }
 
-                validateArgsSameSize(i, 0, 1, phase, file);
-                validateArgsSameSize(i, 0, 2, phase, file);
-                validateArgsSameSize(i, 1, 2, phase, file);
-                break;
+              validateArgReadNoPtr(i, 1, temps, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempFP(i, 1, phase, file);
+
+              validateArgsSameSize(i, 0, 1, phase, file);
+              break;
+            }
+            case IO_SLL:
+            case IO_SLR:
+            case IO_SAR: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP) {
+                validateTempGP(i, 0, phase, file);
+                validateTempWrite(temps, i->args[0], phase, file);
               }
-              case IO_FADD:
-              case IO_FSUB:
-              case IO_FMUL:
-              case IO_FDIV:
-              case IO_FMOD: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP) {
-                  validateTempFP(i, 0, phase, file);
-                  validateTempWrite(temps, i->args[0], phase, file);
-                }
 
-                validateArgReadNoPtr(i, 1, temps, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempFP(i, 1, phase, file);
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempGP(i, 1, phase, file);
 
-                validateArgReadNoPtr(i, 2, temps, phase, file);
-                if (i->args[2]->kind == OK_TEMP)
-                  validateTempFP(i, 2, phase, file);
+              validateArgByteRead(i, 2, temps, phase, file);
 
-                validateArgsSameSize(i, 0, 1, phase, file);
-                validateArgsSameSize(i, 0, 2, phase, file);
-                validateArgsSameSize(i, 1, 2, phase, file);
-                break;
+              validateArgsSameSize(i, 0, 1, phase, file);
+              break;
+            }
+            case IO_L:
+            case IO_LE:
+            case IO_E:
+            case IO_NE:
+            case IO_G:
+            case IO_GE:
+            case IO_A:
+            case IO_AE:
+            case IO_B:
+            case IO_BE: {
+              validateArgByteWritten(i, 0, temps, phase, file);
+
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempGP(i, 1, phase, file);
+
+              validateArgRead(i, 2, temps, localLabels, phase, file);
+              if (i->args[2]->kind == OK_TEMP)
+                validateTempGP(i, 2, phase, file);
+
+              validateArgsSameSize(i, 1, 2, phase, file);
+              break;
+            }
+            case IO_FL:
+            case IO_FLE:
+            case IO_FE:
+            case IO_FNE:
+            case IO_FG:
+            case IO_FGE: {
+              validateArgByteWritten(i, 0, temps, phase, file);
+
+              validateArgReadNoPtr(i, 1, temps, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempFP(i, 1, phase, file);
+
+              validateArgReadNoPtr(i, 2, temps, phase, file);
+              if (i->args[2]->kind == OK_TEMP)
+                validateTempFP(i, 2, phase, file);
+
+              validateArgsSameSize(i, 1, 2, phase, file);
+              break;
+            }
+            case IO_Z:
+            case IO_NZ: {
+              validateArgByteWritten(i, 0, temps, phase, file);
+
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              break;
+            }
+            case IO_LNOT: {
+              validateArgByteWritten(i, 0, temps, phase, file);
+
+              validateArgByteRead(i, 1, temps, phase, file);
+              break;
+            }
+            case IO_SX:
+            case IO_ZX: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP)
+                validateTempGP(i, 0, phase, file);
+
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempGP(i, 1, phase, file);
+
+              if (irOperandSizeof(i->args[0]) <=
+                  irOperandSizeof(i->args[1])) {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - %s instruction's argument 0 is not larger "
+                        "than "
+                        "argument 1\n",
+                        file->inputFilename, phase, IROPERATOR_NAMES[i->op]);
+                file->errored = true;
               }
-              case IO_NEG:
-              case IO_NOT: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP) {
-                  validateTempGP(i, 0, phase, file);
-                  validateTempWrite(temps, i->args[0], phase, file);
-                }
+              break;
+            }
+            case IO_TRUNC: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP)
+                validateTempGP(i, 0, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempGP(i, 1, phase, file);
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempGP(i, 1, phase, file);
 
-                validateArgsSameSize(i, 0, 1, phase, file);
-                break;
+              if (irOperandSizeof(i->args[0]) >=
+                  irOperandSizeof(i->args[1])) {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - TRUNC instruction's argument 0 is not "
+                        "smaller than argument 1\n",
+                        file->inputFilename, phase);
+                file->errored = true;
               }
-              case IO_FNEG: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP) {
-                  validateTempFP(i, 0, phase, file);
-                  validateTempWrite(temps, i->args[0], phase, file);
-                }
+              break;
+            }
+            case IO_U2F:
+            case IO_S2F: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP)
+                validateTempFP(i, 0, phase, file);
+
+              validateArgRead(i, 1, temps, localLabels, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempGP(i, 1, phase, file);
+              break;
+            }
+            case IO_FRESIZE: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP)
+                validateTempFP(i, 0, phase, file);
 
-                validateArgReadNoPtr(i, 1, temps, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempFP(i, 1, phase, file);
+              validateArgReadNoPtr(i, 1, temps, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempFP(i, 1, phase, file);
 
-                validateArgsSameSize(i, 0, 1, phase, file);
-                break;
+              if (irOperandSizeof(i->args[0]) ==
+                  irOperandSizeof(i->args[1])) {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - TRUNC instruction's argument 0 and 1 are "
+                        "the same size\n",
+                        file->inputFilename, phase);
+                file->errored = true;
               }
-              case IO_SLL:
-              case IO_SLR:
-              case IO_SAR: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP) {
-                  validateTempGP(i, 0, phase, file);
-                  validateTempWrite(temps, i->args[0], phase, file);
-                }
+              break;
+            }
+            case IO_F2I: {
+              validateArgWritable(i, 0, temps, phase, file);
+              if (i->args[0]->kind == OK_TEMP)
+                validateTempGP(i, 0, phase, file);
+
+              validateArgReadNoPtr(i, 1, temps, phase, file);
+              if (i->args[1]->kind == OK_TEMP)
+                validateTempFP(i, 1, phase, file);
+              break;
+            }
+            case IO_JUMP: {
+              validateArgLocal(i, 0, phase, file);
+              validateLocalJumpTarget(i, 0, localLabels, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempGP(i, 1, phase, file);
+              if (blocked && currInst->next != block->instructions.tail) {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - non-terminal jump encountered in basic "
+                        "block IR\n",
+                        file->inputFilename, phase);
+                file->errored = true;
+              }
+              break;
+            }
+            case IO_JUMPTABLE: {
+              validateArgKind(i, 0, OK_TEMP, phase, file);
 
-                validateArgByteRead(i, 2, temps, phase, file);
+              // TODO: check that this is a RODATA frag
+              validateArgLocal(i, 1, phase, file);
 
-                validateArgsSameSize(i, 0, 1, phase, file);
-                break;
+              if (blocked && currInst->next != block->instructions.tail) {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - non-terminal jump encountered in basic "
+                        "block IR\n",
+                        file->inputFilename, phase);
+                file->errored = true;
               }
-              case IO_L:
-              case IO_LE:
-              case IO_E:
-              case IO_NE:
-              case IO_G:
-              case IO_GE:
-              case IO_A:
-              case IO_AE:
-              case IO_B:
-              case IO_BE: {
-                validateArgByteWritten(i, 0, temps, phase, file);
+              break;
+            }
+            case IO_J2L:
+            case IO_J2LE:
+            case IO_J2E:
+            case IO_J2NE:
+            case IO_J2G:
+            case IO_J2GE:
+            case IO_J2A:
+            case IO_J2AE:
+            case IO_J2B:
+            case IO_J2BE: {
+              if (blocked) {
+                validateArgLocal(i, 0, phase, file);
+                validateLocalJumpTarget(i, 0, localLabels, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempGP(i, 1, phase, file);
+                validateArgLocal(i, 1, phase, file);
+                validateLocalJumpTarget(i, 1, localLabels, phase, file);
 
                 validateArgRead(i, 2, temps, localLabels, phase, file);
                 if (i->args[2]->kind == OK_TEMP)
                   validateTempGP(i, 2, phase, file);
 
-                validateArgsSameSize(i, 1, 2, phase, file);
-                break;
+                validateArgRead(i, 3, temps, localLabels, phase, file);
+                if (i->args[3]->kind == OK_TEMP)
+                  validateTempGP(i, 3, phase, file);
+
+                validateArgsSameSize(i, 2, 3, phase, file);
+
+                if (currInst->next != block->instructions.tail) {
+                  fprintf(
+                      stderr,
+                      "%s: internal compiler error: IR validation after %s "
+                      "failed - non-terminal jump encountered in basic "
+                      "block IR\n",
+                      file->inputFilename, phase);
+                  file->errored = true;
+                }
+              } else {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - two-target jump encountered in scheduled "
+                        "IR\n",
+                        file->inputFilename, phase);
+                file->errored = true;
               }
-              case IO_FL:
-              case IO_FLE:
-              case IO_FE:
-              case IO_FNE:
-              case IO_FG:
-              case IO_FGE: {
-                validateArgByteWritten(i, 0, temps, phase, file);
+              break;
+            }
+            case IO_J2FL:
+            case IO_J2FLE:
+            case IO_J2FE:
+            case IO_J2FNE:
+            case IO_J2FG:
+            case IO_J2FGE: {
+              if (blocked) {
+                validateArgLocal(i, 0, phase, file);
+                validateLocalJumpTarget(i, 0, localLabels, phase, file);
 
-                validateArgReadNoPtr(i, 1, temps, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempFP(i, 1, phase, file);
+                validateArgLocal(i, 1, phase, file);
+                validateLocalJumpTarget(i, 1, localLabels, phase, file);
 
                 validateArgReadNoPtr(i, 2, temps, phase, file);
                 if (i->args[2]->kind == OK_TEMP)
                   validateTempFP(i, 2, phase, file);
 
-                validateArgsSameSize(i, 1, 2, phase, file);
-                break;
-              }
-              case IO_Z:
-              case IO_NZ: {
-                validateArgByteWritten(i, 0, temps, phase, file);
+                validateArgReadNoPtr(i, 3, temps, phase, file);
+                if (i->args[3]->kind == OK_TEMP)
+                  validateTempFP(i, 3, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
-                break;
-              }
-              case IO_LNOT: {
-                validateArgByteWritten(i, 0, temps, phase, file);
-
-                validateArgByteRead(i, 1, temps, phase, file);
-                break;
-              }
-              case IO_SX:
-              case IO_ZX: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP)
-                  validateTempGP(i, 0, phase, file);
+                validateArgsSameSize(i, 2, 3, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempGP(i, 1, phase, file);
-
-                if (irOperandSizeof(i->args[0]) <=
-                    irOperandSizeof(i->args[1])) {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - %s instruction's argument 0 is not larger "
-                          "than "
-                          "argument 1\n",
-                          file->inputFilename, phase, IROPERATOR_NAMES[i->op]);
+                if (currInst->next != block->instructions.tail) {
+                  fprintf(
+                      stderr,
+                      "%s: internal compiler error: IR validation after %s "
+                      "failed - non-terminal jump encountered in basic "
+                      "block "
+                      "IR\n",
+                      file->inputFilename, phase);
                   file->errored = true;
                 }
-                break;
+              } else {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - two-target jump encountered in scheduled "
+                        "IR\n",
+                        file->inputFilename, phase);
+                file->errored = true;
               }
-              case IO_TRUNC: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP)
-                  validateTempGP(i, 0, phase, file);
+              break;
+            }
+            case IO_J2Z:
+            case IO_J2NZ: {
+              if (blocked) {
+                validateArgLocal(i, 0, phase, file);
+                validateLocalJumpTarget(i, 0, localLabels, phase, file);
 
-                validateArgRead(i, 1, temps, localLabels, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempGP(i, 1, phase, file);
+                validateArgLocal(i, 1, phase, file);
+                validateLocalJumpTarget(i, 1, localLabels, phase, file);
+
+                validateArgRead(i, 2, temps, localLabels, phase, file);
 
-                if (irOperandSizeof(i->args[0]) >=
-                    irOperandSizeof(i->args[1])) {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - TRUNC instruction's argument 0 is not "
-                          "smaller than argument 1\n",
-                          file->inputFilename, phase);
+                if (currInst->next != block->instructions.tail) {
+                  fprintf(
+                      stderr,
+                      "%s: internal compiler error: IR validation after %s "
+                      "failed - non-terminal jump encountered in basic "
+                      "block "
+                      "IR\n",
+                      file->inputFilename, phase);
                   file->errored = true;
                 }
-                break;
+              } else {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - two-target jump encountered in scheduled "
+                        "IR\n",
+                        file->inputFilename, phase);
+                file->errored = true;
               }
-              case IO_U2F:
-              case IO_S2F: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP)
-                  validateTempFP(i, 0, phase, file);
+              break;
+            }
+            case IO_J1L:
+            case IO_J1LE:
+            case IO_J1E:
+            case IO_J1NE:
+            case IO_J1G:
+            case IO_J1GE:
+            case IO_J1A:
+            case IO_J1AE:
+            case IO_J1B:
+            case IO_J1BE: {
+              if (!blocked) {
+                validateArgLocal(i, 0, phase, file);
+                validateLocalJumpTarget(i, 0, localLabels, phase, file);
 
                 validateArgRead(i, 1, temps, localLabels, phase, file);
                 if (i->args[1]->kind == OK_TEMP)
                   validateTempGP(i, 1, phase, file);
-                break;
-              }
-              case IO_FRESIZE: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP)
-                  validateTempFP(i, 0, phase, file);
 
-                validateArgReadNoPtr(i, 1, temps, phase, file);
-                if (i->args[1]->kind == OK_TEMP)
-                  validateTempFP(i, 1, phase, file);
+                validateArgRead(i, 2, temps, localLabels, phase, file);
+                if (i->args[2]->kind == OK_TEMP)
+                  validateTempGP(i, 2, phase, file);
 
-                if (irOperandSizeof(i->args[0]) ==
-                    irOperandSizeof(i->args[1])) {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - TRUNC instruction's argument 0 and 1 are "
-                          "the same size\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
+                validateArgsSameSize(i, 1, 2, phase, file);
+              } else {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - one-target jump encountered in basic block "
+                        "IR\n",
+                        file->inputFilename, phase);
+                file->errored = true;
               }
-              case IO_F2I: {
-                validateArgWritable(i, 0, temps, phase, file);
-                if (i->args[0]->kind == OK_TEMP)
-                  validateTempGP(i, 0, phase, file);
+              break;
+            }
+            case IO_J1FL:
+            case IO_J1FLE:
+            case IO_J1FE:
+            case IO_J1FNE:
+            case IO_J1FG:
+            case IO_J1FGE: {
+              if (!blocked) {
+                validateArgLocal(i, 0, phase, file);
+                validateLocalJumpTarget(i, 0, localLabels, phase, file);
 
                 validateArgReadNoPtr(i, 1, temps, phase, file);
                 if (i->args[1]->kind == OK_TEMP)
                   validateTempFP(i, 1, phase, file);
-                break;
-              }
-              case IO_JUMP: {
-                validateArgLocal(i, 0, phase, file);
-                validateLocalJumpTarget(i, 0, localLabels, phase, file);
-
-                if (blocked && currInst->next != block->instructions.tail) {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - non-terminal jump encountered in basic "
-                          "block IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
-              }
-              case IO_JUMPTABLE: {
-                validateArgKind(i, 0, OK_TEMP, phase, file);
 
-                // TODO: check that this is a RODATA frag
-                validateArgLocal(i, 1, phase, file);
+                validateArgReadNoPtr(i, 2, temps, phase, file);
+                if (i->args[2]->kind == OK_TEMP)
+                  validateTempFP(i, 2, phase, file);
 
-                if (blocked && currInst->next != block->instructions.tail) {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - non-terminal jump encountered in basic "
-                          "block IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
-              }
-              case IO_J2L:
-              case IO_J2LE:
-              case IO_J2E:
-              case IO_J2NE:
-              case IO_J2G:
-              case IO_J2GE:
-              case IO_J2A:
-              case IO_J2AE:
-              case IO_J2B:
-              case IO_J2BE: {
-                if (blocked) {
-                  validateArgLocal(i, 0, phase, file);
-                  validateLocalJumpTarget(i, 0, localLabels, phase, file);
-
-                  validateArgLocal(i, 1, phase, file);
-                  validateLocalJumpTarget(i, 1, localLabels, phase, file);
-
-                  validateArgRead(i, 2, temps, localLabels, phase, file);
-                  if (i->args[2]->kind == OK_TEMP)
-                    validateTempGP(i, 2, phase, file);
-
-                  validateArgRead(i, 3, temps, localLabels, phase, file);
-                  if (i->args[3]->kind == OK_TEMP)
-                    validateTempGP(i, 3, phase, file);
-
-                  validateArgsSameSize(i, 2, 3, phase, file);
-
-                  if (currInst->next != block->instructions.tail) {
-                    fprintf(
-                        stderr,
-                        "%s: internal compiler error: IR validation after %s "
-                        "failed - non-terminal jump encountered in basic "
-                        "block IR\n",
-                        file->inputFilename, phase);
-                    file->errored = true;
-                  }
-                } else {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - two-target jump encountered in scheduled "
-                          "IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
-              }
-              case IO_J2FL:
-              case IO_J2FLE:
-              case IO_J2FE:
-              case IO_J2FNE:
-              case IO_J2FG:
-              case IO_J2FGE: {
-                if (blocked) {
-                  validateArgLocal(i, 0, phase, file);
-                  validateLocalJumpTarget(i, 0, localLabels, phase, file);
-
-                  validateArgLocal(i, 1, phase, file);
-                  validateLocalJumpTarget(i, 1, localLabels, phase, file);
-
-                  validateArgReadNoPtr(i, 2, temps, phase, file);
-                  if (i->args[2]->kind == OK_TEMP)
-                    validateTempFP(i, 2, phase, file);
-
-                  validateArgReadNoPtr(i, 3, temps, phase, file);
-                  if (i->args[3]->kind == OK_TEMP)
-                    validateTempFP(i, 3, phase, file);
-
-                  validateArgsSameSize(i, 2, 3, phase, file);
-
-                  if (currInst->next != block->instructions.tail) {
-                    fprintf(
-                        stderr,
+                validateArgsSameSize(i, 1, 2, phase, file);
+              } else {
+                fprintf(stderr,
                         "%s: internal compiler error: IR validation after %s "
-                        "failed - non-terminal jump encountered in basic "
-                        "block "
+                        "failed - one-target jump encountered in basic block "
                         "IR\n",
                         file->inputFilename, phase);
-                    file->errored = true;
-                  }
-                } else {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - two-target jump encountered in scheduled "
-                          "IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
+                file->errored = true;
               }
-              case IO_J2Z:
-              case IO_J2NZ: {
-                if (blocked) {
-                  validateArgLocal(i, 0, phase, file);
-                  validateLocalJumpTarget(i, 0, localLabels, phase, file);
-
-                  validateArgLocal(i, 1, phase, file);
-                  validateLocalJumpTarget(i, 1, localLabels, phase, file);
-
-                  validateArgRead(i, 2, temps, localLabels, phase, file);
+              break;
+            }
+            case IO_J1Z:
+            case IO_J1NZ: {
+              if (!blocked) {
+                validateArgLocal(i, 0, phase, file);
+                validateLocalJumpTarget(i, 0, localLabels, phase, file);
 
-                  if (currInst->next != block->instructions.tail) {
-                    fprintf(
-                        stderr,
+                validateArgRead(i, 1, temps, localLabels, phase, file);
+              } else {
+                fprintf(stderr,
                         "%s: internal compiler error: IR validation after %s "
-                        "failed - non-terminal jump encountered in basic "
-                        "block "
+                        "failed - one-target jump encountered in basic block "
                         "IR\n",
                         file->inputFilename, phase);
-                    file->errored = true;
-                  }
-                } else {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - two-target jump encountered in scheduled "
-                          "IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
-              }
-              case IO_J1L:
-              case IO_J1LE:
-              case IO_J1E:
-              case IO_J1NE:
-              case IO_J1G:
-              case IO_J1GE:
-              case IO_J1A:
-              case IO_J1AE:
-              case IO_J1B:
-              case IO_J1BE: {
-                if (!blocked) {
-                  validateArgLocal(i, 0, phase, file);
-                  validateLocalJumpTarget(i, 0, localLabels, phase, file);
-
-                  validateArgRead(i, 1, temps, localLabels, phase, file);
-                  if (i->args[1]->kind == OK_TEMP)
-                    validateTempGP(i, 1, phase, file);
-
-                  validateArgRead(i, 2, temps, localLabels, phase, file);
-                  if (i->args[2]->kind == OK_TEMP)
-                    validateTempGP(i, 2, phase, file);
-
-                  validateArgsSameSize(i, 1, 2, phase, file);
-                } else {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - one-target jump encountered in basic block "
-                          "IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
-              }
-              case IO_J1FL:
-              case IO_J1FLE:
-              case IO_J1FE:
-              case IO_J1FNE:
-              case IO_J1FG:
-              case IO_J1FGE: {
-                if (!blocked) {
-                  validateArgLocal(i, 0, phase, file);
-                  validateLocalJumpTarget(i, 0, localLabels, phase, file);
-
-                  validateArgReadNoPtr(i, 1, temps, phase, file);
-                  if (i->args[1]->kind == OK_TEMP)
-                    validateTempFP(i, 1, phase, file);
-
-                  validateArgReadNoPtr(i, 2, temps, phase, file);
-                  if (i->args[2]->kind == OK_TEMP)
-                    validateTempFP(i, 2, phase, file);
-
-                  validateArgsSameSize(i, 1, 2, phase, file);
-                } else {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - one-target jump encountered in basic block "
-                          "IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
-              }
-              case IO_J1Z:
-              case IO_J1NZ: {
-                if (!blocked) {
-                  validateArgLocal(i, 0, phase, file);
-                  validateLocalJumpTarget(i, 0, localLabels, phase, file);
-
-                  validateArgRead(i, 1, temps, localLabels, phase, file);
-                } else {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - one-target jump encountered in basic block "
-                          "IR\n",
-                          file->inputFilename, phase);
-                  file->errored = true;
-                }
-                break;
-              }
-              case IO_CALL: {
-                validateArgJumpTarget(i, 0, temps, localLabels, phase, file);
-                break;
-              }
-              case IO_RETURN: {
-                if (blocked && currInst->next != block->instructions.tail) {
-                  fprintf(stderr,
-                          "%s: internal compiler error: IR validation after %s "
-                          "failed - non-terminal return encountered in %s IR\n",
-                          file->inputFilename, phase,
-                          blocked ? "basic block" : "scheduled");
-                  file->errored = true;
-                }
-                break;
+                file->errored = true;
               }
-              default: {
-                error(__FILE__, __LINE__, "invalid IROperator enum");
+              break;
+            }
+            case IO_CALL: {
+              validateArgJumpTarget(i, 0, temps, localLabels, phase, file);
+              break;
+            }
+            case IO_RETURN: {
+              if (blocked && currInst->next != block->instructions.tail) {
+                fprintf(stderr,
+                        "%s: internal compiler error: IR validation after %s "
+                        "failed - non-terminal return encountered in %s IR\n",
+                        file->inputFilename, phase,
+                        blocked ? "basic block" : "scheduled");
+                file->errored = true;
               }
+              break;
+            }
+            default: {
+              error(__FILE__, __LINE__, "invalid IROperator enum");
             }
           }
         }
-        free(temps);
-        free(localLabels);
       }
+      free(temps);
+      free(localLabels);
     }
+  }
+}
+static int validateIr(char const *phase, bool blocked) {
+  bool errored = false;
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *file = &fileList.entries[fileIdx];
+    validateIrFile(phase, blocked, file);
     errored = errored || file->errored;
   }
 
   if (errored) return -1;
 
-  return validateIRArchSpecific(phase, blocked);
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    if (validateIRArchSpecific(phase, blocked, &fileList.entries[fileIdx]) !=
+        0)
+      errored = true;
+  }
+
+  return errored ? -1 : 0;
 }
 
 int validateBlockedIr(char const *phase) { return validateIr(phase, true); }
 
-int validateScheduledIr(char const *phase) { return validateIr(phase, false); }
\ No newline at end of file
+int validateScheduledIr(char const *phase) { return validateIr(phase, false); }
+
+/**
+ * checks one file's IR, both arch-neutral and arch-specific parts
+ */
+static int validateIrOneFile(char const *phase, bool blocked, size_t fileIdx) {
+  FileListEntry *file = &fileList.entries[fileIdx];
+  validateIrFile(phase, blocked, file);
+  if (file->errored) return -1;
+  return validateIRArchSpecific(phase, blocked, file);
+}
+
+int validateBlockedIrFile(char const *phase, size_t fileIdx) {
+  return validateIrOneFile(phase, true, fileIdx);
+}
+
+int validateScheduledIrFile(char const *phase, size_t fileIdx) {
+  return validateIrOneFile(phase, false, fileIdx);
+}
\ No newline at end of file
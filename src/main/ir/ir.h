@@ -696,6 +696,16 @@ extern char const *const ALLOCHINT_NAMES[];
  */
 int validateBlockedIr(char const *phase);
 
+/**
+ * checks that one file in the file list has valid IR (while IR is in basic
+ * blocks) - see validateBlockedIr
+ *
+ * @param phase phase to name as the one at fault
+ * @param fileIdx index of the file in the file list
+ * @returns -1 on failure, 0 on success
+ */
+int validateBlockedIrFile(char const *phase, size_t fileIdx);
+
 /**
  * checks that all files in the file list have valid IR (while IR is a single
  * block)
@@ -712,4 +722,14 @@ int validateBlockedIr(char const *phase);
  */
 int validateScheduledIr(char const *phase);
 
+/**
+ * checks that one file in the file list has valid IR (while IR is a single
+ * block) - see validateScheduledIr
+ *
+ * @param phase phase to name as the one at fault
+ * @param fileIdx index of the file in the file list
+ * @returns -1 on failure, 0 on success
+ */
+int validateScheduledIrFile(char const *phase, size_t fileIdx);
+
 #endif  // TLC_IR_IR_H_
\ No newline at end of file
@@ -30,12 +30,14 @@ void lexDump(FileListEntry *entry) {
   Token t;
   do {
     lex(entry, &t);
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, t.offset, &line, &character);
     if (t.type >= TT_ID && t.type <= TT_LIT_FLOAT)
-      fprintf(stderr, "%zu:%zu: %s (%s)\n", t.line, t.character,
+      fprintf(stderr, "%zu:%zu: %s (%s)\n", line, character,
               TOKEN_NAMES[t.type], t.string);
     else
-      fprintf(stderr, "%zu:%zu: %s\n", t.line, t.character,
-              TOKEN_NAMES[t.type]);
+      fprintf(stderr, "%zu:%zu: %s\n", line, character, TOKEN_NAMES[t.type]);
   } while (t.type != TT_EOF);
 
   lexerStateUninit(entry);
@@ -30,10 +30,13 @@
 #include <unistd.h>
 
 #include "fileList.h"
+#include "lexer/scan.h"
+#include "util/container/optimization.h"
 #include "util/container/stringBuilder.h"
 #include "util/conversions.h"
+#include "util/diagnostics.h"
 #include "util/format.h"
-#include "util/functional.h"
+#include "util/intern.h"
 #include "util/internalError.h"
 #include "util/string.h"
 #include "version.h"
@@ -153,7 +156,7 @@ char const *const TOKEN_NAMES[] = {
 /**
  * initializes a token
  *
- * @param state LexerState to draw line and character from
+ * @param state LexerState to draw the token's starting offset from
  * @param token token to initialize
  * @param type type of token
  * @param string additional data, may be null, depends on type
@@ -161,8 +164,7 @@ char const *const TOKEN_NAMES[] = {
 static void tokenInit(LexerState *state, Token *token, TokenType type,
                       char *string) {
   token->type = type;
-  token->line = state->line;
-  token->character = state->character;
+  token->offset = (uint32_t)(state->tokenStart - state->map);
   token->string = string;
 
   // consistency check
@@ -173,89 +175,170 @@ static void tokenInit(LexerState *state, Token *token, TokenType type,
           "stringed token type");
 }
 
-void tokenUninit(Token *token) { free(token->string); }
-
-/** keyword map */
-HashMap keywordMap;
-char const *const KEYWORD_STRINGS[] = {
-    "module",  "import", "opaque",   "struct",   "union", "enum",   "typedef",
-    "if",      "else",   "while",    "do",       "for",   "switch", "case",
-    "default", "break",  "continue", "return",   "cast",  "sizeof", "true",
-    "false",   "null",   "void",     "ubyte",    "byte",  "char",   "ushort",
-    "short",   "uint",   "int",      "wchar",    "ulong", "long",   "float",
-    "double",  "bool",   "const",    "volatile",
-};
-TokenType const KEYWORD_TOKENS[] = {
-    TT_MODULE,  TT_IMPORT, TT_OPAQUE,   TT_STRUCT, TT_UNION,    TT_ENUM,
-    TT_TYPEDEF, TT_IF,     TT_ELSE,     TT_WHILE,  TT_DO,       TT_FOR,
-    TT_SWITCH,  TT_CASE,   TT_DEFAULT,  TT_BREAK,  TT_CONTINUE, TT_RETURN,
-    TT_CAST,    TT_SIZEOF, TT_TRUE,     TT_FALSE,  TT_NULL,     TT_VOID,
-    TT_UBYTE,   TT_BYTE,   TT_CHAR,     TT_USHORT, TT_SHORT,    TT_UINT,
-    TT_INT,     TT_WCHAR,  TT_ULONG,    TT_LONG,   TT_FLOAT,    TT_DOUBLE,
-    TT_BOOL,    TT_CONST,  TT_VOLATILE,
-};
+void tokenUninit(Token *token) {
+  // payloads are interned, and never freed
+  (void)token;
+}
 
-/** magic token map */
-HashMap magicMap;
-char const *const MAGIC_STRINGS[] = {
-    "__FILE__",
-    "__LINE__",
-    "__VERSION__",
-};
+TokenVector *tokenVectorCreate(void) {
+  TokenVector *v = malloc(sizeof(TokenVector));
+  v->size = 0;
+  v->capacity = PTR_VECTOR_INIT_CAPACITY;
+  v->elements = malloc(v->capacity * sizeof(Token));
+  return v;
+}
+void tokenVectorInsert(TokenVector *v, Token const *token) {
+  if (v->size == v->capacity) {
+    v->capacity *= VECTOR_GROWTH_FACTOR;
+    v->elements = realloc(v->elements, v->capacity * sizeof(Token));
+  }
+  v->elements[v->size++] = *token;
+}
+void tokenVectorFree(TokenVector *v) {
+  if (v == NULL) return;
+  free(v->elements);
+  free(v);
+}
+
+/** interns a heap-allocated payload, freeing the original */
+static char *internOwned(char *string) {
+  char *interned = intern(string, strlen(string));
+  free(string);
+  return interned;
+}
+
+/** kinds of magic token */
 typedef enum {
+  MTT_NONE, /**< not a magic token */
   MTT_FILE,
   MTT_LINE,
   MTT_VERSION,
 } MagicTokenType;
-MagicTokenType const MAGIC_TOKENS[] = {
-    MTT_FILE,
-    MTT_LINE,
-    MTT_VERSION,
-};
 
-void lexerInitMaps(void) {
-  hashMapInit(&keywordMap);
-  for (size_t idx = 0; idx < sizeof(KEYWORD_STRINGS) / sizeof(char const *);
-       ++idx) {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-qual"
-    hashMapSet(&keywordMap, KEYWORD_STRINGS[idx], (void *)&KEYWORD_TOKENS[idx]);
-#pragma GCC diagnostic pop
-  }
-  hashMapInit(&magicMap);
-  for (size_t idx = 0; idx < sizeof(MAGIC_STRINGS) / sizeof(char const *);
-       ++idx) {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-qual"
-    hashMapSet(&magicMap, MAGIC_STRINGS[idx], (void *)&MAGIC_TOKENS[idx]);
-#pragma GCC diagnostic pop
-  }
+/** a keyword or magic token */
+typedef struct {
+  char const *text; /**< spelling - NULL if the slot is empty */
+  size_t length;
+  TokenType type;       /**< token type, TT_ID for magic tokens */
+  MagicTokenType magic; /**< magic token type, MTT_NONE for keywords */
+} ReservedWord;
+
+/** length of the longest reserved word */
+#define MAX_RESERVED_LENGTH 11
+/** multiplier for reservedHash */
+#define RESERVED_MULTIPLIER 0x9704870bU
+
+/**
+ * hashes a possibly reserved word
+ *
+ * The length and the first, middle, and last characters are packed into a
+ * 32-bit key and reduced to 7 bits by multiplicative hashing. The multiplier
+ * was found by search so that no two reserved words share a slot - if a
+ * reserved word is added, a new multiplier must be found and the table below
+ * rebuilt with misc/reserved-word-hash-generator.py.
+ *
+ * @param text text of the word
+ * @param length length of the word, at least one
+ * @returns slot of the word in RESERVED_WORDS
+ */
+static size_t reservedHash(char const *text, size_t length) {
+  uint32_t key = (uint32_t)length | (uint32_t)(unsigned char)text[0] << 8 |
+                 (uint32_t)(unsigned char)text[length / 2] << 16 |
+                 (uint32_t)(unsigned char)text[length - 1] << 24;
+  return (key * RESERVED_MULTIPLIER) >> 25;
 }
 
-void lexerUninitMaps(void) {
-  hashMapUninit(&keywordMap, nullDtor);
-  hashMapUninit(&magicMap, nullDtor);
+/**
+ * perfect hash table of reserved words, indexed by reservedHash - generated by
+ * misc/reserved-word-hash-generator.py
+ */
+static ReservedWord const RESERVED_WORDS[128] = {
+    [0] = {"return", 6, TT_RETURN, MTT_NONE},
+    [3] = {"for", 3, TT_FOR, MTT_NONE},
+    [4] = {"__VERSION__", 11, TT_ID, MTT_VERSION},
+    [6] = {"default", 7, TT_DEFAULT, MTT_NONE},
+    [8] = {"false", 5, TT_FALSE, MTT_NONE},
+    [14] = {"case", 4, TT_CASE, MTT_NONE},
+    [16] = {"void", 4, TT_VOID, MTT_NONE},
+    [17] = {"union", 5, TT_UNION, MTT_NONE},
+    [18] = {"ushort", 6, TT_USHORT, MTT_NONE},
+    [19] = {"else", 4, TT_ELSE, MTT_NONE},
+    [22] = {"char", 4, TT_CHAR, MTT_NONE},
+    [24] = {"ubyte", 5, TT_UBYTE, MTT_NONE},
+    [25] = {"continue", 8, TT_CONTINUE, MTT_NONE},
+    [28] = {"if", 2, TT_IF, MTT_NONE},
+    [29] = {"switch", 6, TT_SWITCH, MTT_NONE},
+    [30] = {"sizeof", 6, TT_SIZEOF, MTT_NONE},
+    [34] = {"do", 2, TT_DO, MTT_NONE},
+    [35] = {"struct", 6, TT_STRUCT, MTT_NONE},
+    [36] = {"bool", 4, TT_BOOL, MTT_NONE},
+    [37] = {"float", 5, TT_FLOAT, MTT_NONE},
+    [43] = {"volatile", 8, TT_VOLATILE, MTT_NONE},
+    [44] = {"double", 6, TT_DOUBLE, MTT_NONE},
+    [56] = {"uint", 4, TT_UINT, MTT_NONE},
+    [57] = {"opaque", 6, TT_OPAQUE, MTT_NONE},
+    [60] = {"true", 4, TT_TRUE, MTT_NONE},
+    [66] = {"short", 5, TT_SHORT, MTT_NONE},
+    [67] = {"module", 6, TT_MODULE, MTT_NONE},
+    [70] = {"enum", 4, TT_ENUM, MTT_NONE},
+    [71] = {"break", 5, TT_BREAK, MTT_NONE},
+    [73] = {"__FILE__", 8, TT_ID, MTT_FILE},
+    [79] = {"byte", 4, TT_BYTE, MTT_NONE},
+    [80] = {"__LINE__", 8, TT_ID, MTT_LINE},
+    [81] = {"int", 3, TT_INT, MTT_NONE},
+    [91] = {"const", 5, TT_CONST, MTT_NONE},
+    [92] = {"long", 4, TT_LONG, MTT_NONE},
+    [97] = {"cast", 4, TT_CAST, MTT_NONE},
+    [100] = {"while", 5, TT_WHILE, MTT_NONE},
+    [104] = {"wchar", 5, TT_WCHAR, MTT_NONE},
+    [107] = {"typedef", 7, TT_TYPEDEF, MTT_NONE},
+    [117] = {"null", 4, TT_NULL, MTT_NONE},
+    [119] = {"import", 6, TT_IMPORT, MTT_NONE},
+    [127] = {"ulong", 5, TT_ULONG, MTT_NONE},
+};
+
+/**
+ * classifies a word as reserved or not without copying it
+ *
+ * @param text text of the word
+ * @param length length of the word, at least one
+ * @returns the reserved word, or NULL if the word isn't reserved
+ */
+static ReservedWord const *findReserved(char const *text, size_t length) {
+  if (length > MAX_RESERVED_LENGTH) return NULL;
+  ReservedWord const *word = &RESERVED_WORDS[reservedHash(text, length)];
+  if (word->text == NULL || word->length != length ||
+      memcmp(word->text, text, length) != 0)
+    return NULL;
+  return word;
 }
 
 int lexerStateInit(FileListEntry *entry) {
   LexerState *state = &entry->lexerState;
-  state->character = 1;
-  state->line = 1;
   state->pushedBack = false;
+  state->bodyTokens = NULL;
 
   // try to map the file
   int fd = open(entry->inputFilename, O_RDONLY);
   if (fd == -1) {
-    fprintf(stderr, "%s: error: cannot open file\n", entry->inputFilename);
+    fprintf(diagnosticStream(), "%s: error: cannot open file\n",
+            entry->inputFilename);
     return -1;
   }
   struct stat statbuf;
   if (fstat(fd, &statbuf) != 0) {
-    fprintf(stderr, "%s: error: cannot stat file\n", entry->inputFilename);
+    fprintf(diagnosticStream(), "%s: error: cannot stat file\n",
+            entry->inputFilename);
     close(fd);
     return -1;
   }
   state->length = (size_t)statbuf.st_size;
+  if (state->length > UINT32_MAX) {
+    fprintf(diagnosticStream(), "%s: error: file too large\n",
+            entry->inputFilename);
+    close(fd);
+    return -1;
+  }
   if (state->length == 0) {
     state->current = state->map = NULL;
   } else {
@@ -263,14 +346,31 @@ int lexerStateInit(FileListEntry *entry) {
         mmap(NULL, state->length, PROT_READ, MAP_PRIVATE, fd, 0);
     close(fd);
     if (state->map == (void *)-1) {
-      fprintf(stderr, "%s: error: cannot mmap file\n", entry->inputFilename);
+      fprintf(diagnosticStream(), "%s: error: cannot mmap file\n",
+              entry->inputFilename);
       return -1;
     }
   }
 
+  // positions are resolved against the version of the file being lexed
+  fileListEntryIndexLines(entry, state->map, state->length);
+
   return 0;
 }
 
+/**
+ * reports an error at some position in the file being lexed
+ */
+static void reportError(FileListEntry *entry, char const *position,
+                        char const *message) {
+  uint32_t offset = (uint32_t)(position - entry->lexerState.map);
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(), "%s:%zu:%zu: error: %s\n", entry->inputFilename,
+          line, character, message);
+}
+
 /**
  * gets a character from the lexer, returns '\x04' if end of file
  */
@@ -293,141 +393,57 @@ static void put(LexerState *state, size_t n) {
 }
 /**
  * consumes whitespace while updating the entry
+ *
+ * runs of whitespace and comment bodies are skipped using the vectorized
+ * scanners, so only the characters that might end a comment are examined one
+ * at a time
+ *
  * @param entry entry to munch from
  */
 static void lexWhitespace(FileListEntry *entry) {
   LexerState *state = &entry->lexerState;
-  bool whitespace = true;
-  while (whitespace) {
-    char c = get(state);
-    switch (c) {
-      case ' ':
-      case '\t': {
-        state->character += 1;
-        break;
-      }
-      case '\n': {
-        state->character = 1;
-        ++state->line;
-        break;
-      }
-      case '\r': {
-        state->character = 1;
-        ++state->line;
-        // handle cr-lf
-        char lf = get(state);
-        if (lf != '\n') put(state, 1);
+  char const *end = state->map + state->length;
+  while (true) {
+    state->current = scanWhitespace(state->current, end);
+    if (get(state) != '/') {
+      // not whitespace anymore
+      put(state, 1);
+      return;
+    }
+
+    char next = get(state);
+    switch (next) {
+      case '/': {
+        // line comment - the line break is consumed as whitespace
+        state->current = scanLineComment(state->current, end);
         break;
       }
-      case '/': {
-        char next = get(state);
-        switch (next) {
-          case '/': {
-            // line comment
-            state->character += 2;
-
-            bool inComment = true;
-            while (inComment) {
-              char commentChar = get(state);
-              switch (commentChar) {
-                case '\x04': {
-                  // eof
-                  inComment = false;
-                  put(state, 1);
-                  break;
-                }
-                case '\n': {
-                  inComment = false;
-                  state->character = 1;
-                  state->line += 1;
-                  break;
-                }
-                case '\r': {
-                  inComment = false;
-                  state->character = 1;
-                  state->line += 1;
-                  // handle cr-lf
-                  char lf = get(state);
-                  if (lf != '\n') put(state, 1);
-                  break;
-                }
-                default: {
-                  // much that
-                  state->character += 1;
-                  break;
-                }
-              }
-            }
-            break;
-          }
-          case '*': {
-            state->character += 2;
-
-            bool inComment = true;
-            while (inComment) {
-              char commentChar = get(state);
-              switch (commentChar) {
-                case '\x04': {
-                  fprintf(stderr,
-                          "%s:%zu:%zu: error: unterminated block comment\n",
-                          entry->inputFilename, state->line, state->character);
-                  put(state, 1);
-                  entry->errored = true;
-                  return;
-                }
-                case '\n': {
-                  state->character = 1;
-                  state->line += 1;
-                  break;
-                }
-                case '\r': {
-                  state->character = 1;
-                  state->line += 1;
-                  // handle cr-lf
-                  char lf = get(state);
-                  if (lf != '\n') put(state, 1);
-                  break;
-                }
-                case '*': {
-                  // maybe the end?
-                  char slash = get(state);
-                  switch (slash) {
-                    case '/': {
-                      state->character += 2;
-                      inComment = false;
-                      break;
-                    }
-                    default: {
-                      // not the end
-                      put(state, 1);
-                      state->character += 1;
-                      break;
-                    }
-                  }
-                  break;
-                }
-                default: {
-                  state->character += 1;
-                  break;
-                }
-              }
-            }
-            break;
-          }
-          default: {
-            // not a comment, return initial slash and second char
-            put(state, 2);
-            whitespace = false;
-            break;
+      case '*': {
+        bool inComment = true;
+        while (inComment) {
+          state->current = scanBlockComment(state->current, end);
+          char commentChar = get(state);
+          if (commentChar == '\x04') {
+            reportError(entry, state->current - 1,
+                        "unterminated block comment");
+            put(state, 1);
+            entry->errored = true;
+            return;
           }
+
+          // star - maybe the end?
+          char slash = get(state);
+          if (slash == '/')
+            inComment = false;
+          else
+            put(state, 1);
         }
         break;
       }
       default: {
-        // not whitespace anymore
-        put(state, 1);
-        whitespace = false;
-        break;
+        // not a comment, return initial slash and second char
+        put(state, 2);
+        return;
       }
     }
   }
@@ -437,10 +453,7 @@ static void lexWhitespace(FileListEntry *entry) {
 static void clip(LexerState *state, Token *token, char const *start,
                  TokenType type) {
   size_t length = (size_t)(state->current - start);
-  char *clip = strncpy(malloc(length + 1), start, length);
-  clip[length] = '\0';
-  tokenInit(state, token, type, clip);
-  state->character += length;
+  tokenInit(state, token, type, intern(start, length));
 }
 
 /** lexes a hexadecimal number, prefix already lexed */
@@ -451,11 +464,10 @@ static void lexHex(FileListEntry *entry, Token *token, char const *start) {
   if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
         (c >= 'A' && c <= 'F'))) {
     // error!
-    fprintf(stderr, "%s:%zu:%zu: error: invalid hexadecimal integer literal\n",
-            entry->inputFilename, state->line, state->character);
+    reportError(entry, state->tokenStart,
+                "invalid hexadecimal integer literal");
     put(state, 1);
     tokenInit(state, token, TT_BAD_HEX, NULL);
-    state->character += 2;
     entry->errored = true;
     return;
   }
@@ -523,11 +535,9 @@ static void lexBinary(FileListEntry *entry, Token *token, char const *start) {
   char c = get(state);
   if (!(c >= '0' && c <= '1')) {
     // error!
-    fprintf(stderr, "%s:%zu:%zu: error: invalid binary integer literal\n",
-            entry->inputFilename, state->line, state->character);
+    reportError(entry, state->tokenStart, "invalid binary integer literal");
     put(state, 1);
     tokenInit(state, token, TT_BAD_BIN, NULL);
-    state->character += 2;
     entry->errored = true;
     return;
   }
@@ -614,59 +624,43 @@ static void lexNumber(FileListEntry *entry, Token *token) {
 static void lexId(FileListEntry *entry, Token *token) {
   LexerState *state = &entry->lexerState;
   char const *start = state->current;
+  state->current = scanId(start, state->map + state->length);
+  size_t length = (size_t)(state->current - start);
 
-  while (true) {
-    char c = get(state);
-    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
-          (c >= 'A' && c <= 'Z') || c == '_')) {
-      // end of identifier
-      put(state, 1);
-      size_t length = (size_t)(state->current - start);
-      char *clip = strncpy(malloc(length + 1), start, length);
-      clip[length] = '\0';
-
-      // classify the clip
-      TokenType const *keywordToken = hashMapGet(&keywordMap, clip);
-      if (keywordToken != NULL) {
+  // classify the word
+  ReservedWord const *reserved = findReserved(start, length);
+  if (reserved != NULL) {
+    switch (reserved->magic) {
+      case MTT_NONE: {
         // this is a keyword
-        tokenInit(state, token, *keywordToken, NULL);
-        state->character += length;
-        free(clip);
-        return;
+        tokenInit(state, token, reserved->type, NULL);
+        break;
       }
-      MagicTokenType const *magicToken = hashMapGet(&magicMap, clip);
-      if (magicToken != NULL) {
-        // this is a magic token
-        switch (*magicToken) {
-          case MTT_FILE: {
-            tokenInit(state, token, TT_LIT_STRING,
-                      escapeString(entry->inputFilename));
-            state->character += length;
-            free(clip);
-            return;
-          }
-          case MTT_LINE: {
-            tokenInit(state, token, TT_LIT_INT_D, format("%zu", state->line));
-            state->character += length;
-            free(clip);
-            return;
-          }
-          case MTT_VERSION: {
-            tokenInit(state, token, TT_LIT_STRING,
-                      escapeString(VERSION_STRING));
-            state->character += length;
-            free(clip);
-            return;
-          }
-        }
+      case MTT_FILE: {
+        tokenInit(state, token, TT_LIT_STRING,
+                  internOwned(escapeString(entry->inputFilename)));
+        break;
+      }
+      case MTT_LINE: {
+        size_t line;
+        size_t character;
+        fileListEntryPosition(entry, (uint32_t)(start - state->map), &line,
+                              &character);
+        tokenInit(state, token, TT_LIT_INT_D,
+                  internOwned(format("%zu", line)));
+        break;
+      }
+      case MTT_VERSION: {
+        tokenInit(state, token, TT_LIT_STRING,
+                  internOwned(escapeString(VERSION_STRING)));
+        break;
       }
-
-      // this is a regular id
-      tokenInit(state, token, TT_ID, clip);
-      state->character += length;
-      return;
     }
+    return;
   }
+
+  // this is a regular id
+  tokenInit(state, token, TT_ID, intern(start, length));
 }
 
 /**
@@ -677,7 +671,6 @@ static void panicString(LexerState *state) {
     char c = get(state);
     switch (c) {
       case '\\': {
-        state->character += 1;
         char next = get(state);
         switch (next) {
           case 'x': {
@@ -687,8 +680,6 @@ static void panicString(LexerState *state) {
               if (!isNybble(hex)) {
                 put(state, 1);
                 break;
-              } else {
-                state->character += 1;
               }
             }
             break;
@@ -700,29 +691,23 @@ static void panicString(LexerState *state) {
               if (!isNybble(hex)) {
                 put(state, 1);
                 break;
-              } else {
-                state->character += 1;
               }
             }
             break;
           }
           default: {
-            state->character += 1;
             break;
           }
         }
         break;
       }
       case '"': {
-        state->character += 1;
         return;
       }
       default: {
         if (!((c >= ' ' && c <= '~' && c != '"' && c != '\\') || c == '\t')) {
           put(state, 1);
           return;
-        } else {
-          state->character += 1;
         }
       }
     }
@@ -738,13 +723,13 @@ static void lexString(FileListEntry *entry, Token *token) {
 
   TokenType type = TT_LIT_STRING;
   while (true) {
+    state->current = scanString(state->current, state->map + state->length);
     char c = get(state);
     switch (c) {
       case '"': {
         // end of string
         size_t length = (size_t)(state->current - start - 1);
-        char *clip = strncpy(malloc(length + 1), start, length);
-        clip[length] = '\0';
+        char *clip = intern(start, length);
 
         if (type == TT_LIT_STRING) {
           // check for w-string-ness
@@ -758,19 +743,16 @@ static void lexString(FileListEntry *entry, Token *token) {
           // check for ending w
           char next = get(state);
           if (next != 'w') {
-            fprintf(stderr,
-                    "%s:%zu:%zu: error: wide characters in narrow string\n",
-                    entry->inputFilename, state->line, state->character);
+            reportError(entry, state->tokenStart,
+                        "wide characters in narrow string");
             put(state, 1);
             tokenInit(state, token, TT_LIT_WSTRING, clip);
-            state->character += length + 2;
             entry->errored = true;
             return;
           }
         }
 
         tokenInit(state, token, type, clip);
-        state->character += length + (type == TT_LIT_STRING ? 2 : 3);
         return;
       }
       case '\\': {
@@ -782,14 +764,10 @@ static void lexString(FileListEntry *entry, Token *token) {
             for (size_t idx = 0; idx < 2; ++idx) {
               char hex = get(state);
               if (!isNybble(hex)) {
-                fprintf(
-                    stderr,
-                    "%s:%zu:%zu: error: invalid hexadecimal escape sequence\n",
-                    entry->inputFilename, state->line,
-                    state->character + (size_t)(state->current - start));
+                reportError(entry, state->current - 1,
+                            "invalid hexadecimal escape sequence");
                 put(state, 1);
                 tokenInit(state, token, TT_BAD_STRING, NULL);
-                state->character += (size_t)(state->current - start + 1);
                 panicString(state);
                 entry->errored = true;
                 return;
@@ -802,14 +780,10 @@ static void lexString(FileListEntry *entry, Token *token) {
             for (size_t idx = 0; idx < 8; ++idx) {
               char hex = get(state);
               if (!isNybble(hex)) {
-                fprintf(
-                    stderr,
-                    "%s:%zu:%zu: error: invalid hexadecimal escape sequence\n",
-                    entry->inputFilename, state->line,
-                    state->character + (size_t)(state->current - start));
+                reportError(entry, state->current - 1,
+                            "invalid hexadecimal escape sequence");
                 put(state, 1);
                 tokenInit(state, token, TT_BAD_STRING, NULL);
-                state->character += (size_t)(state->current - start + 1);
                 panicString(state);
                 entry->errored = true;
                 return;
@@ -821,12 +795,9 @@ static void lexString(FileListEntry *entry, Token *token) {
           default: {
             if (next != 'n' && next != 'r' && next != 't' && next != '0' &&
                 next != '\\' && next != '"') {
-              fprintf(stderr,
-                      "%s:%zu:%zu: error: unrecognized escape sequence\n",
-                      entry->inputFilename, state->line,
-                      state->character + (size_t)(state->current - start));
+              reportError(entry, state->current - 1,
+                          "unrecognized escape sequence");
               tokenInit(state, token, TT_BAD_STRING, NULL);
-              state->character += (size_t)(state->current - start + 1);
               panicString(state);
               entry->errored = true;
               return;
@@ -838,30 +809,22 @@ static void lexString(FileListEntry *entry, Token *token) {
       case '\x04':
       case '\n':
       case '\r': {
-        fprintf(stderr, "%s:%zu:%zu: error: unterminated string literal\n",
-                entry->inputFilename, state->line,
-                state->character + (size_t)(state->current - start));
+        reportError(entry, state->current - 1, "unterminated string literal");
         put(state, 1);
 
         size_t length = (size_t)(state->current - start);
-        char *clip = strncpy(malloc(length + 1), start, length);
-        clip[length] = '\0';
+        char *clip = intern(start, length);
 
         tokenInit(state, token, type, clip);
-        state->character += length + 1;
         entry->errored = true;
         return;
       }
       default: {
         if (!((c >= ' ' && c <= '~' && c != '"' && c != '\\') || c == '\t')) {
-          fprintf(stderr,
-                  "%s:%zu:%zu: error: unsupported character encountered in "
-                  "string literal\n",
-                  entry->inputFilename, state->line,
-                  state->character + (size_t)(state->current - start) + 1);
+          reportError(entry, state->current,
+                      "unsupported character encountered in string literal");
           put(state, 1);
           tokenInit(state, token, TT_BAD_STRING, NULL);
-          state->character += (size_t)(state->current - start);
           entry->errored = true;
           return;
         }
@@ -879,7 +842,6 @@ static void panicChar(LexerState *state) {
     char c = get(state);
     switch (c) {
       case '\\': {
-        state->character += 1;
         char next = get(state);
         switch (next) {
           case 'x': {
@@ -889,8 +851,6 @@ static void panicChar(LexerState *state) {
               if (!isNybble(hex)) {
                 put(state, 1);
                 break;
-              } else {
-                state->character += 1;
               }
             }
             break;
@@ -902,29 +862,23 @@ static void panicChar(LexerState *state) {
               if (!isNybble(hex)) {
                 put(state, 1);
                 break;
-              } else {
-                state->character += 1;
               }
             }
             break;
           }
           default: {
-            state->character += 1;
             break;
           }
         }
         break;
       }
       case '\'': {
-        state->character += 1;
         return;
       }
       default: {
         if (!((c >= ' ' && c <= '~' && c != '\'' && c != '\\') || c == '\t')) {
           put(state, 1);
           return;
-        } else {
-          state->character += 1;
         }
       }
     }
@@ -943,15 +897,10 @@ static void lexChar(FileListEntry *entry, Token *token) {
   switch (c) {
     case '\'': {
       // empty literal
-      fprintf(stderr, "%s:%zu:%zu: error: empty character literal\n",
-              entry->inputFilename, state->line, state->character);
+      reportError(entry, state->tokenStart, "empty character literal");
       tokenInit(state, token, TT_BAD_CHAR, NULL);
-      state->character += 2;
       char next = get(state);
-      if (next != 'w')
-        put(state, 1);
-      else
-        state->character += 1;
+      if (next != 'w') put(state, 1);
       entry->errored = true;
       return;
     }
@@ -964,15 +913,10 @@ static void lexChar(FileListEntry *entry, Token *token) {
           for (size_t idx = 0; idx < 2; ++idx) {
             char hex = get(state);
             if (!isNybble(hex)) {
-              fprintf(
-                  stderr,
-                  "%s:%zu:%zu: error: invalid hexadecimal escape sequence\n",
-                  entry->inputFilename, state->line,
-                  state->character +
-                      ((size_t)(state->current - start) + 1 - idx));
+              reportError(entry, state->current - idx,
+                          "invalid hexadecimal escape sequence");
               put(state, 1);
               tokenInit(state, token, TT_BAD_CHAR, NULL);
-              state->character += (size_t)(state->current - start + 1);
               panicChar(state);
               entry->errored = true;
               return;
@@ -985,15 +929,10 @@ static void lexChar(FileListEntry *entry, Token *token) {
           for (size_t idx = 0; idx < 8; ++idx) {
             char hex = get(state);
             if (!isNybble(hex)) {
-              fprintf(
-                  stderr,
-                  "%s:%zu:%zu: error: invalid hexadecimal escape sequence\n",
-                  entry->inputFilename, state->line,
-                  state->character +
-                      ((size_t)(state->current - start) + 1 - idx));
+              reportError(entry, state->current - idx,
+                          "invalid hexadecimal escape sequence");
               put(state, 1);
               tokenInit(state, token, TT_BAD_CHAR, NULL);
-              state->character += (size_t)(state->current - start + 1);
               panicChar(state);
               entry->errored = true;
               return;
@@ -1005,11 +944,9 @@ static void lexChar(FileListEntry *entry, Token *token) {
         default: {
           if (next != 'n' && next != 'r' && next != 't' && next != '0' &&
               next != '\\' && next != '\'') {
-            fprintf(stderr, "%s:%zu:%zu: error: unrecognized escape sequence\n",
-                    entry->inputFilename, state->line,
-                    state->character + (size_t)(state->current - start));
+            reportError(entry, state->current - 1,
+                        "unrecognized escape sequence");
             tokenInit(state, token, TT_BAD_CHAR, NULL);
-            state->character += (size_t)(state->current - start + 1);
             panicChar(state);
             entry->errored = true;
             return;
@@ -1021,25 +958,18 @@ static void lexChar(FileListEntry *entry, Token *token) {
     case '\x04':
     case '\r':
     case '\n': {
-      fprintf(stderr,
-              "%s:%zu:%zu: error: unterminated empty character literal\n",
-              entry->inputFilename, state->line,
-              state->character + (size_t)(state->current - start));
+      reportError(entry, state->current - 1,
+                  "unterminated empty character literal");
       put(state, 1);
       tokenInit(state, token, TT_BAD_CHAR, NULL);
-      state->character += (size_t)(state->current - start + 1);
       entry->errored = true;
       return;
     }
     default: {
       if (!((c >= ' ' && c <= '~' && c != '"' && c != '\\') || c == '\t')) {
-        fprintf(stderr,
-                "%s:%zu:%zu: error: unsupported character encountered in "
-                "character literal\n",
-                entry->inputFilename, state->line,
-                state->character + (size_t)(state->current - start) + 1);
+        reportError(entry, state->current,
+                    "unsupported character encountered in character literal");
         tokenInit(state, token, TT_BAD_CHAR, NULL);
-        state->character += (size_t)(state->current - start + 1);
         panicChar(state);
         entry->errored = true;
         return;
@@ -1048,33 +978,25 @@ static void lexChar(FileListEntry *entry, Token *token) {
   }
 
   size_t length = (size_t)(state->current - start);
-  char *clip = strncpy(malloc(length + 1), start, length);
-  clip[length] = '\0';
+  char *clip = intern(start, length);
 
   c = get(state);
   switch (c) {
     case '\x04':
     case '\r':
     case '\n': {
-      fprintf(stderr, "%s:%zu:%zu: error: unterminated character literal\n",
-              entry->inputFilename, state->line,
-              state->character + (size_t)(state->current - start));
+      reportError(entry, state->current - 1, "unterminated character literal");
       put(state, 1);
       tokenInit(state, token, type, clip);
-      state->character += length + 1;
       entry->errored = true;
       return;
     }
     default: {
       if (c != '\'') {
-        fprintf(
-            stderr,
-            "%s:%zu:%zu: error: multiple characters in a character literal\n",
-            entry->inputFilename, state->line,
-            (size_t)(state->current - start) + 1);
+        reportError(entry, state->current - 1,
+                    "multiple characters in a character literal");
         put(state, 1);
         tokenInit(state, token, type, clip);
-        state->character += length + 1;
         panicChar(state);
         entry->errored = true;
         return;
@@ -1095,20 +1017,16 @@ static void lexChar(FileListEntry *entry, Token *token) {
     // check for ending w
     char next = get(state);
     if (next != 'w') {
-      fprintf(
-          stderr,
-          "%s:%zu:%zu: error: wide characters in narrow character literal\n",
-          entry->inputFilename, state->line, state->character);
+      reportError(entry, state->tokenStart,
+                  "wide characters in narrow character literal");
       put(state, 1);
       tokenInit(state, token, TT_LIT_WCHAR, clip);
-      state->character += length + 2;
       entry->errored = true;
       return;
     }
   }
 
   tokenInit(state, token, type, clip);
-  state->character += length + (type == TT_LIT_CHAR ? 2 : 3);
 }
 
 void lex(FileListEntry *entry, Token *token) {
@@ -1123,6 +1041,7 @@ void lex(FileListEntry *entry, Token *token) {
 
   // munch whitespace
   lexWhitespace(entry);
+  state->tokenStart = state->current;
 
   // return a token
   char c = get(state);
@@ -1136,47 +1055,38 @@ void lex(FileListEntry *entry, Token *token) {
     // punctuation
     case ';': {
       tokenInit(state, token, TT_SEMI, NULL);
-      state->character += 1;
       return;
     }
     case ',': {
       tokenInit(state, token, TT_COMMA, NULL);
-      state->character += 1;
       return;
     }
     case '(': {
       tokenInit(state, token, TT_LPAREN, NULL);
-      state->character += 1;
       return;
     }
     case ')': {
       tokenInit(state, token, TT_RPAREN, NULL);
-      state->character += 1;
       return;
     }
     case '[': {
       tokenInit(state, token, TT_LSQUARE, NULL);
-      state->character += 1;
       return;
     }
     case ']': {
       tokenInit(state, token, TT_RSQUARE, NULL);
-      state->character += 1;
       return;
     }
     case '{': {
       tokenInit(state, token, TT_LBRACE, NULL);
-      state->character += 1;
       return;
     }
     case '}': {
       tokenInit(state, token, TT_RBRACE, NULL);
-      state->character += 1;
       return;
     }
     case '.': {
       tokenInit(state, token, TT_DOT, NULL);
-      state->character += 1;
       return;
     }
     case '-': {
@@ -1185,19 +1095,16 @@ void lex(FileListEntry *entry, Token *token) {
         case '>': {
           // ->
           tokenInit(state, token, TT_ARROW, NULL);
-          state->character += 2;
           return;
         }
         case '-': {
           // --
           tokenInit(state, token, TT_DEC, NULL);
-          state->character += 2;
           return;
         }
         case '=': {
           // -=
           tokenInit(state, token, TT_SUBASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
@@ -1210,7 +1117,6 @@ void lex(FileListEntry *entry, Token *token) {
             // just -
             put(state, 1);
             tokenInit(state, token, TT_MINUS, NULL);
-            state->character += 1;
             return;
           }
         }
@@ -1222,13 +1128,11 @@ void lex(FileListEntry *entry, Token *token) {
         case '+': {
           // ++
           tokenInit(state, token, TT_INC, NULL);
-          state->character += 2;
           return;
         }
         case '=': {
           // +=
           tokenInit(state, token, TT_ADDASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
@@ -1241,7 +1145,6 @@ void lex(FileListEntry *entry, Token *token) {
             // just +
             put(state, 1);
             tokenInit(state, token, TT_PLUS, NULL);
-            state->character += 1;
             return;
           }
         }
@@ -1253,14 +1156,12 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // *=
           tokenInit(state, token, TT_MULASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just *
           put(state, 1);
           tokenInit(state, token, TT_STAR, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1275,14 +1176,12 @@ void lex(FileListEntry *entry, Token *token) {
             case '=': {
               // &&=
               tokenInit(state, token, TT_LANDASSIGN, NULL);
-              state->character += 3;
               return;
             }
             default: {
               // just &&
               put(state, 1);
               tokenInit(state, token, TT_LAND, NULL);
-              state->character += 2;
               return;
             }
           }
@@ -1290,14 +1189,12 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // &=
           tokenInit(state, token, TT_BITANDASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just &
           put(state, 1);
           tokenInit(state, token, TT_AMP, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1308,21 +1205,18 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // !=
           tokenInit(state, token, TT_NEQ, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just !
           put(state, 1);
           tokenInit(state, token, TT_BANG, NULL);
-          state->character += 1;
           return;
         }
       }
     }
     case '~': {
       tokenInit(state, token, TT_TILDE, NULL);
-      state->character += 1;
       return;
     }
     case '=': {
@@ -1331,32 +1225,27 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // ==
           tokenInit(state, token, TT_EQ, NULL);
-          state->character += 2;
           return;
         }
         case '-': {
           // =-
           tokenInit(state, token, TT_NEGASSIGN, NULL);
-          state->character += 2;
           return;
         }
         case '!': {
           // =!
           tokenInit(state, token, TT_LNOTASSIGN, NULL);
-          state->character += 2;
           return;
         }
         case '~': {
           // =~
           tokenInit(state, token, TT_BITNOTASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just =
           put(state, 1);
           tokenInit(state, token, TT_ASSIGN, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1368,14 +1257,12 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // /=
           tokenInit(state, token, TT_DIVASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just /
           put(state, 1);
           tokenInit(state, token, TT_SLASH, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1386,14 +1273,12 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // %=
           tokenInit(state, token, TT_MODASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just %
           put(state, 1);
           tokenInit(state, token, TT_PERCENT, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1407,28 +1292,24 @@ void lex(FileListEntry *entry, Token *token) {
           switch (next2) {
             case '=': {
               tokenInit(state, token, TT_LSHIFTASSIGN, NULL);
-              state->character += 3;
               return;
             }
             default: {
               // just <<
               put(state, 1);
               tokenInit(state, token, TT_LSHIFT, NULL);
-              state->character += 2;
               return;
             }
           }
         }
         case '=': {
           tokenInit(state, token, TT_LTEQ, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just <
           put(state, 1);
           tokenInit(state, token, TT_LANGLE, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1447,14 +1328,12 @@ void lex(FileListEntry *entry, Token *token) {
                 case '=': {
                   // >>>=
                   tokenInit(state, token, TT_LRSHIFTASSIGN, NULL);
-                  state->character += 4;
                   return;
                 }
                 default: {
                   // just >>>
                   put(state, 1);
                   tokenInit(state, token, TT_LRSHIFT, NULL);
-                  state->character += 3;
                   return;
                 }
               }
@@ -1462,14 +1341,12 @@ void lex(FileListEntry *entry, Token *token) {
             case '=': {
               // >>=
               tokenInit(state, token, TT_ARSHIFTASSIGN, NULL);
-              state->character += 3;
               return;
             }
             default: {
               // just >>
               put(state, 1);
               tokenInit(state, token, TT_ARSHIFT, NULL);
-              state->character += 2;
               return;
             }
           }
@@ -1477,14 +1354,12 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // >=
           tokenInit(state, token, TT_GTEQ, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just >
           put(state, 1);
           tokenInit(state, token, TT_RANGLE, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1499,14 +1374,12 @@ void lex(FileListEntry *entry, Token *token) {
             case '=': {
               // ||=
               tokenInit(state, token, TT_LORASSIGN, NULL);
-              state->character += 3;
               return;
             }
             default: {
               // just ||
               put(state, 1);
               tokenInit(state, token, TT_LOR, NULL);
-              state->character += 2;
               return;
             }
           }
@@ -1514,14 +1387,12 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // |=
           tokenInit(state, token, TT_BITORASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just |
           put(state, 1);
           tokenInit(state, token, TT_BAR, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1532,21 +1403,18 @@ void lex(FileListEntry *entry, Token *token) {
         case '=': {
           // ^=
           tokenInit(state, token, TT_BITXORASSIGN, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just ^
           put(state, 1);
           tokenInit(state, token, TT_CARET, NULL);
-          state->character += 1;
           return;
         }
       }
     }
     case '?': {
       tokenInit(state, token, TT_QUESTION, NULL);
-      state->character += 1;
       return;
     }
     case ':': {
@@ -1555,14 +1423,12 @@ void lex(FileListEntry *entry, Token *token) {
         case ':': {
           // ::
           tokenInit(state, token, TT_SCOPE, NULL);
-          state->character += 2;
           return;
         }
         default: {
           // just :
           put(state, 1);
           tokenInit(state, token, TT_COLON, NULL);
-          state->character += 1;
           return;
         }
       }
@@ -1591,11 +1457,10 @@ void lex(FileListEntry *entry, Token *token) {
       } else {
         // error
         char *prettyString = escapeChar(c);
-        fprintf(stderr, "%s:%zu:%zu: error: unexpected character: %s\n",
-                entry->inputFilename, state->line, state->character,
-                prettyString);
+        char *message = format("unexpected character: %s", prettyString);
+        reportError(entry, state->tokenStart, message);
+        free(message);
         free(prettyString);
-        state->character += 1;
         entry->errored = true;
         // skip character and try again
         lex(entry, token);
@@ -27,8 +27,8 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
-#include "util/container/hashMap.h"
 
 typedef struct FileListEntry FileListEntry;
 
@@ -160,12 +160,13 @@ extern char const *const TOKEN_NAMES[];
 /** a token */
 typedef struct {
   TokenType type;
-  size_t line;
-  size_t character;
+  uint32_t offset; /**< byte offset of the token's first character - see
+                      fileListEntryPosition */
   char *string; /**< optional, depends on Token#type. For ids, contains the
                    string of the id. For strings and chars, contains the data
                    between the quotes (quotes excluded), for numbers, contains
-                   the whole number (sign and prefix included) */
+                   the whole number (sign and prefix included). Always
+                   interned */
 } Token;
 
 /**
@@ -178,29 +179,45 @@ typedef struct {
  */
 void tokenUninit(Token *token);
 
+/** a vector of tokens, stored contiguously */
+typedef struct {
+  size_t size;
+  size_t capacity;
+  Token *elements;
+} TokenVector;
+
 /**
- * Initializes keyword and magic token maps - must be called before any lexing
- * is done
+ * allocating ctor
+ *
+ * @returns allocated and initialized empty TokenVector
  */
-void lexerInitMaps(void);
-
+TokenVector *tokenVectorCreate(void);
+/**
+ * insert - amortized constant time
+ *
+ * @param v TokenVector to add to
+ * @param token token to copy in
+ */
+void tokenVectorInsert(TokenVector *v, Token const *token);
 /**
- * Deinitializes keyword and magic token maps - may be called after all lexing
- * is done
+ * deallocating dtor
+ *
+ * @param v TokenVector to free, nullable
  */
-void lexerUninitMaps(void);
+void tokenVectorFree(TokenVector *v);
 
 /** internal state for a lexer for some file */
 typedef struct {
-  char *map;           /**< mmap of file */
-  size_t length;       /**< length of file */
-  char const *current; /**< character about to be read */
-
-  size_t line;
-  size_t character;
+  char *map;              /**< mmap of file */
+  size_t length;          /**< length of file */
+  char const *current;    /**< character about to be read */
+  char const *tokenStart; /**< first character of the token being lexed */
 
   Token previous;
   bool pushedBack;
+
+  TokenVector *bodyTokens; /**< where unparsed function bodies are saved -
+                              non-owning, set by the parser */
 } LexerState;
 
 /**
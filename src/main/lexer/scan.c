@@ -0,0 +1,258 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of the lexer's character class scanners
+//
+// Each scanner has three implementations: a scalar loop, an SSE2 loop that
+// tests 16 characters at a time, and an AVX2 loop that tests 32 characters at
+// a time. SSE2 is part of the x86_64 baseline, so it is always available
+// there; AVX2 is used if the CPU supports it. The vector loops only run while
+// a full vector's worth of characters remains, and hand the remainder to the
+// scalar loop, so no load ever crosses the end of the mapping.
+
+#include "lexer/scan.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SCAN_X86_64 1
+#else
+#define SCAN_X86_64 0
+#endif
+
+/** character classes the lexer scans over */
+typedef enum {
+  SC_WHITESPACE,
+  SC_LINE_COMMENT,
+  SC_BLOCK_COMMENT,
+  SC_ID,
+  SC_STRING,
+} ScanClass;
+
+/**
+ * is c the end of a run of the given class
+ */
+static bool stopsRun(ScanClass cls, char c) {
+  switch (cls) {
+    case SC_WHITESPACE: {
+      return c != ' ' && c != '\t' && c != '\n' && c != '\r';
+    }
+    case SC_LINE_COMMENT: {
+      return c == '\n' || c == '\r' || c == '\x04';
+    }
+    case SC_BLOCK_COMMENT: {
+      return c == '*' || c == '\x04';
+    }
+    case SC_ID: {
+      return !((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+               (c >= 'A' && c <= 'Z') || c == '_');
+    }
+    default: {
+      return !((c >= ' ' && c <= '~' && c != '"' && c != '\\') || c == '\t');
+    }
+  }
+}
+
+static char const *scalarScan(ScanClass cls, char const *start,
+                              char const *end) {
+  while (start < end && !stopsRun(cls, *start)) ++start;
+  return start;
+}
+
+#if SCAN_X86_64
+
+/**
+ * produces a mask with the bits corresponding to characters that stop the run
+ * set
+ *
+ * characters outside of ASCII compare as negative, so the signed range
+ * comparisons used for identifier characters correctly exclude them
+ */
+static uint32_t sse2Stops(ScanClass cls, __m128i chars) {
+  __m128i stops;
+  switch (cls) {
+    case SC_WHITESPACE: {
+      __m128i whitespace = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')),
+                       _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t'))),
+          _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')),
+                       _mm_cmpeq_epi8(chars, _mm_set1_epi8('\r'))));
+      return ~(uint32_t)_mm_movemask_epi8(whitespace) & 0xffff;
+    }
+    case SC_LINE_COMMENT: {
+      stops = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\n')),
+                       _mm_cmpeq_epi8(chars, _mm_set1_epi8('\r'))),
+          _mm_cmpeq_epi8(chars, _mm_set1_epi8('\x04')));
+      break;
+    }
+    case SC_BLOCK_COMMENT: {
+      stops = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\x04')),
+                           _mm_cmpeq_epi8(chars, _mm_set1_epi8('*')));
+      break;
+    }
+    case SC_ID: {
+      __m128i digits =
+          _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                        _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+      // folding to lowercase maps '@', '[', '^' and '`' onto non-letters
+      __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+      __m128i letters =
+          _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                        _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+      __m128i underscores = _mm_cmpeq_epi8(chars, _mm_set1_epi8('_'));
+      __m128i ids = _mm_or_si128(_mm_or_si128(digits, letters), underscores);
+      return ~(uint32_t)_mm_movemask_epi8(ids) & 0xffff;
+    }
+    default: {
+      __m128i printable =
+          _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(' ' - 1)),
+                        _mm_cmplt_epi8(chars, _mm_set1_epi8('~' + 1)));
+      __m128i specials =
+          _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('"')),
+                       _mm_cmpeq_epi8(chars, _mm_set1_epi8('\\')));
+      __m128i plain =
+          _mm_or_si128(_mm_andnot_si128(specials, printable),
+                       _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t')));
+      return ~(uint32_t)_mm_movemask_epi8(plain) & 0xffff;
+    }
+  }
+  return (uint32_t)_mm_movemask_epi8(stops);
+}
+
+static char const *sse2Scan(ScanClass cls, char const *start,
+                            char const *end) {
+  while (end - start >= 16) {
+    uint32_t stops =
+        sse2Stops(cls, _mm_loadu_si128((__m128i const *)(void const *)start));
+    if (stops != 0) return start + __builtin_ctz(stops);
+    start += 16;
+  }
+  return scalarScan(cls, start, end);
+}
+
+/** 32-character version of sse2Stops */
+__attribute__((target("avx2"))) static uint32_t avx2Stops(
+    ScanClass cls, __m256i chars) {
+  __m256i stops;
+  switch (cls) {
+    case SC_WHITESPACE: {
+      __m256i whitespace = _mm256_or_si256(
+          _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')),
+                          _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t'))),
+          _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')),
+                          _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\r'))));
+      return ~(uint32_t)_mm256_movemask_epi8(whitespace);
+    }
+    case SC_LINE_COMMENT: {
+      stops = _mm256_or_si256(
+          _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n')),
+                          _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\r'))),
+          _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\x04')));
+      break;
+    }
+    case SC_BLOCK_COMMENT: {
+      stops =
+          _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\x04')),
+                          _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('*')));
+      break;
+    }
+    case SC_ID: {
+      __m256i digits = _mm256_andnot_si256(
+          _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('9')),
+          _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)));
+      __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+      __m256i letters = _mm256_andnot_si256(
+          _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('z')),
+          _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)));
+      __m256i underscores = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_'));
+      __m256i ids =
+          _mm256_or_si256(_mm256_or_si256(digits, letters), underscores);
+      return ~(uint32_t)_mm256_movemask_epi8(ids);
+    }
+    default: {
+      __m256i printable = _mm256_andnot_si256(
+          _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('~')),
+          _mm256_cmpgt_epi8(chars, _mm256_set1_epi8(' ' - 1)));
+      __m256i specials =
+          _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('"')),
+                          _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\\')));
+      __m256i plain =
+          _mm256_or_si256(_mm256_andnot_si256(specials, printable),
+                          _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t')));
+      return ~(uint32_t)_mm256_movemask_epi8(plain);
+    }
+  }
+  return (uint32_t)_mm256_movemask_epi8(stops);
+}
+
+__attribute__((target("avx2"))) static char const *avx2Scan(
+    ScanClass cls, char const *start, char const *end) {
+  while (end - start >= 32) {
+    uint32_t stops = avx2Stops(
+        cls, _mm256_loadu_si256((__m256i const *)(void const *)start));
+    if (stops != 0) return start + __builtin_ctz(stops);
+    start += 32;
+  }
+  return sse2Scan(cls, start, end);
+}
+
+/**
+ * dispatches to the widest available scanner
+ *
+ * most runs between tokens are short, so the first two characters are checked
+ * before any vector is loaded
+ */
+static char const *scan(ScanClass cls, char const *start, char const *end) {
+  if (end - start < 2 || stopsRun(cls, start[0]) || stopsRun(cls, start[1]))
+    return scalarScan(cls, start, end);
+  start += 2;
+  return __builtin_cpu_supports("avx2") ? avx2Scan(cls, start, end)
+                                        : sse2Scan(cls, start, end);
+}
+
+#else
+
+static char const *scan(ScanClass cls, char const *start, char const *end) {
+  return scalarScan(cls, start, end);
+}
+
+#endif
+
+char const *scanWhitespace(char const *start, char const *end) {
+  return scan(SC_WHITESPACE, start, end);
+}
+
+char const *scanLineComment(char const *start, char const *end) {
+  return scan(SC_LINE_COMMENT, start, end);
+}
+
+char const *scanBlockComment(char const *start, char const *end) {
+  return scan(SC_BLOCK_COMMENT, start, end);
+}
+
+char const *scanId(char const *start, char const *end) {
+  return scan(SC_ID, start, end);
+}
+
+char const *scanString(char const *start, char const *end) {
+  return scan(SC_STRING, start, end);
+}
@@ -0,0 +1,79 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * vectorized character class scanning for the lexer
+ *
+ * Each scanner returns the first position in [start, end) that stops the run
+ * it scans for, or end if the run extends to the end of the buffer. Scanners
+ * never read at or past end, so they are safe to use on mmapped files.
+ */
+
+#ifndef TLC_LEXER_SCAN_H_
+#define TLC_LEXER_SCAN_H_
+
+/**
+ * finds the end of a run of whitespace - spaces, tabs, and line breaks
+ *
+ * @param start start of the run
+ * @param end end of the buffer
+ * @returns first character that is not whitespace
+ */
+char const *scanWhitespace(char const *start, char const *end);
+
+/**
+ * finds the end of a line comment's body
+ *
+ * @param start first character in the comment body
+ * @param end end of the buffer
+ * @returns first '\\n', '\\r', or '\\x04'
+ */
+char const *scanLineComment(char const *start, char const *end);
+
+/**
+ * finds the next character of interest in a block comment's body
+ *
+ * @param start first character to scan
+ * @param end end of the buffer
+ * @returns first '*' or '\\x04'
+ */
+char const *scanBlockComment(char const *start, char const *end);
+
+/**
+ * finds the end of an identifier
+ *
+ * @param start first character of the identifier
+ * @param end end of the buffer
+ * @returns first character that isn't in [0-9a-zA-Z_]
+ */
+char const *scanId(char const *start, char const *end);
+
+/**
+ * finds the end of a run of characters that need no special handling in a
+ * string literal
+ *
+ * @param start first character to scan
+ * @param end end of the buffer
+ * @returns first character that is not printable ASCII or a tab, or is '"' or
+ * '\\'
+ */
+char const *scanString(char const *start, char const *end);
+
+#endif  // TLC_LEXER_SCAN_H_
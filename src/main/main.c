@@ -21,23 +21,12 @@
 
 #include <stdbool.h>
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 
-#include "arch/interface.h"
-#include "ast/dump.h"
+#include "compile.h"
 #include "fileList.h"
-#include "ir/dump.h"
-#include "ir/ir.h"
-#include "lexer/dump.h"
-#include "lexer/lexer.h"
-#include "optimization/optimization.h"
 #include "options.h"
-#include "parser/parser.h"
-#include "translation/traceSchedule.h"
-#include "translation/translation.h"
-#include "typechecker/typechecker.h"
-#include "util/internalError.h"
+#include "server.h"
 #include "version.h"
 
 /**
@@ -72,15 +61,24 @@ static bool helpRequested(size_t argc, char **argv) {
   return false;
 }
 
-/** possible return values for main */
-enum {
-  CODE_SUCCESS = EXIT_SUCCESS,
-  CODE_OPTION_ERROR,
-  CODE_FILE_ERROR,
-  CODE_PARSE_ERROR,
-  CODE_TYPECHECK_ERROR,
-  CODE_IR_ERROR,
-};
+/**
+ * finds the value of an argument of the form "<prefix><value>"
+ *
+ * @param argc number of arguments (including name of program)
+ * @param argv list of arguments (including name of program)
+ * @param prefix prefix to look for, including the '='
+ * @returns value of the last such argument, or NULL if there wasn't one
+ */
+static char const *prefixedArgument(size_t argc, char **argv,
+                                    char const *prefix) {
+  char const *value = NULL;
+  size_t length = strlen(prefix);
+  for (size_t idx = 1; idx < argc; ++idx) {
+    if (strcmp(argv[idx], "--") == 0) break;
+    if (strncmp(argv[idx], prefix, length) == 0) value = argv[idx] + length;
+  }
+  return value;
+}
 
 // compile the given declaration and code files into one assembly file per code
 // file, given the flags
@@ -95,6 +93,13 @@ int main(int argc, char **argv) {
         "  --help, -h, -?    Display this information, and stop\n"
         "  --version         Display version information, and stop\n"
         "  --arch=...        Set the target architecture\n"
+        "  -j N              Compile up to N code files at once\n"
+        "  --time-report     Report time and memory used by each phase\n"
+        "  --decl-index      Use and write precompiled declaration modules\n"
+        "  --cache-dir=DIR   Reuse assembly for unchanged code files from DIR\n"
+        "  --lazy-decls      Only parse declaration modules that are used\n"
+        "  --server=SOCKET   Run a compile server listening on SOCKET\n"
+        "  --connect=SOCKET  Compile using the compile server on SOCKET\n"
         "  -W...=...         Configure warning options\n"
         "  --debug-dump=...  Configure debug information\n"
         "\n"
@@ -113,6 +118,22 @@ int main(int argc, char **argv) {
     return CODE_SUCCESS;
   }
 
+  // handle compile server modes
+  char const *serverSocket =
+      prefixedArgument((size_t)argc, argv, "--server=");
+  char const *connectSocket =
+      prefixedArgument((size_t)argc, argv, "--connect=");
+  if (serverSocket != NULL) {
+    if (argc != 2) {
+      fprintf(stderr, "tlc: error: '--server' takes no other arguments\n");
+      return CODE_OPTION_ERROR;
+    }
+    return serverRun(serverSocket);
+  } else if (connectSocket != NULL) {
+    return serverConnect(connectSocket, (size_t)argc,
+                         (char const *const *)argv);
+  }
+
   // parse options, get number of files
   size_t numFiles;
   if (parseArgs((size_t)argc, (char const *const *)argv, &numFiles) != 0)
@@ -122,99 +143,5 @@ int main(int argc, char **argv) {
   if (parseFiles((size_t)argc, (char const *const *)argv, numFiles) != 0)
     return CODE_FILE_ERROR;
 
-  // debug-dump stop for lexing
-  if (options.dump == OPTION_DD_LEX) {
-    lexerInitMaps();
-    for (size_t idx = 0; idx < fileList.size; ++idx)
-      lexDump(&fileList.entries[idx]);
-    lexerUninitMaps();
-  }
-
-  // front-end
-
-  // parse
-  if (parse() != 0) return CODE_PARSE_ERROR;
-
-  // debug-dump stop for parsing
-  if (options.dump == OPTION_DD_PARSE) {
-    for (size_t idx = 0; idx < fileList.size; ++idx)
-      astDump(stderr, &fileList.entries[idx]);
-  }
-
-  // typecheck
-  if (typecheck() != 0) return CODE_TYPECHECK_ERROR;
-
-  // debug-dump stop for typechecking
-  // TODO: write this
-
-  // additional warnings
-  // TODO: unreachable, reserved-id, const-return, duplicate-decl-specifier
-
-  // source code optimization
-  // TODO: write this
-
-  // translate to IR
-  translate();
-
-  // debug-dump stop for IR
-  if (options.dump == OPTION_DD_TRANSLATION) {
-    for (size_t idx = 0; idx < fileList.size; ++idx) {
-      if (fileList.entries[idx].isCode) irDump(stderr, &fileList.entries[idx]);
-    }
-  }
-
-  if (options.debugValidateIr && validateBlockedIr("translation") != 0)
-    return CODE_IR_ERROR;
-
-  // middle-end
-
-  // clean up AST
-  for (size_t idx = 0; idx < fileList.size; ++idx)
-    nodeFree(fileList.entries[idx].ast);
-
-  // blocked ir optimization
-  optimizeBlockedIr();
-
-  // debug-dump stop for optimized IR
-  if (options.dump == OPTION_DD_BLOCKED_OPTIMIZATION) {
-    for (size_t idx = 0; idx < fileList.size; ++idx) {
-      if (fileList.entries[idx].isCode) irDump(stderr, &fileList.entries[idx]);
-    }
-  }
-
-  if (options.debugValidateIr &&
-      validateBlockedIr("optimization before trace scheduling") != 0)
-    return CODE_IR_ERROR;
-
-  // trace scheduling
-  traceSchedule();
-
-  // debug-dump stop for trace-scheduled IR
-  if (options.dump == OPTION_DD_TRACE_SCHEDULING) {
-    for (size_t idx = 0; idx < fileList.size; ++idx) {
-      if (fileList.entries[idx].isCode) irDump(stderr, &fileList.entries[idx]);
-    }
-  }
-
-  if (options.debugValidateIr && validateScheduledIr("trace scheduling") != 0)
-    return CODE_IR_ERROR;
-
-  // scheduled ir optimization
-  optimizeScheduledIr();
-
-  // debug-dump stop for optimized, scheduled IR
-  if (options.dump == OPTION_DD_SCHEDULED_OPTIMIZATION) {
-    for (size_t idx = 0; idx < fileList.size; ++idx) {
-      if (fileList.entries[idx].isCode) irDump(stderr, &fileList.entries[idx]);
-    }
-  }
-
-  if (options.debugValidateIr &&
-      validateScheduledIr("optimization after trace scheduling") != 0)
-    return CODE_IR_ERROR;
-
-  // hand off to arch-specific backend
-  backend();
-
-  return CODE_SUCCESS;
+  return compile();
 }
\ No newline at end of file
@@ -21,7 +21,10 @@
 
 #include "fileList.h"
 #include "ir/ir.h"
+#include "options.h"
+#include "timeReport.h"
 #include "util/internalError.h"
+#include "util/parallel.h"
 
 /**
  * short-circuit unconditional-jump-to-any-jump
@@ -436,37 +439,49 @@ static void deadTempElimination(LinkedList *blocks, size_t maxTemps) {
   }
 }
 
-void optimizeBlockedIr(void) {
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *file = &fileList.entries[fileIdx];
-    Vector *irFrags = &fileList.entries[fileIdx].irFrags;
-    for (size_t fragIdx = 0; fragIdx < irFrags->size; ++fragIdx) {
-      IRFrag *frag = irFrags->elements[fragIdx];
-      if (frag->type == FT_TEXT) {
-        LinkedList *blocks = &frag->data.text.blocks;
-        // TODO: (difficult) inlining
-        // TODO: (difficult) constant propogation
-        // (if only ever used in context where a constant can be used, may
-        // replace temp with constant)
-        // TODO: (difficult) loop-invariant hoisting
-        // (if some expression doesn't change across loop iterations, compute it
-        // outside of the loop)
-        // TODO: (difficult) loop induction variables
-        // (only keep one iteration count for the loop, or reduce for loops to
-        // start and end pointer loops)
-        // TODO: (difficult) common subexpression elimination
-        // (if two expressions are the same, only compute them once)
-        // TODO: (difficult) copy propagation
-        // (if tempB is moved to tempA and tempB isn't changed afterwards,
-        // replace all instances of tempA afterwards with tempB)
-        // TODO: (difficult) tail call optimization
-        shortCircuitJumps(blocks);
-        deadBlockElimination(blocks, irFrags);
-        // TODO: dead label elimination
-        deadTempElimination(blocks, file->nextId);
-      }
+void optimizeBlockedIrFile(size_t fileIdx) {
+  timeReportFileBegin(TRP_BLOCKED_OPTIMIZATION, fileIdx);
+  FileListEntry *file = &fileList.entries[fileIdx];
+  Vector *irFrags = &fileList.entries[fileIdx].irFrags;
+  for (size_t fragIdx = 0; fragIdx < irFrags->size; ++fragIdx) {
+    IRFrag *frag = irFrags->elements[fragIdx];
+    if (frag->type == FT_TEXT) {
+      LinkedList *blocks = &frag->data.text.blocks;
+      // TODO: (difficult) inlining
+      // TODO: (difficult) constant propogation
+      // (if only ever used in context where a constant can be used, may
+      // replace temp with constant)
+      // TODO: (difficult) loop-invariant hoisting
+      // (if some expression doesn't change across loop iterations, compute it
+      // outside of the loop)
+      // TODO: (difficult) loop induction variables
+      // (only keep one iteration count for the loop, or reduce for loops to
+      // start and end pointer loops)
+      // TODO: (difficult) common subexpression elimination
+      // (if two expressions are the same, only compute them once)
+      // TODO: (difficult) copy propagation
+      // (if tempB is moved to tempA and tempB isn't changed afterwards,
+      // replace all instances of tempA afterwards with tempB)
+      // TODO: (difficult) tail call optimization
+      shortCircuitJumps(blocks);
+      deadBlockElimination(blocks, irFrags);
+      // TODO: dead label elimination
+      deadTempElimination(blocks, file->nextId);
     }
   }
+  timeReportFileEnd(TRP_BLOCKED_OPTIMIZATION, fileIdx);
+}
+
+/**
+ * optimizes the blocked IR of the file at the given index - parallelFor adapter
+ */
+static void optimizeBlockedIrFileAt(size_t fileIdx, void *ignored) {
+  (void)ignored;
+  optimizeBlockedIrFile(fileIdx);
+}
+
+void optimizeBlockedIr(void) {
+  parallelFor(options.jobs, fileList.size, optimizeBlockedIrFileAt, NULL);
 }
 
 static void deadLabelElimination(LinkedList *instructions, Vector *frags,
@@ -550,16 +565,29 @@ static void deadLabelElimination(LinkedList *instructions, Vector *frags,
   free(seen);
 }
 
-void optimizeScheduledIr(void) {
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *file = &fileList.entries[fileIdx];
-    Vector *irFrags = &fileList.entries[fileIdx].irFrags;
-    for (size_t fragIdx = 0; fragIdx < irFrags->size; ++fragIdx) {
-      IRFrag *frag = irFrags->elements[fragIdx];
-      if (frag->type == FT_TEXT) {
-        IRBlock *block = frag->data.text.blocks.head->next->data;
-        deadLabelElimination(&block->instructions, irFrags, file->nextId);
-      }
+void optimizeScheduledIrFile(size_t fileIdx) {
+  timeReportFileBegin(TRP_SCHEDULED_OPTIMIZATION, fileIdx);
+  FileListEntry *file = &fileList.entries[fileIdx];
+  Vector *irFrags = &fileList.entries[fileIdx].irFrags;
+  for (size_t fragIdx = 0; fragIdx < irFrags->size; ++fragIdx) {
+    IRFrag *frag = irFrags->elements[fragIdx];
+    if (frag->type == FT_TEXT) {
+      IRBlock *block = frag->data.text.blocks.head->next->data;
+      deadLabelElimination(&block->instructions, irFrags, file->nextId);
     }
   }
+  timeReportFileEnd(TRP_SCHEDULED_OPTIMIZATION, fileIdx);
+}
+
+/**
+ * optimizes the trace-scheduled IR of the file at the given index -
+ * parallelFor adapter
+ */
+static void optimizeScheduledIrFileAt(size_t fileIdx, void *ignored) {
+  (void)ignored;
+  optimizeScheduledIrFile(fileIdx);
+}
+
+void optimizeScheduledIr(void) {
+  parallelFor(options.jobs, fileList.size, optimizeScheduledIrFileAt, NULL);
 }
\ No newline at end of file
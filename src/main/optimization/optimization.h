@@ -25,11 +25,27 @@
 #ifndef TLC_OPTIMIZATION_OPTIMIZATION_H_
 #define TLC_OPTIMIZATION_OPTIMIZATION_H_
 
+#include <stddef.h>
+
+/**
+ * optimizes the blocked IR of the file at the given index
+ *
+ * @param fileIdx index of the file in the file list
+ */
+void optimizeBlockedIrFile(size_t fileIdx);
+
 /**
  * optimizes the blocked IR
  */
 void optimizeBlockedIr(void);
 
+/**
+ * optimizes the trace-scheduled IR of the file at the given index
+ *
+ * @param fileIdx index of the file in the file list
+ */
+void optimizeScheduledIrFile(size_t fileIdx);
+
 /**
  * optimizes the trace-scheduled IR
  */
@@ -20,13 +20,34 @@
 #include "options.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 Options options = {
-    OPTION_W_ERROR, OPTION_W_ERROR, OPTION_W_ERROR,
-    OPTION_DD_NONE, false,          OPTION_A_X86_64_LINUX,
+    OPTION_W_ERROR, OPTION_W_ERROR,        OPTION_W_ERROR,
+    OPTION_DD_NONE, false,                 OPTION_A_X86_64_LINUX,
+    1,              OPTION_TR_NONE,        false,
+    NULL,           false,
 };
 
+/**
+ * parses a positive job count
+ *
+ * @param string string to parse
+ * @param jobs output parameter for the job count
+ * @returns status code (0 = OK)
+ */
+static int parseJobs(char const *string, size_t *jobs) {
+  if (*string < '0' || *string > '9') return -1;
+
+  char *end;
+  unsigned long value = strtoul(string, &end, 10);
+  if (*end != '\0' || value == 0) return -1;
+
+  *jobs = (size_t)value;
+  return 0;
+}
+
 int parseArgs(size_t argc, char const *const *argv, size_t *numFilesOut) {
   size_t numFiles = 0;
 
@@ -74,8 +95,43 @@ int parseArgs(size_t argc, char const *const *argv, size_t *numFilesOut) {
       options.debugValidateIr = true;
     } else if (strcmp(argv[idx], "--no-debug-validate-ir") == 0) {
       options.debugValidateIr = false;
+    } else if (strcmp(argv[idx], "--time-report") == 0) {
+      options.timeReport = OPTION_TR_SUMMARY;
+    } else if (strcmp(argv[idx], "--time-report=per-file") == 0) {
+      options.timeReport = OPTION_TR_PER_FILE;
+    } else if (strcmp(argv[idx], "--no-time-report") == 0) {
+      options.timeReport = OPTION_TR_NONE;
+    } else if (strcmp(argv[idx], "--decl-index") == 0) {
+      options.declIndex = true;
+    } else if (strcmp(argv[idx], "--no-decl-index") == 0) {
+      options.declIndex = false;
+    } else if (strncmp(argv[idx], "--cache-dir=", 12) == 0) {
+      if (argv[idx][12] == '\0') {
+        fprintf(stderr, "tlc: error: '--cache-dir=' requires a directory\n");
+        return -1;
+      }
+      options.cacheDir = argv[idx] + 12;
+    } else if (strcmp(argv[idx], "--no-cache-dir") == 0) {
+      options.cacheDir = NULL;
+    } else if (strcmp(argv[idx], "--lazy-decls") == 0) {
+      options.lazyDecls = true;
+    } else if (strcmp(argv[idx], "--no-lazy-decls") == 0) {
+      options.lazyDecls = false;
     } else if (strcmp(argv[idx], "--arch=x86_64-linux") == 0) {
       options.arch = OPTION_A_X86_64_LINUX;
+    } else if (strcmp(argv[idx], "-j") == 0) {
+      // job count is the next argument
+      if (idx + 1 == argc || parseJobs(argv[idx + 1], &options.jobs) != 0) {
+        fprintf(stderr, "tlc: error: '-j' requires a positive job count\n");
+        return -1;
+      }
+      ++idx;
+    } else if (strncmp(argv[idx], "-j", 2) == 0) {
+      if (parseJobs(argv[idx] + 2, &options.jobs) != 0) {
+        fprintf(stderr, "tlc: error: options '%s' not recognized\n",
+                argv[idx]);
+        return -1;
+      }
     } else {
       fprintf(stderr, "tlc: error: options '%s' not recognized\n", argv[idx]);
       return -1;
@@ -44,6 +44,12 @@ typedef enum {
   OPTION_DD_TRACE_SCHEDULING,
   OPTION_DD_SCHEDULED_OPTIMIZATION,
 } DebugDumpOption;
+/** Time report options */
+typedef enum {
+  OPTION_TR_NONE,
+  OPTION_TR_SUMMARY,
+  OPTION_TR_PER_FILE,
+} TimeReportOption;
 /** Architecture options */
 typedef enum {
   OPTION_A_X86_64_LINUX,
@@ -56,6 +62,12 @@ typedef struct {
   DebugDumpOption dump;
   bool debugValidateIr;
   ArchOption arch;
+  size_t jobs; /**< maximum number of threads to compile with */
+  TimeReportOption timeReport;
+  bool declIndex;       /**< use and write precompiled declarations */
+  char const *cacheDir; /**< directory to cache generated assembly in, or NULL
+                           if nothing should be cached */
+  bool lazyDecls;       /**< only parse decl modules code modules reach */
 } Options;
 
 /**
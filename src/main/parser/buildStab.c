@@ -31,17 +31,12 @@
 #include "util/container/hashMap.h"
 #include "util/container/hashSet.h"
 #include "util/container/vector.h"
+#include "util/diagnostics.h"
 #include "util/format.h"
 #include "util/functional.h"
 #include "util/internalError.h"
 #include "util/numericSizing.h"
 
-static bool fileListEntryArrayContains(FileListEntry **arry, size_t size,
-                                       FileListEntry *f) {
-  for (size_t idx = 0; idx < size; ++idx)
-    if (arry[idx] == f) return true;
-  return false;
-}
 static bool nameArrayContains(Node **arry, size_t size, Node *n) {
   for (size_t idx = 0; idx < size; ++idx)
     if (nameNodeEqual(arry[idx], n)) return true;
@@ -50,57 +45,57 @@ static bool nameArrayContains(Node **arry, size_t size, Node *n) {
 int resolveImports(void) {
   bool errored = false;
 
-  // check for duplciate decl modules
-  FileListEntry **processed = malloc(sizeof(FileListEntry *) * fileList.size);
-  size_t numProcessed = 0;
+  // check for duplciate decl modules - the module index maps each name to the
+  // first file declaring it, so any other file is chained to that one
+  size_t *nextDuplicate = malloc(sizeof(size_t) * fileList.size);
+  size_t *lastDuplicate = malloc(sizeof(size_t) * fileList.size);
   for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    if (!fileList.entries[fileIdx].isCode &&
-        !fileListEntryArrayContains(processed, numProcessed,
-                                    &fileList.entries[fileIdx])) {
-      // for each declaration file, if its name hasn't been processed yet,
-      // process it
-      FileListEntry **duplicateEntries =
-          malloc(sizeof(FileListEntry *) * fileList.size);
-      size_t numDuplicates = 0;
-      for (size_t compareIdx = fileIdx + 1; compareIdx < fileList.size;
-           ++compareIdx) {
-        // check it against each other file
-        if (!fileList.entries[compareIdx].isCode &&
-            nameNodeEqual(
-                fileList.entries[fileIdx].ast->data.file.module->data.module.id,
-                fileList.entries[compareIdx]
-                    .ast->data.file.module->data.module.id)) {
-          duplicateEntries[numDuplicates++] = &fileList.entries[compareIdx];
-        }
-      }
-      if (numDuplicates != 0) {
-        char *nameString = stringifyId(
-            fileList.entries[fileIdx].ast->data.file.module->data.module.id);
-        fprintf(stderr,
-                "%s:%zu:%zu: error: module '%s' declared in multiple "
-                "declaration modules\n",
-                fileList.entries[fileIdx].inputFilename,
-                fileList.entries[fileIdx].ast->line,
-                fileList.entries[fileIdx].ast->character, nameString);
-        free(nameString);
-        for (size_t printIdx = 0; printIdx < numDuplicates; ++printIdx)
-          fprintf(stderr, "%s:%zu:%zu: note: declared here\n",
-                  duplicateEntries[printIdx]->inputFilename,
-                  duplicateEntries[printIdx]->ast->line,
-                  duplicateEntries[printIdx]->ast->character);
-        errored = true;
-      }
-      free(duplicateEntries);
-
-      processed[numProcessed++] = &fileList.entries[fileIdx];
+    nextDuplicate[fileIdx] = fileIdx;
+    lastDuplicate[fileIdx] = fileIdx;
+    FileListEntry *entry = &fileList.entries[fileIdx];
+    if (entry->isCode) continue;
+    FileListEntry *first =
+        fileListFindDeclName(entry->ast->data.file.module->data.module.id);
+    // the resident entries of a compile server were checked when built
+    if (first == entry || (first->preparsed && entry->preparsed)) continue;
+    size_t firstIdx = (size_t)(first - fileList.entries);
+    nextDuplicate[lastDuplicate[firstIdx]] = fileIdx;
+    lastDuplicate[firstIdx] = fileIdx;
+  }
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    if (lastDuplicate[fileIdx] == fileIdx) continue;
+    FileListEntry *entry = &fileList.entries[fileIdx];
+    char *nameString =
+        stringifyId(entry->ast->data.file.module->data.module.id);
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, entry->ast->offset, &line, &character);
+    fprintf(diagnosticStream(),
+            "%s:%zu:%zu: error: module '%s' declared in multiple "
+            "declaration modules\n",
+            entry->inputFilename, line, character, nameString);
+    free(nameString);
+    for (size_t duplicateIdx = nextDuplicate[fileIdx]; true;
+         duplicateIdx = nextDuplicate[duplicateIdx]) {
+      FileListEntry *duplicate = &fileList.entries[duplicateIdx];
+      size_t line;
+      size_t character;
+      fileListEntryPosition(duplicate, duplicate->ast->offset, &line,
+                            &character);
+      fprintf(diagnosticStream(), "%s:%zu:%zu: note: declared here\n",
+              duplicate->inputFilename, line, character);
+      if (duplicateIdx == lastDuplicate[fileIdx]) break;
     }
+    errored = true;
   }
-  free(processed);
+  free(nextDuplicate);
+  free(lastDuplicate);
 
   if (errored) return -1;
 
   // link imports
   for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    if (fileList.entries[fileIdx].preparsed) continue;
     Node *ast = fileList.entries[fileIdx].ast;
     Vector *imports = ast->data.file.imports;
 
@@ -121,29 +116,43 @@ int resolveImports(void) {
       switch (options.duplicateImport) {
         case OPTION_W_ERROR: {
           char *nameString = stringifyId(ast->data.file.module->data.module.id);
-          fprintf(stderr, "%s:%zu:%zu: error: '%s' imports itself\n",
-                  fileList.entries[fileIdx].inputFilename,
-                  ast->data.file.module->line, ast->data.file.module->character,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(&fileList.entries[fileIdx],
+                                ast->data.file.module->offset, &line,
+                                &character);
+          fprintf(diagnosticStream(),
+                  "%s:%zu:%zu: error: '%s' imports itself\n",
+                  fileList.entries[fileIdx].inputFilename, line, character,
                   nameString);
           free(nameString);
-          for (size_t idx = 0; idx < numColliding; ++idx)
-            fprintf(stderr, "%s:%zu:%zu: note: imported here\n",
-                    fileList.entries[fileIdx].inputFilename,
-                    colliding[idx]->line, colliding[idx]->character);
+          for (size_t idx = 0; idx < numColliding; ++idx) {
+            fileListEntryPosition(&fileList.entries[fileIdx],
+                                  colliding[idx]->offset, &line, &character);
+            fprintf(diagnosticStream(), "%s:%zu:%zu: note: imported here\n",
+                    fileList.entries[fileIdx].inputFilename, line, character);
+          }
           fileList.entries[fileIdx].errored = true;
           break;
         }
         case OPTION_W_WARN: {
           char *nameString = stringifyId(ast->data.file.module->data.module.id);
-          fprintf(stderr, "%s:%zu:%zu: warning: '%s' imports itself\n",
-                  fileList.entries[fileIdx].inputFilename,
-                  ast->data.file.module->line, ast->data.file.module->character,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(&fileList.entries[fileIdx],
+                                ast->data.file.module->offset, &line,
+                                &character);
+          fprintf(diagnosticStream(),
+                  "%s:%zu:%zu: warning: '%s' imports itself\n",
+                  fileList.entries[fileIdx].inputFilename, line, character,
                   nameString);
           free(nameString);
-          for (size_t idx = 0; idx < numColliding; ++idx)
-            fprintf(stderr, "%s:%zu:%zu: note: imported here\n",
-                    fileList.entries[fileIdx].inputFilename,
-                    colliding[idx]->line, colliding[idx]->character);
+          for (size_t idx = 0; idx < numColliding; ++idx) {
+            fileListEntryPosition(&fileList.entries[fileIdx],
+                                  colliding[idx]->offset, &line, &character);
+            fprintf(diagnosticStream(), "%s:%zu:%zu: note: imported here\n",
+                    fileList.entries[fileIdx].inputFilename, line, character);
+          }
           break;
         }
         case OPTION_W_IGNORE: {
@@ -171,29 +180,47 @@ int resolveImports(void) {
           switch (options.duplicateImport) {
             case OPTION_W_ERROR: {
               char *nameString = stringifyId(import->data.import.id);
-              fprintf(stderr,
+              size_t line;
+              size_t character;
+              fileListEntryPosition(&fileList.entries[fileIdx], import->offset,
+                                    &line, &character);
+              fprintf(diagnosticStream(),
                       "%s:%zu:%zu: error: '%s' imported multiple times\n",
-                      fileList.entries[fileIdx].inputFilename, import->line,
-                      import->character, nameString);
+                      fileList.entries[fileIdx].inputFilename, line, character,
+                      nameString);
               free(nameString);
-              for (size_t idx = 0; idx < numColliding; ++idx)
-                fprintf(stderr, "%s:%zu:%zu: note: imported here\n",
-                        fileList.entries[fileIdx].inputFilename,
-                        colliding[idx]->line, colliding[idx]->character);
+              for (size_t idx = 0; idx < numColliding; ++idx) {
+                fileListEntryPosition(&fileList.entries[fileIdx],
+                                      colliding[idx]->offset, &line,
+                                      &character);
+                fprintf(diagnosticStream(),
+                        "%s:%zu:%zu: note: imported here\n",
+                        fileList.entries[fileIdx].inputFilename, line,
+                        character);
+              }
               fileList.entries[fileIdx].errored = true;
               break;
             }
             case OPTION_W_WARN: {
               char *nameString = stringifyId(import->data.import.id);
-              fprintf(stderr,
+              size_t line;
+              size_t character;
+              fileListEntryPosition(&fileList.entries[fileIdx], import->offset,
+                                    &line, &character);
+              fprintf(diagnosticStream(),
                       "%s:%zu:%zu: warning: '%s' imported multiple times\n",
-                      fileList.entries[fileIdx].inputFilename, import->line,
-                      import->character, nameString);
+                      fileList.entries[fileIdx].inputFilename, line, character,
+                      nameString);
               free(nameString);
-              for (size_t idx = 0; idx < numColliding; ++idx)
-                fprintf(stderr, "%s:%zu:%zu: note: imported here\n",
-                        fileList.entries[fileIdx].inputFilename,
-                        colliding[idx]->line, colliding[idx]->character);
+              for (size_t idx = 0; idx < numColliding; ++idx) {
+                fileListEntryPosition(&fileList.entries[fileIdx],
+                                      colliding[idx]->offset, &line,
+                                      &character);
+                fprintf(diagnosticStream(),
+                        "%s:%zu:%zu: note: imported here\n",
+                        fileList.entries[fileIdx].inputFilename, line,
+                        character);
+              }
               break;
             }
             case OPTION_W_IGNORE: {
@@ -207,9 +234,14 @@ int resolveImports(void) {
 
         if (import->data.import.referenced == NULL) {
           char *name = stringifyId(import->data.import.id);
-          fprintf(stderr, "%s:%zu:%zu error: cannot find module '%s'\n",
-                  fileList.entries[fileIdx].inputFilename, import->line,
-                  import->character, name);
+          size_t line;
+          size_t character;
+          fileListEntryPosition(&fileList.entries[fileIdx], import->offset,
+                                &line, &character);
+          fprintf(diagnosticStream(),
+                  "%s:%zu:%zu error: cannot find module '%s'\n",
+                  fileList.entries[fileIdx].inputFilename, line, character,
+                  name);
           free(name);
           errored = true;
         }
@@ -244,30 +276,29 @@ void startTopLevelStab(FileListEntry *entry) {
     switch (body->type) {
       case NT_OPAQUEDECL: {
         char const *name = body->data.opaqueDecl.name->data.id.id;
-        SymbolTableEntry *existing = hashMapGet(stab, name);
+        SymbolTableEntry *existing = hashMapGetId(stab, name);
         if (existing == NULL && implicitStab != NULL)
-          existing = hashMapGet(implicitStab, name);
+          existing = hashMapGetId(implicitStab, name);
 
         if (existing != NULL) {
           // must not exist
-          errorRedeclaration(entry, body->line, body->character, name,
-                             existing->file, existing->line,
-                             existing->character);
+          errorRedeclaration(entry, body->offset, name, existing->file,
+                             existing->offset);
         } else {
           // create an entry if it doesn't exist
           body->data.opaqueDecl.name->data.id.entry =
-              opaqueStabEntryCreate(entry, body->line, body->character,
+              opaqueStabEntryCreate(entry, body->offset,
                                     body->data.opaqueDecl.name->data.id.id);
-          hashMapPut(stab, name, body->data.opaqueDecl.name->data.id.entry);
+          hashMapPutId(stab, name, body->data.opaqueDecl.name->data.id.entry);
         }
         break;
       }
       case NT_STRUCTDECL: {
         char const *name = body->data.structDecl.name->data.id.id;
-        SymbolTableEntry *existing = hashMapGet(stab, name);
+        SymbolTableEntry *existing = hashMapGetId(stab, name);
         bool fromImplicit = false;
         if (existing == NULL && implicitStab != NULL) {
-          existing = hashMapGet(implicitStab, name);
+          existing = hashMapGetId(implicitStab, name);
           fromImplicit = true;
         }
 
@@ -277,28 +308,27 @@ void startTopLevelStab(FileListEntry *entry) {
             existing->data.opaqueType.definition =
                 body->data.structDecl.name->data.id.entry =
                     structStabEntryCreate(
-                        entry, body->line, body->character,
+                        entry, body->offset,
                         body->data.structDecl.name->data.id.id);
-            hashMapPut(stab, name, body->data.structDecl.name->data.id.entry);
+            hashMapPutId(stab, name, body->data.structDecl.name->data.id.entry);
           } else {
-            errorRedeclaration(entry, body->line, body->character, name,
-                               existing->file, existing->line,
-                               existing->character);
+            errorRedeclaration(entry, body->offset, name, existing->file,
+                               existing->offset);
           }
         } else {
           body->data.structDecl.name->data.id.entry =
-              structStabEntryCreate(entry, body->line, body->character,
+              structStabEntryCreate(entry, body->offset,
                                     body->data.structDecl.name->data.id.id);
-          hashMapPut(stab, name, body->data.structDecl.name->data.id.entry);
+          hashMapPutId(stab, name, body->data.structDecl.name->data.id.entry);
         }
         break;
       }
       case NT_UNIONDECL: {
         char const *name = body->data.unionDecl.name->data.id.id;
-        SymbolTableEntry *existing = hashMapGet(stab, name);
+        SymbolTableEntry *existing = hashMapGetId(stab, name);
         bool fromImplicit = false;
         if (existing == NULL && implicitStab != NULL) {
-          existing = hashMapGet(implicitStab, name);
+          existing = hashMapGetId(implicitStab, name);
           fromImplicit = true;
         }
 
@@ -307,28 +337,27 @@ void startTopLevelStab(FileListEntry *entry) {
           if (existing->kind == SK_OPAQUE && fromImplicit) {
             existing->data.opaqueType.definition =
                 body->data.unionDecl.name->data.id.entry =
-                    unionStabEntryCreate(entry, body->line, body->character,
+                    unionStabEntryCreate(entry, body->offset,
                                          body->data.unionDecl.name->data.id.id);
-            hashMapPut(stab, name, body->data.unionDecl.name->data.id.entry);
+            hashMapPutId(stab, name, body->data.unionDecl.name->data.id.entry);
           } else {
-            errorRedeclaration(entry, body->line, body->character, name,
-                               existing->file, existing->line,
-                               existing->character);
+            errorRedeclaration(entry, body->offset, name, existing->file,
+                               existing->offset);
           }
         } else {
           body->data.unionDecl.name->data.id.entry =
-              unionStabEntryCreate(entry, body->line, body->character,
+              unionStabEntryCreate(entry, body->offset,
                                    body->data.unionDecl.name->data.id.id);
-          hashMapPut(stab, name, body->data.unionDecl.name->data.id.entry);
+          hashMapPutId(stab, name, body->data.unionDecl.name->data.id.entry);
         }
         break;
       }
       case NT_ENUMDECL: {
         char const *name = body->data.enumDecl.name->data.id.id;
-        SymbolTableEntry *existing = hashMapGet(stab, name);
+        SymbolTableEntry *existing = hashMapGetId(stab, name);
         bool fromImplicit = false;
         if (existing == NULL && implicitStab != NULL) {
-          existing = hashMapGet(implicitStab, name);
+          existing = hashMapGetId(implicitStab, name);
           fromImplicit = true;
         }
 
@@ -338,19 +367,18 @@ void startTopLevelStab(FileListEntry *entry) {
           if (existing->kind == SK_OPAQUE && fromImplicit) {
             parentEnum = existing->data.opaqueType.definition =
                 body->data.enumDecl.name->data.id.entry =
-                    enumStabEntryCreate(entry, body->line, body->character,
+                    enumStabEntryCreate(entry, body->offset,
                                         body->data.enumDecl.name->data.id.id);
-            hashMapPut(stab, name, body->data.enumDecl.name->data.id.entry);
+            hashMapPutId(stab, name, body->data.enumDecl.name->data.id.entry);
           } else {
-            errorRedeclaration(entry, body->line, body->character, name,
-                               existing->file, existing->line,
-                               existing->character);
+            errorRedeclaration(entry, body->offset, name, existing->file,
+                               existing->offset);
           }
         } else {
           parentEnum = body->data.enumDecl.name->data.id.entry =
-              enumStabEntryCreate(entry, body->line, body->character,
+              enumStabEntryCreate(entry, body->offset,
                                   body->data.enumDecl.name->data.id.id);
-          hashMapPut(stab, name, body->data.enumDecl.name->data.id.entry);
+          hashMapPutId(stab, name, body->data.enumDecl.name->data.id.entry);
         }
 
         if (parentEnum != NULL) {
@@ -363,16 +391,15 @@ void startTopLevelStab(FileListEntry *entry) {
                 enumLookupEnumConst(parentEnum, constantName->data.id.id);
             if (existing != NULL) {
               // already exists - complain!
-              errorRedeclaration(entry, constantName->line,
-                                 constantName->character,
+              errorRedeclaration(entry, constantName->offset,
                                  constantName->data.id.id, existing->file,
-                                 existing->line, existing->character);
+                                 existing->offset);
             } else {
               vectorInsert(&parentEnum->data.enumType.constantNames,
                            constantName->data.id.id);
 
               constantName->data.id.entry = enumConstStabEntryCreate(
-                  entry, constantName->line, constantName->character,
+                  entry, constantName->offset,
                   constantName->data.id.id, parentEnum);
               vectorInsert(&parentEnum->data.enumType.constantValues,
                            constantName->data.id.entry);
@@ -383,10 +410,10 @@ void startTopLevelStab(FileListEntry *entry) {
       }
       case NT_TYPEDEFDECL: {
         char const *name = body->data.typedefDecl.name->data.id.id;
-        SymbolTableEntry *existing = hashMapGet(stab, name);
+        SymbolTableEntry *existing = hashMapGetId(stab, name);
         bool fromImplicit = false;
         if (existing == NULL && implicitStab != NULL) {
-          existing = hashMapGet(implicitStab, name);
+          existing = hashMapGetId(implicitStab, name);
           fromImplicit = true;
         }
 
@@ -396,19 +423,19 @@ void startTopLevelStab(FileListEntry *entry) {
             existing->data.opaqueType.definition =
                 body->data.typedefDecl.name->data.id.entry =
                     typedefStabEntryCreate(
-                        entry, body->line, body->character,
+                        entry, body->offset,
                         body->data.typedefDecl.name->data.id.id);
-            hashMapPut(stab, name, body->data.typedefDecl.name->data.id.entry);
+            hashMapPutId(stab, name,
+                         body->data.typedefDecl.name->data.id.entry);
           } else {
-            errorRedeclaration(entry, body->line, body->character, name,
-                               existing->file, existing->line,
-                               existing->character);
+            errorRedeclaration(entry, body->offset, name, existing->file,
+                               existing->offset);
           }
         } else {
           body->data.typedefDecl.name->data.id.entry =
-              typedefStabEntryCreate(entry, body->line, body->character,
+              typedefStabEntryCreate(entry, body->offset,
                                      body->data.typedefDecl.name->data.id.id);
-          hashMapPut(stab, name, body->data.typedefDecl.name->data.id.entry);
+          hashMapPutId(stab, name, body->data.typedefDecl.name->data.id.entry);
         }
         break;
       }
@@ -417,18 +444,17 @@ void startTopLevelStab(FileListEntry *entry) {
         for (size_t idx = 0; idx < names->size; ++idx) {
           Node *name = names->elements[idx];
           char const *nameString = name->data.id.id;
-          SymbolTableEntry *existing = hashMapGet(stab, nameString);
+          SymbolTableEntry *existing = hashMapGetId(stab, nameString);
           // can't possibly be from an implicit - this is in a decl module
 
           // must not exist
           if (existing != NULL) {
-            errorRedeclaration(entry, name->line, name->character, nameString,
-                               existing->file, existing->line,
-                               existing->character);
+            errorRedeclaration(entry, name->offset, nameString, existing->file,
+                               existing->offset);
           } else {
             name->data.id.entry = variableStabEntryCreate(
-                entry, name->line, name->character, name->data.id.id);
-            hashMapPut(stab, nameString, name->data.id.entry);
+                entry, name->offset, name->data.id.id);
+            hashMapPutId(stab, nameString, name->data.id.entry);
           }
         }
         break;
@@ -438,10 +464,10 @@ void startTopLevelStab(FileListEntry *entry) {
         for (size_t idx = 0; idx < names->size; ++idx) {
           Node *name = names->elements[idx];
           char const *nameString = name->data.id.id;
-          SymbolTableEntry *existing = hashMapGet(stab, nameString);
+          SymbolTableEntry *existing = hashMapGetId(stab, nameString);
           bool fromImplicit = false;
           if (existing == NULL && implicitStab != NULL) {
-            existing = hashMapGet(implicitStab, nameString);
+            existing = hashMapGetId(implicitStab, nameString);
             fromImplicit = true;
           }
 
@@ -450,45 +476,43 @@ void startTopLevelStab(FileListEntry *entry) {
             // implicit)
             if (existing->kind == SK_VARIABLE && fromImplicit) {
               name->data.id.entry = variableStabEntryCreate(
-                  entry, name->line, name->character, name->data.id.id);
-              hashMapPut(stab, nameString, name->data.id.entry);
+                  entry, name->offset, name->data.id.id);
+              hashMapPutId(stab, nameString, name->data.id.entry);
             } else {
-              errorRedeclaration(entry, name->line, name->character, nameString,
-                                 existing->file, existing->line,
-                                 existing->character);
+              errorRedeclaration(entry, name->offset, nameString,
+                                 existing->file, existing->offset);
             }
           } else {
             name->data.id.entry = variableStabEntryCreate(
-                entry, name->line, name->character, name->data.id.id);
-            hashMapPut(stab, nameString, name->data.id.entry);
+                entry, name->offset, name->data.id.id);
+            hashMapPutId(stab, nameString, name->data.id.entry);
           }
         }
         break;
       }
       case NT_FUNDECL: {
         char const *name = body->data.funDecl.name->data.id.id;
-        SymbolTableEntry *existing = hashMapGet(stab, name);
+        SymbolTableEntry *existing = hashMapGetId(stab, name);
         // can't possibly be from an implicit - this is a decl module
 
         // must not exist
         if (existing != NULL) {
-          errorRedeclaration(entry, body->line, body->character, name,
-                             existing->file, existing->line,
-                             existing->character);
+          errorRedeclaration(entry, body->offset, name, existing->file,
+                             existing->offset);
         } else {
           body->data.funDecl.name->data.id.entry =
-              functionStabEntryCreate(entry, body->line, body->character,
+              functionStabEntryCreate(entry, body->offset,
                                       body->data.funDecl.name->data.id.id);
-          hashMapPut(stab, name, body->data.funDecl.name->data.id.entry);
+          hashMapPutId(stab, name, body->data.funDecl.name->data.id.entry);
         }
         break;
       }
       case NT_FUNDEFN: {
         char const *name = body->data.funDefn.name->data.id.id;
-        SymbolTableEntry *existing = hashMapGet(stab, name);
+        SymbolTableEntry *existing = hashMapGetId(stab, name);
         bool fromImplicit = false;
         if (existing == NULL && implicitStab != NULL) {
-          existing = hashMapGet(implicitStab, name);
+          existing = hashMapGetId(implicitStab, name);
           fromImplicit = true;
         }
 
@@ -496,19 +520,18 @@ void startTopLevelStab(FileListEntry *entry) {
           // may only exist as a funDecl (must be from the implicit)
           if (existing->kind == SK_FUNCTION && fromImplicit) {
             body->data.funDefn.name->data.id.entry =
-                functionStabEntryCreate(entry, body->line, body->character,
+                functionStabEntryCreate(entry, body->offset,
                                         body->data.funDefn.name->data.id.id);
-            hashMapPut(stab, name, body->data.funDefn.name->data.id.entry);
+            hashMapPutId(stab, name, body->data.funDefn.name->data.id.entry);
           } else {
-            errorRedeclaration(entry, body->line, body->character, name,
-                               existing->file, existing->line,
-                               existing->character);
+            errorRedeclaration(entry, body->offset, name, existing->file,
+                               existing->offset);
           }
         } else {
           body->data.funDefn.name->data.id.entry =
-              functionStabEntryCreate(entry, body->line, body->character,
+              functionStabEntryCreate(entry, body->offset,
                                       body->data.funDefn.name->data.id.id);
-          hashMapPut(stab, name, body->data.funDefn.name->data.id.entry);
+          hashMapPutId(stab, name, body->data.funDefn.name->data.id.entry);
         }
         break;
       }
@@ -521,6 +544,28 @@ void startTopLevelStab(FileListEntry *entry) {
   }
 }
 
+/**
+ * compares file indices, for bsearch
+ */
+static int fileIdxCompare(void const *rawA, void const *rawB) {
+  size_t a = *(size_t const *)rawA;
+  size_t b = *(size_t const *)rawB;
+  return a < b ? -1 : a > b ? 1 : 0;
+}
+/**
+ * is this enum constant's value already known?
+ *
+ * constants loaded from precompiled declarations or from outside the group
+ * being built aren't part of the dependency graph, since they already have
+ * their values
+ */
+static bool constantPrecomputed(SymbolTableEntry const *e, size_t const *files,
+                                size_t numFiles) {
+  size_t fileIdx = (size_t)(e->file - fileList.entries);
+  return e->file->declIndex != NULL ||
+         bsearch(&fileIdx, files, numFiles, sizeof(size_t), fileIdxCompare) ==
+             NULL;
+}
 /**
  * find the index of e in enumConstants
  *
@@ -533,18 +578,17 @@ static size_t constantEntryFind(Vector *enumConstants, SymbolTableEntry *e) {
   error(__FILE__, __LINE__,
         "constantEntryFind called with an e not in enumConstants");
 }
-int buildTopLevelEnumStab(void) {
-  Vector enumConstants;  // vector of SymbolTableEntry, non-owning
-  Vector dependencies;   // vector of SymbolTableEntry, non-owning, nullable
-  Vector enumValues;  // vector of extended int literals, non-owning, nullable
-  bool errored = false;
-  vectorInit(&enumConstants);
-  vectorInit(&dependencies);
-  vectorInit(&enumValues);
+void topLevelEnumsInit(TopLevelEnums *enums, size_t const *files,
+                       size_t numFiles) {
+  enums->files = files;
+  enums->numFiles = numFiles;
+  vectorInit(&enums->constants);
+  vectorInit(&enums->dependencies);
+  vectorInit(&enums->values);
 
   // for each enum in each file, create the enumConstant entries
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *entry = &fileList.entries[fileIdx];
+  for (size_t fileIdx = 0; fileIdx < numFiles; ++fileIdx) {
+    FileListEntry *entry = &fileList.entries[files[fileIdx]];
     Vector *bodies = entry->ast->data.file.bodies;
 
     // for each top level
@@ -557,90 +601,91 @@ int buildTopLevelEnumStab(void) {
         // for each constant, record it in the graph
         for (size_t constantIdx = 0; constantIdx < constantSymbols->size;
              ++constantIdx) {
-          vectorInsert(&enumConstants, constantSymbols->elements[constantIdx]);
-          vectorInsert(&dependencies, NULL);
+          vectorInsert(&enums->constants,
+                       constantSymbols->elements[constantIdx]);
+          vectorInsert(&enums->dependencies, NULL);
           vectorInsert(
-              &enumValues,
+              &enums->values,
               body->data.enumDecl.constantValues->elements[constantIdx]);
         }
       }
     }
   }
+}
+int resolveTopLevelEnums(TopLevelEnums *enums, FileListEntry *entry) {
+  Vector *bodies = entry->ast->data.file.bodies;
+  bool errored = false;
+  Environment env;
+  environmentInit(&env, entry);
 
-  // for each enum in each file
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *entry = &fileList.entries[fileIdx];
-    Vector *bodies = entry->ast->data.file.bodies;
-    Environment env;
-    environmentInit(&env, entry);
-
-    // for each enum in the file
-    for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
-      Node *body = bodies->elements[bodyIdx];
-      if (body->type == NT_ENUMDECL) {
-        SymbolTableEntry *thisEnum = body->data.enumDecl.name->data.id.entry;
-        Vector *constantValues = &thisEnum->data.enumType.constantValues;
-
-        // for each constant
-        for (size_t constantIdx = 0; constantIdx < constantValues->size;
-             ++constantIdx) {
-          Node *constantValueNode =
-              body->data.enumDecl.constantValues->elements[constantIdx];
-          size_t constantEntryIdx = constantEntryFind(
-              &enumConstants, constantValues->elements[constantIdx]);
-          if (constantValueNode == NULL) {
-            // depends on previous
-            if (constantIdx == 0) {
-              // no previous entry in this enum - depends on nothing
-              dependencies.elements[constantEntryIdx] = NULL;
-            } else {
-              // depends on previous entry (is always at current - 1)
-              dependencies.elements[constantEntryIdx] =
-                  enumConstants.elements[constantEntryIdx - 1];
-            }
+  // for each enum in the file
+  for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
+    Node *body = bodies->elements[bodyIdx];
+    if (body->type == NT_ENUMDECL) {
+      SymbolTableEntry *thisEnum = body->data.enumDecl.name->data.id.entry;
+      Vector *constantValues = &thisEnum->data.enumType.constantValues;
+
+      // for each constant
+      for (size_t constantIdx = 0; constantIdx < constantValues->size;
+           ++constantIdx) {
+        Node *constantValueNode =
+            body->data.enumDecl.constantValues->elements[constantIdx];
+        size_t constantEntryIdx = constantEntryFind(
+            &enums->constants, constantValues->elements[constantIdx]);
+        if (constantValueNode == NULL) {
+          // depends on previous
+          if (constantIdx == 0) {
+            // no previous entry in this enum - depends on nothing
+            enums->dependencies.elements[constantEntryIdx] = NULL;
           } else {
-            // entry = ...
-            if (constantValueNode->type == NT_LITERAL) {
-              // must be int, char, wchar literal
-              // depends on nothing
-              dependencies.elements[constantEntryIdx] = NULL;
+            // depends on previous entry (is always at current - 1)
+            enums->dependencies.elements[constantEntryIdx] =
+                enums->constants.elements[constantEntryIdx - 1];
+          }
+        } else {
+          // entry = ...
+          if (constantValueNode->type == NT_LITERAL) {
+            // must be int, char, wchar literal
+            // depends on nothing
+            enums->dependencies.elements[constantEntryIdx] = NULL;
+          } else {
+            // depends on another enum - constantValue is a SCOPED_ID
+            // find the enum
+            SymbolTableEntry *stabEntry =
+                environmentLookup(&env, constantValueNode, false);
+            if (stabEntry == NULL) {
+              // error - no such enum
+              errored = true;
+            } else if (stabEntry->kind != SK_ENUMCONST) {
+              size_t line;
+              size_t character;
+              fileListEntryPosition(entry, constantValueNode->offset, &line,
+                                    &character);
+              fprintf(diagnosticStream(),
+                      "%s:%zu:%zu: error: expected an extended integer "
+                      "literal, found %s\n",
+                      entry->inputFilename, line, character,
+                      symbolKindToString(stabEntry->kind));
+              errored = true;
             } else {
-              // depends on another enum - constantValue is a SCOPED_ID
-              // find the enum
-              SymbolTableEntry *stabEntry =
-                  environmentLookup(&env, constantValueNode, false);
-              if (stabEntry == NULL) {
-                // error - no such enum
-                errored = true;
-              } else if (stabEntry->kind != SK_ENUMCONST) {
-                fprintf(stderr,
-                        "%s:%zu:%zu: error: expected an extended integer "
-                        "literal, found %s\n",
-                        entry->inputFilename, constantValueNode->line,
-                        constantValueNode->character,
-                        symbolKindToString(stabEntry->kind));
-                errored = true;
-              } else {
-                dependencies.elements[constantEntryIdx] = stabEntry;
-              }
+              enums->dependencies.elements[constantEntryIdx] = stabEntry;
             }
           }
         }
       }
     }
-
-    environmentUninit(&env);
   }
 
-  if (errored) {
-    vectorUninit(&enumConstants, nullDtor);
-    vectorUninit(&dependencies, nullDtor);
-    vectorUninit(&enumValues, nullDtor);
-    return -1;
-  }
+  environmentUninit(&env);
+  return errored ? -1 : 0;
+}
+int buildTopLevelEnumStab(TopLevelEnums *enums) {
+  size_t const *files = enums->files;
+  size_t numFiles = enums->numFiles;
+  bool errored = false;
 
-  bool *processed = calloc(enumConstants.size, sizeof(bool));
-  for (size_t startIdx = 0; startIdx < enumConstants.size; ++startIdx) {
+  bool *processed = calloc(enums->constants.size, sizeof(bool));
+  for (size_t startIdx = 0; startIdx < enums->constants.size; ++startIdx) {
     if (!processed[startIdx]) {
       typedef struct PathNode {
         size_t curr;
@@ -652,26 +697,36 @@ int buildTopLevelEnumStab(void) {
       path->prev = NULL;
 
       processed[startIdx] = true;
-      if (dependencies.elements[startIdx] != NULL) {
-        size_t curr =
-            constantEntryFind(&enumConstants, dependencies.elements[startIdx]);
+      if (enums->dependencies.elements[startIdx] != NULL &&
+          !constantPrecomputed(enums->dependencies.elements[startIdx], files,
+                               numFiles)) {
+        size_t curr = constantEntryFind(&enums->constants,
+                                        enums->dependencies.elements[startIdx]);
         while (true) {
           // loop that's my problem detected - complain
           if (curr == startIdx) {
             errored = true;
-            SymbolTableEntry *start = enumConstants.elements[startIdx];
-            fprintf(stderr,
+            SymbolTableEntry *start = enums->constants.elements[startIdx];
+            size_t line;
+            size_t character;
+            fileListEntryPosition(start->file, start->offset, &line,
+                                  &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: circular reference in enumeration "
                     "constants\n",
-                    start->file->inputFilename, start->line, start->character);
+                    start->file->inputFilename, line, character);
             PathNode *currPathNode = path;
             while (currPathNode != NULL) {
               currPathNode = currPathNode->prev;
               SymbolTableEntry *currEntry =
-                  enumConstants.elements[currPathNode->curr];
-              fprintf(stderr, "%s:%zu:%zu: note: references above\n",
-                      currEntry->file->inputFilename, currEntry->line,
-                      currEntry->character);
+                  enums->constants.elements[currPathNode->curr];
+              size_t line;
+              size_t character;
+              fileListEntryPosition(currEntry->file, currEntry->offset, &line,
+                                    &character);
+              fprintf(diagnosticStream(),
+                      "%s:%zu:%zu: note: references above\n",
+                      currEntry->file->inputFilename, line, character);
             }
             break;
           }
@@ -694,9 +749,9 @@ int buildTopLevelEnumStab(void) {
           newPath->prev = path;
           path = newPath;
 
-          SymbolTableEntry *dependency = dependencies.elements[startIdx];
+          SymbolTableEntry *dependency = enums->dependencies.elements[startIdx];
           if (dependency == NULL) break;
-          curr = constantEntryFind(&enumConstants, dependency);
+          curr = constantEntryFind(&enums->constants, dependency);
         }
       }
 
@@ -710,24 +765,21 @@ int buildTopLevelEnumStab(void) {
 
   if (errored) {
     free(processed);
-    vectorUninit(&enumConstants, nullDtor);
-    vectorUninit(&dependencies, nullDtor);
-    vectorUninit(&enumValues, nullDtor);
     return -1;
   }
 
   // build the enum values
   size_t numProcessed = 0;
-  memset(processed, 0, sizeof(bool) * enumConstants.size);
-  while (numProcessed < enumConstants.size && !errored) {
-    for (size_t idx = 0; idx < enumConstants.size; ++idx) {
+  memset(processed, 0, sizeof(bool) * enums->constants.size);
+  while (numProcessed < enums->constants.size && !errored) {
+    for (size_t idx = 0; idx < enums->constants.size; ++idx) {
       // for each unprocessed enum
       if (!processed[idx]) {
-        SymbolTableEntry *current = enumConstants.elements[idx];
-        SymbolTableEntry *dependency = dependencies.elements[idx];
+        SymbolTableEntry *current = enums->constants.elements[idx];
+        SymbolTableEntry *dependency = enums->dependencies.elements[idx];
         if (dependency == NULL) {
           // no dependency
-          Node *literal = enumValues.elements[idx];
+          Node *literal = enums->values.elements[idx];
           if (literal == NULL) {
             // has no literal value - must be equal to zero at the start of an
             // enum
@@ -811,10 +863,10 @@ int buildTopLevelEnumStab(void) {
           ++numProcessed;
         } else {
           // depends on something
-          size_t dependencyIdx = constantEntryFind(&enumConstants, dependency);
-          if (processed[dependencyIdx]) {
+          if (constantPrecomputed(dependency, files, numFiles) ||
+              processed[constantEntryFind(&enums->constants, dependency)]) {
             // and dependency is satisfied
-            Node *literal = enumValues.elements[idx];
+            Node *literal = enums->values.elements[idx];
             if (literal == NULL) {
               // is previous plus one
               if (dependency->data.enumConst.signedness) {
@@ -831,11 +883,14 @@ int buildTopLevelEnumStab(void) {
                 if (dependency->data.enumConst.data.unsignedValue ==
                     ULONG_MAX) {
                   errored = true;
-                  fprintf(stderr,
+                  size_t line;
+                  size_t character;
+                  fileListEntryPosition(current->file, current->offset, &line,
+                                        &character);
+                  fprintf(diagnosticStream(),
                           "%s:%zu:%zu: error: unrepresentable enumeration "
                           "constant value - value would overflow a ulong",
-                          current->file->inputFilename, current->line,
-                          current->character);
+                          current->file->inputFilename, line, character);
                   break;
                 }
 
@@ -863,17 +918,13 @@ int buildTopLevelEnumStab(void) {
   }
   free(processed);
 
-  vectorUninit(&enumConstants, nullDtor);
-  vectorUninit(&dependencies, nullDtor);
-  vectorUninit(&enumValues, nullDtor);
-
   if (errored) return -1;
 
   // make all enums be all signed or all unsigned, checking for unrepresentable
   // enums
   // for each enum in each file
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *fileEntry = &fileList.entries[fileIdx];
+  for (size_t fileIdx = 0; fileIdx < numFiles; ++fileIdx) {
+    FileListEntry *fileEntry = &fileList.entries[files[fileIdx]];
     Vector *bodies = fileEntry->ast->data.file.bodies;
 
     // for each top level
@@ -895,12 +946,15 @@ int buildTopLevelEnumStab(void) {
             // must be signed - this is a negative
             if (requiredSign == 1) {
               // unrepresentable enum
-              fprintf(stderr,
+              size_t line;
+              size_t character;
+              fileListEntryPosition(thisEnum->file, thisEnum->offset, &line,
+                                    &character);
+              fprintf(diagnosticStream(),
                       "%s:%zu:%zu: error: unrepresentable enumeration - "
                       "enumeration values must be signed, but are large enough "
                       "to overflow a long",
-                      thisEnum->file->inputFilename, thisEnum->line,
-                      thisEnum->character);
+                      thisEnum->file->inputFilename, line, character);
               errored = true;
               requiredSign = -2;
               break;
@@ -912,13 +966,16 @@ int buildTopLevelEnumStab(void) {
               // must be unsigned - this is greater than LONG_MAX
               if (requiredSign == -1) {
                 // unrepresentable enum
+                size_t line;
+                size_t character;
+                fileListEntryPosition(thisEnum->file, thisEnum->offset, &line,
+                                      &character);
                 fprintf(
-                    stderr,
+                    diagnosticStream(),
                     "%s:%zu:%zu: error: unrepresentable enumeration - "
                     "enumeration values must be signed, but are large enough "
                     "to overflow a long",
-                    thisEnum->file->inputFilename, thisEnum->line,
-                    thisEnum->character);
+                    thisEnum->file->inputFilename, line, character);
                 errored = true;
                 requiredSign = -2;
                 break;
@@ -949,8 +1006,8 @@ int buildTopLevelEnumStab(void) {
 
   // find backing type
   // for each file
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    FileListEntry *fileEntry = &fileList.entries[fileIdx];
+  for (size_t fileIdx = 0; fileIdx < numFiles; ++fileIdx) {
+    FileListEntry *fileEntry = &fileList.entries[files[fileIdx]];
     Vector *bodies = fileEntry->ast->data.file.bodies;
 
     // for each top level enum
@@ -1008,9 +1065,14 @@ int buildTopLevelEnumStab(void) {
 
   return 0;
 }
+void topLevelEnumsUninit(TopLevelEnums *enums) {
+  vectorUninit(&enums->constants, nullDtor);
+  vectorUninit(&enums->dependencies, nullDtor);
+  vectorUninit(&enums->values, nullDtor);
+}
 
 static bool checkScopedIdCollisionsBetween(Node *longImport, Node *shortImport,
-                                           char const *currentFilename) {
+                                           FileListEntry *entry) {
   Node *longName = longImport->data.import.id;
   Node *shortName = shortImport->data.import.id;
   FileListEntry const *longFile = longImport->data.import.referenced;
@@ -1023,13 +1085,13 @@ static bool checkScopedIdCollisionsBetween(Node *longImport, Node *shortImport,
         longName->data.scopedId.components
             ->elements[longName->data.scopedId.components->size - 1];
     SymbolTableEntry *nameMatch =
-        hashMapGet(shortFile->ast->data.file.stab, lastNameNode->data.id.id);
+        hashMapGetId(shortFile->ast->data.file.stab, lastNameNode->data.id.id);
     if (nameMatch != NULL && nameMatch->kind == SK_ENUM) {
       // FIRSTELM is an enum within the shorter
       for (size_t enumIdx = 0;
            enumIdx < nameMatch->data.enumType.constantNames.size; ++enumIdx) {
         // for each enum constant, is it in the longFile?
-        SymbolTableEntry *colliding = hashMapGet(
+        SymbolTableEntry *colliding = hashMapGetId(
             longFile->ast->data.file.stab,
             nameMatch->data.enumType.constantNames.elements[enumIdx]);
         if (colliding != NULL) {
@@ -1037,11 +1099,16 @@ static bool checkScopedIdCollisionsBetween(Node *longImport, Node *shortImport,
           char *collidingName = format(
               "%s::%s", longNameString,
               (char *)nameMatch->data.enumType.constantNames.elements[enumIdx]);
-          fprintf(stderr, "%s:%zu:%zu: error: '%s' introduced multiple times\n",
-                  currentFilename, longImport->line, longImport->character,
-                  collidingName);
-          fprintf(stderr, "%s:%zu:%zu: note: also introduced here\n",
-                  currentFilename, shortImport->line, shortImport->character);
+          size_t line;
+          size_t character;
+          fileListEntryPosition(entry, longImport->offset, &line, &character);
+          fprintf(diagnosticStream(),
+                  "%s:%zu:%zu: error: '%s' introduced multiple times\n",
+                  entry->inputFilename, line, character, collidingName);
+          fileListEntryPosition(entry, shortImport->offset, &line, &character);
+          fprintf(diagnosticStream(),
+                  "%s:%zu:%zu: note: also introduced here\n",
+                  entry->inputFilename, line, character);
           free(longNameString);
           free(collidingName);
           return true;
@@ -1063,24 +1130,29 @@ static bool checkScopedIdCollisionsWithCurrent(Node *import,
         fileName->data.scopedId.components
             ->elements[fileName->data.scopedId.components->size - 1];
     SymbolTableEntry *nameMatch =
-        hashMapGet(importFile->ast->data.file.stab, lastNameNode->data.id.id);
+        hashMapGetId(importFile->ast->data.file.stab, lastNameNode->data.id.id);
     if (nameMatch != NULL && nameMatch->kind == SK_ENUM) {
       // FIRSTELM is an enum within the import
       for (size_t enumIdx = 0;
            enumIdx < nameMatch->data.enumType.constantNames.size; ++enumIdx) {
         // for each enum constant, is it in the current module?
-        SymbolTableEntry *colliding = hashMapGet(
+        SymbolTableEntry *colliding = hashMapGetId(
             entry->ast->data.file.stab,
             nameMatch->data.enumType.constantNames.elements[enumIdx]);
         if (colliding != NULL) {
+          size_t line;
+          size_t character;
+          fileListEntryPosition(entry, colliding->offset, &line, &character);
           fprintf(
-              stderr,
+              diagnosticStream(),
               "%s:%zu:%zu: error: '%s' collides with imported scoped "
               "identifier\n",
-              entry->inputFilename, colliding->line, colliding->character,
+              entry->inputFilename, line, character,
               (char *)nameMatch->data.enumType.constantNames.elements[enumIdx]);
-          fprintf(stderr, "%s:%zu:%zu: note: also introduced here\n",
-                  entry->inputFilename, import->line, import->character);
+          fileListEntryPosition(entry, import->offset, &line, &character);
+          fprintf(diagnosticStream(),
+                  "%s:%zu:%zu: note: also introduced here\n",
+                  entry->inputFilename, line, character);
           return true;
         }
       }
@@ -1092,27 +1164,32 @@ static bool checkScopedIdCollisionsWithCurrent(Node *import,
         importName->data.scopedId.components
             ->elements[importName->data.scopedId.components->size - 1];
     SymbolTableEntry *nameMatch =
-        hashMapGet(entry->ast->data.file.stab, lastNameNode->data.id.id);
+        hashMapGetId(entry->ast->data.file.stab, lastNameNode->data.id.id);
     if (nameMatch != NULL && nameMatch->kind == SK_ENUM) {
       // FIRSTELM is an enum within the current module
       for (size_t enumIdx = 0;
            enumIdx < nameMatch->data.enumType.constantNames.size; ++enumIdx) {
         // for each enum constant, is it in the import?
-        SymbolTableEntry *colliding = hashMapGet(
+        SymbolTableEntry *colliding = hashMapGetId(
             importFile->ast->data.file.stab,
             nameMatch->data.enumType.constantNames.elements[enumIdx]);
         if (colliding != NULL) {
           SymbolTableEntry *collidingEntry =
               nameMatch->data.enumType.constantValues.elements[enumIdx];
+          size_t line;
+          size_t character;
+          fileListEntryPosition(entry, collidingEntry->offset, &line,
+                                &character);
           fprintf(
-              stderr,
+              diagnosticStream(),
               "%s:%zu:%zu: error: '%s' collides with imported scoped "
               "identifier\n",
-              entry->inputFilename, collidingEntry->line,
-              collidingEntry->character,
+              entry->inputFilename, line, character,
               (char *)nameMatch->data.enumType.constantNames.elements[enumIdx]);
-          fprintf(stderr, "%s:%zu:%zu: note: also introduced here\n",
-                  entry->inputFilename, import->line, import->character);
+          fileListEntryPosition(entry, import->offset, &line, &character);
+          fprintf(diagnosticStream(),
+                  "%s:%zu:%zu: note: also introduced here\n",
+                  entry->inputFilename, line, character);
           return true;
         }
       }
@@ -1137,8 +1214,8 @@ void checkScopedIdCollisions(FileListEntry *entry) {
     for (size_t shortIdx = 0; shortIdx < imports->size; ++shortIdx) {
       Node *shortImport = imports->elements[shortIdx];
       entry->errored =
-          entry->errored || checkScopedIdCollisionsBetween(
-                                longImport, shortImport, entry->inputFilename);
+          entry->errored ||
+          checkScopedIdCollisionsBetween(longImport, shortImport, entry);
     }
 
     // check for problems with current module
@@ -1164,15 +1241,12 @@ void finishStructStab(FileListEntry *entry, Node *body,
       Type *existing = structLookupField(stabEntry, name->data.id.id);
       if (existing != NULL) {
         // already exists - complain!
-        errorRedeclaration(entry, name->line, name->character, name->data.id.id,
-                           stabEntry->file, stabEntry->line,
-                           stabEntry->character);
+        errorRedeclaration(entry, name->offset, name->data.id.id,
+                           stabEntry->file, stabEntry->offset);
       } else {
-        vectorInsert(&stabEntry->data.structType.fieldNames, name->data.id.id);
-        vectorInsert(&stabEntry->data.structType.fieldTypes, typeCopy(type));
+        structAddField(stabEntry, name->data.id.id, type);
       }
     }
-    typeFree(type);
   }
 }
 
@@ -1193,15 +1267,12 @@ void finishUnionStab(FileListEntry *entry, Node *body,
       Type *existing = unionLookupOption(stabEntry, name->data.id.id);
       if (existing != NULL) {
         // already exists - complain!
-        errorRedeclaration(entry, name->line, name->character, name->data.id.id,
-                           stabEntry->file, stabEntry->line,
-                           stabEntry->character);
+        errorRedeclaration(entry, name->offset, name->data.id.id,
+                           stabEntry->file, stabEntry->offset);
       } else {
-        vectorInsert(&stabEntry->data.unionType.optionNames, name->data.id.id);
-        vectorInsert(&stabEntry->data.unionType.optionTypes, typeCopy(type));
+        unionAddOption(stabEntry, name->data.id.id, type);
       }
     }
-    typeFree(type);
   }
 }
 
@@ -1223,13 +1294,12 @@ void finishEnumStab(FileListEntry *entry, Node *body,
         enumLookupEnumConst(stabEntry, constantName->data.id.id);
     if (existing != NULL) {
       // already exists - complain!
-      errorRedeclaration(entry, constantName->line, constantName->character,
-                         constantName->data.id.id, existing->file,
-                         existing->line, existing->character);
+      errorRedeclaration(entry, constantName->offset, constantName->data.id.id,
+                         existing->file, existing->offset);
       errored = true;
     } else {
       constantName->data.id.entry = enumConstStabEntryCreate(
-          entry, constantName->line, constantName->character,
+          entry, constantName->offset,
           constantName->data.id.id, stabEntry);
 
       vectorInsert(&stabEntry->data.enumType.constantNames,
@@ -1282,11 +1352,14 @@ void finishEnumStab(FileListEntry *entry, Node *body,
           // error - no such enum
           errored = true;
         } else if (stabEntry->kind != SK_ENUMCONST) {
-          fprintf(stderr,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(entry, constantValueNode->offset, &line,
+                                &character);
+          fprintf(diagnosticStream(),
                   "%s:%zu:%zu: error: expected an extended integer "
                   "literal, found %s\n",
-                  entry->inputFilename, constantValueNode->line,
-                  constantValueNode->character,
+                  entry->inputFilename, line, character,
                   symbolKindToString(stabEntry->kind));
           errored = true;
         } else {
@@ -1316,7 +1389,9 @@ void finishEnumStab(FileListEntry *entry, Node *body,
       path->prev = NULL;
 
       processed[startIdx] = true;
-      if (dependencies.elements[startIdx] != NULL) {
+      SymbolTableEntry *startDependency = dependencies.elements[startIdx];
+      if (startDependency != NULL &&
+          startDependency->data.enumConst.parent == stabEntry) {
         size_t curr =
             constantEntryFind(&enumConstants, dependencies.elements[startIdx]);
         while (true) {
@@ -1324,18 +1399,26 @@ void finishEnumStab(FileListEntry *entry, Node *body,
           if (curr == startIdx) {
             errored = true;
             SymbolTableEntry *start = enumConstants.elements[startIdx];
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(start->file, start->offset, &line,
+                                  &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: circular reference in enumeration "
                     "constants\n",
-                    start->file->inputFilename, start->line, start->character);
+                    start->file->inputFilename, line, character);
             PathNode *currPathNode = path;
             while (currPathNode != NULL) {
               currPathNode = currPathNode->prev;
               SymbolTableEntry *currEntry =
                   enumConstants.elements[currPathNode->curr];
-              fprintf(stderr, "%s:%zu:%zu: note: references above\n",
-                      currEntry->file->inputFilename, currEntry->line,
-                      currEntry->character);
+              size_t line;
+              size_t character;
+              fileListEntryPosition(currEntry->file, currEntry->offset, &line,
+                                    &character);
+              fprintf(diagnosticStream(),
+                      "%s:%zu:%zu: note: references above\n",
+                      currEntry->file->inputFilename, line, character);
             }
             break;
           }
@@ -1475,8 +1558,8 @@ void finishEnumStab(FileListEntry *entry, Node *body,
           ++numProcessed;
         } else {
           // depends on something
-          size_t dependencyIdx = constantEntryFind(&enumConstants, dependency);
-          if (processed[dependencyIdx]) {
+          if (dependency->data.enumConst.parent != stabEntry ||
+              processed[constantEntryFind(&enumConstants, dependency)]) {
             // and dependency is satisfied
             Node *literal = enumValues.elements[idx];
             if (literal == NULL) {
@@ -1495,11 +1578,14 @@ void finishEnumStab(FileListEntry *entry, Node *body,
                 if (dependency->data.enumConst.data.unsignedValue ==
                     ULONG_MAX) {
                   errored = true;
-                  fprintf(stderr,
+                  size_t line;
+                  size_t character;
+                  fileListEntryPosition(current->file, current->offset, &line,
+                                        &character);
+                  fprintf(diagnosticStream(),
                           "%s:%zu:%zu: error: unrepresentable enumeration "
                           "constant value - value would overflow a ulong",
-                          current->file->inputFilename, current->line,
-                          current->character);
+                          current->file->inputFilename, line, character);
                   break;
                 }
 
@@ -1543,12 +1629,15 @@ void finishEnumStab(FileListEntry *entry, Node *body,
       // must be signed - this is a negative
       if (requiredSign == 1) {
         // unrepresentable enum
-        fprintf(stderr,
+        size_t line;
+        size_t character;
+        fileListEntryPosition(stabEntry->file, stabEntry->offset, &line,
+                              &character);
+        fprintf(diagnosticStream(),
                 "%s:%zu:%zu: error: unrepresentable enumeration - "
                 "enumeration values must be signed, but are large enough "
                 "to overflow a long",
-                stabEntry->file->inputFilename, stabEntry->line,
-                stabEntry->character);
+                stabEntry->file->inputFilename, line, character);
         errored = true;
         requiredSign = -2;
         break;
@@ -1560,12 +1649,15 @@ void finishEnumStab(FileListEntry *entry, Node *body,
         // must be unsigned - this is greater than LONG_MAX
         if (requiredSign == -1) {
           // unrepresentable enum
-          fprintf(stderr,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(stabEntry->file, stabEntry->offset, &line,
+                                &character);
+          fprintf(diagnosticStream(),
                   "%s:%zu:%zu: error: unrepresentable enumeration - "
                   "enumeration values must be signed, but are large enough "
                   "to overflow a long",
-                  stabEntry->file->inputFilename, stabEntry->line,
-                  stabEntry->character);
+                  stabEntry->file->inputFilename, line, character);
           errored = true;
           requiredSign = -2;
           break;
@@ -1674,9 +1766,8 @@ void finishTopLevelStab(FileListEntry *entry) {
 
         for (size_t nameIdx = 0; nameIdx < names->size; ++nameIdx) {
           Node *name = names->elements[nameIdx];
-          name->data.id.entry->data.variable.type = typeCopy(type);
+          name->data.id.entry->data.variable.type = type;
         }
-        typeFree(type);
 
         break;
       }
@@ -1694,31 +1785,38 @@ void finishTopLevelStab(FileListEntry *entry) {
           char const *nameString = name->data.id.id;
           SymbolTableEntry *existing =
               implicitStab == NULL ? NULL
-                                   : hashMapGet(implicitStab, nameString);
+                                   : hashMapGetId(implicitStab, nameString);
           if (existing != NULL && existing->data.variable.type != NULL &&
               !typeEqual(existing->data.variable.type, type)) {
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, name->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: redeclaration of %s as a variable of a "
                     "different type\n",
-                    entry->inputFilename, name->line, name->character,
-                    nameString);
-            fprintf(stderr, "%s:%zu:%zu: note: previously declared here\n",
-                    existing->file->inputFilename, existing->line,
-                    existing->character);
+                    entry->inputFilename, line, character, nameString);
+            fileListEntryPosition(existing->file, existing->offset, &line,
+                                  &character);
+            fprintf(diagnosticStream(),
+                    "%s:%zu:%zu: note: previously declared here\n",
+                    existing->file->inputFilename, line, character);
             entry->errored = true;
           }
 
-          name->data.id.entry->data.variable.type = typeCopy(type);
+          name->data.id.entry->data.variable.type = type;
 
           Node *initializer = initializers->elements[nameIdx];
           if (initializer != NULL && initializer->type == NT_SCOPEDID) {
             SymbolTableEntry *enumConst =
                 environmentLookup(&env, initializer, false);
             if (enumConst != NULL && enumConst->kind != SK_ENUMCONST) {
-              fprintf(stderr,
+              size_t line;
+              size_t character;
+              fileListEntryPosition(entry, initializer->offset, &line,
+                                    &character);
+              fprintf(diagnosticStream(),
                       "%s:%zu:%zu: error: expected a value literal, found %s\n",
-                      entry->inputFilename, initializer->line,
-                      initializer->character,
+                      entry->inputFilename, line, character,
                       symbolKindToString(enumConst->kind));
               entry->errored = true;
             }
@@ -1726,8 +1824,6 @@ void finishTopLevelStab(FileListEntry *entry) {
           }
         }
 
-        typeFree(type);
-
         break;
       }
       case NT_FUNDECL: {
@@ -1757,7 +1853,7 @@ void finishTopLevelStab(FileListEntry *entry) {
       case NT_FUNDEFN: {
         char const *name = body->data.funDefn.name->data.id.id;
         SymbolTableEntry *existing =
-            implicitStab == NULL ? NULL : hashMapGet(implicitStab, name);
+            implicitStab == NULL ? NULL : hashMapGetId(implicitStab, name);
         bool mismatch = false;
 
         Type *returnType = nodeToType(body->data.funDefn.returnType, &env);
@@ -1768,13 +1864,18 @@ void finishTopLevelStab(FileListEntry *entry) {
         if (existing != NULL && existing->data.function.returnType != NULL &&
             !typeEqual(existing->data.function.returnType, returnType)) {
           // redeclaration of function with different type
-          fprintf(stderr,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(entry, body->offset, &line, &character);
+          fprintf(diagnosticStream(),
                   "%s:%zu:%zu: error: redeclaration of %s as a function of a "
                   "different type\n",
-                  entry->inputFilename, body->line, body->character, name);
-          fprintf(stderr, "%s:%zu:%zu: note: previously declared here\n",
-                  existing->file->inputFilename, existing->line,
-                  existing->character);
+                  entry->inputFilename, line, character, name);
+          fileListEntryPosition(existing->file, existing->offset, &line,
+                                &character);
+          fprintf(diagnosticStream(),
+                  "%s:%zu:%zu: note: previously declared here\n",
+                  existing->file->inputFilename, line, character);
           entry->errored = true;
           mismatch = true;
         }
@@ -1796,13 +1897,18 @@ void finishTopLevelStab(FileListEntry *entry) {
                          argType) &&
               !mismatch) {
             // redeclaration of function with different type
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, body->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: redeclaration of %s as a function of a "
                     "different type\n",
-                    entry->inputFilename, body->line, body->character, name);
-            fprintf(stderr, "%s:%zu:%zu: note: previously declared here\n",
-                    existing->file->inputFilename, existing->line,
-                    existing->character);
+                    entry->inputFilename, line, character, name);
+            fileListEntryPosition(existing->file, existing->offset, &line,
+                                  &character);
+            fprintf(diagnosticStream(),
+                    "%s:%zu:%zu: note: previously declared here\n",
+                    existing->file->inputFilename, line, character);
             entry->errored = true;
             mismatch = true;
           }
@@ -25,7 +25,10 @@
 #ifndef TLC_PARSER_BUILDSTAB_H_
 #define TLC_PARSER_BUILDSTAB_H_
 
+#include <stddef.h>
+
 #include "fileList.h"
+#include "util/container/vector.h"
 
 /**
  * builds the module map, checking for any errors, and links the import
@@ -46,12 +49,56 @@ int resolveImports(void);
  */
 void startTopLevelStab(FileListEntry *entry);
 
+/** the top level enum constants of a group of files, completed together */
+typedef struct {
+  size_t const *files; /**< indices of the files, in increasing order */
+  size_t numFiles;
+  Vector constants;    /**< vector of SymbolTableEntry, non-owning */
+  Vector dependencies; /**< vector of SymbolTableEntry each constant depends
+                            on, non-owning, nullable */
+  Vector values;       /**< vector of extended int literals, non-owning,
+                            nullable */
+} TopLevelEnums;
+
 /**
- * completes the symbol table for enums at the top level
+ * collects the enum constants at the top level of a group of files
+ *
+ * Enumeration constants in the group may refer to each other
  *
+ * @param enums TopLevelEnums to initialize
+ * @param files indices of the files in the group, in increasing order
+ * @param numFiles number of files in the group
+ */
+void topLevelEnumsInit(TopLevelEnums *enums, size_t const *files,
+                       size_t numFiles);
+
+/**
+ * looks up the constants referred to by the enum constants at the top level of
+ * one file of the group
+ *
+ * @param enums TopLevelEnums of the group
+ * @param entry file to process
  * @returns 0 if everything is OK, -1 otherwise
  */
-int buildTopLevelEnumStab(void);
+int resolveTopLevelEnums(TopLevelEnums *enums, FileListEntry *entry);
+
+/**
+ * completes the symbol table for enums at the top level of a group of files
+ *
+ * Every file in the group must have been resolved, and any constants referred
+ * to outside the group must already be complete
+ *
+ * @param enums TopLevelEnums of the group
+ * @returns 0 if everything is OK, -1 otherwise
+ */
+int buildTopLevelEnumStab(TopLevelEnums *enums);
+
+/**
+ * deinitializes a TopLevelEnums
+ *
+ * @param enums TopLevelEnums to deinitialize
+ */
+void topLevelEnumsUninit(TopLevelEnums *enums);
 
 /**
  * checks the imports for scoped id collisions among imports
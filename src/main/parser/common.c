@@ -23,6 +23,7 @@
 
 #include "fileList.h"
 #include "util/conversions.h"
+#include "util/diagnostics.h"
 
 /** array between token type (as int) and token name */
 static char const *const TOKEN_DESCRIPTORS[] = {
@@ -140,8 +141,11 @@ static char const *const TOKEN_DESCRIPTORS[] = {
 
 void errorExpectedString(FileListEntry *entry, char const *expected,
                          Token const *actual) {
-  fprintf(stderr, "%s:%zu:%zu: error: expected %s, but found %s\n",
-          entry->inputFilename, actual->line, actual->character, expected,
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, actual->offset, &line, &character);
+  fprintf(diagnosticStream(), "%s:%zu:%zu: error: expected %s, but found %s\n",
+          entry->inputFilename, line, character, expected,
           TOKEN_DESCRIPTORS[actual->type]);
   entry->errored = true;
 }
@@ -149,17 +153,25 @@ void errorExpectedToken(FileListEntry *entry, TokenType expected,
                         Token const *actual) {
   errorExpectedString(entry, TOKEN_DESCRIPTORS[expected], actual);
 }
-void errorRedeclaration(FileListEntry *file, size_t line, size_t character,
-                        char const *name, FileListEntry *collidingFile,
-                        size_t collidingLine, size_t collidingChar) {
-  fprintf(stderr, "%s:%zu:%zu: error: redeclaration of %s\n",
+void errorRedeclaration(FileListEntry *file, uint32_t offset, char const *name,
+                        FileListEntry *collidingFile,
+                        uint32_t collidingOffset) {
+  size_t line;
+  size_t character;
+  fileListEntryPosition(file, offset, &line, &character);
+  fprintf(diagnosticStream(), "%s:%zu:%zu: error: redeclaration of %s\n",
           file->inputFilename, line, character, name);
-  fprintf(stderr, "%s:%zu:%zu: note: previously declared here\n",
-          collidingFile->inputFilename, collidingLine, collidingChar);
+  fileListEntryPosition(collidingFile, collidingOffset, &line, &character);
+  fprintf(diagnosticStream(), "%s:%zu:%zu: note: previously declared here\n",
+          collidingFile->inputFilename, line, character);
   file->errored = true;
 }
 void errorIntOverflow(FileListEntry *entry, Token *token) {
-  fprintf(stderr, "%s:%zu:%zu: error: integer constant is too large\n",
-          entry->inputFilename, token->line, token->character);
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, token->offset, &line, &character);
+  fprintf(diagnosticStream(),
+          "%s:%zu:%zu: error: integer constant is too large\n",
+          entry->inputFilename, line, character);
   entry->errored = true;
 }
\ No newline at end of file
@@ -52,16 +52,14 @@ void errorExpectedToken(FileListEntry *entry, TokenType expected,
  * complain about a redeclaration
  *
  * @param file file containing the redeclaration
- * @param line line of the redeclaration
- * @param character character of the redeclaration
+ * @param offset offset of the redeclaration
  * @param name colliding name
  * @param collidingFile file containing the original declaration
- * @param collidingLine line of the original declaration
- * @param collidingChar character of the original declaration
+ * @param collidingOffset offset of the original declaration
  */
-void errorRedeclaration(FileListEntry *file, size_t line, size_t character,
-                        char const *name, FileListEntry *collidingFile,
-                        size_t collidingLine, size_t collidingChar);
+void errorRedeclaration(FileListEntry *file, uint32_t offset, char const *name,
+                        FileListEntry *collidingFile,
+                        uint32_t collidingOffset);
 
 /**
  * prints an error complaining about a too-large integral value
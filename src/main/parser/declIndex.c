@@ -0,0 +1,797 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Precompiled declaration modules
+//
+// An index is a stream of unsigned LEB128 numbers and NUL-terminated strings.
+// Identifiers are interned as they are read. Module names are used in place,
+// so the index stays mapped until it is unloaded.
+//
+// index := magic version sourceHash modules module imports entries
+// modules := count (name hash)*
+// module := offset name
+// imports := count (offset name)*
+// name := count (string offset)*
+// entries := count (kind id offset data)*
+//
+// entry data depends on the symbol kind:
+//  - opaque: nothing (definitions only come from code files)
+//  - struct, union: count (string type)*
+//  - enum: backingType count (string offset signedness value)*
+//  - typedef, variable: type
+//  - function: returnType count type*
+//
+// type := kind data, where reference types are written as the index of the
+// module they come from (zero for the current module, otherwise one plus the
+// index into modules) and the referenced entry's id
+
+#include "parser/declIndex.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ast/ast.h"
+#include "ast/symbolTable.h"
+#include "ast/type.h"
+#include "util/diagnostics.h"
+#include "util/format.h"
+#include "util/functional.h"
+#include "util/hash.h"
+#include "util/intern.h"
+#include "util/serialize.h"
+
+/** identifies a precompiled declaration module */
+static char const DECL_INDEX_MAGIC[8] = "TLC-TDI";
+/** version of the format - must be changed whenever the format changes */
+static uint64_t const DECL_INDEX_VERSION = 2;
+
+/** a reference type whose entry has yet to be resolved */
+typedef struct {
+  Type *type;     /**< non-owning reference to the type to resolve */
+  size_t module;  /**< zero for the current module, else one plus the index */
+  char const *id; /**< id of the referenced entry */
+} DeclIndexReference;
+
+/** a cursor into a mapped index */
+typedef struct {
+  uint8_t const *current;
+  uint8_t const *end;
+  bool errored; /**< has the cursor run off the end or read bad data */
+} Reader;
+
+static uint64_t readNumber(Reader *r) {
+  uint64_t value = 0;
+  for (unsigned shift = 0; shift < 64 && r->current != r->end; shift += 7) {
+    uint8_t byte = *r->current++;
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return value;
+  }
+  r->errored = true;
+  return 0;
+}
+
+static char const *readString(Reader *r) {
+  uint8_t const *terminator =
+      memchr(r->current, '\0', (size_t)(r->end - r->current));
+  if (terminator == NULL) {
+    r->errored = true;
+    return "";
+  }
+  char const *s = (char const *)r->current;
+  r->current = terminator + 1;
+  return s;
+}
+
+/**
+ * reads an identifier, interning it
+ */
+static char *readId(Reader *r) {
+  char const *s = readString(r);
+  return intern(s, strlen(s));
+}
+
+/**
+ * reads a count of things that each take at least one byte
+ */
+static size_t readCount(Reader *r) {
+  uint64_t count = readNumber(r);
+  if (count > (uint64_t)(r->end - r->current)) {
+    r->errored = true;
+    return 0;
+  }
+  return (size_t)count;
+}
+
+/**
+ * reads a source offset
+ */
+static uint32_t readOffset(Reader *r) {
+  uint64_t offset = readNumber(r);
+  if (offset > UINT32_MAX) {
+    r->errored = true;
+    return 0;
+  }
+  return (uint32_t)offset;
+}
+
+static Node *readIdComponent(Reader *r) {
+  Token token;
+  token.type = TT_ID;
+  token.string = readId(r);
+  token.offset = readOffset(r);
+  return idNodeCreate(&token);
+}
+
+static Node *readName(Reader *r) {
+  size_t numComponents = readCount(r);
+  if (r->errored || numComponents == 0) {
+    r->errored = true;
+    return NULL;
+  }
+
+  if (numComponents == 1) {
+    Node *id = readIdComponent(r);
+    if (!r->errored) return id;
+    nodeFree(id);
+    return NULL;
+  }
+
+  Vector *components = vectorCreate();
+  for (size_t idx = 0; idx < numComponents && !r->errored; ++idx)
+    vectorInsert(components, readIdComponent(r));
+  if (r->errored) {
+    nodeVectorFree(components);
+    return NULL;
+  }
+  return scopedIdNodeCreate(components);
+}
+
+static Type *readType(Reader *r, DeclIndex *index) {
+  switch (readNumber(r)) {
+    case TK_KEYWORD: {
+      uint64_t keyword = readNumber(r);
+      if (r->errored || keyword > TK_BOOL) break;
+      return keywordTypeCreate((TypeKeyword)keyword);
+    }
+    case TK_QUALIFIED: {
+      bool constQual = readNumber(r) != 0;
+      bool volatileQual = readNumber(r) != 0;
+      Type *base = readType(r, index);
+      if (base == NULL) return NULL;
+      return qualifiedTypeCreate(base, constQual, volatileQual);
+    }
+    case TK_POINTER: {
+      Type *base = readType(r, index);
+      if (base == NULL) return NULL;
+      return pointerTypeCreate(base);
+    }
+    case TK_ARRAY: {
+      uint64_t length = readNumber(r);
+      Type *type = readType(r, index);
+      if (type == NULL) return NULL;
+      return arrayTypeCreate(length, type);
+    }
+    case TK_FUNPTR: {
+      Type *returnType = readType(r, index);
+      if (returnType == NULL) return NULL;
+      Vector argTypes;
+      vectorInit(&argTypes);
+      size_t numArgs = readCount(r);
+      for (size_t idx = 0; idx < numArgs && !r->errored; ++idx) {
+        Type *argType = readType(r, index);
+        if (argType != NULL) vectorInsert(&argTypes, argType);
+      }
+      if (!r->errored) return funPtrTypeCreate(returnType, &argTypes);
+      vectorUninit(&argTypes, nullDtor);
+      return NULL;
+    }
+    case TK_AGGREGATE: {
+      Vector types;
+      vectorInit(&types);
+      size_t numTypes = readCount(r);
+      for (size_t idx = 0; idx < numTypes && !r->errored; ++idx) {
+        Type *type = readType(r, index);
+        if (type != NULL) vectorInsert(&types, type);
+      }
+      if (!r->errored) return aggregateTypeCreate(&types);
+      vectorUninit(&types, nullDtor);
+      return NULL;
+    }
+    case TK_REFERENCE: {
+      uint64_t module = readNumber(r);
+      char const *id = readId(r);
+      if (r->errored || module > index->numModules) break;
+      DeclIndexReference *reference = malloc(sizeof(DeclIndexReference));
+      reference->type = unresolvedReferenceTypeCreate();
+      reference->module = (size_t)module;
+      reference->id = id;
+      vectorInsert(&index->references, reference);
+      return reference->type;
+    }
+    default: {
+      break;
+    }
+  }
+  r->errored = true;
+  return NULL;
+}
+
+/**
+ * reads a struct or union's fields
+ */
+static void readFields(Reader *r, DeclIndex *index, SymbolTableEntry *entry,
+                       void (*add)(SymbolTableEntry *, char const *, Type *)) {
+  size_t numFields = readCount(r);
+  for (size_t idx = 0; idx < numFields && !r->errored; ++idx) {
+    char const *name = readId(r);
+    Type *type = readType(r, index);
+    if (type != NULL) add(entry, name, type);
+  }
+}
+
+static void readEnumConstants(Reader *r, FileListEntry *entry,
+                              SymbolTableEntry *enumEntry) {
+  size_t numConstants = readCount(r);
+  for (size_t idx = 0; idx < numConstants && !r->errored; ++idx) {
+    char const *name = readId(r);
+    uint32_t offset = readOffset(r);
+    SymbolTableEntry *constant =
+        enumConstStabEntryCreate(entry, offset, name, enumEntry);
+    constant->data.enumConst.signedness = readNumber(r) != 0;
+    constant->data.enumConst.data.unsignedValue = readNumber(r);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    vectorInsert(&enumEntry->data.enumType.constantNames, name);
+#pragma GCC diagnostic pop
+    vectorInsert(&enumEntry->data.enumType.constantValues, constant);
+  }
+}
+
+static void readEntries(Reader *r, FileListEntry *entry, DeclIndex *index,
+                        HashMap *stab) {
+  size_t numEntries = readCount(r);
+  for (size_t idx = 0; idx < numEntries && !r->errored; ++idx) {
+    uint64_t kind = readNumber(r);
+    char const *id = readId(r);
+    uint32_t offset = readOffset(r);
+    if (r->errored) return;
+
+    SymbolTableEntry *stabEntry;
+    switch (kind) {
+      case SK_OPAQUE: {
+        stabEntry = opaqueStabEntryCreate(entry, offset, id);
+        break;
+      }
+      case SK_STRUCT: {
+        stabEntry = structStabEntryCreate(entry, offset, id);
+        readFields(r, index, stabEntry, structAddField);
+        break;
+      }
+      case SK_UNION: {
+        stabEntry = unionStabEntryCreate(entry, offset, id);
+        readFields(r, index, stabEntry, unionAddOption);
+        break;
+      }
+      case SK_ENUM: {
+        stabEntry = enumStabEntryCreate(entry, offset, id);
+        stabEntry->data.enumType.backingType = readType(r, index);
+        readEnumConstants(r, entry, stabEntry);
+        break;
+      }
+      case SK_TYPEDEF: {
+        stabEntry = typedefStabEntryCreate(entry, offset, id);
+        stabEntry->data.typedefType.actual = readType(r, index);
+        break;
+      }
+      case SK_VARIABLE: {
+        stabEntry = variableStabEntryCreate(entry, offset, id);
+        stabEntry->data.variable.type = readType(r, index);
+        break;
+      }
+      case SK_FUNCTION: {
+        stabEntry = functionStabEntryCreate(entry, offset, id);
+        stabEntry->data.function.returnType = readType(r, index);
+        size_t numArgs = readCount(r);
+        for (size_t argIdx = 0; argIdx < numArgs && !r->errored; ++argIdx) {
+          Type *argType = readType(r, index);
+          if (argType != NULL)
+            vectorInsert(&stabEntry->data.function.argumentTypes, argType);
+        }
+        break;
+      }
+      default: {
+        r->errored = true;
+        return;
+      }
+    }
+
+    if (hashMapPutId(stab, id, stabEntry) != 0) {
+      stabEntryFree(stabEntry);
+      r->errored = true;
+    }
+  }
+}
+
+/**
+ * reads a module or import statement
+ *
+ * @param r reader to read from
+ * @param keywordType type of the statement's keyword
+ * @returns statement node, or NULL if the index is malformed
+ */
+static Node *readStatement(Reader *r, TokenType keywordType) {
+  Token keyword;
+  keyword.type = keywordType;
+  keyword.offset = readOffset(r);
+  keyword.string = NULL;
+  Node *name = readName(r);
+  if (name == NULL) return NULL;
+  return keywordType == TT_MODULE ? moduleNodeCreate(&keyword, name)
+                                  : importNodeCreate(&keyword, name);
+}
+
+/**
+ * reads the stub AST for a module
+ *
+ * @returns AST, or NULL if the index is malformed
+ */
+static Node *readFile(Reader *r, FileListEntry *entry, DeclIndex *index) {
+  Arena *arena = arenaCreate();
+  nodeArenaSet(arena);
+
+  Node *module = readStatement(r, TT_MODULE);
+  if (module == NULL) {
+    nodeArenaSet(NULL);
+    arenaFree(arena);
+    return NULL;
+  }
+
+  Vector *imports = vectorCreate();
+  size_t numImports = readCount(r);
+  for (size_t idx = 0; idx < numImports && !r->errored; ++idx) {
+    Node *import = readStatement(r, TT_IMPORT);
+    if (import != NULL) vectorInsert(imports, import);
+  }
+
+  Node *file = fileNodeCreate(module, imports, vectorCreate(), arena);
+  readEntries(r, entry, index, file->data.file.stab);
+  nodeArenaSet(NULL);
+  if (r->errored || r->current != r->end) {
+    nodeFree(file);
+    return NULL;
+  }
+  return file;
+}
+
+static void declIndexFree(DeclIndex *index) {
+  munmap(index->map, index->length);
+  free(index->moduleNames);
+  free(index->moduleHashes);
+  free(index->modules);
+  vectorUninit(&index->references, free);
+  free(index);
+}
+
+int declIndexLoad(FileListEntry *entry) {
+  LexerState *source = &entry->lexerState;
+  entry->sourceHash = fnv1a(source->map, source->length);
+
+  char *indexFilename = format("%si", entry->inputFilename);
+  int fd = open(indexFilename, O_RDONLY);
+  free(indexFilename);
+  if (fd == -1) return -1;
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) != 0 || statbuf.st_size == 0) {
+    close(fd);
+    return -1;
+  }
+  size_t length = (size_t)statbuf.st_size;
+  char *map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == (void *)-1) return -1;
+
+  DeclIndex *index = malloc(sizeof(DeclIndex));
+  index->map = map;
+  index->length = length;
+  index->numModules = 0;
+  index->moduleNames = NULL;
+  index->moduleHashes = NULL;
+  index->modules = NULL;
+  vectorInit(&index->references);
+
+  Reader r = {(uint8_t const *)map, (uint8_t const *)map + length, false};
+  if (length < sizeof(DECL_INDEX_MAGIC) ||
+      memcmp(map, DECL_INDEX_MAGIC, sizeof(DECL_INDEX_MAGIC)) != 0) {
+    declIndexFree(index);
+    return -1;
+  }
+  r.current += sizeof(DECL_INDEX_MAGIC);
+  if (readNumber(&r) != DECL_INDEX_VERSION ||
+      readNumber(&r) != entry->sourceHash || r.errored) {
+    declIndexFree(index);
+    return -1;
+  }
+
+  size_t numModules = readCount(&r);
+  index->moduleNames = malloc(sizeof(char const *) * numModules);
+  index->moduleHashes = malloc(sizeof(uint64_t) * numModules);
+  index->modules = malloc(sizeof(FileListEntry *) * numModules);
+  for (; index->numModules < numModules && !r.errored; ++index->numModules) {
+    index->moduleNames[index->numModules] = readString(&r);
+    index->moduleHashes[index->numModules] = readNumber(&r);
+    index->modules[index->numModules] = NULL;
+  }
+
+  Node *ast = r.errored ? NULL : readFile(&r, entry, index);
+  if (ast == NULL) {
+    declIndexFree(index);
+    return -1;
+  }
+
+  entry->ast = ast;
+  entry->declIndex = index;
+  return 0;
+}
+
+int declIndexValidate(FileListEntry *entry) {
+  DeclIndex *index = entry->declIndex;
+  for (size_t moduleIdx = 0; moduleIdx < index->numModules; ++moduleIdx) {
+    FileListEntry *module = fileListFindDecl(index->moduleNames[moduleIdx]);
+    if (module == NULL || module->sourceHash != index->moduleHashes[moduleIdx])
+      return -1;
+    index->modules[moduleIdx] = module;
+  }
+  return 0;
+}
+
+void declIndexResolve(FileListEntry *entry) {
+  DeclIndex *index = entry->declIndex;
+  for (size_t idx = 0; idx < index->references.size; ++idx) {
+    DeclIndexReference *reference = index->references.elements[idx];
+    FileListEntry *module = reference->module == 0
+                                ? entry
+                                : index->modules[reference->module - 1];
+    SymbolTableEntry *referenced =
+        hashMapGetId(module->ast->data.file.stab, reference->id);
+    if (referenced == NULL || referenced->kind == SK_VARIABLE ||
+        referenced->kind == SK_FUNCTION || referenced->kind == SK_ENUMCONST) {
+      fprintf(diagnosticStream(),
+              "%si: error: precompiled declarations refer to '%s', which is "
+              "not a type in %s\n",
+              entry->inputFilename, reference->id, module->inputFilename);
+      entry->errored = true;
+    } else {
+      reference->type->data.reference.entry = referenced;
+    }
+  }
+  vectorUninit(&index->references, free);
+  vectorInit(&index->references);
+}
+
+static void writeIdComponent(FILE *out, Node *id) {
+  serializeString(out, id->data.id.id);
+  serializeNumber(out, id->offset);
+}
+
+static void writeName(FILE *out, Node *name) {
+  if (name->type == NT_ID) {
+    serializeNumber(out, 1);
+    writeIdComponent(out, name);
+  } else {
+    Vector *components = name->data.scopedId.components;
+    serializeNumber(out, components->size);
+    for (size_t idx = 0; idx < components->size; ++idx)
+      writeIdComponent(out, components->elements[idx]);
+  }
+}
+
+/**
+ * adds every module transitively imported by a file to the module list
+ *
+ * @param file file whose imports to add
+ * @param self module being written, which is never added
+ * @param modules list of modules so far
+ */
+static void collectModules(FileListEntry *file, FileListEntry *self,
+                           Vector *modules) {
+  Vector *imports = file->ast->data.file.imports;
+  for (size_t importIdx = 0; importIdx < imports->size; ++importIdx) {
+    Node *import = imports->elements[importIdx];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+    FileListEntry *referenced = import->data.import.referenced;
+#pragma GCC diagnostic pop
+    if (referenced == self) continue;
+
+    bool seen = false;
+    for (size_t idx = 0; idx < modules->size; ++idx) {
+      if (modules->elements[idx] == referenced) {
+        seen = true;
+        break;
+      }
+    }
+    if (!seen) {
+      vectorInsert(modules, referenced);
+      collectModules(referenced, self, modules);
+    }
+  }
+}
+
+/**
+ * writes a type
+ *
+ * @returns false if the type can't be written
+ */
+static bool writeType(FILE *out, Type const *t, FileListEntry *self,
+                      Vector const *modules) {
+  if (t == NULL) return false;
+
+  serializeNumber(out, t->kind);
+  switch (t->kind) {
+    case TK_KEYWORD: {
+      serializeNumber(out, t->data.keyword.keyword);
+      return true;
+    }
+    case TK_QUALIFIED: {
+      serializeNumber(out, t->data.qualified.constQual);
+      serializeNumber(out, t->data.qualified.volatileQual);
+      return writeType(out, t->data.qualified.base, self, modules);
+    }
+    case TK_POINTER: {
+      return writeType(out, t->data.pointer.base, self, modules);
+    }
+    case TK_ARRAY: {
+      serializeNumber(out, t->data.array.length);
+      return writeType(out, t->data.array.type, self, modules);
+    }
+    case TK_FUNPTR: {
+      if (!writeType(out, t->data.funPtr.returnType, self, modules))
+        return false;
+      serializeNumber(out, t->data.funPtr.argTypes.size);
+      for (size_t idx = 0; idx < t->data.funPtr.argTypes.size; ++idx) {
+        if (!writeType(out, t->data.funPtr.argTypes.elements[idx], self,
+                       modules))
+          return false;
+      }
+      return true;
+    }
+    case TK_AGGREGATE: {
+      serializeNumber(out, t->data.aggregate.types.size);
+      for (size_t idx = 0; idx < t->data.aggregate.types.size; ++idx) {
+        if (!writeType(out, t->data.aggregate.types.elements[idx], self,
+                       modules))
+          return false;
+      }
+      return true;
+    }
+    case TK_REFERENCE: {
+      SymbolTableEntry *referenced = t->data.reference.entry;
+      size_t module = 0;
+      if (referenced->file != self) {
+        for (size_t idx = 0; idx < modules->size; ++idx) {
+          if (modules->elements[idx] == referenced->file) {
+            module = idx + 1;
+            break;
+          }
+        }
+        if (module == 0) return false;
+      }
+      // must be findable by id in the module's top level
+      if (hashMapGetId(referenced->file->ast->data.file.stab, referenced->id) !=
+          referenced)
+        return false;
+
+      serializeNumber(out, module);
+      serializeString(out, referenced->id);
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * writes the fields of a struct or a union
+ *
+ * @returns false if the fields can't be written
+ */
+static bool writeFields(FILE *out, Vector const *names, Vector const *types,
+                        FileListEntry *self, Vector const *modules) {
+  serializeNumber(out, names->size);
+  for (size_t idx = 0; idx < names->size; ++idx) {
+    serializeString(out, names->elements[idx]);
+    if (!writeType(out, types->elements[idx], self, modules)) return false;
+  }
+  return true;
+}
+
+/**
+ * writes a top level symbol table entry
+ *
+ * @returns false if the entry can't be written
+ */
+static bool writeEntry(FILE *out, SymbolTableEntry const *e,
+                       FileListEntry *self, Vector const *modules) {
+  serializeNumber(out, e->kind);
+  serializeString(out, e->id);
+  serializeNumber(out, e->offset);
+  switch (e->kind) {
+    case SK_OPAQUE: {
+      return true;
+    }
+    case SK_STRUCT: {
+      return writeFields(out, &e->data.structType.fieldNames,
+                         &e->data.structType.fieldTypes, self, modules);
+    }
+    case SK_UNION: {
+      return writeFields(out, &e->data.unionType.optionNames,
+                         &e->data.unionType.optionTypes, self, modules);
+    }
+    case SK_ENUM: {
+      if (!writeType(out, e->data.enumType.backingType, self, modules))
+        return false;
+      Vector const *constants = &e->data.enumType.constantValues;
+      serializeNumber(out, constants->size);
+      for (size_t idx = 0; idx < constants->size; ++idx) {
+        SymbolTableEntry const *constant = constants->elements[idx];
+        serializeString(out, constant->id);
+        serializeNumber(out, constant->offset);
+        serializeNumber(out, constant->data.enumConst.signedness);
+        serializeNumber(out, constant->data.enumConst.data.unsignedValue);
+      }
+      return true;
+    }
+    case SK_TYPEDEF: {
+      return writeType(out, e->data.typedefType.actual, self, modules);
+    }
+    case SK_VARIABLE: {
+      return writeType(out, e->data.variable.type, self, modules);
+    }
+    case SK_FUNCTION: {
+      if (!writeType(out, e->data.function.returnType, self, modules))
+        return false;
+      Vector const *argTypes = &e->data.function.argumentTypes;
+      serializeNumber(out, argTypes->size);
+      for (size_t idx = 0; idx < argTypes->size; ++idx) {
+        if (!writeType(out, argTypes->elements[idx], self, modules))
+          return false;
+      }
+      return true;
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/**
+ * lists the top level entries of a decl file, in declaration order
+ */
+static void collectEntries(Node *file, Vector *entries) {
+  Vector *bodies = file->data.file.bodies;
+  for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
+    Node *body = bodies->elements[bodyIdx];
+    switch (body->type) {
+      case NT_OPAQUEDECL: {
+        vectorInsert(entries, body->data.opaqueDecl.name->data.id.entry);
+        break;
+      }
+      case NT_STRUCTDECL: {
+        vectorInsert(entries, body->data.structDecl.name->data.id.entry);
+        break;
+      }
+      case NT_UNIONDECL: {
+        vectorInsert(entries, body->data.unionDecl.name->data.id.entry);
+        break;
+      }
+      case NT_ENUMDECL: {
+        vectorInsert(entries, body->data.enumDecl.name->data.id.entry);
+        break;
+      }
+      case NT_TYPEDEFDECL: {
+        vectorInsert(entries, body->data.typedefDecl.name->data.id.entry);
+        break;
+      }
+      case NT_VARDECL: {
+        Vector *names = body->data.varDecl.names;
+        for (size_t idx = 0; idx < names->size; ++idx) {
+          Node *name = names->elements[idx];
+          vectorInsert(entries, name->data.id.entry);
+        }
+        break;
+      }
+      case NT_FUNDECL: {
+        vectorInsert(entries, body->data.funDecl.name->data.id.entry);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * writes the index for a decl file
+ *
+ * @returns false if the index can't be written
+ */
+static bool writeFile(FILE *out, FileListEntry *entry) {
+  Node *ast = entry->ast;
+  Vector modules;
+  vectorInit(&modules);
+  collectModules(entry, entry, &modules);
+
+  fwrite(DECL_INDEX_MAGIC, sizeof(DECL_INDEX_MAGIC), 1, out);
+  serializeNumber(out, DECL_INDEX_VERSION);
+  serializeNumber(out, entry->sourceHash);
+
+  serializeNumber(out, modules.size);
+  for (size_t idx = 0; idx < modules.size; ++idx) {
+    FileListEntry *module = modules.elements[idx];
+    char *name = stringifyId(module->ast->data.file.module->data.module.id);
+    serializeString(out, name);
+    free(name);
+    serializeNumber(out, module->sourceHash);
+  }
+
+  serializeNumber(out, ast->data.file.module->offset);
+  writeName(out, ast->data.file.module->data.module.id);
+
+  Vector *imports = ast->data.file.imports;
+  serializeNumber(out, imports->size);
+  for (size_t idx = 0; idx < imports->size; ++idx) {
+    Node *import = imports->elements[idx];
+    serializeNumber(out, import->offset);
+    writeName(out, import->data.import.id);
+  }
+
+  Vector entries;
+  vectorInit(&entries);
+  collectEntries(ast, &entries);
+  bool ok = true;
+  serializeNumber(out, entries.size);
+  for (size_t idx = 0; idx < entries.size && ok; ++idx)
+    ok = writeEntry(out, entries.elements[idx], entry, &modules);
+
+  vectorUninit(&entries, nullDtor);
+  vectorUninit(&modules, nullDtor);
+  return ok;
+}
+
+void declIndexWrite(FileListEntry *entry) {
+  char *indexFilename = format("%si", entry->inputFilename);
+  AtomicFile out;
+  if (atomicFileOpen(&out, indexFilename) == 0)
+    atomicFileClose(&out, writeFile(out.stream, entry));
+  free(indexFilename);
+}
+
+void declIndexUnload(FileListEntry *entry) {
+  if (entry->declIndex != NULL) {
+    declIndexFree(entry->declIndex);
+    entry->declIndex = NULL;
+  }
+}
@@ -0,0 +1,106 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * precompiled declaration module (.tdi) reader and writer
+ *
+ * A precompiled declaration module holds the resolved symbol table of a
+ * declaration module, keyed by a hash of its source and of the source of every
+ * module it (transitively) imports. It lives next to its source, so foo.td is
+ * precompiled into foo.tdi.
+ */
+
+#ifndef TLC_PARSER_DECLINDEX_H_
+#define TLC_PARSER_DECLINDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fileList.h"
+#include "util/container/vector.h"
+
+/** a loaded precompiled declaration module */
+struct DeclIndex {
+  char *map;                /**< mmap of the index - owns the stab's strings */
+  size_t length;            /**< length of the mapping */
+  size_t numModules;        /**< number of transitively imported modules */
+  char const **moduleNames; /**< stringified name of each imported module */
+  uint64_t *moduleHashes;   /**< source hash of each imported module */
+  FileListEntry **modules;  /**< imported modules, filled in by validation */
+  Vector references;        /**< vector of DeclIndexReference - reference
+                               types still to be resolved */
+};
+
+/**
+ * loads the precompiled declarations for a declaration module whose source is
+ * mapped in its lexer state
+ *
+ * Always sets the entry's source hash. If the index exists and matches the
+ * source, the entry's AST becomes a stub with no bodies, and the top level
+ * symbol table is populated, except for references to named types. Files are
+ * independent at this point, so this may be run concurrently
+ *
+ * @param entry entry to load
+ * @returns 0 if loaded, nonzero if the source must be parsed instead
+ */
+int declIndexLoad(FileListEntry *entry);
+
+/**
+ * checks that every module a loaded index was built against is in the file
+ * list with the same source hash
+ *
+ * Expects every decl file to have had declIndexLoad called on it, and the decl
+ * files to have been indexed by fileListIndexDecls
+ *
+ * @param entry entry loaded from an index
+ * @returns 0 if OK, nonzero if the index is out of date
+ */
+int declIndexValidate(FileListEntry *entry);
+
+/**
+ * resolves references to named types in a loaded index
+ *
+ * Must be called after the top level stab has been started for this file and
+ * every decl file it imports. Sets entry->errored if an error happened
+ *
+ * @param entry entry loaded from an index
+ */
+void declIndexResolve(FileListEntry *entry);
+
+/**
+ * writes the precompiled declarations for a declaration module parsed from
+ * source
+ *
+ * Must be called after the top level stab has been finished. Failure to write
+ * the index is not an error
+ *
+ * @param entry entry to write
+ */
+void declIndexWrite(FileListEntry *entry);
+
+/**
+ * frees a loaded index, if any - must be called after the AST of the entry is
+ * freed, since the AST references strings in the index
+ *
+ * @param entry entry to unload
+ */
+void declIndexUnload(FileListEntry *entry);
+
+#endif  // TLC_PARSER_DECLINDEX_H_
@@ -19,6 +19,7 @@
 
 #include "parser/functionBody.h"
 
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,6 +28,7 @@
 #include "fileList.h"
 #include "parser/common.h"
 #include "util/conversions.h"
+#include "util/diagnostics.h"
 #include "util/internalError.h"
 
 // token stuff
@@ -42,16 +44,8 @@
  * @param t token to write into
  */
 static void next(Node *unparsed, Token *t) {
-  // get pointer to saved token
-  Token *saved =
-      unparsed->data.unparsed.tokens->elements[unparsed->data.unparsed.curr];
-  // give ownership of it to the caller
-  memcpy(t, saved, sizeof(Token));
-  // free malloc'ed block - this token has its guts ripped out
-  free(saved);
-  // clear it - we don't need to remember it any more
-  unparsed->data.unparsed.tokens->elements[unparsed->data.unparsed.curr++] =
-      NULL;
+  *t = unparsed->data.unparsed.tokens
+           ->elements[unparsed->data.unparsed.curr++];
 }
 
 /**
@@ -65,13 +59,8 @@ static void next(Node *unparsed, Token *t) {
  * @param t token to read from
  */
 static void prev(Node *unparsed, Token *t) {
-  // malloc new block
-  Token *saved = malloc(sizeof(Token));
-  // copy from t (t now has its guts ripped out)
-  memcpy(saved, t, sizeof(Token));
-  // save it
   unparsed->data.unparsed.tokens->elements[--unparsed->data.unparsed.curr] =
-      saved;
+      *t;
 }
 
 // miscellaneous functions
@@ -455,10 +444,13 @@ static Node *parseExtendedIntLiteral(FileListEntry *entry, Node *unparsed,
         nodeFree(n);
         return NULL;
       } else if (stabEntry->kind != SK_ENUMCONST) {
-        fprintf(stderr,
+        size_t line;
+        size_t character;
+        fileListEntryPosition(entry, n->offset, &line, &character);
+        fprintf(diagnosticStream(),
                 "%s:%zu:%zu: error: expected an extended integer "
                 "literal, found %s\n",
-                entry->inputFilename, n->line, n->character,
+                entry->inputFilename, line, character,
                 symbolKindToString(stabEntry->kind));
         entry->errored = true;
 
@@ -532,9 +524,7 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Node *unparsed,
         switch (peek.type) {
           case TT_RSQUARE: {
             // end of the init
-            Node *n = literalNodeCreate(LT_AGGREGATEINIT, start);
-            n->data.literal.data.aggregateInitVal = literals;
-            return n;
+            return aggregateInitLiteralNodeCreate(start, literals);
           }
           case TT_COMMA: {
             break;  // continue on
@@ -553,9 +543,7 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Node *unparsed,
       }
       case TT_RSQUARE: {
         // end of the init
-        Node *n = literalNodeCreate(LT_AGGREGATEINIT, start);
-        n->data.literal.data.aggregateInitVal = literals;
-        return n;
+        return aggregateInitLiteralNodeCreate(start, literals);
       }
       default: {
         errorExpectedString(entry, "a literal", &peek);
@@ -963,12 +951,16 @@ static Node *parsePrimaryExpression(FileListEntry *entry, Node *unparsed,
         } else if (stabEntry->kind != SK_ENUMCONST &&
                    stabEntry->kind != SK_FUNCTION &&
                    stabEntry->kind != SK_VARIABLE) {
-          fprintf(stderr,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(entry, n->offset, &line, &character);
+          fprintf(diagnosticStream(),
                   "%s:%zu:%zu: error: cannot use a type as a variable\n",
-                  entry->inputFilename, n->line, n->character);
-          fprintf(stderr, "%s:%zu:%zu: note: declared here\n",
-                  stabEntry->file->inputFilename, stabEntry->line,
-                  stabEntry->character);
+                  entry->inputFilename, line, character);
+          fileListEntryPosition(stabEntry->file, stabEntry->offset, &line,
+                                &character);
+          fprintf(diagnosticStream(), "%s:%zu:%zu: note: declared here\n",
+                  stabEntry->file->inputFilename, line, character);
           entry->errored = true;
         } else {
           if (n->type == NT_ID) {
@@ -1431,223 +1423,129 @@ static Node *parsePrefixExpression(FileListEntry *entry, Node *unparsed,
   }
 }
 
-/**
- * parses a multiplication expression
- *
- * @param entry entry containing this node
- * @param unparsed unparsed node to read from
- * @param env environment to use
- * @param start first id in expression, or null if none provided
- *
- * @returns node or null on error
- */
-static Node *parseMultiplicationExpression(FileListEntry *entry, Node *unparsed,
-                                           Environment *env, Node *start) {
-  Node *exp = parsePrefixExpression(entry, unparsed, env, start);
-  if (exp == NULL) {
-    return NULL;
-  }
-
-  while (true) {
-    Token op;
-    next(unparsed, &op);
-    switch (op.type) {
-      case TT_STAR:
-      case TT_SLASH:
-      case TT_PERCENT: {
-        Node *rhs = parsePrefixExpression(entry, unparsed, env, NULL);
-        if (rhs == NULL) {
-          nodeFree(exp);
-          return NULL;
-        }
-
-        exp = binOpExpNodeCreate(multiplicationTokenToBinop(op.type), exp, rhs);
-        break;
-      }
-      default: {
-        prev(unparsed, &op);
-        return exp;
-      }
-    }
-  }
-}
+/** how tightly an infix operator binds, loosest first */
+typedef enum {
+  BP_NONE, /**< not an infix operator */
+  BP_ASSIGNMENT,
+  BP_TERNARY,
+  BP_LOGICAL,
+  BP_BITWISE,
+  BP_EQUALITY,
+  BP_COMPARISON,
+  BP_SHIFT,
+  BP_ADDITION,
+  BP_MULTIPLICATION,
+} BindingPower;
+
+/** an infix operator */
+typedef struct {
+  BindingPower power; /**< how tightly the operator binds */
+  BinOpType op;       /**< operator to build - unused for the ternary */
+} InfixOperator;
+
+/** infix operators by token type; other tokens end the expression */
+static InfixOperator const INFIX_OPERATORS[] = {
+    [TT_STAR] = {BP_MULTIPLICATION, BO_MUL},
+    [TT_AMP] = {BP_BITWISE, BO_BITAND},
+    [TT_PLUS] = {BP_ADDITION, BO_ADD},
+    [TT_MINUS] = {BP_ADDITION, BO_SUB},
+    [TT_SLASH] = {BP_MULTIPLICATION, BO_DIV},
+    [TT_PERCENT] = {BP_MULTIPLICATION, BO_MOD},
+    [TT_LSHIFT] = {BP_SHIFT, BO_LSHIFT},
+    [TT_ARSHIFT] = {BP_SHIFT, BO_ARSHIFT},
+    [TT_LRSHIFT] = {BP_SHIFT, BO_LRSHIFT},
+    [TT_LANGLE] = {BP_COMPARISON, BO_LT},
+    [TT_RANGLE] = {BP_COMPARISON, BO_GT},
+    [TT_LTEQ] = {BP_COMPARISON, BO_LTEQ},
+    [TT_GTEQ] = {BP_COMPARISON, BO_GTEQ},
+    [TT_EQ] = {BP_EQUALITY, BO_EQ},
+    [TT_NEQ] = {BP_EQUALITY, BO_NEQ},
+    [TT_BAR] = {BP_BITWISE, BO_BITOR},
+    [TT_CARET] = {BP_BITWISE, BO_BITXOR},
+    [TT_LAND] = {BP_LOGICAL, BO_LAND},
+    [TT_LOR] = {BP_LOGICAL, BO_LOR},
+    [TT_QUESTION] = {.power = BP_TERNARY},
+    [TT_ASSIGN] = {BP_ASSIGNMENT, BO_ASSIGN},
+    [TT_MULASSIGN] = {BP_ASSIGNMENT, BO_MULASSIGN},
+    [TT_DIVASSIGN] = {BP_ASSIGNMENT, BO_DIVASSIGN},
+    [TT_MODASSIGN] = {BP_ASSIGNMENT, BO_MODASSIGN},
+    [TT_ADDASSIGN] = {BP_ASSIGNMENT, BO_ADDASSIGN},
+    [TT_SUBASSIGN] = {BP_ASSIGNMENT, BO_SUBASSIGN},
+    [TT_LSHIFTASSIGN] = {BP_ASSIGNMENT, BO_LSHIFTASSIGN},
+    [TT_ARSHIFTASSIGN] = {BP_ASSIGNMENT, BO_ARSHIFTASSIGN},
+    [TT_LRSHIFTASSIGN] = {BP_ASSIGNMENT, BO_LRSHIFTASSIGN},
+    [TT_BITANDASSIGN] = {BP_ASSIGNMENT, BO_BITANDASSIGN},
+    [TT_BITXORASSIGN] = {BP_ASSIGNMENT, BO_BITXORASSIGN},
+    [TT_BITORASSIGN] = {BP_ASSIGNMENT, BO_BITORASSIGN},
+    [TT_LANDASSIGN] = {BP_ASSIGNMENT, BO_LANDASSIGN},
+    [TT_LORASSIGN] = {BP_ASSIGNMENT, BO_LORASSIGN},
+};
+
+static Node *parseBinaryExpression(FileListEntry *entry, Node *unparsed,
+                                   Environment *env, Node *start,
+                                   BindingPower minPower);
 
 /**
- * parses an addition expression
+ * parses a ternary expression's consequent and alternative
  *
  * @param entry entry containing this node
- * @param unparsed unparsed node to read from
+ * @param unparsed unparsed node to read from, just past the question mark
  * @param env environment to use
- * @param start first id in expression, or null if none provided
+ * @param predicate parsed predicate
  *
  * @returns node or null on error
  */
-static Node *parseAdditionExpression(FileListEntry *entry, Node *unparsed,
-                                     Environment *env, Node *start) {
-  Node *exp = parseMultiplicationExpression(entry, unparsed, env, start);
-  if (exp == NULL) {
+static Node *parseTernaryRest(FileListEntry *entry, Node *unparsed,
+                              Environment *env, Node *predicate) {
+  Node *consequent = parseExpression(entry, unparsed, env, NULL);
+  if (consequent == NULL) {
+    nodeFree(predicate);
     return NULL;
   }
 
-  while (true) {
-    Token op;
-    next(unparsed, &op);
-    switch (op.type) {
-      case TT_PLUS:
-      case TT_MINUS: {
-        Node *rhs = parseMultiplicationExpression(entry, unparsed, env, NULL);
-        if (rhs == NULL) {
-          nodeFree(exp);
-          return NULL;
-        }
+  Token colon;
+  next(unparsed, &colon);
+  if (colon.type != TT_COLON) {
+    errorExpectedToken(entry, TT_COLON, &colon);
 
-        exp = binOpExpNodeCreate(additionTokenToBinop(op.type), exp, rhs);
-        break;
-      }
-      default: {
-        prev(unparsed, &op);
-        return exp;
-      }
-    }
-  }
-}
+    prev(unparsed, &colon);
 
-/**
- * parses a shift expression
- *
- * @param entry entry containing this node
- * @param unparsed unparsed node to read from
- * @param env environment to use
- * @param start first id in expression, or null if none provided
- *
- * @returns node or null on error
- */
-static Node *parseShiftExpression(FileListEntry *entry, Node *unparsed,
-                                  Environment *env, Node *start) {
-  Node *exp = parseAdditionExpression(entry, unparsed, env, start);
-  if (exp == NULL) {
+    nodeFree(consequent);
+    nodeFree(predicate);
     return NULL;
   }
 
-  while (true) {
-    Token op;
-    next(unparsed, &op);
-    switch (op.type) {
-      case TT_LSHIFT:
-      case TT_ARSHIFT:
-      case TT_LRSHIFT: {
-        Node *rhs = parseAdditionExpression(entry, unparsed, env, NULL);
-        if (rhs == NULL) {
-          nodeFree(exp);
-          return NULL;
-        }
-
-        exp = binOpExpNodeCreate(shiftTokenToBinop(op.type), exp, rhs);
-        break;
-      }
-      default: {
-        prev(unparsed, &op);
-        return exp;
-      }
-    }
-  }
-}
-
-/**
- * parses a comparison expression
- *
- * @param entry entry containing this node
- * @param unparsed unparsed node to read from
- * @param env environment to use
- * @param start first id in expression, or null if none provided
- *
- * @returns node or null on error
- */
-static Node *parseComparisonExpression(FileListEntry *entry, Node *unparsed,
-                                       Environment *env, Node *start) {
-  Node *exp = parseShiftExpression(entry, unparsed, env, start);
-  if (exp == NULL) {
+  Node *alternative =
+      parseBinaryExpression(entry, unparsed, env, NULL, BP_TERNARY);
+  if (alternative == NULL) {
+    nodeFree(consequent);
+    nodeFree(predicate);
     return NULL;
   }
 
-  while (true) {
-    Token op;
-    next(unparsed, &op);
-    switch (op.type) {
-      case TT_LANGLE:
-      case TT_RANGLE:
-      case TT_LTEQ:
-      case TT_GTEQ: {
-        Node *rhs = parseShiftExpression(entry, unparsed, env, NULL);
-        if (rhs == NULL) {
-          nodeFree(exp);
-          return NULL;
-        }
-
-        exp = binOpExpNodeCreate(comparisonTokenToBinop(op.type), exp, rhs);
-        break;
-      }
-      default: {
-        prev(unparsed, &op);
-        return exp;
-      }
-    }
-  }
+  return ternaryExpNodeCreate(predicate, consequent, alternative);
 }
 
 /**
- * parses an equality expression
- *
- * @param entry entry containing this node
- * @param unparsed unparsed node to read from
- * @param env environment to use
- * @param start first id in expression, or null if none provided
+ * parses an expression made of infix operators binding at least as tightly as
+ * minPower, by precedence climbing
  *
- * @returns node or null on error
- */
-static Node *parseEqualityExpression(FileListEntry *entry, Node *unparsed,
-                                     Environment *env, Node *start) {
-  Node *exp = parseComparisonExpression(entry, unparsed, env, start);
-  if (exp == NULL) {
-    return NULL;
-  }
-
-  while (true) {
-    Token op;
-    next(unparsed, &op);
-    switch (op.type) {
-      case TT_EQ:
-      case TT_NEQ: {
-        Node *rhs = parseComparisonExpression(entry, unparsed, env, NULL);
-        if (rhs == NULL) {
-          nodeFree(exp);
-          return NULL;
-        }
-
-        exp = binOpExpNodeCreate(equalityTokenToBinop(op.type), exp, rhs);
-        break;
-      }
-      default: {
-        prev(unparsed, &op);
-        return exp;
-      }
-    }
-  }
-}
-
-/**
- * parses a bitwise expression
+ * Assignments, ternaries, and logical operators associate to the right; the
+ * rest associate to the left. Logical and bitwise operators each share one
+ * precedence level.
  *
  * @param entry entry containing this node
  * @param unparsed unparsed node to read from
  * @param env environment to use
  * @param start first id in expression, or null if none provided
+ * @param minPower loosest operator to accept
  *
  * @returns node or null on error
  */
-static Node *parseBitwiseExpression(FileListEntry *entry, Node *unparsed,
-                                    Environment *env, Node *start) {
-  Node *exp = parseEqualityExpression(entry, unparsed, env, start);
+static Node *parseBinaryExpression(FileListEntry *entry, Node *unparsed,
+                                   Environment *env, Node *start,
+                                   BindingPower minPower) {
+  Node *exp = parsePrefixExpression(entry, unparsed, env, start);
   if (exp == NULL) {
     return NULL;
   }
@@ -1655,117 +1553,34 @@ static Node *parseBitwiseExpression(FileListEntry *entry, Node *unparsed,
   while (true) {
     Token op;
     next(unparsed, &op);
-    switch (op.type) {
-      case TT_AMP:
-      case TT_BAR:
-      case TT_CARET: {
-        Node *rhs = parseEqualityExpression(entry, unparsed, env, NULL);
-        if (rhs == NULL) {
-          nodeFree(exp);
-          return NULL;
-        }
-
-        exp = binOpExpNodeCreate(bitwiseTokenToBinop(op.type), exp, rhs);
-        break;
-      }
-      default: {
-        prev(unparsed, &op);
-        return exp;
-      }
+    if (op.type >= sizeof(INFIX_OPERATORS) / sizeof(InfixOperator) ||
+        INFIX_OPERATORS[op.type].power == BP_NONE ||
+        INFIX_OPERATORS[op.type].power < minPower) {
+      prev(unparsed, &op);
+      return exp;
     }
-  }
-}
+    InfixOperator const *infix = &INFIX_OPERATORS[op.type];
 
-/**
- * parses a logical expression
- *
- * @param entry entry containing this node
- * @param unparsed unparsed node to read from
- * @param env environment to use
- * @param start first id in expression, or null if none provided
- *
- * @returns node or null on error
- */
-static Node *parseLogicalExpression(FileListEntry *entry, Node *unparsed,
-                                    Environment *env, Node *start) {
-  Node *exp = parseBitwiseExpression(entry, unparsed, env, start);
-  if (exp == NULL) {
-    return NULL;
-  }
-
-  while (true) {
-    Token op;
-    next(unparsed, &op);
-    switch (op.type) {
-      case TT_LAND:
-      case TT_LOR: {
-        Node *rhs = parseLogicalExpression(entry, unparsed, env, NULL);
-        if (rhs == NULL) {
-          nodeFree(exp);
-          return NULL;
-        }
-
-        exp = binOpExpNodeCreate(logicalTokenToBinop(op.type), exp, rhs);
-        break;
-      }
-      default: {
-        prev(unparsed, &op);
-        return exp;
+    if (op.type == TT_QUESTION) {
+      exp = parseTernaryRest(entry, unparsed, env, exp);
+      if (exp == NULL) {
+        return NULL;
       }
+      continue;
     }
-  }
-}
 
-/**
- * parses a ternary expression
- *
- * @param entry entry containing this node
- * @param unparsed unparsed node to read from
- * @param env environment to use
- * @param start first id in expression, or null if none provided
- *
- * @returns node or null on error
- */
-static Node *parseTernaryExpression(FileListEntry *entry, Node *unparsed,
-                                    Environment *env, Node *start) {
-  Node *predicate = parseLogicalExpression(entry, unparsed, env, start);
-  if (predicate == NULL) {
-    return NULL;
-  }
-
-  Token question;
-  next(unparsed, &question);
-  if (question.type != TT_QUESTION) {
-    prev(unparsed, &question);
-    return predicate;
-  }
-
-  Node *consequent = parseExpression(entry, unparsed, env, NULL);
-  if (consequent == NULL) {
-    nodeFree(predicate);
-    return NULL;
-  }
-
-  Token colon;
-  next(unparsed, &colon);
-  if (colon.type != TT_COLON) {
-    errorExpectedToken(entry, TT_COLON, &colon);
-
-    prev(unparsed, &colon);
-
-    nodeFree(consequent);
-    nodeFree(predicate);
-    return NULL;
-  }
+    Node *rhs = parseBinaryExpression(
+        entry, unparsed, env, NULL,
+        infix->power == BP_ASSIGNMENT || infix->power == BP_LOGICAL
+            ? infix->power
+            : infix->power + 1);
+    if (rhs == NULL) {
+      nodeFree(exp);
+      return NULL;
+    }
 
-  Node *alternative = parseTernaryExpression(entry, unparsed, env, NULL);
-  if (alternative == NULL) {
-    nodeFree(consequent);
-    nodeFree(predicate);
-    return NULL;
+    exp = binOpExpNodeCreate(infix->op, exp, rhs);
   }
-
-  return ternaryExpNodeCreate(predicate, consequent, alternative);
 }
 
 /**
@@ -1780,41 +1595,7 @@ static Node *parseTernaryExpression(FileListEntry *entry, Node *unparsed,
  */
 static Node *parseAssignmentExpression(FileListEntry *entry, Node *unparsed,
                                        Environment *env, Node *start) {
-  Node *lhs = parseTernaryExpression(entry, unparsed, env, start);
-  if (lhs == NULL) {
-    return NULL;
-  }
-
-  Token op;
-  next(unparsed, &op);
-  switch (op.type) {
-    case TT_ASSIGN:
-    case TT_MULASSIGN:
-    case TT_DIVASSIGN:
-    case TT_MODASSIGN:
-    case TT_ADDASSIGN:
-    case TT_SUBASSIGN:
-    case TT_LSHIFTASSIGN:
-    case TT_ARSHIFTASSIGN:
-    case TT_LRSHIFTASSIGN:
-    case TT_BITANDASSIGN:
-    case TT_BITXORASSIGN:
-    case TT_BITORASSIGN:
-    case TT_LANDASSIGN:
-    case TT_LORASSIGN: {
-      Node *rhs = parseAssignmentExpression(entry, unparsed, env, NULL);
-      if (rhs == NULL) {
-        nodeFree(lhs);
-        return NULL;
-      }
-
-      return binOpExpNodeCreate(assignmentTokenToBinop(op.type), lhs, rhs);
-    }
-    default: {
-      prev(unparsed, &op);
-      return lhs;
-    }
-  }
+  return parseBinaryExpression(entry, unparsed, env, start, BP_ASSIGNMENT);
 }
 
 /**
@@ -1904,18 +1685,19 @@ static Node *parseSwitchCase(FileListEntry *entry, Node *unparsed,
     } else {
       prev(unparsed, &peek);
 
-      environmentPush(env, hashMapCreate());
+      environmentPush(env);
       Node *body = parseStmt(entry, unparsed, env);
-      HashMap *bodyStab = environmentPop(env);
+      Scope bodyStab;
+      environmentPop(env, &bodyStab);
       if (body == NULL) {
         panicSwitch(unparsed);
 
         nodeVectorFree(values);
-        stabFree(bodyStab);
+        scopeUninit(&bodyStab);
         return NULL;
       }
 
-      return switchCaseNodeCreate(start, values, body, bodyStab);
+      return switchCaseNodeCreate(start, values, body, &bodyStab);
     }
   }
 }
@@ -1941,17 +1723,18 @@ static Node *parseSwitchDefault(FileListEntry *entry, Node *unparsed,
     return NULL;
   }
 
-  environmentPush(env, hashMapCreate());
+  environmentPush(env);
   Node *body = parseStmt(entry, unparsed, env);
-  HashMap *bodyStab = environmentPop(env);
+  Scope bodyStab;
+  environmentPop(env, &bodyStab);
   if (body == NULL) {
     panicSwitch(unparsed);
 
-    stabFree(bodyStab);
+    scopeUninit(&bodyStab);
     return NULL;
   }
 
-  return switchDefaultNodeCreate(start, body, bodyStab);
+  return switchDefaultNodeCreate(start, body, &bodyStab);
 }
 
 // context sensitive parsers
@@ -1971,23 +1754,30 @@ static Node *parseCompoundStmt(FileListEntry *entry, Node *unparsed,
   next(unparsed, &lbrace);
 
   Vector *stmts = vectorCreate();
-  environmentPush(env, hashMapCreate());
+  environmentPush(env);
 
   while (true) {
     Token peek;
     next(unparsed, &peek);
     switch (peek.type) {
       case TT_RBRACE: {
-        return compoundStmtNodeCreate(&lbrace, stmts, environmentPop(env));
+        Scope stab;
+        environmentPop(env, &stab);
+        return compoundStmtNodeCreate(&lbrace, stmts, &stab);
       }
       case TT_EOF: {
-        fprintf(stderr, "%s:%zu:%zu: error: unmatched left brace\n",
-                entry->inputFilename, lbrace.line, lbrace.character);
+        size_t line;
+        size_t character;
+        fileListEntryPosition(entry, lbrace.offset, &line, &character);
+        fprintf(diagnosticStream(), "%s:%zu:%zu: error: unmatched left brace\n",
+                entry->inputFilename, line, character);
         entry->errored = true;
 
         prev(unparsed, &peek);
 
-        return compoundStmtNodeCreate(&lbrace, stmts, environmentPop(env));
+        Scope stab;
+        environmentPop(env, &stab);
+        return compoundStmtNodeCreate(&lbrace, stmts, &stab);
       }
       default: {
         prev(unparsed, &peek);
@@ -2039,11 +1829,12 @@ static Node *parseIfStmt(FileListEntry *entry, Node *unparsed, Environment *env,
     return NULL;
   }
 
-  environmentPush(env, hashMapCreate());
+  environmentPush(env);
   Node *consequent = parseStmt(entry, unparsed, env);
-  HashMap *consequentStab = environmentPop(env);
+  Scope consequentStab;
+  environmentPop(env, &consequentStab);
   if (consequent == NULL) {
-    stabFree(consequentStab);
+    scopeUninit(&consequentStab);
     nodeFree(predicate);
     return NULL;
   }
@@ -2052,23 +1843,24 @@ static Node *parseIfStmt(FileListEntry *entry, Node *unparsed, Environment *env,
   next(unparsed, &elseKwd);
   if (elseKwd.type != TT_ELSE) {
     prev(unparsed, &elseKwd);
-    return ifStmtNodeCreate(start, predicate, consequent, consequentStab, NULL,
+    return ifStmtNodeCreate(start, predicate, consequent, &consequentStab, NULL,
                             NULL);
   }
 
-  environmentPush(env, hashMapCreate());
+  environmentPush(env);
   Node *alternative = parseStmt(entry, unparsed, env);
-  HashMap *alternativeStab = environmentPop(env);
+  Scope alternativeStab;
+  environmentPop(env, &alternativeStab);
   if (alternative == NULL) {
-    stabFree(alternativeStab);
+    scopeUninit(&alternativeStab);
     nodeFree(consequent);
-    stabFree(consequentStab);
+    scopeUninit(&consequentStab);
     nodeFree(predicate);
     return NULL;
   }
 
-  return ifStmtNodeCreate(start, predicate, consequent, consequentStab,
-                          alternative, alternativeStab);
+  return ifStmtNodeCreate(start, predicate, consequent, &consequentStab,
+                          alternative, &alternativeStab);
 }
 
 /**
@@ -2111,16 +1903,17 @@ static Node *parseWhileStmt(FileListEntry *entry, Node *unparsed,
     return NULL;
   }
 
-  environmentPush(env, hashMapCreate());
+  environmentPush(env);
   Node *body = parseStmt(entry, unparsed, env);
-  HashMap *bodyStab = environmentPop(env);
+  Scope bodyStab;
+  environmentPop(env, &bodyStab);
   if (body == NULL) {
-    stabFree(bodyStab);
+    scopeUninit(&bodyStab);
     nodeFree(condition);
     return NULL;
   }
 
-  return whileStmtNodeCreate(start, condition, body, bodyStab);
+  return whileStmtNodeCreate(start, condition, body, &bodyStab);
 }
 
 /**
@@ -2135,13 +1928,14 @@ static Node *parseWhileStmt(FileListEntry *entry, Node *unparsed,
  */
 static Node *parseDoWhileStmt(FileListEntry *entry, Node *unparsed,
                               Environment *env, Token *start) {
-  environmentPush(env, hashMapCreate());
+  environmentPush(env);
   Node *body = parseStmt(entry, unparsed, env);
-  HashMap *bodyStab = environmentPop(env);
+  Scope bodyStab;
+  environmentPop(env, &bodyStab);
   if (body == NULL) {
     panicStmt(unparsed);
 
-    stabFree(bodyStab);
+    scopeUninit(&bodyStab);
     return NULL;
   }
 
@@ -2154,7 +1948,7 @@ static Node *parseDoWhileStmt(FileListEntry *entry, Node *unparsed,
     panicStmt(unparsed);
 
     nodeFree(body);
-    stabFree(bodyStab);
+    scopeUninit(&bodyStab);
     return NULL;
   }
 
@@ -2167,7 +1961,7 @@ static Node *parseDoWhileStmt(FileListEntry *entry, Node *unparsed,
     panicStmt(unparsed);
 
     nodeFree(body);
-    stabFree(bodyStab);
+    scopeUninit(&bodyStab);
     return NULL;
   }
 
@@ -2176,7 +1970,7 @@ static Node *parseDoWhileStmt(FileListEntry *entry, Node *unparsed,
     panicStmt(unparsed);
 
     nodeFree(body);
-    stabFree(bodyStab);
+    scopeUninit(&bodyStab);
     return NULL;
   }
 
@@ -2190,11 +1984,11 @@ static Node *parseDoWhileStmt(FileListEntry *entry, Node *unparsed,
 
     nodeFree(condition);
     nodeFree(body);
-    stabFree(bodyStab);
+    scopeUninit(&bodyStab);
     return NULL;
   }
 
-  return doWhileStmtNodeCreate(start, body, bodyStab, condition);
+  return doWhileStmtNodeCreate(start, body, &bodyStab, condition);
 }
 
 /**
@@ -2271,6 +2065,17 @@ static Node *parseForInitStmt(FileListEntry *entry, Node *unparsed,
   }
 }
 
+/**
+ * ends the innermost local scope of a statement that couldn't be parsed
+ *
+ * @param env environment to remove the scope from
+ */
+static void discardScope(Environment *env) {
+  Scope scope;
+  environmentPop(env, &scope);
+  scopeUninit(&scope);
+}
+
 /**
  * parses a for statement
  *
@@ -2293,12 +2098,12 @@ static Node *parseForStmt(FileListEntry *entry, Node *unparsed,
     return NULL;
   }
 
-  environmentPush(env, hashMapCreate());
+  environmentPush(env);
   Node *initializer = parseForInitStmt(entry, unparsed, env);
   if (initializer == NULL) {
     panicStmt(unparsed);
 
-    stabFree(environmentPop(env));
+    discardScope(env);
     return NULL;
   }
 
@@ -2307,7 +2112,8 @@ static Node *parseForStmt(FileListEntry *entry, Node *unparsed,
     panicStmt(unparsed);
 
     nodeFree(initializer);
-    stabFree(environmentPop(env));
+    discardScope(env);
+    return NULL;
   }
 
   Token semi;
@@ -2320,7 +2126,8 @@ static Node *parseForStmt(FileListEntry *entry, Node *unparsed,
 
     nodeFree(condition);
     nodeFree(initializer);
-    stabFree(environmentPop(env));
+    discardScope(env);
+    return NULL;
   }
 
   Token peek;
@@ -2336,7 +2143,7 @@ static Node *parseForStmt(FileListEntry *entry, Node *unparsed,
 
       nodeFree(condition);
       nodeFree(initializer);
-      stabFree(environmentPop(env));
+      discardScope(env);
       return NULL;
     }
   } else {
@@ -2354,24 +2161,27 @@ static Node *parseForStmt(FileListEntry *entry, Node *unparsed,
     nodeFree(increment);
     nodeFree(condition);
     nodeFree(initializer);
-    stabFree(environmentPop(env));
+    discardScope(env);
     return NULL;
   }
 
-  environmentPush(env, hashMapCreate());
+  environmentPush(env);
   Node *body = parseStmt(entry, unparsed, env);
-  HashMap *bodyStab = environmentPop(env);
+  Scope bodyStab;
+  environmentPop(env, &bodyStab);
   if (body == NULL) {
+    scopeUninit(&bodyStab);
     nodeFree(increment);
     nodeFree(condition);
     nodeFree(initializer);
-    stabFree(environmentPop(env));
+    discardScope(env);
     return NULL;
   }
 
-  HashMap *loopStab = environmentPop(env);
-  return forStmtNodeCreate(start, loopStab, initializer, condition, increment,
-                           body, bodyStab);
+  Scope loopStab;
+  environmentPop(env, &loopStab);
+  return forStmtNodeCreate(start, &loopStab, initializer, condition, increment,
+                           body, &bodyStab);
 }
 
 /**
@@ -2468,10 +2278,13 @@ static Node *parseSwitchStmt(FileListEntry *entry, Node *unparsed,
   }
 
   if (cases->size == 0) {
-    fprintf(stderr,
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, lbrace.offset, &line, &character);
+    fprintf(diagnosticStream(),
             "%s:%zu:%zu: error: expected at least one case in a switch "
             "statement\n",
-            entry->inputFilename, lbrace.line, lbrace.character);
+            entry->inputFilename, line, character);
     entry->errored = true;
 
     nodeVectorFree(cases);
@@ -2652,10 +2465,13 @@ static Node *parseVarDefnStmt(FileListEntry *entry, Node *unparsed,
         // done
         vectorInsert(initializers, NULL);
         if (names->size == 0) {
-          fprintf(stderr,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(entry, typeNode->offset, &line, &character);
+          fprintf(diagnosticStream(),
                   "%s:%zu:%zu: error: expected at least one name in a variable "
                   "declaration\n",
-                  entry->inputFilename, typeNode->line, typeNode->character);
+                  entry->inputFilename, line, character);
           entry->errored = true;
 
           nodeVectorFree(initializers);
@@ -2693,20 +2509,19 @@ static Node *parseVarDefnStmt(FileListEntry *entry, Node *unparsed,
   for (size_t idx = 0; idx < names->size; ++idx) {
     Node *name = names->elements[idx];
     name->data.id.entry = variableStabEntryCreate(
-        entry, name->line, name->character, name->data.id.id);
-    name->data.id.entry->data.variable.type = typeCopy(type);
+        entry, name->offset, name->data.id.id);
+    name->data.id.entry->data.variable.type = type;
 
     SymbolTableEntry *existing =
-        hashMapGet(environmentTop(env), name->data.id.id);
+        scopeGet(environmentTop(env), name->data.id.id);
     if (existing != NULL) {
       // whoops - this already exists! complain!
-      errorRedeclaration(entry, name->line, name->character, name->data.id.id,
-                         existing->file, existing->line, existing->character);
+      errorRedeclaration(entry, name->offset, name->data.id.id, existing->file,
+                         existing->offset);
     }
 
-    hashMapPut(environmentTop(env), name->data.id.id, name->data.id.entry);
+    scopePut(environmentTop(env), name->data.id.id, name->data.id.entry);
   }
-  typeFree(type);
 
   return varDefnStmtNodeCreate(typeNode, names, initializers);
 }
@@ -2775,17 +2590,17 @@ static Node *parseOpaqueDecl(FileListEntry *entry, Node *unparsed,
   }
 
   name->data.id.entry = opaqueStabEntryCreate(
-      entry, start->line, start->character, name->data.id.id);
+      entry, start->offset, name->data.id.id);
 
   SymbolTableEntry *existing =
-      hashMapGet(environmentTop(env), name->data.id.id);
+      scopeGet(environmentTop(env), name->data.id.id);
   if (existing != NULL) {
     // whoops - this already exists! complain!
-    errorRedeclaration(entry, name->line, name->character, name->data.id.id,
-                       existing->file, existing->line, existing->character);
+    errorRedeclaration(entry, name->offset, name->data.id.id, existing->file,
+                       existing->offset);
   }
 
-  hashMapPut(environmentTop(env), name->data.id.id, name->data.id.entry);
+  scopePut(environmentTop(env), name->data.id.id, name->data.id.entry);
   return opaqueDeclNodeCreate(start, name);
 }
 
@@ -2867,10 +2682,13 @@ static Node *parseStructDecl(FileListEntry *entry, Node *unparsed,
   }
 
   if (fields->size == 0) {
-    fprintf(stderr,
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, lbrace.offset, &line, &character);
+    fprintf(diagnosticStream(),
             "%s:%zu:%zu: error: expected at least one field in a struct "
             "declaration\n",
-            entry->inputFilename, lbrace.line, lbrace.character);
+            entry->inputFilename, line, character);
     entry->errored = true;
 
     nodeFree(name);
@@ -2892,7 +2710,7 @@ static Node *parseStructDecl(FileListEntry *entry, Node *unparsed,
 
   Node *body = structDeclNodeCreate(start, name, fields);
   SymbolTableEntry *existing =
-      hashMapGet(environmentTop(env), name->data.id.id);
+      scopeGet(environmentTop(env), name->data.id.id);
   if (existing != NULL) {
     if (existing->kind == SK_OPAQUE) {
       // overwrite the opaque
@@ -2900,17 +2718,19 @@ static Node *parseStructDecl(FileListEntry *entry, Node *unparsed,
       existing->kind = SK_STRUCT;
       vectorInit(&existing->data.structType.fieldNames);
       vectorInit(&existing->data.structType.fieldTypes);
+      hashMapInit(&existing->data.structType.fieldIndices);
+      atomic_init(&existing->data.structType.layout, NULL);
       finishStructStab(entry, body, name->data.id.entry, env);
     } else {
       // whoops - this already exists! complain!
-      errorRedeclaration(entry, name->line, name->character, name->data.id.id,
-                         existing->file, existing->line, existing->character);
+      errorRedeclaration(entry, name->offset, name->data.id.id, existing->file,
+                         existing->offset);
     }
   } else {
     // create a new entry
     name->data.id.entry = structStabEntryCreate(
-        entry, start->line, start->character, name->data.id.id);
-    hashMapPut(environmentTop(env), name->data.id.id, name->data.id.entry);
+        entry, start->offset, name->data.id.id);
+    scopePut(environmentTop(env), name->data.id.id, name->data.id.entry);
     finishStructStab(entry, body, name->data.id.entry, env);
   }
 
@@ -2995,10 +2815,13 @@ static Node *parseUnionDecl(FileListEntry *entry, Node *unparsed,
   }
 
   if (options->size == 0) {
-    fprintf(stderr,
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, lbrace.offset, &line, &character);
+    fprintf(diagnosticStream(),
             "%s:%zu:%zu: error: expected at least one options in a union "
             "declaration\n",
-            entry->inputFilename, lbrace.line, lbrace.character);
+            entry->inputFilename, line, character);
     entry->errored = true;
 
     nodeFree(name);
@@ -3020,7 +2843,7 @@ static Node *parseUnionDecl(FileListEntry *entry, Node *unparsed,
 
   Node *body = unionDeclNodeCreate(start, name, options);
   SymbolTableEntry *existing =
-      hashMapGet(environmentTop(env), name->data.id.id);
+      scopeGet(environmentTop(env), name->data.id.id);
   if (existing != NULL) {
     if (existing->kind == SK_OPAQUE) {
       // overwrite the opaque
@@ -3028,17 +2851,19 @@ static Node *parseUnionDecl(FileListEntry *entry, Node *unparsed,
       existing->kind = SK_UNION;
       vectorInit(&existing->data.unionType.optionNames);
       vectorInit(&existing->data.unionType.optionTypes);
+      hashMapInit(&existing->data.unionType.optionIndices);
+      atomic_init(&existing->data.unionType.layout, NULL);
       finishUnionStab(entry, body, name->data.id.entry, env);
     } else {
       // whoops - this already exists! complain!
-      errorRedeclaration(entry, name->line, name->character, name->data.id.id,
-                         existing->file, existing->line, existing->character);
+      errorRedeclaration(entry, name->offset, name->data.id.id, existing->file,
+                         existing->offset);
     }
   } else {
     // create a new entry
     name->data.id.entry = unionStabEntryCreate(
-        entry, start->line, start->character, name->data.id.id);
-    hashMapPut(environmentTop(env), name->data.id.id, name->data.id.entry);
+        entry, start->offset, name->data.id.id);
+    scopePut(environmentTop(env), name->data.id.id, name->data.id.entry);
     finishUnionStab(entry, body, name->data.id.entry, env);
   }
 
@@ -3163,10 +2988,13 @@ static Node *parseEnumDecl(FileListEntry *entry, Node *unparsed,
   }
 
   if (constantNames->size == 0) {
-    fprintf(stderr,
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, lbrace.offset, &line, &character);
+    fprintf(diagnosticStream(),
             "%s:%zu:%zu: error: expected at least one enumeration constant in "
             "a enumeration declaration\n",
-            entry->inputFilename, lbrace.line, lbrace.character);
+            entry->inputFilename, line, character);
     entry->errored = true;
 
     panicStmt(unparsed);
@@ -3193,7 +3021,7 @@ static Node *parseEnumDecl(FileListEntry *entry, Node *unparsed,
 
   Node *body = enumDeclNodeCreate(start, name, constantNames, constantValues);
   SymbolTableEntry *existing =
-      hashMapGet(environmentTop(env), name->data.id.id);
+      scopeGet(environmentTop(env), name->data.id.id);
   if (existing != NULL) {
     if (existing->kind == SK_OPAQUE) {
       // overwrite the opaque
@@ -3204,14 +3032,14 @@ static Node *parseEnumDecl(FileListEntry *entry, Node *unparsed,
       finishEnumStab(entry, body, name->data.id.entry, env);
     } else {
       // whoops - this already exists! complain!
-      errorRedeclaration(entry, name->line, name->character, name->data.id.id,
-                         existing->file, existing->line, existing->character);
+      errorRedeclaration(entry, name->offset, name->data.id.id, existing->file,
+                         existing->offset);
     }
   } else {
     // create a new entry
     name->data.id.entry = enumStabEntryCreate(
-        entry, start->line, start->character, name->data.id.id);
-    hashMapPut(environmentTop(env), name->data.id.id, name->data.id.entry);
+        entry, start->offset, name->data.id.id);
+    scopePut(environmentTop(env), name->data.id.id, name->data.id.entry);
     finishEnumStab(entry, body, name->data.id.entry, env);
   }
 
@@ -3260,7 +3088,7 @@ static Node *parseTypedefDecl(FileListEntry *entry, Node *unparsed,
 
   Node *body = typedefDeclNodeCreate(start, originalType, name);
   SymbolTableEntry *existing =
-      hashMapGet(environmentTop(env), name->data.id.id);
+      scopeGet(environmentTop(env), name->data.id.id);
   if (existing != NULL) {
     if (existing->kind == SK_OPAQUE) {
       // overwrite the opaque
@@ -3269,14 +3097,14 @@ static Node *parseTypedefDecl(FileListEntry *entry, Node *unparsed,
       finishTypedefStab(entry, body, name->data.id.entry, env);
     } else {
       // whoops - this already exists! complain!
-      errorRedeclaration(entry, name->line, name->character, name->data.id.id,
-                         existing->file, existing->line, existing->character);
+      errorRedeclaration(entry, name->offset, name->data.id.id, existing->file,
+                         existing->offset);
     }
   } else {
     // create a new entry
     name->data.id.entry = typedefStabEntryCreate(
-        entry, start->line, start->character, name->data.id.id);
-    hashMapPut(environmentTop(env), name->data.id.id, name->data.id.entry);
+        entry, start->offset, name->data.id.id);
+    scopePut(environmentTop(env), name->data.id.id, name->data.id.entry);
     finishTypedefStab(entry, body, name->data.id.entry, env);
   }
 
@@ -3437,12 +3265,34 @@ static Node *parseStmt(FileListEntry *entry, Node *unparsed, Environment *env) {
   }
 }
 
-void parseFunctionBody(FileListEntry *entry) {
+void functionBodySizes(FileListEntry const *entry, size_t *sizes) {
+  Vector *bodies = entry->ast->data.file.bodies;
+  size_t lastIdx = bodies->size;  // last function definition seen, if any
+  for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx) {
+    Node *body = bodies->elements[bodyIdx];
+    sizes[bodyIdx] = 0;
+    if (body->type != NT_FUNDEFN) continue;
+
+    // bodies' tokens are stored one after the other, in order
+    size_t begin = body->data.funDefn.body->data.unparsed.curr;
+    if (lastIdx != bodies->size) {
+      Node *last = bodies->elements[lastIdx];
+      sizes[lastIdx] = begin - last->data.funDefn.body->data.unparsed.curr;
+    }
+    lastIdx = bodyIdx;
+  }
+  if (lastIdx != bodies->size) {
+    Node *last = bodies->elements[lastIdx];
+    sizes[lastIdx] = entry->ast->data.file.bodyTokens->size -
+                     last->data.funDefn.body->data.unparsed.curr;
+  }
+}
+
+void parseFunctionBodies(FileListEntry *entry, size_t begin, size_t end) {
   Environment env;
   environmentInit(&env, entry);
 
-  for (size_t bodyIdx = 0; bodyIdx < entry->ast->data.file.bodies->size;
-       ++bodyIdx) {
+  for (size_t bodyIdx = begin; bodyIdx < end; ++bodyIdx) {
     // for each top level thing
     Node *body = entry->ast->data.file.bodies->elements[bodyIdx];
     switch (body->type) {
@@ -3451,25 +3301,24 @@ void parseFunctionBody(FileListEntry *entry) {
         SymbolTableEntry *functionEntry =
             body->data.funDefn.name->data.id.entry;
         // setup stab for arguments
-        HashMap *stab = body->data.funDefn.argStab;
-        environmentPush(&env, stab);
+        environmentPush(&env);
 
         for (size_t argIdx = 0; argIdx < body->data.funDefn.argTypes->size;
              ++argIdx) {
           Node *argType = body->data.funDefn.argTypes->elements[argIdx];
           Node *argName = body->data.funDefn.argNames->elements[argIdx];
           SymbolTableEntry *stabEntry = variableStabEntryCreate(
-              entry, argType->line, argType->character, argName->data.id.id);
+              entry, argType->offset, argName->data.id.id);
           stabEntry->data.variable.type = nodeToType(argType, &env);
           if (stabEntry->data.variable.type == NULL) entry->errored = true;
-          SymbolTableEntry *existing = hashMapGet(stab, argName->data.id.id);
+          SymbolTableEntry *existing =
+              scopeGet(environmentTop(&env), argName->data.id.id);
           if (existing != NULL) {
             // already exists - complain!
-            errorRedeclaration(entry, argName->line, argName->character,
-                               argName->data.id.id, existing->file,
-                               existing->line, existing->character);
+            errorRedeclaration(entry, argName->offset, argName->data.id.id,
+                               existing->file, existing->offset);
           } else {
-            hashMapPut(stab, argName->data.id.id, stabEntry);
+            scopePut(environmentTop(&env), argName->data.id.id, stabEntry);
             vectorInsert(&functionEntry->data.function.argumentEntries,
                          stabEntry);
           }
@@ -3480,7 +3329,9 @@ void parseFunctionBody(FileListEntry *entry) {
         body->data.funDefn.body = parseCompoundStmt(entry, unparsed, &env);
         nodeFree(unparsed);
 
-        environmentPop(&env);
+        Scope argStab;
+        environmentPop(&env, &argStab);
+        body->data.funDefn.argStab = nodeScopeFreeze(&argStab);
         break;
       }
       default: {
@@ -3491,4 +3342,10 @@ void parseFunctionBody(FileListEntry *entry) {
   }
 
   environmentUninit(&env);
+}
+
+void finishFunctionBodies(FileListEntry *entry) {
+  // every body has been parsed - their tokens are no longer needed
+  tokenVectorFree(entry->ast->data.file.bodyTokens);
+  entry->ast->data.file.bodyTokens = NULL;
 }
\ No newline at end of file
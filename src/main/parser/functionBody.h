@@ -25,13 +25,38 @@
 #ifndef TLC_PARSER_FUNCTIONBODY_H_
 #define TLC_PARSER_FUNCTIONBODY_H_
 
+#include <stddef.h>
+
 #include "ast/ast.h"
 
 /**
- * parses all of the function bodies (unparsed nodes)
+ * measures the unparsed function bodies among a file's top level bodies
+ *
+ * @param entry entry to measure
+ * @param sizes array with an element for each top level body, to write the
+ * number of tokens in each function body into (zero if the top level body
+ * isn't a function definition)
+ */
+void functionBodySizes(FileListEntry const *entry, size_t *sizes);
+
+/**
+ * parses the function bodies (unparsed nodes) among some of a file's top level
+ * bodies
+ *
+ * function bodies only read the top level symbol tables, so disjoint ranges of
+ * the same file may be parsed concurrently
  *
  * @param entry entry to read
+ * @param begin index of the first top level body to parse
+ * @param end index one past the last top level body to parse
+ */
+void parseFunctionBodies(FileListEntry *entry, size_t begin, size_t end);
+
+/**
+ * releases the tokens of a file's function bodies, once they've all been parsed
+ *
+ * @param entry entry to finish
  */
-void parseFunctionBody(FileListEntry *entry);
+void finishFunctionBodies(FileListEntry *entry);
 
 #endif  // TLC_PARSER_FUNCTIONBODY_H_
\ No newline at end of file
@@ -0,0 +1,258 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of the module import graph
+
+#include "parser/importGraph.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fileList.h"
+
+/** marks files left out of the graph, and nodes not visited yet */
+#define NONE SIZE_MAX
+
+/**
+ * gets the node a file belongs to - the module's declaration file, if there is
+ * one
+ *
+ * @param idx index of the file
+ * @returns index of the file standing for the node, or NONE if the file is
+ * left out
+ */
+static size_t nodeOf(size_t idx) {
+  FileListEntry *entry = &fileList.entries[idx];
+  if (entry->preparsed) return NONE;
+  if (!entry->isCode) return idx;
+
+  FileListEntry *declEntry =
+      fileListFindDeclName(entry->ast->data.file.module->data.module.id);
+  if (declEntry == NULL || declEntry->preparsed) return idx;
+  return (size_t)(declEntry - fileList.entries);
+}
+
+/**
+ * calls visit for each import edge of the graph, from the importing node to the
+ * imported node
+ *
+ * @param nodes node of each file
+ * @param visit function to call with the two nodes and context
+ * @param context extra data to pass to visit
+ */
+static void forEachEdge(size_t const *nodes,
+                        void (*visit)(size_t, size_t, void *), void *context) {
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    if (nodes[idx] == NONE) continue;
+    Vector *imports = fileList.entries[idx].ast->data.file.imports;
+    for (size_t importIdx = 0; importIdx < imports->size; ++importIdx) {
+      // repeated imports are only linked once
+      FileListEntry const *referenced =
+          ((Node *)imports->elements[importIdx])->data.import.referenced;
+      if (referenced == NULL) continue;
+
+      size_t imported = (size_t)(referenced - fileList.entries);
+      if (nodes[imported] != NONE && nodes[imported] != nodes[idx])
+        visit(nodes[idx], nodes[imported], context);
+    }
+  }
+}
+
+/** adjacency lists of the nodes, indexed by file */
+typedef struct {
+  size_t *starts; /**< where each node's edges start, plus the end */
+  size_t *edges;  /**< nodes each node imports */
+  size_t *fill;   /**< next free edge of each node, while filling */
+} Adjacency;
+
+/**
+ * counts an edge
+ */
+static void countEdge(size_t from, size_t to, void *rawAdjacency) {
+  (void)to;
+  Adjacency *adjacency = rawAdjacency;
+  ++adjacency->starts[from + 1];
+}
+
+/**
+ * records an edge
+ */
+static void fillEdge(size_t from, size_t to, void *rawAdjacency) {
+  Adjacency *adjacency = rawAdjacency;
+  adjacency->edges[adjacency->fill[from]++] = to;
+}
+
+/** a node being visited by the strongly connected component search */
+typedef struct {
+  size_t node; /**< node being visited */
+  size_t edge; /**< next edge of the node to follow */
+} Frame;
+
+/**
+ * finds the strongly connected components of the graph with Tarjan's
+ * algorithm, numbering them in the order they're completed, so each component
+ * comes after the components it can reach
+ *
+ * @param nodes node of each file
+ * @param adjacency edges of the graph
+ * @param components output array - component of each node, or NONE for files
+ * that aren't nodes
+ * @returns number of components
+ */
+static size_t findComponents(size_t const *nodes, Adjacency const *adjacency,
+                             size_t *components) {
+  size_t numFiles = fileList.size;
+  size_t *order = malloc(sizeof(size_t) * numFiles);
+  size_t *lowLink = malloc(sizeof(size_t) * numFiles);
+  bool *onStack = calloc(numFiles, sizeof(bool));
+  size_t *stack = malloc(sizeof(size_t) * numFiles);
+  Frame *frames = malloc(sizeof(Frame) * numFiles);
+  size_t stackSize = 0;
+  size_t numVisited = 0;
+  size_t numComponents = 0;
+  for (size_t idx = 0; idx < numFiles; ++idx) {
+    order[idx] = NONE;
+    components[idx] = NONE;
+  }
+
+  for (size_t root = 0; root < numFiles; ++root) {
+    if (nodes[root] != root || order[root] != NONE) continue;
+
+    size_t numFrames = 0;
+    size_t next = root;
+    while (true) {
+      if (next != NONE) {
+        // start visiting a node
+        order[next] = lowLink[next] = numVisited++;
+        stack[stackSize++] = next;
+        onStack[next] = true;
+        frames[numFrames++] = (Frame){next, adjacency->starts[next]};
+        next = NONE;
+      }
+
+      Frame *frame = &frames[numFrames - 1];
+      size_t node = frame->node;
+      if (frame->edge < adjacency->starts[node + 1]) {
+        // follow the next edge
+        size_t to = adjacency->edges[frame->edge++];
+        if (order[to] == NONE)
+          next = to;
+        else if (onStack[to] && order[to] < lowLink[node])
+          lowLink[node] = order[to];
+        continue;
+      }
+
+      // done with the node
+      if (lowLink[node] == order[node]) {
+        size_t member;
+        do {
+          member = stack[--stackSize];
+          onStack[member] = false;
+          components[member] = numComponents;
+        } while (member != node);
+        ++numComponents;
+      }
+      if (--numFrames == 0) break;
+      size_t parent = frames[numFrames - 1].node;
+      if (lowLink[node] < lowLink[parent]) lowLink[parent] = lowLink[node];
+    }
+  }
+
+  free(frames);
+  free(stack);
+  free(onStack);
+  free(lowLink);
+  free(order);
+  return numComponents;
+}
+
+void importGraphInit(ImportGraph *graph) {
+  size_t numFiles = fileList.size;
+  size_t *nodes = malloc(sizeof(size_t) * numFiles);
+  for (size_t idx = 0; idx < numFiles; ++idx) nodes[idx] = nodeOf(idx);
+
+  Adjacency adjacency;
+  adjacency.starts = calloc(numFiles + 1, sizeof(size_t));
+  forEachEdge(nodes, countEdge, &adjacency);
+  for (size_t idx = 0; idx < numFiles; ++idx)
+    adjacency.starts[idx + 1] += adjacency.starts[idx];
+  adjacency.edges = malloc(sizeof(size_t) * adjacency.starts[numFiles]);
+  adjacency.fill = malloc(sizeof(size_t) * numFiles);
+  memcpy(adjacency.fill, adjacency.starts, sizeof(size_t) * numFiles);
+  forEachEdge(nodes, fillEdge, &adjacency);
+  free(adjacency.fill);
+
+  size_t *components = malloc(sizeof(size_t) * numFiles);
+  graph->size = findComponents(nodes, &adjacency, components);
+
+  // files of each component, by counting sort, so they stay in order
+  graph->fileStarts = calloc(graph->size + 1, sizeof(size_t));
+  for (size_t idx = 0; idx < numFiles; ++idx) {
+    if (nodes[idx] != NONE) ++graph->fileStarts[components[nodes[idx]] + 1];
+  }
+  for (size_t component = 0; component < graph->size; ++component)
+    graph->fileStarts[component + 1] += graph->fileStarts[component];
+  graph->files = malloc(sizeof(size_t) * graph->fileStarts[graph->size]);
+  size_t *fill = malloc(sizeof(size_t) * graph->size);
+  memcpy(fill, graph->fileStarts, sizeof(size_t) * graph->size);
+  for (size_t idx = 0; idx < numFiles; ++idx) {
+    if (nodes[idx] != NONE) graph->files[fill[components[nodes[idx]]]++] = idx;
+  }
+  free(fill);
+
+  // imports of each component, without repeats
+  size_t *lastImporter = malloc(sizeof(size_t) * graph->size);
+  for (size_t component = 0; component < graph->size; ++component)
+    lastImporter[component] = NONE;
+  graph->importStarts = malloc(sizeof(size_t) * (graph->size + 1));
+  graph->imports = malloc(sizeof(size_t) * adjacency.starts[numFiles]);
+  size_t numImports = 0;
+  for (size_t component = 0; component < graph->size; ++component) {
+    graph->importStarts[component] = numImports;
+    for (size_t fileIdx = graph->fileStarts[component];
+         fileIdx < graph->fileStarts[component + 1]; ++fileIdx) {
+      size_t node = graph->files[fileIdx];
+      if (nodes[node] != node) continue;
+      for (size_t edge = adjacency.starts[node];
+           edge < adjacency.starts[node + 1]; ++edge) {
+        size_t imported = components[adjacency.edges[edge]];
+        if (imported == component || lastImporter[imported] == component)
+          continue;
+        lastImporter[imported] = component;
+        graph->imports[numImports++] = imported;
+      }
+    }
+  }
+  graph->importStarts[graph->size] = numImports;
+  free(lastImporter);
+
+  free(components);
+  free(adjacency.edges);
+  free(adjacency.starts);
+  free(nodes);
+}
+
+void importGraphUninit(ImportGraph *graph) {
+  free(graph->fileStarts);
+  free(graph->files);
+  free(graph->importStarts);
+  free(graph->imports);
+}
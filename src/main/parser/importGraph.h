@@ -0,0 +1,66 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * the module import graph, condensed into strongly connected components
+ *
+ * A module's declaration file and code files are one node of the graph, and
+ * each import is an edge to the imported module. Modules that import each
+ * other, directly or not, form one component; the components themselves form
+ * a DAG, which lets the passes that build top level symbol tables handle a
+ * module as soon as everything it imports has been handled.
+ */
+
+#ifndef TLC_PARSER_IMPORTGRAPH_H_
+#define TLC_PARSER_IMPORTGRAPH_H_
+
+#include <stddef.h>
+
+/** the components of the import graph, in topological order */
+typedef struct {
+  size_t size;        /**< number of components */
+  size_t *fileStarts; /**< where each component's files start in files, with
+                           one extra element marking the end */
+  size_t *files; /**< indices of each component's files, in increasing order
+                      within each component */
+  size_t *importStarts; /**< where each component's imports start in imports,
+                             with one extra element marking the end */
+  size_t *imports; /**< components each component imports from - always
+                        earlier components, and never repeated */
+} ImportGraph;
+
+/**
+ * builds the import graph of the files in the file list
+ *
+ * Must be called after imports are resolved. Preparsed files are left out,
+ * since they're already complete
+ *
+ * @param graph graph to initialize
+ */
+void importGraphInit(ImportGraph *graph);
+
+/**
+ * uninitializes an import graph
+ *
+ * @param graph graph to uninitialize
+ */
+void importGraphUninit(ImportGraph *graph);
+
+#endif  // TLC_PARSER_IMPORTGRAPH_H_
@@ -0,0 +1,218 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Lazy loading of declaration modules
+
+#include "parser/lazyDecls.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fileList.h"
+#include "lexer/lexer.h"
+#include "options.h"
+#include "util/container/hashMap.h"
+#include "util/container/vector.h"
+#include "util/diagnostics.h"
+#include "util/format.h"
+#include "util/functional.h"
+#include "util/parallel.h"
+
+/** the module and import lines at the start of a file */
+typedef struct {
+  bool valid;     /**< were the lines read without any errors? */
+  char *module;   /**< name of the module, owning, or NULL */
+  Vector imports; /**< vector of char *, owning - names of imported modules */
+} FileHeader;
+
+/**
+ * lexes a possibly scoped id
+ *
+ * @param entry entry to lex from
+ * @param next output parameter for the token after the id, or the offending
+ * token if there was no id - owned by the caller
+ * @returns id, stringified as by stringifyId, or NULL if there was no id
+ */
+static char *scanAnyId(FileListEntry *entry, Token *next) {
+  lex(entry, next);
+  if (next->type != TT_ID) return NULL;
+
+  char *id = strdup(next->string);
+  while (true) {
+    lex(entry, next);
+    if (next->type != TT_SCOPE) return id;
+
+    lex(entry, next);
+    if (next->type != TT_ID) {
+      free(id);
+      return NULL;
+    }
+    char *old = id;
+    id = format("%s::%s", old, next->string);
+    free(old);
+    tokenUninit(next);
+  }
+}
+
+/**
+ * reads the module and import lines of the file at the given index
+ *
+ * diagnostics are discarded - a file that can't be read is kept, and parsing
+ * it reports them again
+ *
+ * @param idx index of the file
+ * @param rawHeaders array of FileHeader to read into
+ */
+static void scanHeader(size_t idx, void *rawHeaders) {
+  FileListEntry *entry = &fileList.entries[idx];
+  FileHeader *header = &((FileHeader *)rawHeaders)[idx];
+  header->valid = false;
+  header->module = NULL;
+  vectorInit(&header->imports);
+  if (entry->preparsed) return;
+
+  DiagnosticBuffer buffer;
+  diagnosticBufferBegin(&buffer);
+  if (lexerStateInit(entry) == 0) {
+    Token token;
+    lex(entry, &token);
+    if (token.type == TT_MODULE) {
+      header->module = scanAnyId(entry, &token);
+      bool ok = header->module != NULL && token.type == TT_SEMI;
+      while (ok) {
+        lex(entry, &token);
+        if (token.type != TT_IMPORT) {
+          header->valid = true;
+          break;
+        }
+        char *import = scanAnyId(entry, &token);
+        if (import != NULL) vectorInsert(&header->imports, import);
+        ok = import != NULL && token.type == TT_SEMI;
+      }
+    }
+    tokenUninit(&token);
+  }
+  lexerStateUninit(entry);
+  diagnosticBufferEnd(&buffer);
+  diagnosticBufferDiscard(&buffer);
+
+  header->valid = header->valid && !entry->errored;
+  entry->errored = false;
+}
+
+/**
+ * marks the declaration files declaring a module as kept, along with
+ * everything they import
+ *
+ * @param modules map from module name to vector of FileHeader declaring it
+ * @param headers headers of all the files
+ * @param keep which files are kept
+ * @param name name of the module to mark
+ */
+static void reach(HashMap *modules, FileHeader *headers, bool *keep,
+                  char *name) {
+  Vector worklist;
+  vectorInit(&worklist);
+  vectorInsert(&worklist, name);
+  while (worklist.size != 0) {
+    Vector *declaring = hashMapGet(modules, worklist.elements[--worklist.size]);
+    if (declaring == NULL) continue;  // reported once parsed
+
+    for (size_t idx = 0; idx < declaring->size; ++idx) {
+      FileHeader *header = declaring->elements[idx];
+      size_t fileIdx = (size_t)(header - headers);
+      if (keep[fileIdx]) continue;
+      keep[fileIdx] = true;
+      for (size_t importIdx = 0; importIdx < header->imports.size; ++importIdx)
+        vectorInsert(&worklist, header->imports.elements[importIdx]);
+    }
+  }
+  vectorUninit(&worklist, nullDtor);
+}
+
+/**
+ * frees a vector of FileHeader *
+ */
+static void headerVectorFree(Vector *v) {
+  vectorUninit(v, nullDtor);
+  free(v);
+}
+
+void lazyDeclsPrune(void) {
+  FileHeader *headers = malloc(sizeof(FileHeader) * fileList.size);
+  parallelFor(options.jobs, fileList.size, scanHeader, headers);
+
+  bool *keep = calloc(fileList.size, sizeof(bool));
+  bool pruning = true;
+  HashMap modules;
+  hashMapInit(&modules);
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    FileHeader *header = &headers[idx];
+    if (fileList.entries[idx].preparsed) {
+      // already checked against the other preparsed files
+      keep[idx] = true;
+    } else if (!header->valid) {
+      pruning = false;
+    } else if (!fileList.entries[idx].isCode) {
+      Vector *declaring = hashMapGet(&modules, header->module);
+      if (declaring == NULL) {
+        declaring = vectorCreate();
+        hashMapPut(&modules, header->module, declaring);
+      }
+      vectorInsert(declaring, header);
+    }
+  }
+
+  size_t numKept = fileList.size;
+  if (pruning) {
+    // code files reach their own declaration module and their imports
+    for (size_t idx = 0; idx < fileList.size; ++idx) {
+      FileHeader *header = &headers[idx];
+      if (!fileList.entries[idx].isCode || fileList.entries[idx].preparsed)
+        continue;
+      keep[idx] = true;
+      reach(&modules, headers, keep, header->module);
+      for (size_t importIdx = 0; importIdx < header->imports.size; ++importIdx)
+        reach(&modules, headers, keep, header->imports.elements[importIdx]);
+    }
+
+    // stably move the dropped entries past the end
+    FileListEntry *entries = malloc(sizeof(FileListEntry) * fileList.size);
+    numKept = 0;
+    for (size_t idx = 0; idx < fileList.size; ++idx) {
+      if (keep[idx]) entries[numKept++] = fileList.entries[idx];
+    }
+    size_t numMoved = numKept;
+    for (size_t idx = 0; idx < fileList.size; ++idx) {
+      if (!keep[idx]) entries[numMoved++] = fileList.entries[idx];
+    }
+    memcpy(fileList.entries, entries, sizeof(FileListEntry) * fileList.size);
+    free(entries);
+  }
+
+  hashMapUninit(&modules, (void (*)(void *))headerVectorFree);
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    free(headers[idx].module);
+    vectorUninit(&headers[idx].imports, free);
+  }
+  free(headers);
+  free(keep);
+  fileList.size = numKept;
+}
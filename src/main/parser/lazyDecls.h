@@ -0,0 +1,43 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * lazy loading of declaration modules, for --lazy-decls
+ *
+ * Only the module and import lines of each file are read up front. A
+ * declaration module is kept only if some code module reaches it, through its
+ * own declaration module or through imports; every other declaration module is
+ * dropped before it is parsed.
+ */
+
+#ifndef TLC_PARSER_LAZYDECLS_H_
+#define TLC_PARSER_LAZYDECLS_H_
+
+/**
+ * drops the declaration modules no code module reaches from the file list
+ *
+ * Dropped entries are moved past the end of the file list, and are otherwise
+ * untouched. If the start of any file can't be read, every file is kept, so
+ * that parsing reports the problem as usual. Must be called after the lexer
+ * maps are initialized, and before anything else is done with the entries
+ */
+void lazyDeclsPrune(void);
+
+#endif  // TLC_PARSER_LAZYDECLS_H_
@@ -22,6 +22,7 @@
 #include <stdio.h>
 
 #include "fileList.h"
+#include "util/diagnostics.h"
 #include "util/internalError.h"
 
 /**
@@ -70,19 +71,25 @@ static void checkStmt(FileListEntry *entry, Node *stmt, bool inSwitch) {
     }
     case NT_BREAKSTMT: {
       if (!inSwitch) {
-        fprintf(stderr,
+        size_t line;
+        size_t character;
+        fileListEntryPosition(entry, stmt->offset, &line, &character);
+        fprintf(diagnosticStream(),
                 "%s:%zu:%zu: error: break statements may not be outside of a "
                 "loop or a switch\n",
-                entry->inputFilename, stmt->line, stmt->character);
+                entry->inputFilename, line, character);
         entry->errored = true;
       }
       break;
     }
     case NT_CONTINUESTMT: {
-      fprintf(stderr,
+      size_t line;
+      size_t character;
+      fileListEntryPosition(entry, stmt->offset, &line, &character);
+      fprintf(diagnosticStream(),
               "%s:%zu:%zu: error: continue statements may not be outside of "
               "a loop\n",
-              entry->inputFilename, stmt->line, stmt->character);
+              entry->inputFilename, line, character);
       entry->errored = true;
     }
     default: {
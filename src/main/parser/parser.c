@@ -19,11 +19,402 @@
 
 #include "parser/parser.h"
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ast/environment.h"
 #include "fileList.h"
+#include "options.h"
 #include "parser/buildStab.h"
+#include "parser/declIndex.h"
 #include "parser/functionBody.h"
+#include "parser/importGraph.h"
+#include "parser/lazyDecls.h"
 #include "parser/miscCheck.h"
 #include "parser/topLevel.h"
+#include "timeReport.h"
+#include "util/diagnostics.h"
+#include "util/internalError.h"
+#include "util/parallel.h"
+
+/**
+ * lexes and parses the top level of a file, or loads it from its precompiled
+ * declarations
+ *
+ * @param entry entry to parse
+ * @param useDeclIndex should precompiled declarations be used if available
+ */
+static void parseTopLevelFile(FileListEntry *entry, bool useDeclIndex) {
+  if (lexerStateInit(entry) != 0) {
+    entry->errored = true;
+  } else {
+    if (!useDeclIndex || declIndexLoad(entry) != 0)
+      entry->ast = parseFile(entry);
+    lexerStateUninit(entry);
+  }
+}
+
+/**
+ * pass one for a single file - lexes and parses the top level of the file
+ *
+ * files are independent at this point, so this may be run concurrently
+ *
+ * @param idx index of the file to parse
+ * @param rawBuffers array of DiagnosticBuffer to capture each file's
+ * diagnostics in, or NULL to report them directly
+ */
+static void parseTopLevel(size_t idx, void *rawBuffers) {
+  DiagnosticBuffer *buffers = rawBuffers;
+  FileListEntry *entry = &fileList.entries[idx];
+  if (buffers != NULL) diagnosticBufferBegin(&buffers[idx]);
+  timeReportFileBegin(TRP_PARSE_TOP_LEVEL, idx);
+
+  if (!entry->preparsed)
+    parseTopLevelFile(entry, options.declIndex && !entry->isCode);
+
+  timeReportFileEnd(TRP_PARSE_TOP_LEVEL, idx);
+  if (buffers != NULL) diagnosticBufferEnd(&buffers[idx]);
+}
+
+/** steps of passes three to six, in the order their diagnostics are reported */
+typedef enum {
+  SS_START_DECL,    /**< pass three, for decl files */
+  SS_RESOLVE,       /**< pass three, for precompiled declarations */
+  SS_START_CODE,    /**< pass three, for code files */
+  SS_SCOPED_IDS,    /**< pass four */
+  SS_ENUM_LOOKUPS,  /**< pass five, looking up the constants enums refer to */
+  SS_ENUM_VALUES,   /**< pass five, computing enum values - reported with the
+                         component's first file */
+  SS_FINISH_DECL,   /**< pass six, for decl files */
+  SS_FINISH_CODE,   /**< pass six, for code files */
+  SS_NUM_STEPS,
+} StabStep;
+
+/**
+ * the stage each step is part of, indexed by StabStep
+ *
+ * a stage only runs if every stage before it succeeded, but the steps of a
+ * stage all run. Pass five is two stages, since enum values are only computed
+ * once every constant has been looked up
+ */
+static int const STEP_STAGES[] = {0, 0, 0, 1, 2, 3, 4, 4};
+
+/** number of stages */
+#define NUM_STAB_STAGES 5
+
+/** passes three to six, run over the components of the import graph */
+typedef struct {
+  ImportGraph graph;
+  DiagnosticBuffer *diagnostics[SS_NUM_STEPS]; /**< for each step, each file's
+                                                    captured diagnostics */
+  int *lastStage; /**< last stage each component went through */
+  bool *failed;   /**< did each component's last stage report an error? */
+} StabPasses;
+
+/**
+ * runs one step of passes three to six over the files of a component
+ *
+ * @param passes passes being run
+ * @param component index of the component
+ * @param step step to run
+ * @param enums the component's top level enums, for pass five
+ * @returns whether an error was reported
+ */
+static bool runStabStep(StabPasses *passes, size_t component, StabStep step,
+                        TopLevelEnums *enums) {
+  ImportGraph *graph = &passes->graph;
+  size_t const *files = &graph->files[graph->fileStarts[component]];
+  size_t numFiles =
+      graph->fileStarts[component + 1] - graph->fileStarts[component];
+
+  if (step == SS_ENUM_VALUES) {
+    // enums in a component may depend on each other, so they're done together
+    DiagnosticBuffer *buffer = &passes->diagnostics[step][files[0]];
+    diagnosticBufferBegin(buffer);
+    timeReportFileBegin(TRP_PARSE_ENUM_STAB, files[0]);
+    bool errored = buildTopLevelEnumStab(enums) != 0;
+    timeReportFileEnd(TRP_PARSE_ENUM_STAB, files[0]);
+    diagnosticBufferEnd(buffer);
+    return errored;
+  }
+
+  bool errored = false;
+  for (size_t idx = 0; idx < numFiles; ++idx) {
+    FileListEntry *entry = &fileList.entries[files[idx]];
+    TimeReportPhase phase;
+    switch (step) {
+      case SS_START_DECL:
+      case SS_START_CODE: {
+        if (entry->isCode != (step == SS_START_CODE)) continue;
+        phase = TRP_PARSE_START_STAB;
+        break;
+      }
+      case SS_RESOLVE: {
+        if (entry->declIndex == NULL) continue;
+        phase = TRP_PARSE_START_STAB;
+        break;
+      }
+      case SS_SCOPED_IDS: {
+        phase = TRP_PARSE_SCOPED_IDS;
+        break;
+      }
+      case SS_ENUM_LOOKUPS: {
+        phase = TRP_PARSE_ENUM_STAB;
+        break;
+      }
+      case SS_FINISH_DECL:
+      case SS_FINISH_CODE: {
+        if (entry->isCode != (step == SS_FINISH_CODE)) continue;
+        phase = TRP_PARSE_FINISH_STAB;
+        break;
+      }
+      default: {
+        error(__FILE__, __LINE__, "invalid StabStep enum encountered");
+      }
+    }
+
+    DiagnosticBuffer *buffer = &passes->diagnostics[step][files[idx]];
+    diagnosticBufferBegin(buffer);
+    timeReportFileBegin(phase, files[idx]);
+    switch (step) {
+      case SS_START_DECL:
+      case SS_START_CODE: {
+        startTopLevelStab(entry);
+        break;
+      }
+      case SS_RESOLVE: {
+        declIndexResolve(entry);
+        break;
+      }
+      case SS_SCOPED_IDS: {
+        checkScopedIdCollisions(entry);
+        // every imported symbol table is complete by now
+        entry->ast->data.file.importIndex = importIndexCreate(entry);
+        break;
+      }
+      case SS_ENUM_LOOKUPS: {
+        errored = resolveTopLevelEnums(enums, entry) != 0 || errored;
+        break;
+      }
+      case SS_FINISH_DECL:
+      case SS_FINISH_CODE: {
+        finishTopLevelStab(entry);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    timeReportFileEnd(phase, files[idx]);
+    diagnosticBufferEnd(buffer);
+    errored = errored || entry->errored;
+  }
+  return errored;
+}
+
+/**
+ * passes three to six for a single component of the import graph - builds the
+ * top level symbol tables of its files
+ *
+ * runs once every component it imports from is done. A stage stops the
+ * component if it reports an error, and the component only goes as far as the
+ * components it imports from went, so each stage that runs sees the same
+ * symbol tables it would if it were run over every file at once. Enum values
+ * can't be computed from the constants of a failed stage, though, so only the
+ * lookups are done after one
+ *
+ * @param component index of the component
+ * @param rawPasses StabPasses being run
+ */
+static void buildComponentStab(size_t component, void *rawPasses) {
+  StabPasses *passes = rawPasses;
+  ImportGraph *graph = &passes->graph;
+
+  int limit = NUM_STAB_STAGES - 1;
+  for (size_t edge = graph->importStarts[component];
+       edge < graph->importStarts[component + 1]; ++edge) {
+    size_t imported = graph->imports[edge];
+    int importLimit = passes->lastStage[imported];
+    if (importLimit == STEP_STAGES[SS_ENUM_VALUES] && passes->failed[imported])
+      importLimit = STEP_STAGES[SS_ENUM_LOOKUPS];
+    if (importLimit < limit) limit = importLimit;
+  }
+
+  TopLevelEnums enums;
+  bool enumsInitialized = false;
+  int lastStage = -1;
+  bool failed = false;
+  for (StabStep step = 0; step < SS_NUM_STEPS && STEP_STAGES[step] <= limit;
+       ++step) {
+    if (failed && STEP_STAGES[step] != lastStage) break;
+    lastStage = STEP_STAGES[step];
+    if (step == SS_ENUM_LOOKUPS) {
+      topLevelEnumsInit(&enums, &graph->files[graph->fileStarts[component]],
+                        graph->fileStarts[component + 1] -
+                            graph->fileStarts[component]);
+      enumsInitialized = true;
+    }
+    failed = runStabStep(passes, component, step, &enums) || failed;
+  }
+  if (enumsInitialized) topLevelEnumsUninit(&enums);
+  passes->lastStage[component] = lastStage;
+  passes->failed[component] = failed;
+}
+
+/**
+ * reports the diagnostics of passes three to six, as if each stage had been
+ * run over every file in turn, stopping at the first stage that failed
+ *
+ * @param passes passes that have been run
+ * @returns 0 if no stage failed, -1 otherwise
+ */
+static int reportStabPasses(StabPasses *passes) {
+  int failedStage = NUM_STAB_STAGES;
+  for (size_t component = 0; component < passes->graph.size; ++component) {
+    if (passes->failed[component] && passes->lastStage[component] < failedStage)
+      failedStage = passes->lastStage[component];
+  }
+
+  for (StabStep step = 0; step < SS_NUM_STEPS; ++step) {
+    for (size_t idx = 0; idx < fileList.size; ++idx) {
+      DiagnosticBuffer *buffer = &passes->diagnostics[step][idx];
+      if (buffer->text == NULL) continue;
+      if (STEP_STAGES[step] <= failedStage)
+        diagnosticBufferFlush(buffer);
+      else
+        diagnosticBufferDiscard(buffer);
+    }
+  }
+
+  return failedStage == NUM_STAB_STAGES ? 0 : -1;
+}
+
+/**
+ * smallest number of tokens worth of function bodies to parse as one chunk in
+ * pass seven, so capturing diagnostics doesn't cost more than the parsing
+ */
+#define MIN_BODY_CHUNK_TOKENS 4096
+
+/** a run of consecutive top level bodies of one file, parsed together */
+typedef struct {
+  size_t fileIdx;               /**< index of the file the bodies are in */
+  size_t begin;                 /**< index of the first top level body */
+  size_t end;                   /**< index one past the last top level body */
+  size_t numTokens;             /**< number of function body tokens */
+  Arena *arena;                 /**< arena the parsed bodies are in */
+  DiagnosticBuffer diagnostics; /**< diagnostics, if captured */
+  TimeReportPart time;
+} BodyChunk;
+
+/** the chunks of pass seven */
+typedef struct {
+  BodyChunk *chunks; /**< chunks, in source order */
+  size_t size;
+  BodyChunk **order; /**< chunks, largest first */
+  bool capture;      /**< should diagnostics be captured? */
+} BodyChunks;
+
+/**
+ * compares chunks by size, largest first
+ *
+ * @param rawA pointer to BodyChunk pointer
+ * @param rawB pointer to BodyChunk pointer
+ * @returns negative, zero or positive as a goes before, with or after b
+ */
+static int bodyChunkCompare(void const *rawA, void const *rawB) {
+  BodyChunk const *a = *(BodyChunk *const *)rawA;
+  BodyChunk const *b = *(BodyChunk *const *)rawB;
+  return (a->numTokens < b->numTokens) - (a->numTokens > b->numTokens);
+}
+
+/**
+ * splits the function bodies of every code file into chunks, with several
+ * chunks per thread if there are enough bodies
+ *
+ * @param chunks chunks to initialize
+ * @param numThreads number of threads the chunks will be parsed by
+ */
+static void bodyChunksInit(BodyChunks *chunks, size_t numThreads) {
+  size_t **sizes = calloc(fileList.size, sizeof(size_t *));
+  size_t totalTokens = 0;
+  size_t maxChunks = 0;
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    FileListEntry *entry = &fileList.entries[fileIdx];
+    if (!entry->isCode) continue;
+    Vector *bodies = entry->ast->data.file.bodies;
+    sizes[fileIdx] = malloc(sizeof(size_t) * (bodies->size + 1));
+    functionBodySizes(entry, sizes[fileIdx]);
+    for (size_t bodyIdx = 0; bodyIdx < bodies->size; ++bodyIdx)
+      totalTokens += sizes[fileIdx][bodyIdx];
+    maxChunks += bodies->size + 1;
+  }
+
+  // a handful of chunks per thread, so threads that finish early can help with
+  // what's left
+  size_t chunkTokens =
+      numThreads <= 1 ? SIZE_MAX : totalTokens / numThreads / 8;
+  if (chunkTokens < MIN_BODY_CHUNK_TOKENS) chunkTokens = MIN_BODY_CHUNK_TOKENS;
+
+  chunks->chunks = malloc(sizeof(BodyChunk) * maxChunks);
+  chunks->size = 0;
+  chunks->capture = numThreads > 1;
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    if (sizes[fileIdx] == NULL) continue;
+    size_t numBodies = fileList.entries[fileIdx].ast->data.file.bodies->size;
+    size_t begin = 0;
+    size_t numTokens = 0;
+    for (size_t bodyIdx = 0; bodyIdx < numBodies; ++bodyIdx) {
+      numTokens += sizes[fileIdx][bodyIdx];
+      if (numTokens >= chunkTokens || bodyIdx + 1 == numBodies) {
+        BodyChunk *chunk = &chunks->chunks[chunks->size++];
+        chunk->fileIdx = fileIdx;
+        chunk->begin = begin;
+        chunk->end = bodyIdx + 1;
+        chunk->numTokens = numTokens;
+        begin = bodyIdx + 1;
+        numTokens = 0;
+      }
+    }
+    free(sizes[fileIdx]);
+  }
+  free(sizes);
+
+  // hand out the biggest chunks first, so one big function doesn't start last -
+  // unless diagnostics go straight to stderr, and have to be in source order
+  chunks->order = malloc(sizeof(BodyChunk *) * chunks->size);
+  for (size_t idx = 0; idx < chunks->size; ++idx)
+    chunks->order[idx] = &chunks->chunks[idx];
+  if (chunks->capture)
+    qsort(chunks->order, chunks->size, sizeof(BodyChunk *), bodyChunkCompare);
+}
+
+/**
+ * pass seven for a single chunk - parses the function bodies in the chunk
+ *
+ * the top level symbol tables are finished at this point, so this may be run
+ * concurrently
+ *
+ * @param idx index of the chunk to parse, in handing-out order
+ * @param rawChunks BodyChunks to parse from
+ */
+static void parseBodyChunk(size_t idx, void *rawChunks) {
+  BodyChunks *chunks = rawChunks;
+  BodyChunk *chunk = chunks->order[idx];
+  if (chunks->capture) diagnosticBufferBegin(&chunk->diagnostics);
+  timeReportPartBegin(&chunk->time);
+
+  // other chunks of the same file are being parsed at the same time, so each
+  // chunk gets its own arena, which the file takes over afterwards
+  chunk->arena = arenaCreate();
+  nodeArenaSet(chunk->arena);
+  parseFunctionBodies(&fileList.entries[chunk->fileIdx], chunk->begin,
+                      chunk->end);
+  nodeArenaSet(NULL);
+
+  timeReportPartEnd(&chunk->time);
+  if (chunks->capture) diagnosticBufferEnd(&chunk->diagnostics);
+}
 
 int parse(void) {
   // IMPLEMENTATION NOTES
@@ -31,8 +422,17 @@ int parse(void) {
   // Since type information is needed to disambiguate variable declarations, the
   // parse and symbol table builder are merged together.
   //
+  // If declaration modules are loaded lazily, pass one starts by reading just
+  // the module and import lines of every file, and drops the decl files no
+  // code file reaches from the file list before anything else is parsed.
+  //
   // Pass one parses everything but function bodies - so the AST exists, but may
-  // contain unparsed nodes.
+  // contain unparsed nodes. Decl files with up-to-date precompiled declarations
+  // are loaded from those instead, as a module, imports, and a symbol table
+  // that is complete except for references to types, which are resolved in
+  // pass three. Those files have no bodies, so later passes skip over them.
+  // Preparsed files (decl files kept by the compile server) already went
+  // through every pass, and are skipped entirely.
   //
   // Pass two resolves imports, by first making sure each decl file uniquely
   // names an import, then linking each import with it's referenced
@@ -55,6 +455,10 @@ int parse(void) {
   // the same as they are declared?), and resolves references in variable
   // definitions.
   //
+  // Passes three through six only need the symbol tables of the modules a
+  // module imports, so they're run on one strongly connected component of the
+  // import graph at a time, once the components it imports from are done.
+  //
   // Pass seven parses function bodies, fills in the symbol table entries for
   // them, checking for collisions, and resolves identifier references (yes,
   // this is a lot of work for one pass)
@@ -76,87 +480,132 @@ int parse(void) {
   //  - cleanup
   //  - return NULL
 
-  int retval = 0;
   bool errored = false; /**< has any part of the whole thing errored */
 
   // pass 1 - parse top level stuff, without populating symbol tables
-  lexerInitMaps();
+  // files are parsed concurrently, with diagnostics reported in file order
+  timeReportBegin(TRP_PARSE_TOP_LEVEL);
+  if (options.lazyDecls) lazyDeclsPrune();
+  DiagnosticBuffer *buffers =
+      options.jobs > 1 ? malloc(sizeof(DiagnosticBuffer) * fileList.size)
+                       : NULL;
+  parallelFor(options.jobs, fileList.size, parseTopLevel, buffers);
   for (size_t idx = 0; idx < fileList.size; ++idx) {
-    retval = lexerStateInit(&fileList.entries[idx]);
-    if (retval != 0) {
-      errored = true;
-      continue;
-    }
-
-    fileList.entries[idx].ast = parseFile(&fileList.entries[idx]);
+    if (buffers != NULL) diagnosticBufferFlush(&buffers[idx]);
     errored = errored || fileList.entries[idx].errored;
-
-    lexerStateUninit(&fileList.entries[idx]);
   }
-  lexerUninitMaps();
-  if (errored) return -1;
-
-  // pass 2 - resolve imports and check for scoped id collision between imports
-  if (resolveImports() != 0) return -1;
-
-  // pass 3 - populate stab
-  for (size_t idx = 0; idx < fileList.size; ++idx) {
-    if (!fileList.entries[idx].isCode) {
-      startTopLevelStab(&fileList.entries[idx]);
-      errored = errored || fileList.entries[idx].errored;
+  free(buffers);
+  // decl files are looked up by module name from here on - a stale decl file
+  // reparsed below still declares the same module
+  if (!errored) fileListIndexDecls();
+  if (!errored && options.declIndex) {
+    // precompiled declarations are stale if anything they were built against
+    // has changed - those files are parsed from source instead
+    bool *stale = calloc(fileList.size, sizeof(bool));
+    for (size_t idx = 0; idx < fileList.size; ++idx) {
+      FileListEntry *entry = &fileList.entries[idx];
+      stale[idx] = entry->declIndex != NULL && !entry->preparsed &&
+                   declIndexValidate(entry) != 0;
     }
-  }
-  for (size_t idx = 0; idx < fileList.size; ++idx) {
-    if (fileList.entries[idx].isCode) {
-      startTopLevelStab(&fileList.entries[idx]);
-      errored = errored || fileList.entries[idx].errored;
+    for (size_t idx = 0; idx < fileList.size; ++idx) {
+      if (stale[idx]) {
+        FileListEntry *entry = &fileList.entries[idx];
+        nodeFree(entry->ast);
+        entry->ast = NULL;
+        declIndexUnload(entry);
+        parseTopLevelFile(entry, false);
+        errored = errored || entry->errored;
+      }
     }
+    free(stale);
   }
+  timeReportEnd(TRP_PARSE_TOP_LEVEL);
   if (errored) return -1;
 
-  // pass 4 - check for scoped id collisions between imports
-  for (size_t idx = 0; idx < fileList.size; ++idx) {
-    checkScopedIdCollisions(&fileList.entries[idx]);
-    errored = errored || fileList.entries[idx].errored;
-  }
-  if (errored) return -1;
-
-  // pass 5 - build and fill in stab for enums - watch out for
-  // dependency loops
-  if (buildTopLevelEnumStab() != 0) return -1;
+  // pass 2 - resolve imports and check for scoped id collision between imports
+  timeReportBegin(TRP_PARSE_IMPORTS);
+  int importStatus = resolveImports();
+  timeReportEnd(TRP_PARSE_IMPORTS);
+  if (importStatus != 0) return -1;
 
-  // pass 6 - fill in stab for everything else
+  // passes 3 to 6 - build the top level symbol tables
+  // modules are handled in import order, so each component of the import graph
+  // is done as soon as everything it imports is; independent components are
+  // done concurrently, with diagnostics reported pass by pass in file order
+  timeReportBegin(TRP_PARSE_TOP_LEVEL_STAB);
+  StabPasses passes;
+  importGraphInit(&passes.graph);
+  for (StabStep step = 0; step < SS_NUM_STEPS; ++step)
+    passes.diagnostics[step] = calloc(fileList.size, sizeof(DiagnosticBuffer));
+  passes.lastStage = malloc(sizeof(int) * passes.graph.size);
+  passes.failed = malloc(sizeof(bool) * passes.graph.size);
+  parallelForDag(options.jobs, passes.graph.size, passes.graph.importStarts,
+                 passes.graph.imports, buildComponentStab, &passes);
+  int stabStatus = reportStabPasses(&passes);
   for (size_t idx = 0; idx < fileList.size; ++idx) {
-    if (!fileList.entries[idx].isCode) {
-      finishTopLevelStab(&fileList.entries[idx]);
-      errored = errored || fileList.entries[idx].errored;
+    // only code files look anything up past pass six - decl files kept for
+    // later compilations mustn't hold on to entries of their imports
+    FileListEntry *entry = &fileList.entries[idx];
+    if (!entry->isCode) {
+      importIndexFree(entry->ast->data.file.importIndex);
+      entry->ast->data.file.importIndex = NULL;
     }
   }
-  for (size_t idx = 0; idx < fileList.size; ++idx) {
-    if (fileList.entries[idx].isCode) {
-      finishTopLevelStab(&fileList.entries[idx]);
-      errored = errored || fileList.entries[idx].errored;
+  free(passes.failed);
+  free(passes.lastStage);
+  for (StabStep step = 0; step < SS_NUM_STEPS; ++step)
+    free(passes.diagnostics[step]);
+  importGraphUninit(&passes.graph);
+  timeReportEnd(TRP_PARSE_TOP_LEVEL_STAB);
+  if (stabStatus != 0) return -1;
+
+  // decl files are complete - save them for later compilations
+  if (options.declIndex) {
+    for (size_t idx = 0; idx < fileList.size; ++idx) {
+      if (!fileList.entries[idx].isCode &&
+          fileList.entries[idx].declIndex == NULL &&
+          !fileList.entries[idx].preparsed)
+        declIndexWrite(&fileList.entries[idx]);
     }
   }
-  if (errored) return -1;
 
   // pass 7 - parse unparsed nodes, writing the symbol table as we go -
   // entries are filled in
+  // function bodies are parsed concurrently, in chunks of consecutive bodies,
+  // with diagnostics reported in source order
+  timeReportBegin(TRP_PARSE_FUNCTION_BODIES);
+  BodyChunks chunks;
+  bodyChunksInit(&chunks, options.jobs);
+  parallelFor(options.jobs, chunks.size, parseBodyChunk, &chunks);
+  for (size_t idx = 0; idx < chunks.size; ++idx) {
+    BodyChunk *chunk = &chunks.chunks[idx];
+    if (chunks.capture) diagnosticBufferFlush(&chunk->diagnostics);
+    timeReportPartAdd(TRP_PARSE_FUNCTION_BODIES, chunk->fileIdx, &chunk->time);
+    arenaAdopt(fileList.entries[chunk->fileIdx].ast->data.file.arena,
+               chunk->arena);
+  }
+  free(chunks.chunks);
+  free(chunks.order);
   for (size_t idx = 0; idx < fileList.size; ++idx) {
     if (fileList.entries[idx].isCode) {
-      parseFunctionBody(&fileList.entries[idx]);
+      finishFunctionBodies(&fileList.entries[idx]);
       errored = errored || fileList.entries[idx].errored;
     }
   }
+  timeReportEnd(TRP_PARSE_FUNCTION_BODIES);
   if (errored) return -1;
 
   // pass 8 - check additional constraints and warnings (continue/break)
+  timeReportBegin(TRP_PARSE_MISC);
   for (size_t idx = 0; idx < fileList.size; ++idx) {
     if (fileList.entries[idx].isCode) {
+      timeReportFileBegin(TRP_PARSE_MISC, idx);
       checkMisc(&fileList.entries[idx]);
+      timeReportFileEnd(TRP_PARSE_MISC, idx);
       errored = errored || fileList.entries[idx].errored;
     }
   }
+  timeReportEnd(TRP_PARSE_MISC);
   if (errored) return -1;
 
   return 0;
@@ -26,6 +26,7 @@
 #include "fileList.h"
 #include "parser/common.h"
 #include "util/conversions.h"
+#include "util/diagnostics.h"
 
 // panics
 
@@ -404,9 +405,7 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Token *start) {
         switch (peek.type) {
           case TT_RSQUARE: {
             // end of the init
-            Node *n = literalNodeCreate(LT_AGGREGATEINIT, start);
-            n->data.literal.data.aggregateInitVal = literals;
-            return n;
+            return aggregateInitLiteralNodeCreate(start, literals);
           }
           case TT_COMMA: {
             break;  // continue on
@@ -425,9 +424,7 @@ static Node *parseAggregateInitializer(FileListEntry *entry, Token *start) {
       }
       case TT_RSQUARE: {
         // end of the init
-        Node *n = literalNodeCreate(LT_AGGREGATEINIT, start);
-        n->data.literal.data.aggregateInitVal = literals;
-        return n;
+        return aggregateInitLiteralNodeCreate(start, literals);
       }
       default: {
         errorExpectedString(entry, "a right square bracket or a literal",
@@ -1271,16 +1268,15 @@ static Node *finishVarDefn(FileListEntry *entry, Node *type, Vector *names,
  * @returns unparsed node, or NULL if fatal error
  */
 static Node *parseFuncBody(FileListEntry *entry, Token *start) {
-  Vector *tokens = vectorCreate();
-  Token *startCopy = malloc(sizeof(Token));
-  memcpy(startCopy, start, sizeof(Token));
-  vectorInsert(tokens, startCopy);
+  TokenVector *tokens = entry->lexerState.bodyTokens;
+  size_t begin = tokens->size;
+  tokenVectorInsert(tokens, start);
 
   size_t levels = 1;
   while (levels > 0) {
-    Token *token = malloc(sizeof(Token));
-    lex(entry, token);
-    switch (token->type) {
+    Token token;
+    lex(entry, &token);
+    switch (token.type) {
       case TT_LBRACE: {
         ++levels;
         break;
@@ -1292,22 +1288,22 @@ static Node *parseFuncBody(FileListEntry *entry, Token *start) {
       case TT_EOF: {
         // unmatched brace! - will let parseFunctionBody (in functionBody.c)
         // complain about it
-        vectorInsert(tokens, token);
+        tokenVectorInsert(tokens, &token);
 
         // put a copy of the EOF token back - safe and not
         // strictly necessary: parseBodies will pull another token
         // from the lexer, which thinks every token past the end is
         // an EOF, and EOFs are all flat objects in memory
-        unLex(entry, token);
-        return unparsedNodeCreate(tokens);
+        unLex(entry, &token);
+        return unparsedNodeCreate(tokens, begin);
       }
       default: {
         break;
       }
     }
-    vectorInsert(tokens, token);
+    tokenVectorInsert(tokens, &token);
   }
-  return unparsedNodeCreate(tokens);
+  return unparsedNodeCreate(tokens, begin);
 }
 
 /**
@@ -1635,10 +1631,13 @@ static Node *parseStructDecl(FileListEntry *entry, Token *start) {
   }
 
   if (fields->size == 0) {
-    fprintf(stderr,
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, lbrace.offset, &line, &character);
+    fprintf(diagnosticStream(),
             "%s:%zu:%zu: error: expected at least one field in a struct "
             "declaration\n",
-            entry->inputFilename, lbrace.line, lbrace.character);
+            entry->inputFilename, line, character);
     entry->errored = true;
 
     nodeFree(name);
@@ -1736,10 +1735,13 @@ static Node *parseUnionDecl(FileListEntry *entry, Token *start) {
   }
 
   if (options->size == 0) {
-    fprintf(stderr,
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, lbrace.offset, &line, &character);
+    fprintf(diagnosticStream(),
             "%s:%zu:%zu: error: expected at least one option in a union "
             "declaration\n",
-            entry->inputFilename, lbrace.line, lbrace.character);
+            entry->inputFilename, line, character);
     entry->errored = true;
 
     nodeFree(name);
@@ -1877,10 +1879,13 @@ static Node *parseEnumDecl(FileListEntry *entry, Token *start) {
   }
 
   if (constantNames->size == 0) {
-    fprintf(stderr,
+    size_t line;
+    size_t character;
+    fileListEntryPosition(entry, lbrace.offset, &line, &character);
+    fprintf(diagnosticStream(),
             "%s:%zu:%zu: error: expected at least one enumeration constant in "
             "a enumeration declaration\n",
-            entry->inputFilename, lbrace.line, lbrace.character);
+            entry->inputFilename, line, character);
     entry->errored = true;
 
     panicTopLevel(entry);
@@ -2026,16 +2031,27 @@ static Vector *parseBodies(FileListEntry *entry) {
 }
 
 Node *parseFile(FileListEntry *entry) {
+  TokenVector *bodyTokens = tokenVectorCreate();
+  entry->lexerState.bodyTokens = bodyTokens;
+  Arena *arena = arenaCreate();
+  nodeArenaSet(arena);
+
   Node *module = parseModule(entry);
   Vector *imports = parseImports(entry);
   Vector *bodies = parseBodies(entry);
 
+  entry->lexerState.bodyTokens = NULL;
+  Node *file = NULL;
   if (module == NULL) {
     // fatal error in the module
     nodeVectorFree(imports);
     nodeVectorFree(bodies);
-    return NULL;
+    tokenVectorFree(bodyTokens);
+    arenaFree(arena);
   } else {
-    return fileNodeCreate(module, imports, bodies);
+    file = fileNodeCreate(module, imports, bodies, arena);
+    file->data.file.bodyTokens = bodyTokens;
   }
+  nodeArenaSet(NULL);
+  return file;
 }
\ No newline at end of file
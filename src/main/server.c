@@ -0,0 +1,603 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "server.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ast/type.h"
+#include "compile.h"
+#include "fileList.h"
+#include "options.h"
+#include "parser/declIndex.h"
+#include "parser/parser.h"
+#include "typechecker/typechecker.h"
+#include "util/format.h"
+#include "util/functional.h"
+#include "util/serialize.h"
+
+// Protocol (numbers and strings as in util/serialize.h), over a UNIX stream
+// socket:
+//
+// client -> server: a single zero byte, carrying the client's stdout and
+//                   stderr as SCM_RIGHTS ancillary data, then
+//                   request := cwd numArgs arg*
+// server -> client: response := exitCode
+//
+// Requests are compiled one at a time.
+
+/** decl files kept between requests */
+typedef struct {
+  bool valid;      /**< are the entries parsed and typechecked? */
+  char *cwd;       /**< directory the filenames are relative to */
+  size_t size;     /**< number of decl files */
+  size_t capacity; /**< number of entries allocated - a request's code files
+                      are placed after the decl files, since the decl files'
+                      ASTs point to their entries */
+  FileListEntry *entries;
+  char **filenames;
+  struct stat *stats; /**< stat of each file when it was last hashed */
+  WarningOption duplicateImport; /**< options the entries were built with */
+  ArchOption arch;
+  bool declIndex;
+  char *diagnostics; /**< diagnostics produced while building the entries */
+  size_t diagnosticsLength;
+} Resident;
+
+/** the server's decl files */
+static Resident resident;
+/** options as given on the server's command line */
+static Options defaultOptions;
+/** set when the server should stop */
+static volatile sig_atomic_t stopping = 0;
+
+/**
+ * frees the resident decl files, and the types they used - the server only
+ * builds types for them
+ */
+static void residentUninit(void) {
+  for (size_t idx = 0; idx < resident.size; ++idx) {
+    nodeFree(resident.entries[idx].ast);
+    declIndexUnload(&resident.entries[idx]);
+    vectorUninit(&resident.entries[idx].irFrags, nullDtor);
+    free(resident.entries[idx].lineStarts);
+    free(resident.filenames[idx]);
+  }
+  typeTableClear();
+  free(resident.cwd);
+  free(resident.entries);
+  free(resident.filenames);
+  free(resident.stats);
+  free(resident.diagnostics);
+  memset(&resident, 0, sizeof(Resident));
+}
+
+/**
+ * parses and typechecks the decl files of the current file list, making them
+ * resident
+ *
+ * Diagnostics are captured, to be repeated for each request using the
+ * resident decl files
+ *
+ * @param cwd current directory
+ * @param capacity number of entries to allocate
+ */
+static void residentBuild(char const *cwd, size_t capacity) {
+  residentUninit();
+
+  resident.cwd = strcpy(malloc(strlen(cwd) + 1), cwd);
+  resident.capacity = capacity;
+  resident.entries = malloc(sizeof(FileListEntry) * capacity);
+  resident.filenames = malloc(sizeof(char *) * fileList.size);
+  resident.stats = malloc(sizeof(struct stat) * fileList.size);
+  resident.duplicateImport = options.duplicateImport;
+  resident.arch = options.arch;
+  resident.declIndex = options.declIndex;
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    char const *filename = fileList.entries[idx].inputFilename;
+    if (fileList.entries[idx].isCode) continue;
+
+    size_t residentIdx = resident.size++;
+    FileListEntry *entry = &resident.entries[residentIdx];
+    resident.filenames[residentIdx] =
+        strcpy(malloc(strlen(filename) + 1), filename);
+    fileListEntryInit(entry, resident.filenames[residentIdx], false);
+    if (stat(filename, &resident.stats[residentIdx]) != 0)
+      memset(&resident.stats[residentIdx], 0, sizeof(struct stat));
+    fileListEntryHash(entry);
+  }
+
+  // build the entries as if only the decl files were given, capturing stderr -
+  // with no code files, lazy loading would drop them all
+  FileListEntry *requestEntries = fileList.entries;
+  size_t requestSize = fileList.size;
+  fileList.entries = resident.entries;
+  fileList.size = resident.size;
+  TimeReportOption timeReport = options.timeReport;
+  options.timeReport = OPTION_TR_NONE;
+  bool lazyDecls = options.lazyDecls;
+  options.lazyDecls = false;
+
+  FILE *capture = tmpfile();
+  int savedStderr = dup(STDERR_FILENO);
+  if (capture == NULL || savedStderr == -1) {
+    if (capture != NULL) fclose(capture);
+    if (savedStderr != -1) close(savedStderr);
+    fileList.entries = requestEntries;
+    fileList.size = requestSize;
+    options.timeReport = timeReport;
+    options.lazyDecls = lazyDecls;
+    residentUninit();
+    return;
+  }
+  fflush(stderr);
+  dup2(fileno(capture), STDERR_FILENO);
+
+  resident.valid = parse() == 0 && typecheck() == 0;
+
+  fflush(stderr);
+  dup2(savedStderr, STDERR_FILENO);
+  close(savedStderr);
+  fileList.entries = requestEntries;
+  fileList.size = requestSize;
+  options.timeReport = timeReport;
+  options.lazyDecls = lazyDecls;
+
+  long length = ftell(capture);
+  resident.diagnosticsLength = length > 0 ? (size_t)length : 0;
+  resident.diagnostics = malloc(resident.diagnosticsLength + 1);
+  rewind(capture);
+  if (fread(resident.diagnostics, 1, resident.diagnosticsLength, capture) !=
+      resident.diagnosticsLength)
+    resident.valid = false;
+  fclose(capture);
+
+  if (!resident.valid) {
+    // the errors are reported by compiling from scratch instead
+    residentUninit();
+    return;
+  }
+  for (size_t idx = 0; idx < resident.size; ++idx)
+    resident.entries[idx].preparsed = true;
+}
+
+/**
+ * is a resident decl file unchanged? - the file is only hashed if its
+ * modification time or size have changed
+ */
+static bool residentFileUnchanged(size_t idx) {
+  struct stat current;
+  if (stat(resident.filenames[idx], &current) != 0) return false;
+
+  struct stat *recorded = &resident.stats[idx];
+  if (current.st_mtim.tv_sec == recorded->st_mtim.tv_sec &&
+      current.st_mtim.tv_nsec == recorded->st_mtim.tv_nsec &&
+      current.st_size == recorded->st_size &&
+      current.st_ino == recorded->st_ino)
+    return true;
+
+  FileListEntry rehashed = resident.entries[idx];
+  if (fileListEntryHash(&rehashed) != 0 ||
+      rehashed.sourceHash != resident.entries[idx].sourceHash)
+    return false;
+
+  *recorded = current;
+  return true;
+}
+
+/**
+ * can the resident decl files be used for the current file list?
+ *
+ * @param cwd current directory
+ */
+static bool residentMatches(char const *cwd) {
+  if (!resident.valid || strcmp(resident.cwd, cwd) != 0 ||
+      resident.capacity < fileList.size ||
+      resident.duplicateImport != options.duplicateImport ||
+      resident.arch != options.arch || resident.declIndex != options.declIndex)
+    return false;
+
+  size_t residentIdx = 0;
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    if (fileList.entries[idx].isCode) continue;
+    if (residentIdx == resident.size ||
+        strcmp(fileList.entries[idx].inputFilename,
+               resident.filenames[residentIdx]) != 0)
+      return false;
+    ++residentIdx;
+  }
+  if (residentIdx != resident.size) return false;
+
+  for (size_t idx = 0; idx < resident.size; ++idx) {
+    if (!residentFileUnchanged(idx)) return false;
+  }
+  return true;
+}
+
+/**
+ * replaces the current file list's decl files with the resident ones - only
+ * done in the child compiling the request, since the resident entries are
+ * modified
+ */
+static void residentSplice(void) {
+  size_t size = resident.size;
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    if (fileList.entries[idx].isCode)
+      resident.entries[size++] = fileList.entries[idx];
+  }
+  free(fileList.entries);
+  fileList.entries = resident.entries;
+  fileList.size = size;
+
+  fwrite(resident.diagnostics, sizeof(char), resident.diagnosticsLength,
+         stderr);
+}
+
+/**
+ * compiles a request - stdout and stderr must already be the client's
+ *
+ * @param cwd directory to compile in
+ * @param argc number of arguments (including name of program)
+ * @param argv list of arguments (including name of program)
+ * @param listener socket the server is listening on
+ * @returns return value for main
+ */
+static int compileRequest(char const *cwd, size_t argc,
+                          char const *const *argv, int listener) {
+  memcpy(&options, &defaultOptions, sizeof(Options));
+  fileList.entries = NULL;
+  fileList.size = 0;
+
+  int code;
+  size_t numFiles;
+  if (chdir(cwd) != 0) {
+    fprintf(stderr, "tlc: error: cannot change directory to '%s'\n", cwd);
+    code = CODE_FILE_ERROR;
+  } else if (parseArgs(argc, argv, &numFiles) != 0) {
+    code = CODE_OPTION_ERROR;
+  } else if (parseFiles(argc, argv, numFiles) != 0) {
+    code = CODE_FILE_ERROR;
+  } else {
+    // debug dumps include the decl files, so those are compiled from scratch
+    bool useResident = false;
+    if (options.dump == OPTION_DD_NONE) {
+      if (!residentMatches(cwd)) residentBuild(cwd, fileList.size * 2);
+      useResident = resident.valid;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t child = fork();
+    if (child == 0) {
+      close(listener);
+      signal(SIGINT, SIG_DFL);
+      signal(SIGTERM, SIG_DFL);
+      if (useResident) residentSplice();
+      exit(compile());
+    } else if (child == -1) {
+      fprintf(stderr, "tlc: error: cannot start compilation\n");
+      code = CODE_FILE_ERROR;
+    } else {
+      int status;
+      while (waitpid(child, &status, 0) == -1 && errno == EINTR)
+        ;
+      if (WIFEXITED(status)) {
+        code = WEXITSTATUS(status);
+      } else {
+        fprintf(stderr, "tlc: error: compilation terminated by signal %d\n",
+                WTERMSIG(status));
+        code = 128 + WTERMSIG(status);
+      }
+    }
+  }
+
+  for (size_t idx = 0; idx < fileList.size; ++idx) {
+    vectorUninit(&fileList.entries[idx].irFrags, nullDtor);
+    free(fileList.entries[idx].lineStarts);
+  }
+  free(fileList.entries);
+  fileList.entries = NULL;
+  fileList.size = 0;
+  return code;
+}
+
+/**
+ * receives the client's stdout and stderr
+ *
+ * @param client client socket
+ * @param fds output parameter for the file descriptors
+ * @returns status code (0 = OK)
+ */
+static int receiveStreams(int client, int fds[2]) {
+  char byte;
+  struct iovec iov = {&byte, 1};
+  union {
+    struct cmsghdr header;
+    char buffer[CMSG_SPACE(sizeof(int) * 2)];
+  } control;
+  struct msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control.buffer;
+  message.msg_controllen = sizeof(control.buffer);
+
+  if (recvmsg(client, &message, 0) != 1) return -1;
+  struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+  if (header == NULL || header->cmsg_level != SOL_SOCKET ||
+      header->cmsg_type != SCM_RIGHTS ||
+      header->cmsg_len != CMSG_LEN(sizeof(int) * 2))
+    return -1;
+  memcpy(fds, CMSG_DATA(header), sizeof(int) * 2);
+  return 0;
+}
+
+/**
+ * sends this process's stdout and stderr
+ *
+ * @param server server socket
+ * @returns status code (0 = OK)
+ */
+static int sendStreams(int server) {
+  char byte = 0;
+  struct iovec iov = {&byte, 1};
+  union {
+    struct cmsghdr header;
+    char buffer[CMSG_SPACE(sizeof(int) * 2)];
+  } control;
+  memset(&control, 0, sizeof(control));
+  struct msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control.buffer;
+  message.msg_controllen = sizeof(control.buffer);
+
+  struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+  header->cmsg_level = SOL_SOCKET;
+  header->cmsg_type = SCM_RIGHTS;
+  header->cmsg_len = CMSG_LEN(sizeof(int) * 2);
+  int fds[2] = {STDOUT_FILENO, STDERR_FILENO};
+  memcpy(CMSG_DATA(header), fds, sizeof(fds));
+
+  return sendmsg(server, &message, 0) == 1 ? 0 : -1;
+}
+
+/**
+ * handles one client's request
+ *
+ * @param client client socket
+ * @param listener socket the server is listening on
+ */
+static void serveClient(int client, int listener) {
+  int fds[2];
+  if (receiveStreams(client, fds) != 0) return;
+
+  FILE *in = fdopen(dup(client), "r");
+  if (in == NULL) {
+    close(fds[0]);
+    close(fds[1]);
+    return;
+  }
+  bool errored = false;
+  char *cwd = deserializeString(in, &errored);
+  uint64_t argc = deserializeNumber(in, &errored);
+  char **argv =
+      errored || argc == 0 || argc > SIZE_MAX / sizeof(char *)
+          ? NULL
+          : calloc((size_t)argc, sizeof(char *));
+  for (size_t idx = 0; argv != NULL && idx < argc && !errored; ++idx)
+    argv[idx] = deserializeString(in, &errored);
+  fclose(in);
+
+  if (!errored && argv != NULL) {
+    // compile with the client's stdout and stderr
+    int serverStdout = dup(STDOUT_FILENO);
+    int serverStderr = dup(STDERR_FILENO);
+    dup2(fds[0], STDOUT_FILENO);
+    dup2(fds[1], STDERR_FILENO);
+
+    int code =
+        compileRequest(cwd, (size_t)argc, (char const *const *)argv, listener);
+
+    fflush(stdout);
+    fflush(stderr);
+    dup2(serverStdout, STDOUT_FILENO);
+    dup2(serverStderr, STDERR_FILENO);
+    close(serverStdout);
+    close(serverStderr);
+
+    FILE *out = fdopen(dup(client), "w");
+    if (out != NULL) {
+      serializeNumber(out, (uint64_t)code);
+      fclose(out);
+    }
+  }
+
+  for (size_t idx = 0; argv != NULL && idx < argc; ++idx) free(argv[idx]);
+  free(argv);
+  free(cwd);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+/**
+ * fills in a UNIX socket address
+ *
+ * @returns status code (0 = OK)
+ */
+static int socketAddress(struct sockaddr_un *address, char const *socketPath) {
+  memset(address, 0, sizeof(struct sockaddr_un));
+  address->sun_family = AF_UNIX;
+  if (strlen(socketPath) >= sizeof(address->sun_path)) return -1;
+  strcpy(address->sun_path, socketPath);
+  return 0;
+}
+
+/**
+ * connects to a server
+ *
+ * @returns connected socket, or -1 if no server is listening
+ */
+static int connectTo(char const *socketPath) {
+  struct sockaddr_un address;
+  if (socketAddress(&address, socketPath) != 0) return -1;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1) return -1;
+  if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * notes that the server should stop
+ */
+static void stop(int signal) {
+  (void)signal;
+  stopping = 1;
+}
+
+int serverRun(char const *socketPath) {
+  memcpy(&defaultOptions, &options, sizeof(Options));
+
+  struct sockaddr_un address;
+  if (socketAddress(&address, socketPath) != 0) {
+    fprintf(stderr, "tlc: error: socket path '%s' is too long\n", socketPath);
+    return CODE_OPTION_ERROR;
+  }
+
+  // a socket nobody's listening on is left over from a server that was killed
+  int existing = connectTo(socketPath);
+  if (existing != -1) {
+    close(existing);
+    fprintf(stderr, "tlc: error: a server is already listening on '%s'\n",
+            socketPath);
+    return CODE_FILE_ERROR;
+  }
+  struct stat statbuf;
+  if (lstat(socketPath, &statbuf) == 0 && S_ISSOCK(statbuf.st_mode))
+    unlink(socketPath);
+
+  // requests run as the server's user, so only that user may connect - the
+  // socket is created as 0600, rather than chmod-ed once others could connect
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  mode_t mask = umask(0177);
+  bool bound =
+      listener != -1 &&
+      bind(listener, (struct sockaddr *)&address, sizeof(address)) == 0;
+  umask(mask);
+  if (!bound || listen(listener, SOMAXCONN) != 0) {
+    fprintf(stderr, "tlc: error: cannot listen on '%s'\n", socketPath);
+    if (listener != -1) close(listener);
+    return CODE_FILE_ERROR;
+  }
+
+  // stop on SIGINT or SIGTERM - no SA_RESTART, so accept is interrupted
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stop;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  // requests may change directory, so the socket is removed by its full path
+  char *cwd = getcwd(NULL, 0);
+  char *fullPath = socketPath[0] == '/' || cwd == NULL
+                       ? strcpy(malloc(strlen(socketPath) + 1), socketPath)
+                       : format("%s/%s", cwd, socketPath);
+  while (!stopping) {
+    int client = accept(listener, NULL, NULL);
+    if (client == -1) continue;
+    serveClient(client, listener);
+    close(client);
+  }
+
+  close(listener);
+  unlink(fullPath);
+  free(fullPath);
+  free(cwd);
+  residentUninit();
+  return CODE_SUCCESS;
+}
+
+int serverConnect(char const *socketPath, size_t argc,
+                  char const *const *argv) {
+  int server = connectTo(socketPath);
+  if (server == -1) {
+    fprintf(stderr, "tlc: error: cannot connect to a server on '%s'\n",
+            socketPath);
+    return CODE_OPTION_ERROR;
+  }
+  char *cwd = getcwd(NULL, 0);
+  if (cwd == NULL || sendStreams(server) != 0) {
+    fprintf(stderr, "tlc: error: cannot send request to '%s'\n", socketPath);
+    free(cwd);
+    close(server);
+    return CODE_OPTION_ERROR;
+  }
+
+  // forward everything but --connect
+  size_t numForwarded = 0;
+  bool allFiles = false;
+  for (size_t idx = 0; idx < argc; ++idx) {
+    if (strcmp(argv[idx], "--") == 0) allFiles = true;
+    if (allFiles || strncmp(argv[idx], "--connect=", 10) != 0) ++numForwarded;
+  }
+  FILE *out = fdopen(dup(server), "w");
+  if (out != NULL) {
+    serializeString(out, cwd);
+    serializeNumber(out, numForwarded);
+    allFiles = false;
+    for (size_t idx = 0; idx < argc; ++idx) {
+      if (strcmp(argv[idx], "--") == 0) allFiles = true;
+      if (allFiles || strncmp(argv[idx], "--connect=", 10) != 0)
+        serializeString(out, argv[idx]);
+    }
+    fclose(out);
+  }
+  free(cwd);
+
+  // wait for the result
+  FILE *in = fdopen(server, "r");
+  bool errored = in == NULL;
+  uint64_t code = errored ? 0 : deserializeNumber(in, &errored);
+  if (in != NULL)
+    fclose(in);
+  else
+    close(server);
+  if (errored) {
+    fprintf(stderr, "tlc: error: server on '%s' closed the connection\n",
+            socketPath);
+    return CODE_FILE_ERROR;
+  }
+  return (int)code;
+}
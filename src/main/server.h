@@ -0,0 +1,58 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * compile server, for --server and --connect
+ *
+ * The server keeps the decl files of the last request parsed, typechecked, and
+ * with their symbol tables built. Each request is compiled in a forked child
+ * process, which starts from those decl files if they're unchanged, and so
+ * only has to do the work for the request's code files.
+ */
+
+#ifndef TLC_SERVER_H_
+#define TLC_SERVER_H_
+
+#include <stddef.h>
+
+/**
+ * runs a compile server until interrupted
+ *
+ * @param socketPath path of the UNIX socket to listen on
+ * @returns return value for main
+ */
+int serverRun(char const *socketPath);
+
+/**
+ * has a compile server compile with the given command line, as if tlc had been
+ * run with it
+ *
+ * Output from the compilation goes to this process's stdout and stderr
+ *
+ * @param socketPath path of the UNIX socket the server is listening on
+ * @param argc number of arguments (including name of program)
+ * @param argv list of arguments (including name of program), with any
+ * --connect options ignored
+ * @returns return value for main
+ */
+int serverConnect(char const *socketPath, size_t argc,
+                  char const *const *argv);
+
+#endif  // TLC_SERVER_H_
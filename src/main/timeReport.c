@@ -0,0 +1,281 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of per-phase time and memory measurement
+
+#include "timeReport.h"
+
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "fileList.h"
+#include "options.h"
+
+/** a sample of resource usage, or the difference between two samples */
+typedef struct {
+  bool measured;  /**< has this been measured (to completion)? */
+  bool hasMemory; /**< were heap and rss sampled? - not for files measured
+                     while other threads were running */
+  int64_t wall;   /**< wall clock time, in nanoseconds */
+  int64_t cpu;    /**< cpu time, in nanoseconds */
+  int64_t heap;   /**< heap bytes in use */
+  int64_t rss;    /**< peak resident set size, in bytes */
+} Measurement;
+
+/** names of each phase, indexed by TimeReportPhase */
+static char const *const PHASE_NAMES[] = {
+    "parse",
+    "pass 1 - top level parse",
+    "pass 2 - resolve imports",
+    "passes 3 to 6 - top level symbol tables",
+    "pass 3 - start symbol tables",
+    "pass 4 - check scoped ids",
+    "pass 5 - enum symbol tables",
+    "pass 6 - finish symbol tables",
+    "pass 7 - function bodies",
+    "pass 8 - misc checks",
+    "typecheck",
+    "code generation",
+    "translation",
+    "blocked optimization",
+    "trace scheduling",
+    "scheduled optimization",
+    "backend",
+};
+
+/** sample taken at timeReportInit */
+static Measurement overall;
+/** measurements for each phase */
+static Measurement phases[TRP_NUM_PHASES];
+/** measurements for each file in each phase, if a per-file report was asked */
+static Measurement *files[TRP_NUM_PHASES];
+
+/**
+ * reads a clock
+ *
+ * @param clock clock to read
+ * @returns time in nanoseconds
+ */
+static int64_t readClock(clockid_t clock) {
+  struct timespec time;
+  clock_gettime(clock, &time);
+  return (int64_t)time.tv_sec * 1000000000 + (int64_t)time.tv_nsec;
+}
+
+/**
+ * samples current resource usage
+ *
+ * @param m Measurement to write into
+ * @param cpuClock clock to measure cpu time with
+ * @param withMemory should heap and rss usage be sampled? (only meaningful if
+ * no other thread is running)
+ */
+static void sample(Measurement *m, clockid_t cpuClock, bool withMemory) {
+  m->measured = false;
+  m->hasMemory = withMemory;
+  m->wall = readClock(CLOCK_MONOTONIC);
+  m->cpu = readClock(cpuClock);
+  if (withMemory) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waggregate-return"
+    struct mallinfo2 info = mallinfo2();
+#pragma GCC diagnostic pop
+    m->heap = (int64_t)(info.uordblks + info.hblkhd);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    m->rss = (int64_t)usage.ru_maxrss * 1024;
+  } else {
+    m->heap = 0;
+    m->rss = 0;
+  }
+}
+
+/**
+ * turns a starting sample into the difference between it and now
+ *
+ * @param m Measurement holding the starting sample
+ * @param cpuClock clock the starting sample measured cpu time with
+ */
+static void finish(Measurement *m, clockid_t cpuClock) {
+  Measurement end;
+  sample(&end, cpuClock, m->hasMemory);
+  m->measured = true;
+  m->wall = end.wall - m->wall;
+  m->cpu = end.cpu - m->cpu;
+  if (m->hasMemory) {
+    m->heap = end.heap - m->heap;
+    m->rss = end.rss - m->rss;
+  }
+}
+
+void timeReportInit(void) {
+  if (options.timeReport == OPTION_TR_NONE) return;
+
+  for (size_t phase = 0; phase < TRP_NUM_PHASES; ++phase) {
+    phases[phase].measured = false;
+    files[phase] = options.timeReport == OPTION_TR_PER_FILE
+                       ? calloc(fileList.size, sizeof(Measurement))
+                       : NULL;
+  }
+  sample(&overall, CLOCK_PROCESS_CPUTIME_ID, true);
+}
+
+void timeReportBegin(TimeReportPhase phase) {
+  if (options.timeReport == OPTION_TR_NONE) return;
+  sample(&phases[phase], CLOCK_PROCESS_CPUTIME_ID, true);
+}
+void timeReportEnd(TimeReportPhase phase) {
+  if (options.timeReport == OPTION_TR_NONE) return;
+  finish(&phases[phase], CLOCK_PROCESS_CPUTIME_ID);
+}
+
+void timeReportFileBegin(TimeReportPhase phase, size_t fileIdx) {
+  if (options.timeReport != OPTION_TR_PER_FILE) return;
+  // heap and rss are process-wide, so they're only per-file if run serially
+  sample(&files[phase][fileIdx], CLOCK_THREAD_CPUTIME_ID, options.jobs == 1);
+}
+void timeReportFileEnd(TimeReportPhase phase, size_t fileIdx) {
+  if (options.timeReport != OPTION_TR_PER_FILE) return;
+  finish(&files[phase][fileIdx], CLOCK_THREAD_CPUTIME_ID);
+}
+
+void timeReportPartBegin(TimeReportPart *part) {
+  if (options.timeReport != OPTION_TR_PER_FILE) return;
+  Measurement start;
+  sample(&start, CLOCK_THREAD_CPUTIME_ID, options.jobs == 1);
+  part->hasMemory = start.hasMemory;
+  part->wall = start.wall;
+  part->cpu = start.cpu;
+  if (start.hasMemory) {
+    part->heap = start.heap;
+    part->rss = start.rss;
+  }
+}
+void timeReportPartEnd(TimeReportPart *part) {
+  if (options.timeReport != OPTION_TR_PER_FILE) return;
+  Measurement end;
+  sample(&end, CLOCK_THREAD_CPUTIME_ID, part->hasMemory);
+  part->wall = end.wall - part->wall;
+  part->cpu = end.cpu - part->cpu;
+  if (part->hasMemory) {
+    part->heap = end.heap - part->heap;
+    part->rss = end.rss - part->rss;
+  }
+}
+void timeReportPartAdd(TimeReportPhase phase, size_t fileIdx,
+                       TimeReportPart const *part) {
+  if (options.timeReport != OPTION_TR_PER_FILE) return;
+  Measurement *m = &files[phase][fileIdx];
+  if (!m->measured) {
+    m->measured = true;
+    m->hasMemory = part->hasMemory;
+    m->wall = m->cpu = m->heap = m->rss = 0;
+  }
+  m->wall += part->wall;
+  m->cpu += part->cpu;
+  if (part->hasMemory) {
+    m->heap += part->heap;
+    m->rss += part->rss;
+  } else {
+    m->hasMemory = false;
+  }
+}
+
+/**
+ * prints one line of the report
+ *
+ * @param where stream to print to
+ * @param indent indentation level
+ * @param name name of the measured thing
+ * @param m measurement to print
+ */
+static void printRow(FILE *where, int indent, char const *name,
+                     Measurement const *m) {
+  fprintf(where, "%10.6f %10.6f ", (double)m->wall / 1000000000,
+          (double)m->cpu / 1000000000);
+  if (m->hasMemory)
+    fprintf(where, "%+14" PRId64 " %+14" PRId64, m->heap, m->rss);
+  else
+    fprintf(where, "%14s %14s", "n/a (parallel)", "n/a (parallel)");
+  fprintf(where, "  %*s%s\n", indent * 2, "", name);
+}
+
+/**
+ * totals the per-file measurements of a phase that wasn't measured as a whole
+ * (because its files were interleaved with other phases' files)
+ *
+ * @param phase phase to total
+ * @returns whether any file was measured
+ */
+static bool sumFiles(size_t phase) {
+  if (files[phase] == NULL) return false;
+
+  Measurement *total = &phases[phase];
+  total->hasMemory = true;
+  total->wall = total->cpu = total->heap = total->rss = 0;
+  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+    Measurement const *m = &files[phase][fileIdx];
+    if (!m->measured) continue;
+    total->measured = true;
+    total->wall += m->wall;
+    total->cpu += m->cpu;
+    if (m->hasMemory) {
+      total->heap += m->heap;
+      total->rss += m->rss;
+    } else {
+      total->hasMemory = false;
+    }
+  }
+  return total->measured;
+}
+
+void timeReportPrint(FILE *where) {
+  if (options.timeReport == OPTION_TR_NONE) return;
+
+  finish(&overall, CLOCK_PROCESS_CPUTIME_ID);
+
+  fprintf(where, "%10s %10s %14s %14s  %s\n", "wall (s)", "cpu (s)",
+          "heap (bytes)", "peak rss (B)", "phase");
+  for (size_t phase = 0; phase < TRP_NUM_PHASES; ++phase) {
+    if (!phases[phase].measured && !sumFiles(phase)) continue;
+
+    int indent = (phase > TRP_PARSE && phase <= TRP_PARSE_MISC) ||
+                         phase > TRP_CODE_GENERATION
+                     ? 1
+                     : 0;
+    if (phase > TRP_PARSE_TOP_LEVEL_STAB && phase <= TRP_PARSE_FINISH_STAB)
+      ++indent;
+    printRow(where, indent, PHASE_NAMES[phase], &phases[phase]);
+    if (files[phase] != NULL) {
+      for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
+        if (files[phase][fileIdx].measured)
+          printRow(where, indent + 1, fileList.entries[fileIdx].inputFilename,
+                   &files[phase][fileIdx]);
+      }
+    }
+  }
+  printRow(where, 0, "total", &overall);
+
+  for (size_t phase = 0; phase < TRP_NUM_PHASES; ++phase) free(files[phase]);
+}
@@ -0,0 +1,139 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * per-phase time and memory measurement, for --time-report
+ */
+
+#ifndef TLC_TIME_REPORT_H_
+#define TLC_TIME_REPORT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** a measured phase of compilation */
+typedef enum {
+  TRP_PARSE,
+  TRP_PARSE_TOP_LEVEL,
+  TRP_PARSE_IMPORTS,
+  TRP_PARSE_TOP_LEVEL_STAB,
+  TRP_PARSE_START_STAB,
+  TRP_PARSE_SCOPED_IDS,
+  TRP_PARSE_ENUM_STAB,
+  TRP_PARSE_FINISH_STAB,
+  TRP_PARSE_FUNCTION_BODIES,
+  TRP_PARSE_MISC,
+  TRP_TYPECHECK,
+  TRP_CODE_GENERATION,
+  TRP_TRANSLATION,
+  TRP_BLOCKED_OPTIMIZATION,
+  TRP_TRACE_SCHEDULING,
+  TRP_SCHEDULED_OPTIMIZATION,
+  TRP_BACKEND,
+  TRP_NUM_PHASES,
+} TimeReportPhase;
+
+/**
+ * starts measuring the compilation as a whole
+ *
+ * does nothing unless a time report was requested. Must be called after the
+ * file list is built, and before any other timeReport function
+ */
+void timeReportInit(void);
+
+/**
+ * starts measuring a phase - must be called from the main thread
+ *
+ * @param phase phase to measure
+ */
+void timeReportBegin(TimeReportPhase phase);
+/**
+ * stops measuring a phase - must be called from the main thread
+ *
+ * @param phase phase being measured
+ */
+void timeReportEnd(TimeReportPhase phase);
+
+/**
+ * starts measuring one file's part of a phase
+ *
+ * may be called concurrently for different files. Does nothing unless a
+ * per-file report was requested
+ *
+ * @param phase phase being measured
+ * @param fileIdx index of the file in the file list
+ */
+void timeReportFileBegin(TimeReportPhase phase, size_t fileIdx);
+/**
+ * stops measuring one file's part of a phase
+ *
+ * @param phase phase being measured
+ * @param fileIdx index of the file in the file list
+ */
+void timeReportFileEnd(TimeReportPhase phase, size_t fileIdx);
+
+/** a measurement of part of one file's part of a phase */
+typedef struct {
+  bool hasMemory; /**< were heap and rss measured? */
+  int64_t wall;
+  int64_t cpu;
+  int64_t heap;
+  int64_t rss;
+} TimeReportPart;
+
+/**
+ * starts measuring part of one file's part of a phase
+ *
+ * for phases that split files into parts, which may be run concurrently with
+ * other parts of the same file. Does nothing unless a per-file report was
+ * requested
+ *
+ * @param part part to measure
+ */
+void timeReportPartBegin(TimeReportPart *part);
+/**
+ * stops measuring part of one file's part of a phase
+ *
+ * @param part part being measured
+ */
+void timeReportPartEnd(TimeReportPart *part);
+/**
+ * adds a measured part to its file's measurement - must be called from the
+ * main thread
+ *
+ * @param phase phase the part was measured in
+ * @param fileIdx index of the file in the file list
+ * @param part part that has been measured
+ */
+void timeReportPartAdd(TimeReportPhase phase, size_t fileIdx,
+                       TimeReportPart const *part);
+
+/**
+ * prints the report for all measured phases and releases the measurements
+ *
+ * does nothing unless a time report was requested
+ *
+ * @param where stream to print to
+ */
+void timeReportPrint(FILE *where);
+
+#endif  // TLC_TIME_REPORT_H_
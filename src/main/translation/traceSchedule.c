@@ -22,7 +22,10 @@
 #include "fileList.h"
 #include "ir/ir.h"
 #include "ir/shorthand.h"
+#include "options.h"
+#include "timeReport.h"
 #include "util/internalError.h"
+#include "util/parallel.h"
 
 static void copyOverLastInstruction(IRBlock *b, IRBlock *out) {
   // TODO: can make this more efficient by copying over the listnode
@@ -216,22 +219,34 @@ static void scheduleBlock(IRBlock *b, IRBlock *out, LinkedList *blocks,
   irBlockFree(b);
 }
 
-void traceSchedule(void) {
-  for (size_t fileIdx = 0; fileIdx < fileList.size; ++fileIdx) {
-    if (fileList.entries[fileIdx].isCode) {
-      FileListEntry *file = &fileList.entries[fileIdx];
-      for (size_t fragIdx = 0; fragIdx < file->irFrags.size; ++fragIdx) {
-        IRFrag *frag = file->irFrags.elements[fragIdx];
-        if (frag->type == FT_TEXT) {
-          LinkedList blocks;
-          blocks.head = frag->data.text.blocks.head;
-          blocks.tail = frag->data.text.blocks.tail;
-          linkedListInit(&frag->data.text.blocks);
-          IRBlock *out = BLOCK(0, &frag->data.text.blocks);
-          scheduleBlock(blocks.head->next->data, out, &blocks, &file->irFrags);
-          linkedListUninit(&blocks, (void (*)(void *))irBlockFree);
-        }
+void traceScheduleFile(size_t fileIdx) {
+  if (fileList.entries[fileIdx].isCode) {
+    timeReportFileBegin(TRP_TRACE_SCHEDULING, fileIdx);
+    FileListEntry *file = &fileList.entries[fileIdx];
+    for (size_t fragIdx = 0; fragIdx < file->irFrags.size; ++fragIdx) {
+      IRFrag *frag = file->irFrags.elements[fragIdx];
+      if (frag->type == FT_TEXT) {
+        LinkedList blocks;
+        blocks.head = frag->data.text.blocks.head;
+        blocks.tail = frag->data.text.blocks.tail;
+        linkedListInit(&frag->data.text.blocks);
+        IRBlock *out = BLOCK(0, &frag->data.text.blocks);
+        scheduleBlock(blocks.head->next->data, out, &blocks, &file->irFrags);
+        linkedListUninit(&blocks, (void (*)(void *))irBlockFree);
       }
     }
+    timeReportFileEnd(TRP_TRACE_SCHEDULING, fileIdx);
   }
+}
+
+/**
+ * trace schedules the file at the given index - parallelFor adapter
+ */
+static void traceScheduleFileAt(size_t fileIdx, void *ignored) {
+  (void)ignored;
+  traceScheduleFile(fileIdx);
+}
+
+void traceSchedule(void) {
+  parallelFor(options.jobs, fileList.size, traceScheduleFileAt, NULL);
 }
\ No newline at end of file
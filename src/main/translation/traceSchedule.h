@@ -24,6 +24,15 @@
 #ifndef TLC_TRANSLATION_TRACESCHEDULE_H_
 #define TLC_TRANSLATION_TRACESCHEDULE_H_
 
+#include <stddef.h>
+
+/**
+ * trace-schedules the IR of the file at the given index, if it's a code file
+ *
+ * @param fileIdx index of the file in the file list
+ */
+void traceScheduleFile(size_t fileIdx);
+
 /**
  * trace-schedules all of the files' IR
  *
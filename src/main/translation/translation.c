@@ -23,9 +23,12 @@
 #include "fileList.h"
 #include "ir/ir.h"
 #include "ir/shorthand.h"
+#include "options.h"
+#include "timeReport.h"
 #include "util/conversions.h"
 #include "util/internalError.h"
 #include "util/numericSizing.h"
+#include "util/parallel.h"
 #include "util/string.h"
 
 size_t fresh(FileListEntry *file) { return file->nextId++; }
@@ -1418,7 +1421,6 @@ static IROperand *translateMulStyleOp(IRBlock *b, IROperand *lhs,
     IR(b, BINOP(unsignedOp, irOperandCopy(out), castLhs, castRhs));
   else
     IR(b, BINOP(signedOp, irOperandCopy(out), castLhs, castRhs));
-  typeFree(merged);
   return out;
 }
 /**
@@ -1552,7 +1554,6 @@ static IROperand *translateShift(IRBlock *b, IROperand *lhs,
   IROperand *out = TEMPOF(fresh(file), lhsType);
   Type *ubyteType = keywordTypeCreate(TK_UBYTE);
   IROperand *castRhs = translateCast(b, rhs, rhsType, ubyteType, file);
-  typeFree(ubyteType);
   IR(b, BINOP(op, irOperandCopy(out), lhs, castRhs));
   return out;
 }
@@ -1669,7 +1670,6 @@ static IROperand *translateComparison(IRBlock *b, IROperand *lhs,
     IR(b, BINOP(unsignedOp, irOperandCopy(out), castLhs, castRhs));
   else
     IR(b, BINOP(signedOp, irOperandCopy(out), castLhs, castRhs));
-  typeFree(merged);
   return out;
 }
 /**
@@ -2036,7 +2036,6 @@ static LValue *translateExpressionLValue(LinkedList *blocks, Node const *e,
               arithmeticTypeMerge(expressionTypeof(lhs), expressionTypeof(rhs));
           IROperand *castResult =
               translateCast(b, rawResult, merged, expressionTypeof(lhs), file);
-          typeFree(merged);
           translateLValueStore(b, lvalue, castResult, file);
           IR(b, JUMP(nextLabel));
           return lvalue;
@@ -2063,7 +2062,7 @@ static LValue *translateExpressionLValue(LinkedList *blocks, Node const *e,
         case BO_FIELD: {
           LValue *lvalue =
               translateExpressionLValue(blocks, lhs, label, nextLabel, file);
-          SymbolTableEntry const *lhsEntry =
+          SymbolTableEntry *lhsEntry =
               stripCV(expressionTypeof(lhs))->data.reference.entry;
           if (lhsEntry->kind == SK_STRUCT) {
             lvalue->staticOffset +=
@@ -2072,7 +2071,7 @@ static LValue *translateExpressionLValue(LinkedList *blocks, Node const *e,
           return lvalue;
         }
         case BO_PTRFIELD: {
-          SymbolTableEntry const *lhsEntry =
+          SymbolTableEntry *lhsEntry =
               stripCV(expressionTypeof(lhs))->data.reference.entry;
           return lvalueCreate(
               LK_MEM,
@@ -2327,7 +2326,6 @@ static void translateExpressionPredicate(LinkedList *blocks, Node const *e,
           IR(b, CJUMP(binopToCjump(e->data.binOpExp.op, typeFloating(merged),
                                    typeSignedIntegral(merged)),
                       trueLabel, falseLabel, castedLhs, castedRhs));
-          typeFree(merged);
           break;
         }
         case BO_FIELD:
@@ -2667,7 +2665,6 @@ static IROperand *translateExpressionValue(LinkedList *blocks, Node const *e,
               arithmeticTypeMerge(expressionTypeof(lhs), expressionTypeof(rhs));
           IROperand *castResult =
               translateCast(b, rawResult, merged, expressionTypeof(lhs), file);
-          typeFree(merged);
           translateLValueStore(b, lvalue, castResult, file);
           IR(b, JUMP(nextLabel));
           lvalueFree(lvalue);
@@ -2756,7 +2753,7 @@ static IROperand *translateExpressionValue(LinkedList *blocks, Node const *e,
           return result;
         }
         case BO_FIELD: {
-          SymbolTableEntry const *lhsEntry =
+          SymbolTableEntry *lhsEntry =
               stripCV(expressionTypeof(lhs))->data.reference.entry;
           size_t resultLabel = fresh(file);
           IROperand *whole =
@@ -2773,7 +2770,7 @@ static IROperand *translateExpressionValue(LinkedList *blocks, Node const *e,
           return result;
         }
         case BO_PTRFIELD: {
-          SymbolTableEntry const *lhsEntry =
+          SymbolTableEntry *lhsEntry =
               stripCV(stripCV(expressionTypeof(lhs))->data.pointer.base)
                   ->data.reference.entry;
           size_t resultLabel = fresh(file);
@@ -3305,7 +3302,6 @@ static void translateExpressionVoid(LinkedList *blocks, Node const *e,
               arithmeticTypeMerge(expressionTypeof(lhs), expressionTypeof(rhs));
           IROperand *castResult =
               translateCast(b, rawResult, merged, expressionTypeof(lhs), file);
-          typeFree(merged);
           translateLValueStore(b, lvalue, castResult, file);
           IR(b, JUMP(nextLabel));
           lvalueFree(lvalue);
@@ -4016,7 +4012,6 @@ static void translateStmt(LinkedList *blocks, Node *stmt, size_t label,
               IR(b, MOVE(temp, cast));
               IR(b, JUMP(next));
               e->data.variable.temp = temp->data.temp.name;
-              irOperandFree(o);
             }
             curr = next;
           }
@@ -4038,9 +4033,9 @@ static void translateStmt(LinkedList *blocks, Node *stmt, size_t label,
 }
 
 /**
- * translate the given file
+ * translate the bodies of the given file
  */
-static void translateFile(FileListEntry *file) {
+static void translateBodies(FileListEntry *file) {
   char *namePrefix =
       generatePrefix(file->ast->data.file.module->data.module.id);
   Vector *bodies = file->ast->data.file.bodies;
@@ -4087,8 +4082,23 @@ static void translateFile(FileListEntry *file) {
   free(namePrefix);
 }
 
+void translateFile(size_t fileIdx) {
+  if (fileList.entries[fileIdx].isCode) {
+    timeReportFileBegin(TRP_TRANSLATION, fileIdx);
+    translateBodies(&fileList.entries[fileIdx]);
+    timeReportFileEnd(TRP_TRANSLATION, fileIdx);
+  }
+}
+
+/**
+ * translate the file at the given index - parallelFor adapter
+ */
+static void translateFileAt(size_t fileIdx, void *ignored) {
+  (void)ignored;
+  translateFile(fileIdx);
+}
+
 void translate(void) {
-  // for each code file, translate it
-  for (size_t idx = 0; idx < fileList.size; ++idx)
-    if (fileList.entries[idx].isCode) translateFile(&fileList.entries[idx]);
+  // for each code file, translate it - files are independent
+  parallelFor(options.jobs, fileList.size, translateFileAt, NULL);
 }
\ No newline at end of file
@@ -43,6 +43,16 @@ size_t fresh(FileListEntry *file);
  */
 char *getMangledName(SymbolTableEntry *entry);
 
+/**
+ * translates the file at the given index into IR, if it's a code file
+ *
+ * must have valid typechecked ASTs, should always succeed. Other files may be
+ * translated concurrently
+ *
+ * @param fileIdx index of the file in the file list
+ */
+void translateFile(size_t fileIdx);
+
 /**
  * translates all of the files in the file list into IR
  *
@@ -22,9 +22,10 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 
 #include "fileList.h"
+#include "timeReport.h"
+#include "util/diagnostics.h"
 #include "util/internalError.h"
 
 /**
@@ -38,12 +39,14 @@ static Type *boolType;
  * @param from from type
  * @param to to type
  */
-static void errorNoImplicitConversion(FileListEntry *entry, size_t line,
-                                      size_t character, Type const *from,
-                                      Type const *to) {
+static void errorNoImplicitConversion(FileListEntry *entry, uint32_t offset,
+                                      Type const *from, Type const *to) {
   char *fromString = typeToString(from);
   char *toString = typeToString(to);
-  fprintf(stderr,
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(),
           "%s:%zu:%zu: error: cannot implicitly convert a value of type '%s' "
           "to a value of type '%s'\n",
           entry->inputFilename, line, character, fromString, toString);
@@ -54,12 +57,14 @@ static void errorNoImplicitConversion(FileListEntry *entry, size_t line,
 /**
  * complaints about being unable to perform a binop
  */
-static void errorNoBinOp(FileListEntry *entry, size_t line, size_t character,
-                         char const *op, Type const *lhsType,
-                         Type const *rhsType) {
+static void errorNoBinOp(FileListEntry *entry, uint32_t offset, char const *op,
+                         Type const *lhsType, Type const *rhsType) {
   char *lhsString = typeToString(lhsType);
   char *rhsString = typeToString(rhsType);
-  fprintf(stderr,
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(),
           "%s:%zu:%zu: error: cannot perform %s on a value of type '%s' and a "
           "value of type '%s'\n",
           entry->inputFilename, line, character, op, lhsString, rhsString);
@@ -70,10 +75,13 @@ static void errorNoBinOp(FileListEntry *entry, size_t line, size_t character,
 /**
  * complaints about being unable to perform an unop
  */
-static void errorNoUnOp(FileListEntry *entry, size_t line, size_t character,
-                        char const *op, Type const *target) {
+static void errorNoUnOp(FileListEntry *entry, uint32_t offset, char const *op,
+                        Type const *target) {
   char *typeString = typeToString(target);
-  fprintf(stderr,
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(),
           "%s:%zu:%zu: error: cannot perform %s on a value of type '%s'\n",
           entry->inputFilename, line, character, op, typeString);
   entry->errored = true;
@@ -82,10 +90,13 @@ static void errorNoUnOp(FileListEntry *entry, size_t line, size_t character,
 /**
  * complains about there being no member with the given name
  */
-static void errorNoMember(FileListEntry *entry, size_t line, size_t character,
+static void errorNoMember(FileListEntry *entry, uint32_t offset,
                           char const *member, Type const *type) {
   char *typeString = typeToString(type);
-  fprintf(stderr,
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(),
           "%s:%zu:%zu: error: no member named '%s' on a value of "
           "type '%s'\n",
           entry->inputFilename, line, character, member, typeString);
@@ -95,10 +106,13 @@ static void errorNoMember(FileListEntry *entry, size_t line, size_t character,
 /**
  * complains about there being no members
  */
-static void errorNoMembers(FileListEntry *entry, size_t line, size_t character,
+static void errorNoMembers(FileListEntry *entry, uint32_t offset,
                            Type const *type) {
   char *typeString = typeToString(type);
-  fprintf(stderr,
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(),
           "%s:%zu:%zu: error: cannot access members on a value of "
           "type '%s'\n",
           entry->inputFilename, line, character, typeString);
@@ -108,19 +122,25 @@ static void errorNoMembers(FileListEntry *entry, size_t line, size_t character,
 /**
  * complains about expression not being an lvalue
  */
-static void errorNotLvalue(FileListEntry *entry, size_t line, size_t character,
+static void errorNotLvalue(FileListEntry *entry, uint32_t offset,
                            char const *op) {
-  fprintf(stderr, "%s:%zu:%zu: error: cannot %s a non-lvalue\n",
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(), "%s:%zu:%zu: error: cannot %s a non-lvalue\n",
           entry->inputFilename, line, character, op);
   entry->errored = true;
 }
 /**
  * complains about a type being incomplete
  */
-static void errorIncompleteType(FileListEntry *entry, size_t line,
-                                size_t character, Type const *t) {
+static void errorIncompleteType(FileListEntry *entry, uint32_t offset,
+                                Type const *t) {
   char *typeString = typeToString(t);
-  fprintf(stderr,
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(),
           "%s:%zu:%zu: error: values of type '%s' do not exist; the type is "
           "incomplete\n",
           entry->inputFilename, line, character, typeString);
@@ -130,10 +150,13 @@ static void errorIncompleteType(FileListEntry *entry, size_t line,
 /**
  * complains about a type being recursive
  */
-static void errorRecursiveDecl(FileListEntry *entry, size_t line,
-                               size_t character, char const *what,
-                               char const *name) {
-  fprintf(stderr, "%s:%zu:%zu: error: the %s '%s' may not contain itself\n",
+static void errorRecursiveDecl(FileListEntry *entry, uint32_t offset,
+                               char const *what, char const *name) {
+  size_t line;
+  size_t character;
+  fileListEntryPosition(entry, offset, &line, &character);
+  fprintf(diagnosticStream(),
+          "%s:%zu:%zu: error: the %s '%s' may not contain itself\n",
           entry->inputFilename, line, character, what, name);
   entry->errored = true;
 }
@@ -292,18 +315,19 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
 
           if (lhsType != NULL && rhsType != NULL &&
               !typeImplicitlyConvertable(rhsType, lhsType))
-            errorNoImplicitConversion(entry, exp->line, exp->character, rhsType,
-                                      lhsType);
+            errorNoImplicitConversion(entry, exp->offset, rhsType, lhsType);
 
           if (!isLvalue(exp->data.binOpExp.lhs)) {
-            errorNotLvalue(entry, exp->line, exp->character,
-                           "assign a value to");
+            errorNotLvalue(entry, exp->offset, "assign a value to");
           } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                      lhsType->data.qualified.constQual) {
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, exp->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: cannot assign a value to a constant "
                     "variable\n",
-                    entry->inputFilename, exp->line, exp->character);
+                    entry->inputFilename, line, character);
             entry->errored = true;
           }
 
@@ -318,25 +342,25 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = arithmeticTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a multiplication operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a multiplication operation",
+                           lhsType, rhsType);
             }
 
             if (lhsType != NULL && merged != NULL &&
                 !typeImplicitlyConvertable(merged, lhsType))
-              errorNoImplicitConversion(entry, exp->line, exp->character,
-                                        merged, lhsType);
-            typeFree(merged);
+              errorNoImplicitConversion(entry, exp->offset, merged, lhsType);
 
             if (!isLvalue(exp->data.binOpExp.lhs)) {
-              errorNotLvalue(entry, exp->line, exp->character,
-                             "assign a value to");
+              errorNotLvalue(entry, exp->offset, "assign a value to");
             } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                        lhsType->data.qualified.constQual) {
-              fprintf(stderr,
+              size_t line;
+              size_t character;
+              fileListEntryPosition(entry, exp->offset, &line, &character);
+              fprintf(diagnosticStream(),
                       "%s:%zu:%zu: error: cannot assign a value to a constant "
                       "variable\n",
-                      entry->inputFilename, exp->line, exp->character);
+                      entry->inputFilename, line, character);
               entry->errored = true;
             }
           }
@@ -351,25 +375,25 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = arithmeticTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a division operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a division operation", lhsType,
+                           rhsType);
             }
 
             if (lhsType != NULL && merged != NULL &&
                 !typeImplicitlyConvertable(merged, lhsType))
-              errorNoImplicitConversion(entry, exp->line, exp->character,
-                                        merged, lhsType);
-            typeFree(merged);
+              errorNoImplicitConversion(entry, exp->offset, merged, lhsType);
 
             if (!isLvalue(exp->data.binOpExp.lhs)) {
-              errorNotLvalue(entry, exp->line, exp->character,
-                             "assign a value to");
+              errorNotLvalue(entry, exp->offset, "assign a value to");
             } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                        lhsType->data.qualified.constQual) {
-              fprintf(stderr,
+              size_t line;
+              size_t character;
+              fileListEntryPosition(entry, exp->offset, &line, &character);
+              fprintf(diagnosticStream(),
                       "%s:%zu:%zu: error: cannot assign a value to a constant "
                       "variable\n",
-                      entry->inputFilename, exp->line, exp->character);
+                      entry->inputFilename, line, character);
               entry->errored = true;
             }
           }
@@ -384,25 +408,25 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = arithmeticTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a modulo operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a modulo operation", lhsType,
+                           rhsType);
             }
 
             if (lhsType != NULL && merged != NULL &&
                 !typeImplicitlyConvertable(merged, lhsType))
-              errorNoImplicitConversion(entry, exp->line, exp->character,
-                                        merged, lhsType);
-            typeFree(merged);
+              errorNoImplicitConversion(entry, exp->offset, merged, lhsType);
 
             if (!isLvalue(exp->data.binOpExp.lhs)) {
-              errorNotLvalue(entry, exp->line, exp->character,
-                             "assign a value to");
+              errorNotLvalue(entry, exp->offset, "assign a value to");
             } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                        lhsType->data.qualified.constQual) {
-              fprintf(stderr,
+              size_t line;
+              size_t character;
+              fileListEntryPosition(entry, exp->offset, &line, &character);
+              fprintf(diagnosticStream(),
                       "%s:%zu:%zu: error: cannot assign a value to a constant "
                       "variable\n",
-                      entry->inputFilename, exp->line, exp->character);
+                      entry->inputFilename, line, character);
               entry->errored = true;
             }
           }
@@ -418,44 +442,46 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
             if (typeNumeric(lhsType) && typeNumeric(rhsType)) {
               Type *merged = arithmeticTypeMerge(lhsType, rhsType);
               if (merged == NULL) {
-                errorNoBinOp(entry, exp->line, exp->character,
-                             "an addition operation", lhsType, rhsType);
+                errorNoBinOp(entry, exp->offset, "an addition operation",
+                             lhsType, rhsType);
               }
 
               if (lhsType != NULL && merged != NULL &&
                   !typeImplicitlyConvertable(merged, lhsType))
-                errorNoImplicitConversion(entry, exp->line, exp->character,
-                                          merged, lhsType);
-              typeFree(merged);
+                errorNoImplicitConversion(entry, exp->offset, merged, lhsType);
 
               if (!isLvalue(exp->data.binOpExp.lhs)) {
-                errorNotLvalue(entry, exp->line, exp->character,
-                               "assign a value to");
+                errorNotLvalue(entry, exp->offset, "assign a value to");
               } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                          lhsType->data.qualified.constQual) {
+                size_t line;
+                size_t character;
+                fileListEntryPosition(entry, exp->offset, &line, &character);
                 fprintf(
-                    stderr,
+                    diagnosticStream(),
                     "%s:%zu:%zu: error: cannot assign a value to a constant "
                     "variable\n",
-                    entry->inputFilename, exp->line, exp->character);
+                    entry->inputFilename, line, character);
                 entry->errored = true;
               }
             } else if (typePointer(lhsType) && typeIntegral(rhsType)) {
               if (!isLvalue(exp->data.binOpExp.lhs)) {
-                errorNotLvalue(entry, exp->line, exp->character,
-                               "assign a value to");
+                errorNotLvalue(entry, exp->offset, "assign a value to");
               } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                          lhsType->data.qualified.constQual) {
+                size_t line;
+                size_t character;
+                fileListEntryPosition(entry, exp->offset, &line, &character);
                 fprintf(
-                    stderr,
+                    diagnosticStream(),
                     "%s:%zu:%zu: error: cannot assign a value to a constant "
                     "variable\n",
-                    entry->inputFilename, exp->line, exp->character);
+                    entry->inputFilename, line, character);
                 entry->errored = true;
               }
             } else {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "an additon operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "an additon operation", lhsType,
+                           rhsType);
             }
           }
 
@@ -471,44 +497,46 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
             if (typeNumeric(lhsType) && typeNumeric(rhsType)) {
               Type *merged = arithmeticTypeMerge(lhsType, rhsType);
               if (merged == NULL) {
-                errorNoBinOp(entry, exp->line, exp->character,
-                             "a subtraction operation", lhsType, rhsType);
+                errorNoBinOp(entry, exp->offset, "a subtraction operation",
+                             lhsType, rhsType);
               }
 
               if (lhsType != NULL && merged != NULL &&
                   !typeImplicitlyConvertable(merged, lhsType))
-                errorNoImplicitConversion(entry, exp->line, exp->character,
-                                          merged, lhsType);
-              typeFree(merged);
+                errorNoImplicitConversion(entry, exp->offset, merged, lhsType);
 
               if (!isLvalue(exp->data.binOpExp.lhs)) {
-                errorNotLvalue(entry, exp->line, exp->character,
-                               "assign a value to");
+                errorNotLvalue(entry, exp->offset, "assign a value to");
               } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                          lhsType->data.qualified.constQual) {
+                size_t line;
+                size_t character;
+                fileListEntryPosition(entry, exp->offset, &line, &character);
                 fprintf(
-                    stderr,
+                    diagnosticStream(),
                     "%s:%zu:%zu: error: cannot assign a value to a constant "
                     "variable\n",
-                    entry->inputFilename, exp->line, exp->character);
+                    entry->inputFilename, line, character);
                 entry->errored = true;
               }
             } else if (typePointer(lhsType) && typeIntegral(rhsType)) {
               if (!isLvalue(exp->data.binOpExp.lhs)) {
-                errorNotLvalue(entry, exp->line, exp->character,
-                               "assign a value to");
+                errorNotLvalue(entry, exp->offset, "assign a value to");
               } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                          lhsType->data.qualified.constQual) {
+                size_t line;
+                size_t character;
+                fileListEntryPosition(entry, exp->offset, &line, &character);
                 fprintf(
-                    stderr,
+                    diagnosticStream(),
                     "%s:%zu:%zu: error: cannot assign a value to a constant "
                     "variable\n",
-                    entry->inputFilename, exp->line, exp->character);
+                    entry->inputFilename, line, character);
                 entry->errored = true;
               }
             } else {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a subtraction operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a subtraction operation",
+                           lhsType, rhsType);
             }
           }
 
@@ -524,19 +552,21 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL &&
               ((!typeIntegral(lhsType) && !typePointer(lhsType)) ||
                !typeUnsignedIntegral(rhsType))) {
-            errorNoBinOp(entry, exp->line, exp->character, "a shift operation",
-                         lhsType, rhsType);
+            errorNoBinOp(entry, exp->offset, "a shift operation", lhsType,
+                         rhsType);
           }
 
           if (!isLvalue(exp->data.binOpExp.lhs)) {
-            errorNotLvalue(entry, exp->line, exp->character,
-                           "assign a value to");
+            errorNotLvalue(entry, exp->offset, "assign a value to");
           } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                      lhsType->data.qualified.constQual) {
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, exp->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: cannot assign a value to a constant "
                     "variable\n",
-                    entry->inputFilename, exp->line, exp->character);
+                    entry->inputFilename, line, character);
             entry->errored = true;
           }
 
@@ -551,19 +581,21 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL &&
               (!typeSignedIntegral(lhsType) ||
                !typeUnsignedIntegral(rhsType))) {
-            errorNoBinOp(entry, exp->line, exp->character,
-                         "an arithmetic shift operation", lhsType, rhsType);
+            errorNoBinOp(entry, exp->offset, "an arithmetic shift operation",
+                         lhsType, rhsType);
           }
 
           if (!isLvalue(exp->data.binOpExp.lhs)) {
-            errorNotLvalue(entry, exp->line, exp->character,
-                           "assign a value to");
+            errorNotLvalue(entry, exp->offset, "assign a value to");
           } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                      lhsType->data.qualified.constQual) {
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, exp->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: cannot assign a value to a constant "
                     "variable\n",
-                    entry->inputFilename, exp->line, exp->character);
+                    entry->inputFilename, line, character);
             entry->errored = true;
           }
 
@@ -580,25 +612,25 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = arithmeticTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a bitwise operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a bitwise operation", lhsType,
+                           rhsType);
             }
 
             if (lhsType != NULL && merged != NULL &&
                 !typeImplicitlyConvertable(merged, lhsType))
-              errorNoImplicitConversion(entry, exp->line, exp->character,
-                                        merged, lhsType);
-            typeFree(merged);
+              errorNoImplicitConversion(entry, exp->offset, merged, lhsType);
 
             if (!isLvalue(exp->data.binOpExp.lhs)) {
-              errorNotLvalue(entry, exp->line, exp->character,
-                             "assign a value to");
+              errorNotLvalue(entry, exp->offset, "assign a value to");
             } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                        lhsType->data.qualified.constQual) {
-              fprintf(stderr,
+              size_t line;
+              size_t character;
+              fileListEntryPosition(entry, exp->offset, &line, &character);
+              fprintf(diagnosticStream(),
                       "%s:%zu:%zu: error: cannot assign a value to a constant "
                       "variable\n",
-                      entry->inputFilename, exp->line, exp->character);
+                      entry->inputFilename, line, character);
               entry->errored = true;
             }
           }
@@ -615,19 +647,21 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL &&
               (!typeImplicitlyConvertable(lhsType, boolType) ||
                !typeImplicitlyConvertable(rhsType, boolType))) {
-            errorNoBinOp(entry, exp->line, exp->character,
-                         "a logical operation", lhsType, rhsType);
+            errorNoBinOp(entry, exp->offset, "a logical operation", lhsType,
+                         rhsType);
           }
 
           if (!isLvalue(exp->data.binOpExp.lhs)) {
-            errorNotLvalue(entry, exp->line, exp->character,
-                           "assign a value to");
+            errorNotLvalue(entry, exp->offset, "assign a value to");
           } else if (lhsType != NULL && lhsType->kind == TK_QUALIFIED &&
                      lhsType->data.qualified.constQual) {
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, exp->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: cannot assign a value to a constant "
                     "variable\n",
-                    entry->inputFilename, exp->line, exp->character);
+                    entry->inputFilename, line, character);
             entry->errored = true;
           }
 
@@ -643,8 +677,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL &&
               (!typeImplicitlyConvertable(lhsType, boolType) ||
                !typeImplicitlyConvertable(rhsType, boolType))) {
-            errorNoBinOp(entry, exp->line, exp->character,
-                         "a logical operation", lhsType, rhsType);
+            errorNoBinOp(entry, exp->offset, "a logical operation", lhsType,
+                         rhsType);
           }
 
           return exp->data.binOpExp.type = keywordTypeCreate(TK_BOOL);
@@ -660,8 +694,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = arithmeticTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a bitwise operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a bitwise operation", lhsType,
+                           rhsType);
             }
             return exp->data.binOpExp.type = merged;
           } else {
@@ -682,8 +716,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = comparisonTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a comparison operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a comparison operation",
+                           lhsType, rhsType);
             }
             exp->data.binOpExp.comparisonType = merged;
           }
@@ -700,8 +734,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL &&
               ((!typeIntegral(lhsType) && !typePointer(lhsType)) ||
                !typeUnsignedIntegral(rhsType))) {
-            errorNoBinOp(entry, exp->line, exp->character, "a shift operation",
-                         lhsType, rhsType);
+            errorNoBinOp(entry, exp->offset, "a shift operation", lhsType,
+                         rhsType);
           }
 
           return exp->data.binOpExp.type = typeCopy(lhsType);
@@ -715,8 +749,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL &&
               (!typeSignedIntegral(lhsType) ||
                !typeUnsignedIntegral(rhsType))) {
-            errorNoBinOp(entry, exp->line, exp->character,
-                         "an arithmetic shift operation", lhsType, rhsType);
+            errorNoBinOp(entry, exp->offset, "an arithmetic shift operation",
+                         lhsType, rhsType);
           }
 
           return exp->data.binOpExp.type = typeCopy(lhsType);
@@ -731,8 +765,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
             if (typeNumeric(lhsType) && typeNumeric(rhsType)) {
               Type *merged = arithmeticTypeMerge(lhsType, rhsType);
               if (merged == NULL) {
-                errorNoBinOp(entry, exp->line, exp->character,
-                             "an addition operation", lhsType, rhsType);
+                errorNoBinOp(entry, exp->offset, "an addition operation",
+                             lhsType, rhsType);
               }
               return exp->data.binOpExp.type = merged;
             } else if (typePointer(lhsType) && typeIntegral(rhsType)) {
@@ -740,8 +774,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
             } else if (typeIntegral(lhsType) && typePointer(rhsType)) {
               return exp->data.binOpExp.type = typeCopy(rhsType);
             } else {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "an additon operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "an additon operation", lhsType,
+                           rhsType);
               return NULL;
             }
           } else {
@@ -758,8 +792,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
             if (typeNumeric(lhsType) && typeNumeric(rhsType)) {
               Type *merged = arithmeticTypeMerge(lhsType, rhsType);
               if (merged == NULL) {
-                errorNoBinOp(entry, exp->line, exp->character,
-                             "a subtraction operation", lhsType, rhsType);
+                errorNoBinOp(entry, exp->offset, "a subtraction operation",
+                             lhsType, rhsType);
               }
               return exp->data.binOpExp.type = merged;
             } else if (typePointer(lhsType) && typeIntegral(rhsType)) {
@@ -768,8 +802,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
                        typeEqual(stripCV(lhsType), stripCV(rhsType))) {
               return exp->data.binOpExp.type = keywordTypeCreate(TK_LONG);
             } else {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a subtraction operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a subtraction operation",
+                           lhsType, rhsType);
               return NULL;
             }
           } else {
@@ -785,8 +819,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = arithmeticTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a multiplication operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a multiplication operation",
+                           lhsType, rhsType);
             }
             return exp->data.binOpExp.type = merged;
           } else {
@@ -802,8 +836,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = arithmeticTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a division operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a division operation", lhsType,
+                           rhsType);
             }
             return exp->data.binOpExp.type = merged;
           } else {
@@ -819,8 +853,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           if (lhsType != NULL && rhsType != NULL) {
             Type *merged = arithmeticTypeMerge(lhsType, rhsType);
             if (merged == NULL) {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "a modulo operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "a modulo operation", lhsType,
+                           rhsType);
             }
             return exp->data.binOpExp.type = merged;
           } else {
@@ -835,31 +869,16 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
             if (!(strippedType->kind == TK_REFERENCE &&
                   (strippedType->data.reference.entry->kind == SK_STRUCT ||
                    strippedType->data.reference.entry->kind == SK_UNION))) {
-              errorNoMembers(entry, exp->line, exp->character, structType);
+              errorNoMembers(entry, exp->offset, structType);
             } else {
               SymbolTableEntry *ref = strippedType->data.reference.entry;
-              if (ref->kind == SK_STRUCT) {
-                for (size_t idx = 0; idx < ref->data.structType.fieldNames.size;
-                     ++idx) {
-                  if (strcmp(exp->data.binOpExp.rhs->data.id.id,
-                             ref->data.structType.fieldNames.elements[idx]) ==
-                      0) {
-                    return exp->data.binOpExp.type = typeCopy(
-                               ref->data.structType.fieldTypes.elements[idx]);
-                  }
-                }
-              } else {
-                for (size_t idx = 0; idx < ref->data.unionType.optionNames.size;
-                     ++idx) {
-                  if (strcmp(exp->data.binOpExp.rhs->data.id.id,
-                             ref->data.unionType.optionNames.elements[idx]) ==
-                      0) {
-                    return exp->data.binOpExp.type = typeCopy(
-                               ref->data.unionType.optionTypes.elements[idx]);
-                  }
-                }
-              }
-              errorNoMember(entry, exp->line, exp->character,
+              char const *name = exp->data.binOpExp.rhs->data.id.id;
+              Type const *fieldType = ref->kind == SK_STRUCT
+                                          ? structLookupField(ref, name)
+                                          : unionLookupOption(ref, name);
+              if (fieldType != NULL)
+                return exp->data.binOpExp.type = typeCopy(fieldType);
+              errorNoMember(entry, exp->offset,
                             exp->data.binOpExp.rhs->data.id.id, structType);
             }
           }
@@ -875,31 +894,16 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
             if (!(strippedType->kind == TK_REFERENCE &&
                   (strippedType->data.reference.entry->kind == SK_STRUCT ||
                    strippedType->data.reference.entry->kind == SK_UNION))) {
-              errorNoMembers(entry, exp->line, exp->character, structType);
+              errorNoMembers(entry, exp->offset, structType);
             } else {
               SymbolTableEntry *ref = strippedType->data.reference.entry;
-              if (ref->kind == SK_STRUCT) {
-                for (size_t idx = 0; idx < ref->data.structType.fieldNames.size;
-                     ++idx) {
-                  if (strcmp(exp->data.binOpExp.rhs->data.id.id,
-                             ref->data.structType.fieldNames.elements[idx]) ==
-                      0) {
-                    return exp->data.binOpExp.type = typeCopy(
-                               ref->data.structType.fieldTypes.elements[idx]);
-                  }
-                }
-              } else {
-                for (size_t idx = 0; idx < ref->data.unionType.optionNames.size;
-                     ++idx) {
-                  if (strcmp(exp->data.binOpExp.rhs->data.id.id,
-                             ref->data.unionType.optionNames.elements[idx]) ==
-                      0) {
-                    return exp->data.binOpExp.type = typeCopy(
-                               ref->data.unionType.optionTypes.elements[idx]);
-                  }
-                }
-              }
-              errorNoMember(entry, exp->line, exp->character,
+              char const *name = exp->data.binOpExp.rhs->data.id.id;
+              Type const *fieldType = ref->kind == SK_STRUCT
+                                          ? structLookupField(ref, name)
+                                          : unionLookupOption(ref, name);
+              if (fieldType != NULL)
+                return exp->data.binOpExp.type = typeCopy(fieldType);
+              errorNoMember(entry, exp->offset,
                             exp->data.binOpExp.rhs->data.id.id, structType);
             }
           }
@@ -919,8 +923,8 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               return exp->data.binOpExp.type =
                          typeCopy(stripCV(lhsType)->data.pointer.base);
             } else {
-              errorNoBinOp(entry, exp->line, exp->character,
-                           "an array index operation", lhsType, rhsType);
+              errorNoBinOp(entry, exp->offset, "an array index operation",
+                           lhsType, rhsType);
               return NULL;
             }
           } else {
@@ -935,10 +939,13 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               !typeExplicitlyConvertable(target, exp->data.binOpExp.type)) {
             char *fromString = typeToString(target);
             char *toString = typeToString(exp->data.binOpExp.type);
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, exp->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: cannot convert a value of type '%s' to "
                     "a value of type '%s'\n",
-                    entry->inputFilename, exp->line, exp->character, fromString,
+                    entry->inputFilename, line, character, fromString,
                     toString);
             free(fromString);
             free(toString);
@@ -957,8 +964,7 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
           typecheckExpression(exp->data.ternaryExp.predicate, entry);
       if (predicateType != NULL &&
           !typeImplicitlyConvertable(predicateType, boolType)) {
-        errorNoImplicitConversion(entry, exp->data.ternaryExp.predicate->line,
-                                  exp->data.ternaryExp.predicate->character,
+        errorNoImplicitConversion(entry, exp->data.ternaryExp.predicate->offset,
                                   predicateType, boolType);
       }
 
@@ -971,11 +977,14 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
       if (consequentType != NULL && alternativeType != NULL && merged == NULL) {
         char *consequentString = typeToString(consequentType);
         char *alternativeString = typeToString(alternativeType);
-        fprintf(stderr,
+        size_t line;
+        size_t character;
+        fileListEntryPosition(entry, exp->offset, &line, &character);
+        fprintf(diagnosticStream(),
                 "%s:%zu:%zu: error: type mismatch in ternary expression - "
                 "cannot find common type between %s and %s\n",
-                entry->inputFilename, exp->line, exp->character,
-                consequentString, alternativeString);
+                entry->inputFilename, line, character, consequentString,
+                alternativeString);
         entry->errored = true;
         free(consequentString);
         free(alternativeString);
@@ -991,8 +1000,7 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
 
           if (type != NULL) {
             if (!typePointer(type)) {
-              errorNoUnOp(entry, exp->line, exp->character,
-                          "a pointer dereference", type);
+              errorNoUnOp(entry, exp->offset, "a pointer dereference", type);
               return NULL;
             }
 
@@ -1007,8 +1015,7 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               typecheckExpression(exp->data.unOpExp.target, entry);
 
           if (!isLvalue(exp->data.unOpExp.target)) {
-            errorNotLvalue(entry, exp->line, exp->character,
-                           "take the address of");
+            errorNotLvalue(entry, exp->offset, "take the address of");
           } else {
             markEscapes(exp->data.unOpExp.target);
           }
@@ -1025,11 +1032,11 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               typecheckExpression(exp->data.unOpExp.target, entry);
 
           if (type != NULL && !typeNumeric(type) && !typePointer(type)) {
-            errorNoUnOp(entry, exp->line, exp->character, "an increment", type);
+            errorNoUnOp(entry, exp->offset, "an increment", type);
           }
 
           if (!isLvalue(exp->data.unOpExp.target)) {
-            errorNotLvalue(entry, exp->line, exp->character, "increment");
+            errorNotLvalue(entry, exp->offset, "increment");
           }
 
           return exp->data.unOpExp.type = typeCopy(type);
@@ -1040,11 +1047,11 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               typecheckExpression(exp->data.unOpExp.target, entry);
 
           if (type != NULL && !typeNumeric(type) && !typePointer(type)) {
-            errorNoUnOp(entry, exp->line, exp->character, "a decrement", type);
+            errorNoUnOp(entry, exp->offset, "a decrement", type);
           }
 
           if (!isLvalue(exp->data.unOpExp.target)) {
-            errorNotLvalue(entry, exp->line, exp->character, "decrement");
+            errorNotLvalue(entry, exp->offset, "decrement");
           }
 
           return exp->data.unOpExp.type = typeCopy(type);
@@ -1055,7 +1062,7 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
 
           if (type != NULL && !typeSignedIntegral(type) &&
               !typeFloating(type)) {
-            errorNoUnOp(entry, exp->line, exp->character, "a negation", type);
+            errorNoUnOp(entry, exp->offset, "a negation", type);
           }
 
           return exp->data.unOpExp.type = typeCopy(type);
@@ -1065,8 +1072,7 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               typecheckExpression(exp->data.unOpExp.target, entry);
 
           if (type != NULL && !typeBoolean(type)) {
-            errorNoUnOp(entry, exp->line, exp->character, "a logical negation",
-                        type);
+            errorNoUnOp(entry, exp->offset, "a logical negation", type);
           }
 
           return exp->data.unOpExp.type = typeCopy(type);
@@ -1076,8 +1082,7 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               typecheckExpression(exp->data.unOpExp.target, entry);
 
           if (type != NULL && !typeIntegral(type)) {
-            errorNoUnOp(entry, exp->line, exp->character, "a bitwise not",
-                        type);
+            errorNoUnOp(entry, exp->offset, "a bitwise not", type);
           }
 
           return exp->data.unOpExp.type = typeCopy(type);
@@ -1088,12 +1093,11 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
 
           if (type != NULL && !typeSignedIntegral(type) &&
               !typeFloating(type)) {
-            errorNoUnOp(entry, exp->line, exp->character, "a negation", type);
+            errorNoUnOp(entry, exp->offset, "a negation", type);
           }
 
           if (!isLvalue(exp->data.unOpExp.target)) {
-            errorNotLvalue(entry, exp->line, exp->character,
-                           "assign a value to");
+            errorNotLvalue(entry, exp->offset, "assign a value to");
           }
 
           return exp->data.unOpExp.type = typeCopy(type);
@@ -1103,13 +1107,11 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               typecheckExpression(exp->data.unOpExp.target, entry);
 
           if (type != NULL && !typeBoolean(type)) {
-            errorNoUnOp(entry, exp->line, exp->character, "a logical negation",
-                        type);
+            errorNoUnOp(entry, exp->offset, "a logical negation", type);
           }
 
           if (!isLvalue(exp->data.unOpExp.target)) {
-            errorNotLvalue(entry, exp->line, exp->character,
-                           "assign a value to");
+            errorNotLvalue(entry, exp->offset, "assign a value to");
           }
 
           return exp->data.unOpExp.type = typeCopy(type);
@@ -1119,13 +1121,11 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
               typecheckExpression(exp->data.unOpExp.target, entry);
 
           if (type != NULL && !typeIntegral(type)) {
-            errorNoUnOp(entry, exp->line, exp->character, "a bitwise not",
-                        type);
+            errorNoUnOp(entry, exp->offset, "a bitwise not", type);
           }
 
           if (!isLvalue(exp->data.unOpExp.target)) {
-            errorNotLvalue(entry, exp->line, exp->character,
-                           "assign a value to");
+            errorNotLvalue(entry, exp->offset, "assign a value to");
           }
 
           return exp->data.unOpExp.type = typeCopy(type);
@@ -1153,14 +1153,17 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
       if (funType != NULL) {
         Type const *stripped = stripCV(funType);
         if (stripped->kind != TK_FUNPTR) {
-          errorNoUnOp(entry, exp->line, exp->character, "call", funType);
+          errorNoUnOp(entry, exp->offset, "call", funType);
         } else {
           if (stripped->data.funPtr.argTypes.size !=
               exp->data.funCallExp.arguments->size) {
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, exp->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: function expects %zu arguments, but "
                     "was called with %zu\n",
-                    entry->inputFilename, exp->line, exp->character,
+                    entry->inputFilename, line, character,
                     stripped->data.funPtr.argTypes.size,
                     exp->data.funCallExp.arguments->size);
             entry->errored = true;
@@ -1173,7 +1176,7 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
                   !typeImplicitlyConvertable(
                       argType, stripped->data.funPtr.argTypes.elements[idx])) {
                 errorNoImplicitConversion(
-                    entry, arg->line, arg->character, argType,
+                    entry, arg->offset, argType,
                     stripped->data.funPtr.argTypes.elements[idx]);
               }
             }
@@ -1243,16 +1246,17 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
                      pointerTypeCreate(keywordTypeCreate(TK_VOID));
         }
         case LT_AGGREGATEINIT: {
-          exp->data.literal.type = aggregateTypeCreate();
+          Vector types;
+          vectorInit(&types);
           for (size_t idx = 0;
                idx < exp->data.literal.data.aggregateInitVal->size; ++idx) {
             vectorInsert(
-                &exp->data.literal.type->data.aggregate.types,
+                &types,
                 typeCopy(typecheckExpression(
                     exp->data.literal.data.aggregateInitVal->elements[idx],
                     entry)));
           }
-          return exp->data.literal.type;
+          return exp->data.literal.type = aggregateTypeCreate(&types);
         }
         default: {
           error(__FILE__, __LINE__, "invalid literal type encountered");
@@ -1262,25 +1266,25 @@ static Type const *typecheckExpression(Node *exp, FileListEntry *entry) {
     case NT_SCOPEDID: {
       return exp->data.scopedId.type =
                  exp->data.scopedId.entry->kind == SK_VARIABLE
-                     ? typeCopy(exp->data.scopedId.entry->data.variable.type)
+                     ? exp->data.scopedId.entry->data.variable.type
                      : referenceTypeCreate(
                            exp->data.scopedId.entry->data.enumConst.parent);
     }
     case NT_ID: {
       if (exp->data.id.entry->kind == SK_VARIABLE) {
-        return exp->data.id.type =
-                   typeCopy(exp->data.id.entry->data.variable.type);
+        return exp->data.id.type = exp->data.id.entry->data.variable.type;
       } else {
-        exp->data.id.type = funPtrTypeCreate(
-            typeCopy(exp->data.id.entry->data.function.returnType));
+        Vector argTypes;
+        vectorInit(&argTypes);
         for (size_t idx = 0;
              idx < exp->data.id.entry->data.function.argumentTypes.size;
              ++idx) {
-          vectorInsert(&exp->data.id.type->data.funPtr.argTypes,
-                       typeCopy(exp->data.id.entry->data.function.argumentTypes
-                                    .elements[idx]));
+          vectorInsert(
+              &argTypes,
+              exp->data.id.entry->data.function.argumentTypes.elements[idx]);
         }
-        return exp->data.id.type;
+        return exp->data.id.type = funPtrTypeCreate(
+                   exp->data.id.entry->data.function.returnType, &argTypes);
       }
     }
     default: {
@@ -1313,8 +1317,7 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
           typecheckExpression(stmt->data.ifStmt.predicate, entry);
       if (predicateType != NULL &&
           !typeImplicitlyConvertable(predicateType, boolType)) {
-        errorNoImplicitConversion(entry, stmt->data.ifStmt.predicate->line,
-                                  stmt->data.ifStmt.predicate->character,
+        errorNoImplicitConversion(entry, stmt->data.ifStmt.predicate->offset,
                                   predicateType, boolType);
       }
       typecheckStmt(stmt->data.ifStmt.consequent, returnType, entry);
@@ -1326,8 +1329,7 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
           typecheckExpression(stmt->data.whileStmt.condition, entry);
       if (conditionType != NULL &&
           !typeImplicitlyConvertable(conditionType, boolType)) {
-        errorNoImplicitConversion(entry, stmt->data.whileStmt.condition->line,
-                                  stmt->data.whileStmt.condition->character,
+        errorNoImplicitConversion(entry, stmt->data.whileStmt.condition->offset,
                                   conditionType, boolType);
       }
       typecheckStmt(stmt->data.whileStmt.body, returnType, entry);
@@ -1339,8 +1341,8 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
           typecheckExpression(stmt->data.doWhileStmt.condition, entry);
       if (conditionType != NULL &&
           !typeImplicitlyConvertable(conditionType, boolType)) {
-        errorNoImplicitConversion(entry, stmt->data.doWhileStmt.condition->line,
-                                  stmt->data.doWhileStmt.condition->character,
+        errorNoImplicitConversion(entry,
+                                  stmt->data.doWhileStmt.condition->offset,
                                   conditionType, boolType);
       }
       break;
@@ -1351,8 +1353,7 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
           typecheckExpression(stmt->data.forStmt.condition, entry);
       if (conditionType != NULL &&
           !typeImplicitlyConvertable(conditionType, boolType)) {
-        errorNoImplicitConversion(entry, stmt->data.forStmt.condition->line,
-                                  stmt->data.forStmt.condition->character,
+        errorNoImplicitConversion(entry, stmt->data.forStmt.condition->offset,
                                   conditionType, boolType);
       }
       if (stmt->data.forStmt.increment != NULL)
@@ -1365,10 +1366,13 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
           typecheckExpression(stmt->data.switchStmt.condition, entry);
       if (!typeSwitchable(conditionType)) {
         char *typeString = typeToString(conditionType);
-        fprintf(stderr,
+        size_t line;
+        size_t character;
+        fileListEntryPosition(entry, stmt->data.switchStmt.condition->offset,
+                              &line, &character);
+        fprintf(diagnosticStream(),
                 "%s:%zu:%zu: error: cannot switch on values of type '%s'\n",
-                entry->inputFilename, stmt->data.switchStmt.condition->line,
-                stmt->data.switchStmt.condition->character, typeString);
+                entry->inputFilename, line, character, typeString);
         free(typeString);
         entry->errored = true;
       }
@@ -1386,8 +1390,8 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
               Type const *valueType = typecheckExpression(value, entry);
               if (conditionType != NULL && valueType != NULL &&
                   !typeImplicitlyConvertable(valueType, conditionType)) {
-                errorNoImplicitConversion(entry, value->line, value->character,
-                                          valueType, conditionType);
+                errorNoImplicitConversion(entry, value->offset, valueType,
+                                          conditionType);
               }
             }
             typecheckStmt(caseNode->data.switchCase.body, returnType, entry);
@@ -1414,37 +1418,37 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
           uint64_t unsignedVal;
           int64_t signedVal;
         } value;
-        size_t line;
-        size_t character;
+        uint32_t offset;
       } SwitchCaseVal;
       SwitchCaseVal *values = malloc(sizeof(SwitchCaseVal) * numValues);
       size_t currValue = 0;
 
       bool seenDefault = false;
-      size_t firstLine = 0;
-      size_t firstCharacter = 0;
+      uint32_t firstOffset = 0;
       for (size_t idx = 0; idx < cases->size; ++idx) {
         Node *c = cases->elements[idx];
         if (c->type == NT_SWITCHDEFAULT) {
           if (seenDefault) {
-            fprintf(stderr,
+            size_t line;
+            size_t character;
+            fileListEntryPosition(entry, c->offset, &line, &character);
+            fprintf(diagnosticStream(),
                     "%s:%zu:%zu: error: cannot have multiple default cases in "
                     "a switch statement\n",
-                    entry->inputFilename, c->line, c->character);
-            fprintf(stderr, "%s:%zu:%zu: note: first seen here\n",
-                    entry->inputFilename, firstLine, firstCharacter);
+                    entry->inputFilename, line, character);
+            fileListEntryPosition(entry, firstOffset, &line, &character);
+            fprintf(diagnosticStream(), "%s:%zu:%zu: note: first seen here\n",
+                    entry->inputFilename, line, character);
             entry->errored = true;
           } else {
             seenDefault = true;
-            firstLine = c->line;
-            firstCharacter = c->character;
+            firstOffset = c->offset;
           }
         } else {
           Vector *valueNodes = c->data.switchCase.values;
           for (size_t valueIdx = 0; valueIdx < valueNodes->size; ++valueIdx) {
             Node const *valueNode = valueNodes->elements[valueIdx];
-            values[currValue].line = valueNode->line;
-            values[currValue].character = valueNode->character;
+            values[currValue].offset = valueNode->offset;
             switch (valueNode->type) {
               case NT_LITERAL: {
                 switch (valueNode->data.literal.literalType) {
@@ -1567,14 +1571,19 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
                                    values[currValue - 1].value.signedVal) ||
                   (!isSigned && values[valueIdx].value.unsignedVal ==
                                     values[currValue - 1].value.unsignedVal)) {
-                fprintf(stderr,
+                size_t line;
+                size_t character;
+                fileListEntryPosition(entry, values[currValue - 1].offset,
+                                      &line, &character);
+                fprintf(diagnosticStream(),
                         "%s:%zu:%zu: error: cannot have multiple cases with "
                         "the same value in a switch statement\n",
-                        entry->inputFilename, values[currValue - 1].line,
-                        values[currValue - 1].character);
-                fprintf(stderr, "%s:%zu:%zu: note: first seen here\n",
-                        entry->inputFilename, values[valueIdx].line,
-                        values[valueIdx].character);
+                        entry->inputFilename, line, character);
+                fileListEntryPosition(entry, values[valueIdx].offset, &line,
+                                      &character);
+                fprintf(diagnosticStream(),
+                        "%s:%zu:%zu: note: first seen here\n",
+                        entry->inputFilename, line, character);
                 entry->errored = true;
                 break;
               }
@@ -1592,19 +1601,20 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
             typecheckExpression(stmt->data.returnStmt.value, entry);
         if (valueType != NULL &&
             !typeImplicitlyConvertable(valueType, returnType)) {
-          errorNoImplicitConversion(entry, stmt->data.returnStmt.value->line,
-                                    stmt->data.returnStmt.value->character,
+          errorNoImplicitConversion(entry, stmt->data.returnStmt.value->offset,
                                     valueType, returnType);
         }
       } else {
         if (!(returnType->kind == TK_KEYWORD &&
               returnType->data.keyword.keyword == TK_VOID)) {
           char *typeString = typeToString(returnType);
-          fprintf(stderr,
+          size_t line;
+          size_t character;
+          fileListEntryPosition(entry, stmt->offset, &line, &character);
+          fprintf(diagnosticStream(),
                   "%s:%zu:%zu: error: must return a value from a function "
                   "returining '%s'\n",
-                  entry->inputFilename, stmt->line, stmt->character,
-                  typeString);
+                  entry->inputFilename, line, character, typeString);
           free(typeString);
           entry->errored = true;
         }
@@ -1616,8 +1626,7 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
       Vector *initializers = stmt->data.varDefnStmt.initializers;
       Node *firstName = names->elements[0];
       if (!typeComplete(firstName->data.id.entry->data.variable.type))
-        errorIncompleteType(entry, stmt->data.varDefnStmt.type->line,
-                            stmt->data.varDefnStmt.type->character,
+        errorIncompleteType(entry, stmt->data.varDefnStmt.type->offset,
                             firstName->data.id.entry->data.variable.type);
       for (size_t idx = 0; idx < names->size; ++idx) {
         Node *name = names->elements[idx];
@@ -1627,8 +1636,8 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
           if (initializerType != NULL &&
               !typeImplicitlyConvertable(
                   initializerType, name->data.id.entry->data.variable.type)) {
-            errorNoImplicitConversion(entry, initializer->line,
-                                      initializer->character, initializerType,
+            errorNoImplicitConversion(entry, initializer->offset,
+                                      initializerType,
                                       name->data.id.entry->data.variable.type);
           }
         }
@@ -1641,21 +1650,21 @@ static void typecheckStmt(Node *stmt, Type const *returnType,
     }
     case NT_STRUCTDECL: {
       if (structRecursive(stmt->data.structDecl.name->data.id.entry)) {
-        errorRecursiveDecl(entry, stmt->line, stmt->character, "struct",
+        errorRecursiveDecl(entry, stmt->offset, "struct",
                            stmt->data.structDecl.name->data.id.id);
       }
       break;
     }
     case NT_UNIONDECL: {
       if (unionRecursive(stmt->data.unionDecl.name->data.id.entry)) {
-        errorRecursiveDecl(entry, stmt->line, stmt->character, "union",
+        errorRecursiveDecl(entry, stmt->offset, "union",
                            stmt->data.unionDecl.name->data.id.id);
       }
       break;
     }
     case NT_TYPEDEFDECL: {
       if (typedefRecursive(stmt->data.typedefDecl.name->data.id.entry)) {
-        errorRecursiveDecl(entry, stmt->line, stmt->character, "typedef",
+        errorRecursiveDecl(entry, stmt->offset, "typedef",
                            stmt->data.typedefDecl.name->data.id.id);
       }
       break;
@@ -1681,8 +1690,7 @@ static void typecheckFile(FileListEntry *entry) {
         Vector *initializers = body->data.varDefn.initializers;
         Node *firstName = names->elements[0];
         if (!typeComplete(firstName->data.id.entry->data.variable.type))
-          errorIncompleteType(entry, body->data.varDefn.type->line,
-                              body->data.varDefn.type->character,
+          errorIncompleteType(entry, body->data.varDefn.type->offset,
                               firstName->data.id.entry->data.variable.type);
         for (size_t idx = 0; idx < names->size; ++idx) {
           Node *name = names->elements[idx];
@@ -1694,7 +1702,7 @@ static void typecheckFile(FileListEntry *entry) {
                 !typeImplicitlyConvertable(
                     initializerType, name->data.id.entry->data.variable.type)) {
               errorNoImplicitConversion(
-                  entry, initializer->line, initializer->character,
+                  entry, initializer->offset,
                   initializerType, name->data.id.entry->data.variable.type);
             }
           }
@@ -1705,8 +1713,7 @@ static void typecheckFile(FileListEntry *entry) {
         Vector *names = body->data.varDecl.names;
         Node *firstName = names->elements[0];
         if (!typeComplete(firstName->data.id.entry->data.variable.type))
-          errorIncompleteType(entry, body->data.varDecl.type->line,
-                              body->data.varDecl.type->character,
+          errorIncompleteType(entry, body->data.varDecl.type->offset,
                               firstName->data.id.entry->data.variable.type);
         break;
       }
@@ -1716,15 +1723,14 @@ static void typecheckFile(FileListEntry *entry) {
         if (!((returnType->kind == TK_KEYWORD &&
                returnType->data.keyword.keyword == TK_VOID) ||
               typeComplete(returnType)))
-          errorIncompleteType(entry, body->data.funDefn.returnType->line,
-                              body->data.funDefn.returnType->character,
+          errorIncompleteType(entry, body->data.funDefn.returnType->offset,
                               returnType);
         Vector *argTypes = &body->data.funDefn.name->data.id.entry->data
                                 .function.argumentTypes;
         for (size_t idx = 0; idx < argTypes->size; ++idx) {
           if (!typeComplete(argTypes->elements[idx])) {
             Node *typeNode = body->data.funDefn.argTypes->elements[idx];
-            errorIncompleteType(entry, typeNode->line, typeNode->character,
+            errorIncompleteType(entry, typeNode->offset,
                                 argTypes->elements[idx]);
           }
         }
@@ -1737,15 +1743,14 @@ static void typecheckFile(FileListEntry *entry) {
         if (!((returnType->kind == TK_KEYWORD &&
                returnType->data.keyword.keyword == TK_VOID) ||
               typeComplete(returnType)))
-          errorIncompleteType(entry, body->data.funDecl.returnType->line,
-                              body->data.funDecl.returnType->character,
+          errorIncompleteType(entry, body->data.funDecl.returnType->offset,
                               returnType);
         Vector *argTypes = &body->data.funDecl.name->data.id.entry->data
                                 .function.argumentTypes;
         for (size_t idx = 0; idx < argTypes->size; ++idx) {
           if (!typeComplete(argTypes->elements[idx])) {
             Node *typeNode = body->data.funDecl.argTypes->elements[idx];
-            errorIncompleteType(entry, typeNode->line, typeNode->character,
+            errorIncompleteType(entry, typeNode->offset,
                                 argTypes->elements[idx]);
           }
         }
@@ -1753,21 +1758,21 @@ static void typecheckFile(FileListEntry *entry) {
       }
       case NT_STRUCTDECL: {
         if (structRecursive(body->data.structDecl.name->data.id.entry)) {
-          errorRecursiveDecl(entry, body->line, body->character, "struct",
+          errorRecursiveDecl(entry, body->offset, "struct",
                              body->data.structDecl.name->data.id.id);
         }
         break;
       }
       case NT_UNIONDECL: {
         if (unionRecursive(body->data.unionDecl.name->data.id.entry)) {
-          errorRecursiveDecl(entry, body->line, body->character, "union",
+          errorRecursiveDecl(entry, body->offset, "union",
                              body->data.unionDecl.name->data.id.id);
         }
         break;
       }
       case NT_TYPEDEFDECL: {
         if (typedefRecursive(body->data.typedefDecl.name->data.id.entry)) {
-          errorRecursiveDecl(entry, body->line, body->character, "typedef",
+          errorRecursiveDecl(entry, body->offset, "typedef",
                              body->data.typedefDecl.name->data.id.id);
         }
         break;
@@ -1784,14 +1789,15 @@ int typecheck(void) {
 
   boolType = keywordTypeCreate(TK_BOOL);
 
-  // for each code file, type check it
+  // for each file, type check it
   for (size_t idx = 0; idx < fileList.size; ++idx) {
+    if (fileList.entries[idx].preparsed) continue;
+    timeReportFileBegin(TRP_TYPECHECK, idx);
     typecheckFile(&fileList.entries[idx]);
+    timeReportFileEnd(TRP_TYPECHECK, idx);
     errored = errored || fileList.entries[idx].errored;
   }
 
-  typeFree(boolType);
-
   if (errored) return -1;
 
   return 0;
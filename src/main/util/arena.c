@@ -0,0 +1,111 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of arena allocation
+
+#include "util/arena.h"
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/** size of an ordinary block, including its header */
+#define BLOCK_SIZE 65536
+
+/** header of a block - the block's space follows it */
+struct ArenaBlock {
+  ArenaBlock *next;
+  alignas(max_align_t) char data[];
+};
+
+/**
+ * rounds a size up to the arena's alignment
+ *
+ * @param size size to round
+ * @returns rounded size
+ */
+static size_t alignSize(size_t size) {
+  return (size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+}
+
+Arena *arenaCreate(void) {
+  Arena *arena = malloc(sizeof(Arena));
+  arena->blocks = NULL;
+  arena->next = NULL;
+  arena->end = NULL;
+  return arena;
+}
+
+void *arenaAllocate(Arena *arena, size_t size) {
+  size = alignSize(size);
+  if ((size_t)(arena->end - arena->next) >= size) {
+    void *allocated = arena->next;
+    arena->next += size;
+    return allocated;
+  }
+
+  if (size > (BLOCK_SIZE - sizeof(ArenaBlock)) / 4) {
+    // big allocations get their own block, behind the one being filled
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + size);
+    if (arena->blocks == NULL) {
+      block->next = NULL;
+      arena->blocks = block;
+    } else {
+      block->next = arena->blocks->next;
+      arena->blocks->next = block;
+    }
+    return block->data;
+  }
+
+  // the rest of the current block is abandoned
+  ArenaBlock *block = malloc(BLOCK_SIZE);
+  block->next = arena->blocks;
+  arena->blocks = block;
+  arena->next = block->data + size;
+  arena->end = (char *)block + BLOCK_SIZE;
+  return block->data;
+}
+
+void arenaAdopt(Arena *arena, Arena *other) {
+  if (other->blocks != NULL) {
+    // the other arena's blocks go behind the one being filled
+    ArenaBlock *last = other->blocks;
+    while (last->next != NULL) last = last->next;
+    if (arena->blocks == NULL) {
+      arena->blocks = other->blocks;
+      arena->next = other->next;
+      arena->end = other->end;
+    } else {
+      last->next = arena->blocks->next;
+      arena->blocks->next = other->blocks;
+    }
+  }
+  free(other);
+}
+
+void arenaFree(Arena *arena) {
+  if (arena == NULL) return;
+  ArenaBlock *block = arena->blocks;
+  while (block != NULL) {
+    ArenaBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+  free(arena);
+}
@@ -0,0 +1,73 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * bump allocation of objects that are all freed together
+ */
+
+#ifndef TLC_UTIL_ARENA_H_
+#define TLC_UTIL_ARENA_H_
+
+#include <stddef.h>
+
+typedef struct ArenaBlock ArenaBlock;
+
+/** an arena - a set of blocks that objects are carved out of in order */
+typedef struct {
+  ArenaBlock *blocks; /**< blocks, most recently started first */
+  char *next;         /**< next free byte in the first block */
+  char *end;          /**< end of the first block */
+} Arena;
+
+/**
+ * creates an empty arena
+ *
+ * @returns arena, owning
+ */
+Arena *arenaCreate(void);
+
+/**
+ * allocates space in an arena, aligned for any type
+ *
+ * the space is uninitialized, and stays valid until the arena is freed
+ *
+ * @param arena arena to allocate in
+ * @param size number of bytes to allocate
+ * @returns pointer to the space
+ */
+void *arenaAllocate(Arena *arena, size_t size);
+
+/**
+ * moves everything allocated in one arena into another, and frees the emptied
+ * arena
+ *
+ * @param arena arena to move allocations into
+ * @param other arena to move allocations out of, freed
+ */
+void arenaAdopt(Arena *arena, Arena *other);
+
+/**
+ * frees an arena, and everything allocated in it
+ *
+ * @param arena arena to free, may be null
+ */
+void arenaFree(Arena *arena);
+
+#endif  // TLC_UTIL_ARENA_H_
@@ -18,14 +18,25 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 // Implementation of generic hash map
+//
+// The index holds the low bits of each key's hash next to the position of its
+// entry, so a probe only looks at an entry when those bits match. Robin Hood
+// insertion keeps every entry at most as far from its home slot as the entries
+// it passed on the way, so a lookup can stop at the first slot closer to its
+// home than the key would be. Removal shifts the entries after the removed one
+// back a slot, up to the next empty slot or entry already at home, so no
+// tombstones are needed. Entries keep their full hash, so growing never
+// rehashes a key.
 
 #include "util/container/hashMap.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "optimization.h"
 #include "util/hash.h"
+#include "util/intern.h"
 
 HashMap *hashMapCreate(void) {
   HashMap *map = malloc(sizeof(HashMap));
@@ -35,125 +46,181 @@ HashMap *hashMapCreate(void) {
 
 void hashMapInit(HashMap *map) {
   map->size = 0;
-  map->capacity = PTR_VECTOR_INIT_CAPACITY;
-  map->keys = calloc(map->capacity, sizeof(char const *));
-  map->values = malloc(map->capacity * sizeof(void *));
+  map->capacity = 0;
+  map->entries = NULL;
+  map->slots = NULL;
 }
 
-void *hashMapGet(HashMap const *map, char const *key) {
-  uint64_t hash = djb2xor(key);
-  hash %= map->capacity;
-
-  if (map->keys[hash] == NULL) {
-    return NULL;                                   // not found
-  } else if (strcmp(map->keys[hash], key) != 0) {  // collision
-    uint64_t hash2 = djb2add(key) + 1;
-    for (size_t idx = (hash + hash2) % map->capacity; idx != hash;
-         idx = (idx + hash2) % map->capacity) {
-      if (map->keys[idx] == NULL) {
-        return NULL;
-      } else if (strcmp(map->keys[idx], key) == 0) {  // found it!
-        return map->values[idx];
-      }
+/**
+ * gets the number of entries a map can hold before its index must grow
+ */
+static size_t maxSize(size_t capacity) { return capacity / 8 * 7; }
+
+/**
+ * hashes a key
+ *
+ * @param key key to hash
+ * @param interned is the key interned?
+ */
+static uint64_t keyHash(char const *key, bool interned) {
+  return interned ? internedHash(key) : hashBytes(key, strlen(key));
+}
+
+/**
+ * finds the entry for a key
+ *
+ * @param map map to search
+ * @param key key to search for
+ * @param hash hash of the key
+ * @param interned is the key (and every key in the map) interned?
+ * @returns index of the entry, or map->size if the key isn't in the map
+ */
+static size_t find(HashMap const *map, char const *key, uint64_t hash,
+                   bool interned) {
+  if (map->size == 0) return map->size;
+
+  size_t mask = map->capacity - 1;
+  uint32_t shortHash = (uint32_t)hash;
+  for (size_t idx = hash & mask, distance = 0;;
+       idx = (idx + 1) & mask, ++distance) {
+    HashMapSlot const *slot = &map->slots[idx];
+    // an empty slot, or an entry closer to home than the key would be, means
+    // the key would have been put here
+    if (slot->entry == 0 || ((idx - slot->hash) & mask) < distance)
+      return map->size;
+    if (slot->hash == shortHash) {
+      char const *candidate = map->entries[slot->entry - 1].key;
+      if (candidate == key || (!interned && strcmp(candidate, key) == 0))
+        return slot->entry - 1;
     }
-    return NULL;  // searched everywhere, couldn't find it
-  } else {        // found it
-    return map->values[hash];
   }
 }
 
-int hashMapPut(HashMap *map, char const *key, void *data) {
-  uint64_t hash = djb2xor(key) % map->capacity;
-
-  if (map->keys[hash] == NULL) {
-    map->keys[hash] = key;
-    map->values[hash] = data;
-    ++map->size;
-    return 0;                                      // empty spot
-  } else if (strcmp(map->keys[hash], key) != 0) {  // collision
-    uint64_t hash2 = djb2add(key) + 1;
-    for (size_t idx = (hash + hash2) % map->capacity; idx != hash;
-         idx = (idx + hash2) % map->capacity) {
-      if (map->keys[idx] == NULL) {  // empty spot
-        map->keys[idx] = key;
-        map->values[idx] = data;
-        ++map->size;
-        return 0;
-      } else if (strcmp(map->keys[idx], key) == 0) {  // already in there
-        return -1;
-      }
+/**
+ * puts an entry in a map's index, which must have an empty slot
+ *
+ * @param map map to put into
+ * @param entry index of the entry
+ */
+static void indexInsert(HashMap *map, size_t entry) {
+  size_t mask = map->capacity - 1;
+  HashMapSlot carried = {
+      .hash = (uint32_t)map->entries[entry].hash,
+      .entry = (uint32_t)(entry + 1),
+  };
+  for (size_t idx = carried.hash & mask, distance = 0;;
+       idx = (idx + 1) & mask, ++distance) {
+    HashMapSlot *slot = &map->slots[idx];
+    if (slot->entry == 0) {
+      *slot = carried;
+      return;
     }
-    size_t oldSize = map->capacity;  // unavoidable collision
-    char const **oldKeys = map->keys;
-    void **oldValues = map->values;
-    map->capacity *= 2;
-    map->keys = calloc(map->capacity, sizeof(char const *));
-    map->values = malloc(map->capacity * sizeof(void *));  // resize the map
-    map->size = 0;
-    for (size_t idx = 0; idx < oldSize; ++idx) {
-      if (oldKeys[idx] != NULL) {
-        // can set, since we know the element doesn't exist
-        hashMapSet(map, oldKeys[idx], oldValues[idx]);
-      }
+
+    // take the slot of any entry closer to home, and carry that one on instead
+    size_t slotDistance = (idx - slot->hash) & mask;
+    if (slotDistance < distance) {
+      HashMapSlot displaced = *slot;
+      *slot = carried;
+      carried = displaced;
+      distance = slotDistance;
     }
-    free(oldKeys);
-    free(oldValues);
-    return hashMapPut(map, key, data);  // recurse
-  } else {                              // already in there
+  }
+}
+
+/**
+ * doubles the capacity of a map, rebuilding its index
+ */
+static void grow(HashMap *map) {
+  map->capacity =
+      map->capacity == 0 ? HASH_MAP_INIT_CAPACITY : map->capacity * 2;
+  free(map->slots);
+  map->slots = calloc(map->capacity, sizeof(HashMapSlot));
+  map->entries =
+      realloc(map->entries, maxSize(map->capacity) * sizeof(HashMapEntry));
+  for (size_t idx = 0; idx < map->size; ++idx) indexInsert(map, idx);
+}
+
+/**
+ * inserts or sets a key
+ *
+ * @param map map to insert into
+ * @param key key to insert
+ * @param data value to insert
+ * @param interned is the key (and every key in the map) interned?
+ * @param overwrite should an existing value for the key be replaced?
+ * @returns 0 if the key was inserted, -1 if it already existed
+ */
+static int insert(HashMap *map, char const *key, void *data, bool interned,
+                  bool overwrite) {
+  uint64_t hash = keyHash(key, interned);
+  size_t idx = find(map, key, hash, interned);
+  if (idx != map->size) {  // already in there
+    if (overwrite) map->entries[idx].value = data;
     return -1;
   }
+
+  if (map->size == maxSize(map->capacity)) grow(map);
+  HashMapEntry *entry = &map->entries[map->size];
+  entry->hash = hash;
+  entry->key = key;
+  entry->value = data;
+  indexInsert(map, map->size++);
+  return 0;
+}
+
+void *hashMapGet(HashMap const *map, char const *key) {
+  size_t idx = find(map, key, keyHash(key, false), false);
+  return idx == map->size ? NULL : map->entries[idx].value;
+}
+
+int hashMapPut(HashMap *map, char const *key, void *data) {
+  return insert(map, key, data, false, false);
 }
 
 void hashMapSet(HashMap *map, char const *key, void *data) {
-  uint64_t hash = djb2xor(key) % map->capacity;
-
-  if (map->keys[hash] == NULL) {
-    map->keys[hash] = key;
-    map->values[hash] = data;
-    ++map->size;
-    return;                                        // empty spot
-  } else if (strcmp(map->keys[hash], key) != 0) {  // collision
-    uint64_t hash2 = djb2add(key) + 1;
-    for (size_t idx = (hash + hash2) % map->capacity; idx != hash;
-         idx = (idx + hash2) % map->capacity) {
-      if (map->keys[idx] == NULL) {  // empty spot
-        map->keys[idx] = key;
-        map->values[idx] = data;
-        ++map->size;
-        return;
-      } else if (strcmp(map->keys[idx], key) == 0) {  // already in there
-        map->values[idx] = data;
-        return;
-      }
-    }
-    size_t oldCap = map->capacity;  // unavoidable collision
-    char const **oldKeys = map->keys;
-    void **oldValues = map->values;
-    map->capacity *= 2;
-    map->keys = calloc(map->capacity, sizeof(char const *));
-    map->values = malloc(map->capacity * sizeof(void *));  // resize the map
-    map->size = 0;
-    for (size_t idx = 0; idx < oldCap; ++idx) {
-      if (oldKeys[idx] != NULL) {
-        hashMapSet(map, oldKeys[idx], oldValues[idx]);
-      }
-    }
-    free(oldKeys);
-    free(oldValues);
-    hashMapSet(map, key, data);  // recurse
-    return;
-  } else {  // already in there
-    map->values[hash] = data;
-    return;
+  insert(map, key, data, false, true);
+}
+
+void *hashMapGetId(HashMap const *map, char const *key) {
+  size_t idx = find(map, key, internedHash(key), true);
+  return idx == map->size ? NULL : map->entries[idx].value;
+}
+
+int hashMapPutId(HashMap *map, char const *key, void *data) {
+  return insert(map, key, data, true, false);
+}
+
+void *hashMapRemove(HashMap *map, char const *key) {
+  uint64_t hash = keyHash(key, false);
+  size_t entry = find(map, key, hash, false);
+  if (entry == map->size) return NULL;
+  void *value = map->entries[entry].value;
+
+  // find the entry's slot, then shift the rest of its cluster back into it
+  size_t mask = map->capacity - 1;
+  size_t idx = hash & mask;
+  while (map->slots[idx].entry != entry + 1) idx = (idx + 1) & mask;
+  for (size_t next = (idx + 1) & mask;
+       map->slots[next].entry != 0 &&
+       ((next - map->slots[next].hash) & mask) != 0;
+       idx = next, next = (next + 1) & mask)
+    map->slots[idx] = map->slots[next];
+  map->slots[idx].hash = 0;
+  map->slots[idx].entry = 0;
+
+  // close the gap in the entries, and renumber the slots after it
+  memmove(&map->entries[entry], &map->entries[entry + 1],
+          (map->size - entry - 1) * sizeof(HashMapEntry));
+  --map->size;
+  for (size_t slot = 0; slot < map->capacity; ++slot) {
+    if (map->slots[slot].entry > entry + 1) --map->slots[slot].entry;
   }
+
+  return value;
 }
 
 void hashMapUninit(HashMap *map, void (*dtor)(void *)) {
-  for (size_t idx = 0; idx < map->capacity; ++idx) {
-    if (map->keys[idx] != NULL) {
-      dtor(map->values[idx]);
-    }
-  }
-  free(map->keys);
-  free(map->values);
+  for (size_t idx = 0; idx < map->size; ++idx) dtor(map->entries[idx].value);
+  free(map->entries);
+  free(map->slots);
 }
\ No newline at end of file
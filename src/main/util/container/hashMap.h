@@ -19,20 +19,41 @@
 
 /**
  * @file
- * A java-style generic hash map between char const *keys and void *values
+ * A generic hash map between char const *keys and void *values
  */
 
 #ifndef TLC_UTIL_CONTAINER_HASHMAP_H_
 #define TLC_UTIL_CONTAINER_HASHMAP_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
-/** A hash table between a string (not owned) and a value pointer */
+/** a key and its value */
+typedef struct {
+  uint64_t hash;   /**< cached hash of the key */
+  char const *key; /**< key, not owned */
+  void *value;
+} HashMapEntry;
+
+/** a slot in the index of a HashMap */
+typedef struct {
+  uint32_t hash;  /**< low bits of the hash of the entry's key */
+  uint32_t entry; /**< one plus the index of the entry, zero if empty */
+} HashMapSlot;
+
+/**
+ * A hash table between a string (not owned) and a value pointer
+ *
+ * Entries are kept in insertion order, and are found through an open addressed
+ * index, using Robin Hood linear probing with backward shift deletion, that is
+ * kept at most seven eighths full. Nothing is allocated until the first
+ * insertion
+ */
 typedef struct {
   size_t size;
-  size_t capacity;
-  char const **keys;
-  void **values;
+  size_t capacity;       /**< number of slots, zero or a power of two */
+  HashMapEntry *entries; /**< entries, in insertion order */
+  HashMapSlot *slots;    /**< index of the entries */
 } HashMap;
 
 /**
@@ -77,6 +98,36 @@ int hashMapPut(HashMap *map, char const *key, void *value);
  */
 void hashMapSet(HashMap *map, char const *key, void *value);
 
+/**
+ * hashMapGet for maps whose keys are all interned - keys are compared by
+ * pointer, and their hashes aren't recomputed
+ *
+ * @param map map to search in
+ * @param key interned key to search for
+ */
+void *hashMapGetId(HashMap const *map, char const *key);
+
+/**
+ * hashMapPut for maps whose keys are all interned - keys are compared by
+ * pointer, and their hashes aren't recomputed
+ *
+ * @param map map to insert into
+ * @param key interned key to insert
+ * @param value value to insert
+ * @returns 0 if inserertion is successful, -1 if the key exists
+ */
+int hashMapPutId(HashMap *map, char const *key, void *value);
+
+/**
+ * Removes a key from the table. Linear time operation, since the remaining
+ * entries are kept in insertion order
+ *
+ * @param map map to remove from
+ * @param key key to remove
+ * @returns value the key had, or NULL if the key is not in the table
+ */
+void *hashMapRemove(HashMap *map, char const *key);
+
 /**
  * deinitialize map in-place
  *
@@ -19,73 +19,19 @@
 
 #include "util/container/hashSet.h"
 
-#include <stdlib.h>
-#include <string.h>
+#include "util/functional.h"
 
-#include "optimization.h"
-#include "util/hash.h"
+/** value of every string in a set - never NULL, so it can't look missing */
+static char present;
 
-void hashSetInit(HashSet *set) {
-  set->size = 0;
-  set->capacity = PTR_VECTOR_INIT_CAPACITY;
-  set->elements = calloc(set->capacity, sizeof(char const *));
-}
+void hashSetInit(HashSet *set) { hashMapInit(&set->map); }
 
 bool hashSetContains(HashSet const *set, char const *s) {
-  uint64_t hash = djb2xor(s);
-  hash %= set->capacity;
-
-  if (set->elements[hash] == NULL) {
-    return false;                                    // not found
-  } else if (strcmp(set->elements[hash], s) != 0) {  // collision
-    uint64_t hash2 = djb2add(s) + 1;
-    for (size_t idx = (hash + hash2) % set->capacity; idx != hash;
-         idx = (idx + hash2) % set->capacity) {
-      if (set->elements[idx] == NULL) {
-        return false;
-      } else if (strcmp(set->elements[idx], s) == 0) {  // found it!
-        return true;
-      }
-    }
-    return false;  // searched everywhere, couldn't find it
-  } else {         // found it
-    return true;
-  }
+  return hashMapGet(&set->map, s) != NULL;
 }
 
 int hashSetPut(HashSet *set, char const *s) {
-  uint64_t hash = djb2xor(s) % set->capacity;
-
-  if (set->elements[hash] == NULL) {
-    set->elements[hash] = s;
-    ++set->size;
-    return 0;                                        // empty spot
-  } else if (strcmp(set->elements[hash], s) != 0) {  // collision
-    uint64_t hash2 = djb2add(s) + 1;
-    for (size_t idx = (hash + hash2) % set->capacity; idx != hash;
-         idx = (idx + hash2) % set->capacity) {
-      if (set->elements[idx] == NULL) {  // empty spot
-        set->elements[idx] = s;
-        ++set->size;
-        return 0;
-      } else if (strcmp(set->elements[idx], s) == 0) {  // already in there
-        return -1;
-      }
-    }
-    size_t oldSize = set->capacity;  // unavoidable collision
-    char const **oldElements = set->elements;
-    set->capacity *= 2;
-    set->elements = calloc(set->capacity, sizeof(char const *));
-    set->elements = malloc(set->capacity * sizeof(void *));  // resize the set
-    set->size = 0;
-    for (size_t idx = 0; idx < oldSize; ++idx) {
-      if (oldElements[idx] != NULL) hashSetPut(set, oldElements[idx]);
-    }
-    free(oldElements);
-    return hashSetPut(set, s);  // recurse
-  } else {                      // already in there
-    return -1;
-  }
+  return hashMapPut(&set->map, s, &present);
 }
 
-void hashSetUninit(HashSet *set) { free(set->elements); }
\ No newline at end of file
+void hashSetUninit(HashSet *set) { hashMapUninit(&set->map, nullDtor); }
\ No newline at end of file
@@ -26,13 +26,12 @@
 #define TLC_UTIL_CONTAINER_HASHSET_H_
 
 #include <stdbool.h>
-#include <stddef.h>
+
+#include "util/container/hashMap.h"
 
 /** A set of strings, not owned by this */
 typedef struct {
-  size_t size;
-  size_t capacity;
-  char const **elements;
+  HashMap map; /**< map from each string in the set to a placeholder */
 } HashSet;
 
 /**
@@ -27,5 +27,7 @@ size_t const PTR_VECTOR_INIT_CAPACITY = 8;
 size_t const INT_VECTOR_INIT_CAPACITY = 8;
 // vectors of bytes start with 16 bytes allocated to reduce memory churn
 size_t const BYTE_VECTOR_INIT_CAPACITY = 16;
+// hash maps start with room for 7 entries, enough for most scopes
+size_t const HASH_MAP_INIT_CAPACITY = 8;
 // exponential growth factor for vectors
 size_t const VECTOR_GROWTH_FACTOR = 2;
\ No newline at end of file
@@ -33,6 +33,8 @@ extern size_t const PTR_VECTOR_INIT_CAPACITY;
 extern size_t const INT_VECTOR_INIT_CAPACITY;
 /** starting capacity of a vector of bytes */
 extern size_t const BYTE_VECTOR_INIT_CAPACITY;
+/** starting number of slots in a hash map, must be a power of two */
+extern size_t const HASH_MAP_INIT_CAPACITY;
 /** growth factor of a vector */
 extern size_t const VECTOR_GROWTH_FACTOR;
 
@@ -27,6 +27,7 @@
 #include "util/container/bigInteger.h"
 #include "util/container/digitChain.h"
 #include "util/format.h"
+#include "util/powersOfTen.h"
 
 uint8_t charToU8(char c) {
   union {
@@ -269,10 +270,192 @@ int hexadecimalToInteger(char *string, int8_t *sign, uint64_t *magnitudeOut) {
   return 0;
 }
 
+/** most decimal digits that always fit in a uint64_t */
+#define MAX_FAST_DIGITS 19
+
+/**
+ * multiplies two 64 bit numbers, producing a 128 bit product
+ *
+ * @param a first factor
+ * @param b second factor
+ * @param hi output pointer to the high half of the product
+ * @param lo output pointer to the low half of the product
+ */
+static void multiply128(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+  uint64_t aLo = a & 0xffffffff;
+  uint64_t aHi = a >> 32;
+  uint64_t bLo = b & 0xffffffff;
+  uint64_t bHi = b >> 32;
+
+  uint64_t lowLow = aLo * bLo;
+  uint64_t lowHigh = aLo * bHi;
+  uint64_t highLow = aHi * bLo;
+  uint64_t highHigh = aHi * bHi;
+
+  uint64_t middle =
+      (lowLow >> 32) + (lowHigh & 0xffffffff) + (highLow & 0xffffffff);
+  *lo = (middle << 32) | (lowLow & 0xffffffff);
+  *hi = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+}
+
+/** powers of ten that fit in a uint64_t */
+static uint64_t const SMALL_POWERS_OF_TEN[] = {
+    1U,
+    10U,
+    100U,
+    1000U,
+    10000U,
+    100000U,
+    1000000U,
+    10000000U,
+    100000000U,
+    1000000000U,
+    10000000000U,
+    100000000000U,
+    1000000000000U,
+    10000000000000U,
+    100000000000000U,
+    1000000000000000U,
+    10000000000000000U,
+    100000000000000000U,
+    1000000000000000000U,
+    10000000000000000000U,
+};
+
+/**
+ * converts digits * 10^exponent10 to a float with a single, correctly rounded
+ * operation (Clinger's fast path)
+ *
+ * only possible if digits and 10^|exponent10| are exactly representable as
+ * floats
+ *
+ * @param digits decimal significand
+ * @param exponent10 decimal exponent
+ * @param bitsOut output pointer to the bits of the result
+ * @returns whether the result was found
+ */
+static bool exactFloat(uint64_t digits, int64_t exponent10, uint64_t *bitsOut) {
+  if (digits > (uint64_t)1 << 24 || exponent10 < -10 || exponent10 > 10)
+    return false;
+
+  float value = (float)digits;
+  float power = (float)SMALL_POWERS_OF_TEN[exponent10 < 0 ? -exponent10
+                                                          : exponent10];
+  value = exponent10 < 0 ? value / power : value * power;
+  *bitsOut = floatToBits(value);
+  return true;
+}
+
+/**
+ * converts digits * 10^exponent10 to a double with a single, correctly
+ * rounded operation (Clinger's fast path)
+ *
+ * only possible if digits and 10^|exponent10| are exactly representable as
+ * doubles
+ *
+ * @param digits decimal significand
+ * @param exponent10 decimal exponent
+ * @param bitsOut output pointer to the bits of the result
+ * @returns whether the result was found
+ */
+static bool exactDouble(uint64_t digits, int64_t exponent10,
+                        uint64_t *bitsOut) {
+  if (digits > (uint64_t)1 << 53 || exponent10 < -22 || exponent10 > 22)
+    return false;
+
+  size_t magnitude = (size_t)(exponent10 < 0 ? -exponent10 : exponent10);
+  double value = (double)digits;
+  // 10^19 through 10^22 don't fit in 64 bits, but are exact doubles
+  double power =
+      magnitude < MAX_FAST_DIGITS
+          ? (double)SMALL_POWERS_OF_TEN[magnitude]
+          : (double)SMALL_POWERS_OF_TEN[MAX_FAST_DIGITS] *
+                (double)SMALL_POWERS_OF_TEN[magnitude - MAX_FAST_DIGITS];
+  value = exponent10 < 0 ? value / power : value * power;
+  *bitsOut = doubleToBits(value);
+  return true;
+}
+
+/**
+ * converts digits * 10^exponent10 to a float or double with the Eisel-Lemire
+ * algorithm
+ *
+ * gives up on results that can't be decided from a 128 bit product, as well
+ * as on subnormals and infinities
+ *
+ * @param digits decimal significand - must be non-zero
+ * @param exponent10 decimal exponent
+ * @param mantissaBits number of explicit mantissa bits in the format
+ * @param maxExponent exponent bias of the format
+ * @param mantissaMask mask of the explicit mantissa bits
+ * @param bitsOut output pointer to the (unsigned) bits of the result
+ * @returns whether the result was found
+ */
+static bool eiselLemire(uint64_t digits, int64_t exponent10,
+                        size_t mantissaBits, int64_t maxExponent,
+                        uint64_t mantissaMask, uint64_t *bitsOut) {
+  if (exponent10 < POWERS_OF_TEN_MIN_EXPONENT ||
+      exponent10 > POWERS_OF_TEN_MAX_EXPONENT)
+    return false;
+  uint64_t const *power =
+      POWERS_OF_TEN[exponent10 - POWERS_OF_TEN_MIN_EXPONENT];
+
+  // normalize
+  int leadingZeros = __builtin_clzll(digits);
+  digits <<= leadingZeros;
+  // 217706 / 2^16 approximates log2(10)
+  int64_t exponent =
+      ((217706 * exponent10) >> 16) + 64 + maxExponent - leadingZeros;
+
+  // the product keeps mantissaBits + 3 bits, the rest only matters for
+  // rounding
+  size_t shift = 64 - mantissaBits - 3;
+  uint64_t lowMask = ((uint64_t)1 << shift) - 1;
+
+  uint64_t hi;
+  uint64_t lo;
+  multiply128(digits, power[0], &hi, &lo);
+  if ((hi & lowMask) == lowMask && lo + digits < digits) {
+    // truncating the power of ten may have affected the kept bits - widen
+    uint64_t nextHi;
+    uint64_t nextLo;
+    multiply128(digits, power[1], &nextHi, &nextLo);
+    uint64_t mergedHi = hi;
+    uint64_t mergedLo = lo + nextHi;
+    if (mergedLo < lo) ++mergedHi;
+    if ((mergedHi & lowMask) == lowMask && mergedLo + 1 == 0 &&
+        nextLo + digits < digits)
+      return false;
+    hi = mergedHi;
+    lo = mergedLo;
+  }
+
+  uint64_t top = hi >> 63;
+  uint64_t mantissa = hi >> (top + shift);
+  exponent -= (int64_t)(1 ^ top);
+
+  // can't tell if this is exactly halfway between two floats
+  if (lo == 0 && (hi & lowMask) == 0 && (mantissa & 3) == 1) return false;
+
+  // round to even
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >> (mantissaBits + 1) != 0) {
+    mantissa >>= 1;
+    ++exponent;
+  }
+
+  if (exponent <= 0 || exponent >= 2 * maxExponent + 1) return false;
+
+  *bitsOut = ((uint64_t)exponent << mantissaBits) | (mantissa & mantissaMask);
+  return true;
+}
+
 static uint64_t floatOrDoubleStringToBits(
     char const *string, size_t mantissaBits, int64_t maxExponent,
     int64_t minNormalExponent, int64_t minSubnormalExponent, uint64_t signMask,
-    uint64_t plusInfinity, uint64_t minusInfinity, uint64_t mantissaMask) {
+    uint64_t plusInfinity, uint64_t minusInfinity, uint64_t mantissaMask,
+    bool (*exact)(uint64_t, int64_t, uint64_t *)) {
   int8_t sign;
   // check sign
   switch (string[0]) {
@@ -306,6 +489,49 @@ static uint64_t floatOrDoubleStringToBits(
   }
   if (isZero) return sign == -1 ? signMask : 0x0;
 
+  // try the fast paths - these need the first MAX_FAST_DIGITS significant
+  // digits, and whether any digits were dropped after those
+  uint64_t digits = 0;
+  size_t digitCount = 0;
+  int64_t exponent10 = 0;
+  bool fraction = false;
+  bool truncated = false;
+  for (char const *scan = string; *scan != '\0'; ++scan) {
+    if (*scan == '.') {
+      fraction = true;
+      continue;
+    }
+
+    uint8_t digit = (uint8_t)(charToU8(*scan) - charToU8('0'));
+    if (digitCount < MAX_FAST_DIGITS) {
+      if (digits != 0 || digit != 0) {
+        digits = digits * 10 + digit;
+        ++digitCount;
+      }
+      if (fraction) --exponent10;
+    } else {
+      if (digit != 0) truncated = true;
+      if (!fraction) ++exponent10;
+    }
+  }
+
+  uint64_t fastBits;
+  if (!truncated && exact(digits, exponent10, &fastBits))
+    return (sign == -1 ? signMask : 0x0) | fastBits;
+  if (eiselLemire(digits, exponent10, mantissaBits, maxExponent, mantissaMask,
+                  &fastBits)) {
+    // if digits were dropped, the true value lies between digits and digits
+    // + 1 - both must round to the same float
+    uint64_t upperBits;
+    if (!truncated ||
+        (eiselLemire(digits + 1, exponent10, mantissaBits, maxExponent,
+                     mantissaMask, &upperBits) &&
+         upperBits == fastBits))
+      return (sign == -1 ? signMask : 0x0) | fastBits;
+  }
+
+  // fall back to exact conversion
+
   // exponent
   int64_t exponent;
   // mantissa used to construct the number
@@ -451,14 +677,15 @@ uint32_t floatStringToBits(char const *string) {
   return (uint32_t)floatOrDoubleStringToBits(
       string, FLOAT_MANTISSA_BITS, FLOAT_EXPONENT_MAX, FLOAT_EXPONENT_MIN,
       FLOAT_EXPONENT_MIN_SUBNORMAL, FLOAT_SIGN_MASK, FLOAT_EXPONENT_MASK,
-      FLOAT_SIGN_MASK | FLOAT_EXPONENT_MASK, FLOAT_MANTISSA_MASK);
+      FLOAT_SIGN_MASK | FLOAT_EXPONENT_MASK, FLOAT_MANTISSA_MASK, exactFloat);
 }
 
 uint64_t doubleStringToBits(char const *string) {
   return floatOrDoubleStringToBits(
       string, DOUBLE_MANTISSA_BITS, DOUBLE_EXPONENT_MAX, DOUBLE_EXPONENT_MIN,
       DOUBLE_EXPONENT_MIN_SUBNORMAL, DOUBLE_SIGN_MASK, DOUBLE_EXPONENT_MASK,
-      DOUBLE_SIGN_MASK | DOUBLE_EXPONENT_MASK, DOUBLE_MANTISSA_MASK);
+      DOUBLE_SIGN_MASK | DOUBLE_EXPONENT_MASK, DOUBLE_MANTISSA_MASK,
+      exactDouble);
 }
 
 uint8_t s8ToU8(int8_t s) {
@@ -0,0 +1,61 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of diagnostic output
+
+#include "util/diagnostics.h"
+
+#include <stdlib.h>
+
+#include "util/internalError.h"
+
+/** stream this thread is capturing into, if any */
+static _Thread_local FILE *captureStream = NULL;
+
+FILE *diagnosticStream(void) {
+  return captureStream != NULL ? captureStream : stderr;
+}
+
+void diagnosticBufferBegin(DiagnosticBuffer *buffer) {
+  buffer->text = NULL;
+  buffer->length = 0;
+  buffer->stream = open_memstream(&buffer->text, &buffer->length);
+  if (buffer->stream == NULL)
+    error(__FILE__, __LINE__, "could not capture diagnostics");
+  captureStream = buffer->stream;
+}
+
+void diagnosticBufferEnd(DiagnosticBuffer *buffer) {
+  captureStream = NULL;
+  fclose(buffer->stream);
+  buffer->stream = NULL;
+}
+
+void diagnosticBufferFlush(DiagnosticBuffer *buffer) {
+  fwrite(buffer->text, sizeof(char), buffer->length, stderr);
+  free(buffer->text);
+  buffer->text = NULL;
+  buffer->length = 0;
+}
+
+void diagnosticBufferDiscard(DiagnosticBuffer *buffer) {
+  free(buffer->text);
+  buffer->text = NULL;
+  buffer->length = 0;
+}
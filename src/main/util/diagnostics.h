@@ -0,0 +1,74 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * source-level diagnostic output, with per-thread capture for parallel passes
+ */
+
+#ifndef TLC_UTIL_DIAGNOSTICS_H_
+#define TLC_UTIL_DIAGNOSTICS_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+/** diagnostics captured from one unit of parallel work */
+typedef struct {
+  FILE *stream; /**< stream being captured into, while capturing */
+  char *text;   /**< captured text, once capture has ended */
+  size_t length;
+} DiagnosticBuffer;
+
+/**
+ * gets the stream errors, warnings and notes about the input should be written
+ * to
+ *
+ * @returns this thread's capture stream if capturing, stderr otherwise
+ */
+FILE *diagnosticStream(void);
+
+/**
+ * starts capturing this thread's diagnostics
+ *
+ * @param buffer buffer to capture into
+ */
+void diagnosticBufferBegin(DiagnosticBuffer *buffer);
+
+/**
+ * stops capturing this thread's diagnostics
+ *
+ * @param buffer buffer being captured into
+ */
+void diagnosticBufferEnd(DiagnosticBuffer *buffer);
+
+/**
+ * writes captured diagnostics to stderr and releases them
+ *
+ * @param buffer buffer that has finished capturing
+ */
+void diagnosticBufferFlush(DiagnosticBuffer *buffer);
+
+/**
+ * releases captured diagnostics without writing them
+ *
+ * @param buffer buffer that has finished capturing
+ */
+void diagnosticBufferDiscard(DiagnosticBuffer *buffer);
+
+#endif  // TLC_UTIL_DIAGNOSTICS_H_
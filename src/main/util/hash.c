@@ -19,6 +19,8 @@
 
 #include "util/hash.h"
 
+#include <string.h>
+
 uint64_t djb2xor(char const *s) {
   uint64_t hash = 5381;
   for (; *s != '\0'; ++s) {
@@ -35,4 +37,43 @@ uint64_t djb2add(char const *s) {
     hash += (uint64_t)*s;
   }
   return hash;
-}
\ No newline at end of file
+}
+uint64_t fnv1a(void const *data, size_t length) {
+  return fnv1aExtend(0xcbf29ce484222325, data, length);
+}
+
+uint64_t fnv1aExtend(uint64_t hash, void const *data, size_t length) {
+  uint8_t const *bytes = data;
+  for (size_t idx = 0; idx < length; ++idx) {
+    hash ^= bytes[idx];
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+/**
+ * spreads every bit of a word over every bit of the result - the finalizer of
+ * MurmurHash3
+ */
+static uint64_t avalanche(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccd;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53;
+  hash ^= hash >> 33;
+  return hash;
+}
+uint64_t hashBytes(void const *data, size_t length) {
+  uint8_t const *bytes = data;
+  uint64_t hash = 0x9e3779b97f4a7c15 ^ length;
+  for (; length >= sizeof(uint64_t);
+       bytes += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(uint64_t));
+    hash = (hash ^ word) * 0x9fb21c651e98df25;
+    hash ^= hash >> 32;
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, bytes, length);
+  return avalanche(hash ^ tail);
+}
@@ -25,6 +25,7 @@
 #ifndef TLC_UTIL_HASH_H_
 #define TLC_UTIL_HASH_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -43,4 +44,34 @@ uint64_t djb2xor(char const *s);
  */
 uint64_t djb2add(char const *s);
 
+/**
+ * hash a block of bytes using 64 bit FNV-1a
+ *
+ * @param data bytes to hash
+ * @param length number of bytes
+ * @returns FNV-1a hash of the bytes
+ */
+uint64_t fnv1a(void const *data, size_t length);
+
+/**
+ * continue a 64 bit FNV-1a hash with more bytes - hashing a then b gives the
+ * same result as hashing them concatenated
+ *
+ * @param hash hash of the bytes so far
+ * @param data bytes to hash
+ * @param length number of bytes
+ * @returns FNV-1a hash of the bytes so far followed by data
+ */
+uint64_t fnv1aExtend(uint64_t hash, void const *data, size_t length);
+
+/**
+ * hash a block of bytes eight at a time, for hash tables - every bit of the
+ * result depends on every bit of the input
+ *
+ * @param data bytes to hash
+ * @param length number of bytes
+ * @returns hash of the bytes
+ */
+uint64_t hashBytes(void const *data, size_t length);
+
 #endif  // TLC_UTIL_HASH_H_
\ No newline at end of file
@@ -0,0 +1,180 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of identifier interning
+//
+// Interned strings are stored in arena chunks, each preceded by a header with
+// its hash. The hash is the one hashBytes computes, so a map keyed by interned
+// strings is laid out exactly as if it were keyed by plain copies of them. The
+// table is split into shards, each behind its own lock, so that files being
+// lexed concurrently rarely contend.
+
+#include "util/intern.h"
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/hash.h"
+
+/** an interned string */
+typedef struct {
+  uint64_t hash; /**< hashBytes of text */
+  size_t length;
+  char text[]; /**< null terminated characters */
+} InternedString;
+
+/** number of shards, must be a power of two */
+#define NUM_SHARDS 16
+/** size of an arena chunk */
+#define CHUNK_SIZE 65536
+/** initial number of slots in each shard's table */
+#define SHARD_INIT_CAPACITY 4096
+
+/** a slot in a shard's table */
+typedef struct {
+  uint64_t hash;          /**< copy of string->hash, avoids a dereference */
+  InternedString *string; /**< NULL if the slot is empty */
+} Slot;
+
+/** one independently locked part of the intern table */
+typedef struct {
+  pthread_mutex_t lock;
+  size_t size;
+  size_t capacity; /**< always a power of two */
+  Slot *slots;     /**< open addressed table with linear probing */
+  char *chunk;            /**< arena chunk currently being filled */
+  size_t chunkUsed;
+} Shard;
+
+static Shard shards[NUM_SHARDS];
+static pthread_once_t shardsOnce = PTHREAD_ONCE_INIT;
+
+/** number of entries in each thread's cache, must be a power of two */
+#define CACHE_SIZE 1024
+/**
+ * direct mapped cache of recently interned strings - identifiers repeat
+ * often, so most lookups are answered here without taking a lock. Interned
+ * strings are never freed, so entries never go stale
+ */
+static _Thread_local InternedString *cache[CACHE_SIZE];
+
+static void shardsInit(void) {
+  for (size_t idx = 0; idx < NUM_SHARDS; ++idx) {
+    Shard *shard = &shards[idx];
+    pthread_mutex_init(&shard->lock, NULL);
+    shard->size = 0;
+    shard->capacity = SHARD_INIT_CAPACITY;
+    shard->slots = calloc(shard->capacity, sizeof(Slot));
+    shard->chunk = NULL;
+    shard->chunkUsed = CHUNK_SIZE;
+  }
+}
+
+/**
+ * allocates space for a string in a shard's arena
+ */
+static InternedString *shardAllocate(Shard *shard, size_t length) {
+  size_t size = sizeof(InternedString) + length + 1;
+  size = (size + alignof(InternedString) - 1) & ~(alignof(InternedString) - 1);
+  if (size > CHUNK_SIZE / 4) {
+    // oversized strings get their own allocation
+    return malloc(size);
+  }
+  if (shard->chunkUsed + size > CHUNK_SIZE) {
+    // old chunk is abandoned, but its strings stay alive
+    shard->chunk = malloc(CHUNK_SIZE);
+    shard->chunkUsed = 0;
+  }
+  InternedString *string =
+      (InternedString *)(void *)(shard->chunk + shard->chunkUsed);
+  shard->chunkUsed += size;
+  return string;
+}
+
+/**
+ * doubles the capacity of a shard's table
+ */
+static void shardGrow(Shard *shard) {
+  size_t oldCapacity = shard->capacity;
+  Slot *oldSlots = shard->slots;
+  shard->capacity *= 2;
+  shard->slots = calloc(shard->capacity, sizeof(Slot));
+  for (size_t idx = 0; idx < oldCapacity; ++idx) {
+    if (oldSlots[idx].string != NULL) {
+      size_t slot = (size_t)(oldSlots[idx].hash >> 16);
+      while (shard->slots[slot & (shard->capacity - 1)].string != NULL) ++slot;
+      shard->slots[slot & (shard->capacity - 1)] = oldSlots[idx];
+    }
+  }
+  free(oldSlots);
+}
+
+char *intern(char const *text, size_t length) {
+  pthread_once(&shardsOnce, shardsInit);
+
+  // the top bits of the hash select the shard, and the middle bits the slot in
+  // the shard and in the cache
+  uint64_t hash = hashBytes(text, length);
+
+  InternedString **cached = &cache[(hash >> 32) & (CACHE_SIZE - 1)];
+  if (*cached != NULL && (*cached)->hash == hash &&
+      (*cached)->length == length &&
+      memcmp((*cached)->text, text, length) == 0)
+    return (*cached)->text;
+
+  Shard *shard = &shards[hash >> 60];
+
+  pthread_mutex_lock(&shard->lock);
+  Slot *slot;
+  for (size_t idx = (size_t)(hash >> 16);; ++idx) {
+    slot = &shard->slots[idx & (shard->capacity - 1)];
+    if (slot->string == NULL) break;
+    InternedString *candidate = slot->string;
+    if (slot->hash == hash && candidate->length == length &&
+        memcmp(candidate->text, text, length) == 0) {
+      pthread_mutex_unlock(&shard->lock);
+      *cached = candidate;
+      return candidate->text;
+    }
+  }
+
+  InternedString *string = shardAllocate(shard, length);
+  string->hash = hash;
+  string->length = length;
+  memcpy(string->text, text, length);
+  string->text[length] = '\0';
+  slot->hash = hash;
+  slot->string = string;
+  if (++shard->size * 2 > shard->capacity) shardGrow(shard);
+  pthread_mutex_unlock(&shard->lock);
+  *cached = string;
+  return string->text;
+}
+
+/**
+ * gets the header of an interned string
+ */
+static InternedString const *header(char const *interned) {
+  return (InternedString const *)(void const *)(interned -
+                                                offsetof(InternedString, text));
+}
+
+uint64_t internedHash(char const *interned) { return header(interned)->hash; }
@@ -0,0 +1,53 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * identifier interning
+ *
+ * Interned strings are canonical: two interned strings are equal if and only
+ * if they are the same pointer. They are never freed, and must not be
+ * modified.
+ */
+
+#ifndef TLC_UTIL_INTERN_H_
+#define TLC_UTIL_INTERN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * gets the canonical copy of a string, creating it if it doesn't exist yet.
+ * May be called concurrently
+ *
+ * @param text characters of the string, need not be null terminated
+ * @param length number of characters
+ * @returns null terminated interned string
+ */
+char *intern(char const *text, size_t length);
+
+/**
+ * gets the hash of an interned string without rehashing it
+ *
+ * @param interned interned string
+ * @returns hashBytes(interned, strlen(interned))
+ */
+uint64_t internedHash(char const *interned);
+
+#endif  // TLC_UTIL_INTERN_H_
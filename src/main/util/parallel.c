@@ -0,0 +1,198 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Implementation of fork-join parallelism
+
+#include "util/parallel.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** shared state for one parallelFor call */
+typedef struct {
+  atomic_size_t next; /**< next index to hand out */
+  size_t count;
+  void (*body)(size_t, void *);
+  void *context;
+} ParallelForState;
+
+/**
+ * repeatedly claims and runs the next unclaimed index until none are left
+ *
+ * @param rawState ParallelForState to work on
+ * @returns NULL
+ */
+static void *parallelForWorker(void *rawState) {
+  ParallelForState *state = rawState;
+  for (size_t idx = atomic_fetch_add(&state->next, 1); idx < state->count;
+       idx = atomic_fetch_add(&state->next, 1))
+    state->body(idx, state->context);
+  return NULL;
+}
+
+void parallelFor(size_t numThreads, size_t count,
+                 void (*body)(size_t, void *), void *context) {
+  if (numThreads <= 1 || count <= 1) {
+    for (size_t idx = 0; idx < count; ++idx) body(idx, context);
+    return;
+  }
+
+  ParallelForState state;
+  atomic_init(&state.next, 0);
+  state.count = count;
+  state.body = body;
+  state.context = context;
+
+  // the calling thread is one of the workers
+  size_t numWorkers = (numThreads < count ? numThreads : count) - 1;
+  pthread_t *workers = malloc(sizeof(pthread_t) * numWorkers);
+  size_t numStarted = 0;
+  while (numStarted < numWorkers &&
+         pthread_create(&workers[numStarted], NULL, parallelForWorker,
+                        &state) == 0)
+    ++numStarted;
+
+  parallelForWorker(&state);
+
+  for (size_t idx = 0; idx < numStarted; ++idx)
+    pthread_join(workers[idx], NULL);
+  free(workers);
+}
+
+/** shared state for one parallelForDag call */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t changed; /**< signalled when an index becomes ready, or when
+                               the last index is claimed */
+  size_t *dependentStarts; /**< inverse of the prerequisite lists */
+  size_t *dependents;
+  size_t *waitingOn; /**< number of unfinished prerequisites of each index */
+  size_t *ready;     /**< queue of indices ready to run */
+  size_t readyHead;  /**< next index in ready to hand out */
+  size_t readyTail;  /**< end of the queue */
+  size_t count;
+  void (*body)(size_t, void *);
+  void *context;
+} ParallelForDagState;
+
+/**
+ * repeatedly claims and runs the next ready index, releasing its dependents,
+ * until all indices are claimed
+ *
+ * @param rawState ParallelForDagState to work on
+ * @returns NULL
+ */
+static void *parallelForDagWorker(void *rawState) {
+  ParallelForDagState *state = rawState;
+  pthread_mutex_lock(&state->lock);
+  while (true) {
+    while (state->readyHead == state->readyTail &&
+           state->readyHead < state->count)
+      pthread_cond_wait(&state->changed, &state->lock);
+    if (state->readyHead == state->count) break;
+
+    size_t idx = state->ready[state->readyHead++];
+    if (state->readyHead == state->count)
+      pthread_cond_broadcast(&state->changed);
+    pthread_mutex_unlock(&state->lock);
+
+    state->body(idx, state->context);
+
+    pthread_mutex_lock(&state->lock);
+    for (size_t edge = state->dependentStarts[idx];
+         edge < state->dependentStarts[idx + 1]; ++edge) {
+      size_t dependent = state->dependents[edge];
+      if (--state->waitingOn[dependent] == 0) {
+        state->ready[state->readyTail++] = dependent;
+        pthread_cond_signal(&state->changed);
+      }
+    }
+  }
+  pthread_mutex_unlock(&state->lock);
+  return NULL;
+}
+
+void parallelForDag(size_t numThreads, size_t count,
+                    size_t const *prerequisiteStarts,
+                    size_t const *prerequisites, void (*body)(size_t, void *),
+                    void *context) {
+  // prerequisites come first, so increasing order is always a valid order
+  if (numThreads <= 1 || count <= 1) {
+    for (size_t idx = 0; idx < count; ++idx) body(idx, context);
+    return;
+  }
+
+  ParallelForDagState state;
+  pthread_mutex_init(&state.lock, NULL);
+  pthread_cond_init(&state.changed, NULL);
+  state.count = count;
+  state.body = body;
+  state.context = context;
+
+  // invert the prerequisite lists
+  size_t numEdges = prerequisiteStarts[count];
+  state.dependentStarts = calloc(count + 1, sizeof(size_t));
+  state.dependents = malloc(sizeof(size_t) * numEdges);
+  state.waitingOn = malloc(sizeof(size_t) * count);
+  for (size_t edge = 0; edge < numEdges; ++edge)
+    ++state.dependentStarts[prerequisites[edge] + 1];
+  for (size_t idx = 0; idx < count; ++idx) {
+    state.dependentStarts[idx + 1] += state.dependentStarts[idx];
+    state.waitingOn[idx] = prerequisiteStarts[idx + 1] - prerequisiteStarts[idx];
+  }
+  size_t *fill = malloc(sizeof(size_t) * count);
+  memcpy(fill, state.dependentStarts, sizeof(size_t) * count);
+  for (size_t idx = 0; idx < count; ++idx) {
+    for (size_t edge = prerequisiteStarts[idx];
+         edge < prerequisiteStarts[idx + 1]; ++edge)
+      state.dependents[fill[prerequisites[edge]]++] = idx;
+  }
+  free(fill);
+
+  state.ready = malloc(sizeof(size_t) * count);
+  state.readyHead = state.readyTail = 0;
+  for (size_t idx = 0; idx < count; ++idx) {
+    if (state.waitingOn[idx] == 0) state.ready[state.readyTail++] = idx;
+  }
+
+  // the calling thread is one of the workers
+  size_t numWorkers = (numThreads < count ? numThreads : count) - 1;
+  pthread_t *workers = malloc(sizeof(pthread_t) * numWorkers);
+  size_t numStarted = 0;
+  while (numStarted < numWorkers &&
+         pthread_create(&workers[numStarted], NULL, parallelForDagWorker,
+                        &state) == 0)
+    ++numStarted;
+
+  parallelForDagWorker(&state);
+
+  for (size_t idx = 0; idx < numStarted; ++idx)
+    pthread_join(workers[idx], NULL);
+  free(workers);
+
+  free(state.ready);
+  free(state.waitingOn);
+  free(state.dependents);
+  free(state.dependentStarts);
+  pthread_cond_destroy(&state.changed);
+  pthread_mutex_destroy(&state.lock);
+}
@@ -0,0 +1,72 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * fork-join parallelism over independent work items
+ */
+
+#ifndef TLC_UTIL_PARALLEL_H_
+#define TLC_UTIL_PARALLEL_H_
+
+#include <stddef.h>
+
+/**
+ * calls body once for each index in [0, count), spread over up to numThreads
+ * threads (including the calling thread), returning once all calls are done
+ *
+ * indices are handed out in increasing order, but may complete in any order,
+ * so body must only touch state belonging to its own index (or synchronize
+ * itself). If numThreads is at most one, or if threads can't be created, the
+ * remaining calls are made serially, in order, on the calling thread.
+ *
+ * @param numThreads maximum number of threads to use
+ * @param count number of work items
+ * @param body function to call with the work item index and context
+ * @param context extra data to pass to body
+ */
+void parallelFor(size_t numThreads, size_t count,
+                 void (*body)(size_t, void *), void *context);
+
+/**
+ * calls body once for each index in [0, count), like parallelFor, but doesn't
+ * start the call for an index until the calls for all of its prerequisites have
+ * returned
+ *
+ * the prerequisites of index idx are prerequisites[prerequisiteStarts[idx]]
+ * up to (but not including) prerequisites[prerequisiteStarts[idx + 1]], and
+ * must all be smaller than idx. Calls whose prerequisites are done are made in
+ * the order they became ready. If numThreads is at most one, or if threads
+ * can't be created, the remaining calls are made serially, in order, on the
+ * calling thread.
+ *
+ * @param numThreads maximum number of threads to use
+ * @param count number of work items
+ * @param prerequisiteStarts where each index's prerequisites start, with one
+ * extra element marking the end of the last index's prerequisites
+ * @param prerequisites prerequisites of all indices
+ * @param body function to call with the work item index and context
+ * @param context extra data to pass to body
+ */
+void parallelForDag(size_t numThreads, size_t count,
+                    size_t const *prerequisiteStarts,
+                    size_t const *prerequisites, void (*body)(size_t, void *),
+                    void *context);
+
+#endif  // TLC_UTIL_PARALLEL_H_
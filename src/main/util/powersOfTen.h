@@ -0,0 +1,43 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * 128-bit approximations of powers of ten, for fast float parsing
+ */
+
+#ifndef TLC_UTIL_POWERSOFTEN_H_
+#define TLC_UTIL_POWERSOFTEN_H_
+
+#include <stdint.h>
+
+/** smallest power of ten in POWERS_OF_TEN */
+extern int64_t const POWERS_OF_TEN_MIN_EXPONENT;
+/** largest power of ten in POWERS_OF_TEN */
+extern int64_t const POWERS_OF_TEN_MAX_EXPONENT;
+
+/**
+ * normalized significands of powers of ten, rounded down to 128 bits
+ *
+ * row i holds the high and low halves of 10^(i + POWERS_OF_TEN_MIN_EXPONENT),
+ * shifted so the most significant bit is set
+ */
+extern uint64_t const POWERS_OF_TEN[][2];
+
+#endif  // TLC_UTIL_POWERSOFTEN_H_
@@ -0,0 +1,105 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// implementation of serialization helpers
+
+#include "util/serialize.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util/container/stringBuilder.h"
+#include "util/format.h"
+
+void serializeNumber(FILE *out, uint64_t value) {
+  while (value >= 0x80) {
+    fputc((int)((value & 0x7f) | 0x80), out);
+    value >>= 7;
+  }
+  fputc((int)value, out);
+}
+
+void serializeString(FILE *out, char const *s) {
+  fputs(s, out);
+  fputc('\0', out);
+}
+
+uint64_t deserializeNumber(FILE *in, bool *errored) {
+  uint64_t value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    int byte = getc(in);
+    if (byte == EOF) break;
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return value;
+  }
+  *errored = true;
+  return 0;
+}
+
+char *deserializeString(FILE *in, bool *errored) {
+  StringBuilder sb;
+  stringBuilderInit(&sb);
+  for (int c = getc(in); c != '\0'; c = getc(in)) {
+    if (c == EOF) {
+      stringBuilderUninit(&sb);
+      *errored = true;
+      return NULL;
+    }
+    stringBuilderPush(&sb, (char)c);
+  }
+  char *s = stringBuilderData(&sb);
+  stringBuilderUninit(&sb);
+  return s;
+}
+
+int atomicFileOpen(AtomicFile *file, char const *filename) {
+  file->filename = strdup(filename);
+  file->tempFilename = format("%s.XXXXXX", filename);
+  int fd = mkstemp(file->tempFilename);
+  if (fd == -1) {
+    free(file->filename);
+    free(file->tempFilename);
+    return -1;
+  }
+  fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  file->stream = fdopen(fd, "wb");
+  if (file->stream == NULL) {
+    close(fd);
+    remove(file->tempFilename);
+    free(file->filename);
+    free(file->tempFilename);
+    return -1;
+  }
+  return 0;
+}
+
+int atomicFileClose(AtomicFile *file, bool keep) {
+  keep = ferror(file->stream) == 0 && keep;
+  keep = fclose(file->stream) == 0 && keep;
+  int retval = -1;
+  if (keep && rename(file->tempFilename, file->filename) == 0)
+    retval = 0;
+  else
+    remove(file->tempFilename);
+  free(file->filename);
+  free(file->tempFilename);
+  return retval;
+}
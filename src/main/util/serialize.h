@@ -0,0 +1,93 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * binary serialization helpers for on-disk caches
+ *
+ * Numbers are written as unsigned LEB128, and strings are NUL-terminated
+ */
+
+#ifndef TLC_UTIL_SERIALIZE_H_
+#define TLC_UTIL_SERIALIZE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * writes an unsigned number
+ *
+ * @param out stream to write to
+ * @param value number to write
+ */
+void serializeNumber(FILE *out, uint64_t value);
+
+/**
+ * writes a string, including its terminator
+ *
+ * @param out stream to write to
+ * @param s string to write
+ */
+void serializeString(FILE *out, char const *s);
+
+/**
+ * reads an unsigned number
+ *
+ * @param in stream to read from
+ * @param errored set to true if the number couldn't be read
+ * @returns number read, or zero if it couldn't be read
+ */
+uint64_t deserializeNumber(FILE *in, bool *errored);
+
+/**
+ * reads a string
+ *
+ * @param in stream to read from
+ * @param errored set to true if the string couldn't be read
+ * @returns string read (owning), or NULL if it couldn't be read
+ */
+char *deserializeString(FILE *in, bool *errored);
+
+/** a file that only replaces its destination once it's completely written */
+typedef struct {
+  FILE *stream;       /**< stream to write to */
+  char *filename;     /**< destination */
+  char *tempFilename; /**< where the stream is actually being written */
+} AtomicFile;
+
+/**
+ * starts writing a file
+ *
+ * @param file file to initialize
+ * @param filename destination to eventually replace
+ * @returns status code (0 = OK)
+ */
+int atomicFileOpen(AtomicFile *file, char const *filename);
+
+/**
+ * finishes writing a file, replacing the destination if all writes succeeded
+ *
+ * @param file file to finish
+ * @param keep should the destination be replaced, or the file abandoned
+ * @returns status code (0 = destination replaced)
+ */
+int atomicFileClose(AtomicFile *file, bool keep);
+
+#endif  // TLC_UTIL_SERIALIZE_H_
@@ -0,0 +1,162 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * float literal conversion benchmark
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "benchmarks.h"
+#include "engine.h"
+#include "util/conversions.h"
+#include "util/format.h"
+#include "util/random.h"
+
+/** number of literals in each corpus */
+#define CORPUS_LITERALS 1000000
+/** number of times each corpus is converted */
+#define REPETITIONS 5
+
+/** kinds of generated literal */
+typedef enum {
+  LK_SHORT,      /**< a few digits, as typed by hand */
+  LK_ROUND_TRIP, /**< 17 significant digits, as printed by a generator */
+  LK_EXACT,      /**< the full decimal expansion of a float */
+} LiteralKind;
+
+/**
+ * computes a power of ten
+ *
+ * @param exponent power to raise ten to - must be at most 19
+ * @returns 10^exponent
+ */
+static uint64_t powerOfTen(size_t exponent) {
+  uint64_t power = 1;
+  for (size_t idx = 0; idx < exponent; ++idx) power *= 10;
+  return power;
+}
+
+/**
+ * generates a literal in the form the lexer produces
+ *
+ * @param kind kind of literal to generate
+ * @returns literal, to be freed by the caller
+ */
+static char *makeLiteral(LiteralKind kind) {
+  switch (kind) {
+    case LK_SHORT: {
+      int places = (int)(1 + intRand() % 6);
+      return format("%lu.%0*lu", longRand() % 100000, places,
+                    longRand() % powerOfTen((size_t)places));
+    }
+    case LK_ROUND_TRIP: {
+      // 17 significant digits, with the point somewhere around them
+      char *digits =
+          format("%lu", powerOfTen(16) + longRand() % (9 * powerOfTen(16)));
+      int wholeDigits = (int)(intRand() % 9) - 3;
+      char *literal;
+      if (wholeDigits > 0)
+        literal = format("%.*s.%s", wholeDigits, digits, digits + wholeDigits);
+      else
+        literal = format("0.%0*d%s", -wholeDigits, 0, digits);
+      free(digits);
+      return literal;
+    }
+    case LK_EXACT: {
+      float value = bitsToFloat(0x30000000 + intRand() % 0x18000000);
+      return format("%.46f", (double)value);
+    }
+    default: {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * reads the monotonic clock
+ *
+ * @returns time in nanoseconds
+ */
+static uint64_t now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+}
+
+/**
+ * converts a corpus several times and reports the best throughput
+ *
+ * @param name name of the corpus
+ * @param kind kind of literal the corpus is made of
+ */
+static void benchmarkCorpus(char const *name, LiteralKind kind) {
+  char **literals = malloc(CORPUS_LITERALS * sizeof(char *));
+  for (size_t idx = 0; idx < CORPUS_LITERALS; ++idx)
+    literals[idx] = makeLiteral(kind);
+
+  bool ok = true;
+  for (size_t idx = 0; idx < CORPUS_LITERALS; ++idx) {
+    char *end;
+    ok = ok &&
+         doubleStringToBits(literals[idx]) ==
+             doubleToBits(strtod(literals[idx], &end)) &&
+         floatStringToBits(literals[idx]) ==
+             floatToBits(strtof(literals[idx], &end));
+  }
+  testDynamic(format("%s literals convert like strtod", name), ok);
+
+  uint64_t bestDouble = UINT64_MAX;
+  uint64_t bestFloat = UINT64_MAX;
+  uint64_t checksum = 0;
+  for (size_t rep = 0; rep < REPETITIONS; ++rep) {
+    uint64_t start = now();
+    for (size_t idx = 0; idx < CORPUS_LITERALS; ++idx)
+      checksum += doubleStringToBits(literals[idx]);
+    uint64_t elapsed = now() - start;
+    if (elapsed < bestDouble) bestDouble = elapsed;
+
+    start = now();
+    for (size_t idx = 0; idx < CORPUS_LITERALS; ++idx)
+      checksum += floatStringToBits(literals[idx]);
+    elapsed = now() - start;
+    if (elapsed < bestFloat) bestFloat = elapsed;
+  }
+
+  printf("%-12s %10lu doubles/s %10lu floats/s (checksum %016lx)\n", name,
+         (uint64_t)CORPUS_LITERALS * 1000000000 / bestDouble,
+         (uint64_t)CORPUS_LITERALS * 1000000000 / bestFloat, checksum);
+
+  for (size_t idx = 0; idx < CORPUS_LITERALS; ++idx) free(literals[idx]);
+  free(literals);
+}
+
+void benchmarkConversions(void) {
+  srand(0);  // keep corpora repeatable
+
+  printf("corpus       throughput\n");
+  benchmarkCorpus("short", LK_SHORT);
+  benchmarkCorpus("round-trip", LK_ROUND_TRIP);
+  benchmarkCorpus("exact", LK_EXACT);
+}
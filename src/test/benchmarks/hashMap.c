@@ -0,0 +1,297 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * hash map benchmark, against the double hashed map it replaced
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "benchmarks.h"
+#include "engine.h"
+#include "util/container/hashMap.h"
+#include "util/format.h"
+#include "util/functional.h"
+#include "util/hash.h"
+#include "util/intern.h"
+
+/** number of times each measurement is repeated */
+#define REPETITIONS 5
+/** number of keys in each small map, about as many as a block scope holds */
+#define SMALL_MAP_KEYS 6
+
+/**
+ * the previous hash map - double hashing with djb2, growing only once a probe
+ * sequence has visited every slot
+ */
+typedef struct {
+  size_t size;
+  size_t capacity;
+  char const **keys;
+  void **values;
+} LegacyMap;
+
+static void legacyMapInit(LegacyMap *map) {
+  map->size = 0;
+  map->capacity = 8;
+  map->keys = calloc(map->capacity, sizeof(char const *));
+  map->values = malloc(map->capacity * sizeof(void *));
+}
+
+static size_t legacyMapFindSlot(LegacyMap const *map, char const *key) {
+  uint64_t hash = djb2xor(key) % map->capacity;
+  if (map->keys[hash] == NULL || strcmp(map->keys[hash], key) == 0)
+    return hash;
+
+  uint64_t hash2 = djb2add(key) + 1;
+  for (size_t idx = (hash + hash2) % map->capacity; idx != hash;
+       idx = (idx + hash2) % map->capacity) {
+    if (map->keys[idx] == NULL || strcmp(map->keys[idx], key) == 0) return idx;
+  }
+  return map->capacity;
+}
+
+static int legacyMapPut(LegacyMap *map, char const *key, void *value);
+
+static void legacyMapGrow(LegacyMap *map) {
+  size_t oldCapacity = map->capacity;
+  char const **oldKeys = map->keys;
+  void **oldValues = map->values;
+  map->capacity *= 2;
+  map->keys = calloc(map->capacity, sizeof(char const *));
+  map->values = malloc(map->capacity * sizeof(void *));
+  map->size = 0;
+  for (size_t idx = 0; idx < oldCapacity; ++idx) {
+    if (oldKeys[idx] != NULL) legacyMapPut(map, oldKeys[idx], oldValues[idx]);
+  }
+  free(oldKeys);
+  free(oldValues);
+}
+
+static int legacyMapPut(LegacyMap *map, char const *key, void *value) {
+  size_t idx = legacyMapFindSlot(map, key);
+  if (idx == map->capacity) {
+    legacyMapGrow(map);
+    return legacyMapPut(map, key, value);
+  } else if (map->keys[idx] == NULL) {
+    map->keys[idx] = key;
+    map->values[idx] = value;
+    ++map->size;
+    return 0;
+  } else {
+    return -1;
+  }
+}
+
+static void *legacyMapGet(LegacyMap const *map, char const *key) {
+  size_t idx = legacyMapFindSlot(map, key);
+  return idx == map->capacity || map->keys[idx] == NULL ? NULL
+                                                        : map->values[idx];
+}
+
+static void legacyMapUninit(LegacyMap *map) {
+  free(map->keys);
+  free(map->values);
+}
+
+/**
+ * reads the monotonic clock
+ *
+ * @returns time in nanoseconds
+ */
+static uint64_t now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+}
+
+/** the kinds of map measured */
+typedef enum {
+  MK_LEGACY,   /**< LegacyMap */
+  MK_STRING,   /**< HashMap, with hashMapPut and hashMapGet */
+  MK_INTERNED, /**< HashMap, with hashMapPutId and hashMapGetId */
+} MapKind;
+
+/** the keys a corpus is made of */
+typedef struct {
+  size_t numKeys;
+  char **keys;    /**< keys put into the maps, interned */
+  char **copies;  /**< copies of the keys, not interned */
+  char **missing; /**< keys not in the maps, interned */
+} Corpus;
+
+/**
+ * generates identifier-like keys, in the style of a source file's declarations
+ *
+ * @param corpus corpus to fill in
+ * @param numKeys number of keys
+ */
+static void corpusInit(Corpus *corpus, size_t numKeys) {
+  char const *const stems[] = {
+      "index", "count", "buffer", "node", "entry", "value", "result", "x",
+  };
+  size_t numStems = sizeof(stems) / sizeof(stems[0]);
+
+  corpus->numKeys = numKeys;
+  corpus->keys = malloc(numKeys * sizeof(char *));
+  corpus->copies = malloc(numKeys * sizeof(char *));
+  corpus->missing = malloc(numKeys * sizeof(char *));
+  for (size_t idx = 0; idx < numKeys; ++idx) {
+    char *key = format("%s%zu", stems[idx % numStems], idx / numStems);
+    corpus->keys[idx] = intern(key, strlen(key));
+    corpus->copies[idx] = key;
+    char *missing = format("%sMissing%zu", stems[idx % numStems], idx);
+    corpus->missing[idx] = intern(missing, strlen(missing));
+    free(missing);
+  }
+}
+
+static void corpusUninit(Corpus *corpus) {
+  for (size_t idx = 0; idx < corpus->numKeys; ++idx) free(corpus->copies[idx]);
+  free(corpus->keys);
+  free(corpus->copies);
+  free(corpus->missing);
+}
+
+/**
+ * fills maps of some number of keys each with the corpus, then looks up every
+ * key, and as many keys that aren't there
+ *
+ * @param corpus keys to use
+ * @param kind kind of map to use
+ * @param mapKeys number of keys in each map
+ * @param fillTime best time taken to fill the maps
+ * @param lookupTime best time taken to look up the keys
+ * @returns whether every lookup was correct
+ */
+static bool measure(Corpus const *corpus, MapKind kind, size_t mapKeys,
+                    uint64_t *fillTime, uint64_t *lookupTime) {
+  size_t numMaps = (corpus->numKeys + mapKeys - 1) / mapKeys;
+  LegacyMap *legacyMaps = malloc(numMaps * sizeof(LegacyMap));
+  HashMap *maps = malloc(numMaps * sizeof(HashMap));
+  bool ok = true;
+
+  *fillTime = UINT64_MAX;
+  *lookupTime = UINT64_MAX;
+  for (size_t rep = 0; rep < REPETITIONS; ++rep) {
+    uint64_t start = now();
+    for (size_t idx = 0; idx < corpus->numKeys; ++idx) {
+      size_t mapIdx = idx / mapKeys;
+      void *value = &corpus->keys[idx];
+      switch (kind) {
+        case MK_LEGACY: {
+          if (idx % mapKeys == 0) legacyMapInit(&legacyMaps[mapIdx]);
+          legacyMapPut(&legacyMaps[mapIdx], corpus->copies[idx], value);
+          break;
+        }
+        case MK_STRING: {
+          if (idx % mapKeys == 0) hashMapInit(&maps[mapIdx]);
+          hashMapPut(&maps[mapIdx], corpus->copies[idx], value);
+          break;
+        }
+        case MK_INTERNED: {
+          if (idx % mapKeys == 0) hashMapInit(&maps[mapIdx]);
+          hashMapPutId(&maps[mapIdx], corpus->keys[idx], value);
+          break;
+        }
+      }
+    }
+    uint64_t elapsed = now() - start;
+    if (elapsed < *fillTime) *fillTime = elapsed;
+
+    // lookups use the interned keys, so string keyed maps can't compare by
+    // pointer
+    start = now();
+    for (size_t idx = 0; idx < corpus->numKeys; ++idx) {
+      size_t mapIdx = idx / mapKeys;
+      void *found;
+      void *notFound;
+      switch (kind) {
+        case MK_LEGACY: {
+          found = legacyMapGet(&legacyMaps[mapIdx], corpus->keys[idx]);
+          notFound = legacyMapGet(&legacyMaps[mapIdx], corpus->missing[idx]);
+          break;
+        }
+        case MK_STRING: {
+          found = hashMapGet(&maps[mapIdx], corpus->keys[idx]);
+          notFound = hashMapGet(&maps[mapIdx], corpus->missing[idx]);
+          break;
+        }
+        default: {
+          found = hashMapGetId(&maps[mapIdx], corpus->keys[idx]);
+          notFound = hashMapGetId(&maps[mapIdx], corpus->missing[idx]);
+          break;
+        }
+      }
+      ok = ok && found == &corpus->keys[idx] && notFound == NULL;
+    }
+    elapsed = now() - start;
+    if (elapsed < *lookupTime) *lookupTime = elapsed;
+
+    for (size_t mapIdx = 0; mapIdx < numMaps; ++mapIdx) {
+      if (kind == MK_LEGACY)
+        legacyMapUninit(&legacyMaps[mapIdx]);
+      else
+        hashMapUninit(&maps[mapIdx], nullDtor);
+    }
+  }
+
+  free(legacyMaps);
+  free(maps);
+  return ok;
+}
+
+/**
+ * measures every kind of map on a corpus, and reports their throughput
+ *
+ * @param name name of the measurement
+ * @param corpus keys to use
+ * @param mapKeys number of keys in each map
+ */
+static void benchmarkCorpus(char const *name, Corpus const *corpus,
+                            size_t mapKeys) {
+  char const *const kindNames[] = {"legacy", "string", "interned"};
+  for (MapKind kind = MK_LEGACY; kind <= MK_INTERNED; ++kind) {
+    uint64_t fillTime;
+    uint64_t lookupTime;
+    bool ok = measure(corpus, kind, mapKeys, &fillTime, &lookupTime);
+    testDynamic(format("%s %s maps find every key", name, kindNames[kind]),
+                ok);
+    printf("%-8s %-8s %10lu puts/s %10lu gets/s\n", name, kindNames[kind],
+           (uint64_t)corpus->numKeys * 1000000000 / fillTime,
+           (uint64_t)corpus->numKeys * 2000000000 / lookupTime);
+  }
+}
+
+void benchmarkHashMap(void) {
+  Corpus corpus;
+  corpusInit(&corpus, 1 << 20);
+
+  printf("maps     kind     throughput\n");
+  benchmarkCorpus("small", &corpus, SMALL_MAP_KEYS);
+  benchmarkCorpus("large", &corpus, corpus.numKeys);
+
+  corpusUninit(&corpus);
+}
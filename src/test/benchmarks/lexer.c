@@ -0,0 +1,200 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * lexer throughput benchmark
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "benchmarks.h"
+#include "engine.h"
+#include "fileList.h"
+#include "lexer/lexer.h"
+#include "util/format.h"
+
+/** approximate size of each generated corpus, in bytes */
+#define CORPUS_SIZE (16 * 1024 * 1024)
+/** number of times each corpus is lexed */
+#define REPETITIONS 5
+
+/**
+ * generates a corpus by repeating a list of snippets in order
+ *
+ * @param snippets NULL-terminated list of snippets
+ * @returns path of a temporary file holding the corpus - caller must unlink
+ * and free it
+ */
+static char *makeCorpus(char const *const *snippets) {
+  char *filename = strdup("/tmp/tlc-benchmark-XXXXXX");
+  int fd = mkstemp(filename);
+  if (fd == -1) {
+    free(filename);
+    return NULL;
+  }
+  FILE *file = fdopen(fd, "w");
+
+  size_t written = 0;
+  while (written < CORPUS_SIZE) {
+    for (char const *const *snippet = snippets; *snippet != NULL; ++snippet) {
+      fputs(*snippet, file);
+      written += strlen(*snippet);
+    }
+  }
+
+  fclose(file);
+  return filename;
+}
+
+/**
+ * lexes a file to the end
+ *
+ * @param filename file to lex
+ * @param tokens number of tokens lexed
+ * @returns true if the file lexed without error
+ */
+static bool lexAll(char const *filename, size_t *tokens) {
+  FileListEntry entry;
+  entry.inputFilename = filename;
+  entry.isCode = true;
+  entry.errored = false;
+  entry.lineStarts = NULL;
+  if (lexerStateInit(&entry) != 0) return false;
+
+  *tokens = 0;
+  Token token;
+  for (lex(&entry, &token); token.type != TT_EOF; lex(&entry, &token)) {
+    ++*tokens;
+    tokenUninit(&token);
+  }
+
+  lexerStateUninit(&entry);
+  free(entry.lineStarts);
+  return !entry.errored;
+}
+
+/**
+ * reads the monotonic clock
+ *
+ * @returns time in nanoseconds
+ */
+static uint64_t now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+}
+
+/**
+ * lexes a corpus several times and reports the best throughput
+ *
+ * @param name name of the corpus
+ * @param snippets snippets the corpus is made of
+ */
+static void benchmarkCorpus(char const *name, char const *const *snippets) {
+  char *filename = makeCorpus(snippets);
+  if (filename == NULL) {
+    testDynamic(format("%s corpus created", name), false);
+    return;
+  }
+
+  bool ok = true;
+  size_t tokens = 0;
+  uint64_t best = UINT64_MAX;
+  for (size_t rep = 0; rep < REPETITIONS; ++rep) {
+    uint64_t start = now();
+    ok = lexAll(filename, &tokens) && ok;
+    uint64_t elapsed = now() - start;
+    if (elapsed < best) best = elapsed;
+  }
+  testDynamic(format("%s corpus lexes without errors", name), ok);
+
+  // throughput in tenths of a MiB per second
+  uint64_t throughput = (uint64_t)CORPUS_SIZE * 10000000000 / best / 1048576;
+  printf("%-12s %6lu.%lu MiB/s %10lu tokens/s\n", name, throughput / 10,
+         throughput % 10, (uint64_t)tokens * 1000000000 / best);
+
+  unlink(filename);
+  free(filename);
+}
+
+void benchmarkLexer(void) {
+  char const *const code[] = {
+      "module benchmark::code;\n",
+      "\n",
+      "import benchmark::support;\n",
+      "\n",
+      "// computes the sum of some numbers\n",
+      "int sumNumbers(int const *numbers, ulong count) {\n",
+      "  int accumulator = 0;\n",
+      "  for (ulong index = 0; index < count; ++index) {\n",
+      "    accumulator += numbers[index]; // running total\n",
+      "  }\n",
+      "  return accumulator;\n",
+      "}\n",
+      "\n",
+      "/* a struct describing a point, with some\n",
+      " * documentation attached */\n",
+      "struct Point {\n",
+      "\tdouble xCoordinate;\n",
+      "\tdouble yCoordinate;\n",
+      "};\n",
+      "\n",
+      NULL,
+  };
+  char const *const comments[] = {
+      "/**\n",
+      " * a long documentation comment, as might be found on a public\n",
+      " * declaration in a module's declaration file, explaining what the\n",
+      " * declaration is for and how it should be used\n",
+      " *\n",
+      " * @param value the value to operate on\n",
+      " * @returns the result of the operation\n",
+      " */\n",
+      "int operate(int value); // the operation itself, after its comments\n",
+      "\n",
+      NULL,
+  };
+  char const *const ids[] = {
+      "veryLongIdentifierNameThatGoesOnAndOn anotherIdentifier_underscored",
+      " shortId x y z camelCaseIdentifierNumber12345 SCREAMING_SNAKE_CASE",
+      "\n        indentedIdentifier                    spacedOutIdentifier\n",
+      NULL,
+  };
+
+  char const *const strings[] = {
+      "char const *data = \"an embedded data string, mostly plain text, with "
+      "the occasional\\tescape\\n and a hex \\x7f byte, running on for a "
+      "good while before it ends\";\n",
+      "wchar const *wide = \"wide strings are much the same, \\u0001F600 "
+      "apart from the odd code point\"w;\n",
+      NULL,
+  };
+
+  printf("corpus       throughput\n");
+  benchmarkCorpus("code", code);
+  benchmarkCorpus("comments", comments);
+  benchmarkCorpus("identifiers", ids);
+  benchmarkCorpus("strings", strings);
+}
@@ -21,6 +21,7 @@
 
 #include <string.h>
 
+#include "benchmarks.h"
 #include "engine.h"
 #include "tests.h"
 
@@ -42,6 +43,8 @@ int main(int argc, char *argv[]) {
 
   if (argc <= 1 || containsString((size_t)argc, argv, "bigInteger"))
     testBigInteger();
+  if (argc <= 1 || containsString((size_t)argc, argv, "hashMap"))
+    testHashMap();
   if (argc <= 1 || containsString((size_t)argc, argv, "conversions"))
     testConversions();
 
@@ -49,6 +52,9 @@ int main(int argc, char *argv[]) {
     testCommandLineArgs();
   if (argc <= 1 || containsString((size_t)argc, argv, "lexer")) testLexer();
   if (argc <= 1 || containsString((size_t)argc, argv, "parser")) testParser();
+  if (argc <= 1 || containsString((size_t)argc, argv, "importGraph"))
+    testImportGraph();
+  if (argc <= 1 || containsString((size_t)argc, argv, "type")) testType();
   if (argc <= 1 || containsString((size_t)argc, argv, "typechecker"))
     testTypechecker();
   if (argc <= 1 || containsString((size_t)argc, argv, "translation"))
@@ -59,6 +65,15 @@ int main(int argc, char *argv[]) {
     testTraceScheduling();
   if (argc <= 1 || containsString((size_t)argc, argv, "scheduledOptimization"))
     testScheduledOptimization();
+  if (argc <= 1 || containsString((size_t)argc, argv, "cache")) testCache();
+  if (argc <= 1 || containsString((size_t)argc, argv, "server")) testServer();
+
+  // benchmarks only run when asked for
+  if (containsString((size_t)argc, argv, "lexerBenchmark")) benchmarkLexer();
+  if (containsString((size_t)argc, argv, "conversionsBenchmark"))
+    benchmarkConversions();
+  if (containsString((size_t)argc, argv, "hashMapBenchmark"))
+    benchmarkHashMap();
 
   return testStatusStatus();
 }
\ No newline at end of file
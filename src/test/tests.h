@@ -27,6 +27,8 @@
 
 /** tests bigInteger */
 void testBigInteger(void);
+/** tests hashMap */
+void testHashMap(void);
 /** tests numeric conversions */
 void testConversions(void);
 /** tests command line argument parsing */
@@ -35,6 +37,10 @@ void testCommandLineArgs(void);
 void testLexer(void);
 /** tests the parser */
 void testParser(void);
+/** tests the import graph */
+void testImportGraph(void);
+/** tests types */
+void testType(void);
 /** tests the typechecker */
 void testTypechecker(void);
 /** tests translation */
@@ -45,5 +51,9 @@ void testBlockedOptimization(void);
 void testTraceScheduling(void);
 /** tests optimzation after scheduling */
 void testScheduledOptimization(void);
+/** tests the incremental compilation cache */
+void testCache(void);
+/** tests the compile server */
+void testServer(void);
 
 #endif  // TLC_TEST_TESTS_H_
\ No newline at end of file
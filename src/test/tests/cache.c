@@ -0,0 +1,123 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not, see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * tests for the incremental compilation cache
+ */
+
+#include "cache.h"
+
+#include <assert.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "arch/interface.h"
+#include "compile.h"
+#include "engine.h"
+#include "fileList.h"
+#include "options.h"
+#include "tests.h"
+#include "util/filesystem.h"
+#include "util/format.h"
+
+/**
+ * compiles a single code file
+ *
+ * @returns status of compilation
+ */
+static int compileOne(char const *filename) {
+  FileListEntry entries[1];
+  fileList.entries = &entries[0];
+  fileList.size = 1;
+  fileListEntryInit(&entries[0], filename, true);
+
+  int status = compile();
+
+  free(entries[0].lineStarts);
+  return status;
+}
+
+/**
+ * counts the entries in the cache directory
+ */
+static int countEntries(void) {
+  struct dirent **files;
+  int numFiles = scandir(options.cacheDir, &files, noHiddenFilter, NULL);
+  assert("couldn't open cache dir" && numFiles != -1);
+  for (int idx = 0; idx < numFiles; ++idx) free(files[idx]);
+  free(files);
+  return numFiles;
+}
+
+/**
+ * removes the cache directory and its entries
+ */
+static void removeCache(void) {
+  struct dirent **files;
+  int numFiles = scandir(options.cacheDir, &files, noHiddenFilter, NULL);
+  for (int idx = 0; idx < numFiles; ++idx) {
+    char *name = format("%s/%s", options.cacheDir, files[idx]->d_name);
+    unlink(name);
+    free(name);
+    free(files[idx]);
+  }
+  if (numFiles != -1) free(files);
+  rmdir(options.cacheDir);
+}
+
+void testCache(void) {
+  Options original;
+  memcpy(&original, &options, sizeof(Options));
+
+  char cacheDir[] = "/tmp/tlc-test-cache-XXXXXX";
+  if (mkdtemp(cacheDir) == NULL) {
+    test("cache dir can be created", false);
+    return;
+  }
+  options.arch = OPTION_A_X86_64_LINUX;
+  options.dump = OPTION_DD_NONE;
+  options.timeReport = OPTION_TR_NONE;
+  options.jobs = 1;
+  options.cacheDir = cacheDir;
+
+  // both files have the same contents, but __FILE__ expands differently
+  test("compiling a file adds a cache entry",
+       compileOne("testFiles/cache/first/file.tc") == CODE_SUCCESS &&
+           countEntries() == 1);
+  test("the same contents at another path add another cache entry",
+       compileOne("testFiles/cache/second/file.tc") == CODE_SUCCESS &&
+           countEntries() == 2);
+
+  FileListEntry entries[1];
+  fileList.entries = &entries[0];
+  fileList.size = 1;
+  fileListEntryInit(&entries[0], "testFiles/cache/first/file.tc", true);
+  cacheLookup();
+  test("an unchanged file is loaded from the cache",
+       fileList.size == 0 && entries[0].asmFile != NULL);
+  cacheFinish();
+  if (entries[0].asmFile != NULL) backend(0);
+  test("loading from the cache adds no entries", countEntries() == 2);
+
+  removeCache();
+  memcpy(&options, &original, sizeof(Options));
+}
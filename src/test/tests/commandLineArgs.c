@@ -339,6 +339,175 @@ static void testOptions(void) {
        retval == 0);
   test("debug-dump ir option is correctly set",
        options.dump == OPTION_DD_SCHEDULED_OPTIMIZATION);
+
+  // -j N
+  argc = 4;
+  char const *const argv20[] = {
+      "./tlc",
+      "-j",
+      "4",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv20, &numFiles);
+
+  test("command line with -j N passes", retval == 0);
+  test("-j N option is correctly set", options.jobs == 4);
+  test("-j N option's job count is not a file", numFiles == 1);
+
+  // -jN
+  argc = 3;
+  char const *const argv21[] = {
+      "./tlc",
+      "-j8",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv21, &numFiles);
+
+  test("command line with -jN passes", retval == 0);
+  test("-jN option is correctly set", options.jobs == 8);
+
+  // -j0
+  argc = 3;
+  char const *const argv22[] = {
+      "./tlc",
+      "-j0",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv22, &numFiles);
+  test("command line with -j0 fails", retval != 0);
+
+  // -j without a count
+  argc = 2;
+  char const *const argv23[] = {
+      "./tlc",
+      "-j",
+  };
+  retval = parseArgs(argc, argv23, &numFiles);
+  test("command line with -j and no count fails", retval != 0);
+
+  // --time-report
+  argc = 3;
+  char const *const argv24[] = {
+      "./tlc",
+      "--time-report",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv24, &numFiles);
+
+  test("command line with time-report passes", retval == 0);
+  test("time-report option is correctly set",
+       options.timeReport == OPTION_TR_SUMMARY);
+
+  // --time-report=per-file
+  argc = 3;
+  char const *const argv25[] = {
+      "./tlc",
+      "--time-report=per-file",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv25, &numFiles);
+
+  test("command line with time-report=per-file passes", retval == 0);
+  test("time-report per-file option is correctly set",
+       options.timeReport == OPTION_TR_PER_FILE);
+
+  // --no-time-report
+  argc = 3;
+  char const *const argv26[] = {
+      "./tlc",
+      "--no-time-report",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv26, &numFiles);
+
+  test("command line with no-time-report passes", retval == 0);
+  test("time-report option is correctly unset",
+       options.timeReport == OPTION_TR_NONE);
+
+  // --decl-index
+  argc = 3;
+  char const *const argv27[] = {
+      "./tlc",
+      "--decl-index",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv27, &numFiles);
+
+  test("command line with decl-index passes", retval == 0);
+  test("decl-index option is correctly set", options.declIndex == true);
+
+  // --no-decl-index
+  argc = 3;
+  char const *const argv28[] = {
+      "./tlc",
+      "--no-decl-index",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv28, &numFiles);
+
+  test("command line with no-decl-index passes", retval == 0);
+  test("decl-index option is correctly unset", options.declIndex == false);
+
+  // --cache-dir=
+  argc = 3;
+  char const *const argv29[] = {
+      "./tlc",
+      "--cache-dir=build/cache",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv29, &numFiles);
+
+  test("command line with cache-dir passes", retval == 0);
+  test("cache-dir option is correctly set",
+       options.cacheDir != NULL &&
+           strcmp(options.cacheDir, "build/cache") == 0);
+
+  // --no-cache-dir
+  argc = 3;
+  char const *const argv30[] = {
+      "./tlc",
+      "--no-cache-dir",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv30, &numFiles);
+
+  test("command line with no-cache-dir passes", retval == 0);
+  test("cache-dir option is correctly unset", options.cacheDir == NULL);
+
+  // --cache-dir= without a directory
+  argc = 3;
+  char const *const argv31[] = {
+      "./tlc",
+      "--cache-dir=",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv31, &numFiles);
+
+  test("command line with empty cache-dir fails", retval != 0);
+
+  // --lazy-decls
+  argc = 3;
+  char const *const argv32[] = {
+      "./tlc",
+      "--lazy-decls",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv32, &numFiles);
+
+  test("command line with lazy-decls passes", retval == 0);
+  test("lazy-decls option is correctly set", options.lazyDecls == true);
+
+  // --no-lazy-decls
+  argc = 3;
+  char const *const argv33[] = {
+      "./tlc",
+      "--no-lazy-decls",
+      "foo.tc",
+  };
+  retval = parseArgs(argc, argv33, &numFiles);
+
+  test("command line with no-lazy-decls passes", retval == 0);
+  test("lazy-decls option is correctly unset", options.lazyDecls == false);
 }
 
 void testCommandLineArgs(void) {
@@ -303,6 +303,41 @@ static void testUnderflowDoubleConversions(void) {
   free(messageString);
 }
 
+static void testShortConversions(void) {
+  srand(0);
+
+  bool floatOK = true;
+  bool doubleOK = true;
+  char *messageString = strdup("everything");
+  for (size_t count = 0; count < 10000; ++count) {
+    // a few significant digits, as a literal is usually written
+    int places = (int)(intRand() % 20) + 1;
+    uint64_t whole = longRand() % 100000;
+    uint64_t fraction = longRand() % 1000000;
+    char *stringValue = format("%lu.%0*lu", whole, places, fraction);
+
+    float stdlibFloat = strtof(stringValue, &ignored);
+    if (floatToBits(stdlibFloat) != floatStringToBits(stringValue)) {
+      floatOK = false;
+      free(messageString);
+      messageString = stringValue;
+      break;
+    }
+    double stdlibDouble = strtod(stringValue, &ignored);
+    if (doubleToBits(stdlibDouble) != doubleStringToBits(stringValue)) {
+      doubleOK = false;
+      free(messageString);
+      messageString = stringValue;
+      break;
+    }
+
+    free(stringValue);
+  }
+  testDynamic(format("short float parsing of %s", messageString), floatOK);
+  testDynamic(format("short double parsing of %s", messageString), doubleOK);
+  free(messageString);
+}
+
 void testConversions(void) {
   assert("can't bless conversion tests" && !status.bless);
 
@@ -314,4 +349,5 @@ void testConversions(void) {
   testOverflowDoubleConversions();
   testUnderflowFloatConversions();
   testUnderflowDoubleConversions();
+  testShortConversions();
 }
\ No newline at end of file
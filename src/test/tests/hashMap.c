@@ -0,0 +1,205 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not, see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * tests for hashMap
+ */
+
+#include "util/container/hashMap.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine.h"
+#include "tests.h"
+#include "util/format.h"
+#include "util/functional.h"
+
+/** number of keys inserted - enough to grow the index several times */
+#define NUM_KEYS 5000
+
+/**
+ * creates the keys to insert
+ *
+ * @returns keys, each key%zu for its index (owning)
+ */
+static char **keysCreate(void) {
+  char **keys = malloc(NUM_KEYS * sizeof(char *));
+  for (size_t idx = 0; idx < NUM_KEYS; ++idx) keys[idx] = format("key%zu", idx);
+  return keys;
+}
+
+static void keysFree(char **keys) {
+  for (size_t idx = 0; idx < NUM_KEYS; ++idx) free(keys[idx]);
+  free(keys);
+}
+
+/**
+ * gets the value stored for a key's index - never NULL
+ */
+static void *valueOf(size_t idx) { return (void *)(uintptr_t)(idx + 1); }
+
+/**
+ * checks a map's index: every entry has exactly one slot, and no slot is
+ * further from home than the slot before it allows, which is what lets lookups
+ * stop early
+ */
+static bool indexValid(HashMap const *map) {
+  size_t mask = map->capacity - 1;
+  size_t occupied = 0;
+  bool *seen = calloc(map->size == 0 ? 1 : map->size, sizeof(bool));
+  bool valid = true;
+  for (size_t idx = 0; idx < map->capacity; ++idx) {
+    HashMapSlot const *slot = &map->slots[idx];
+    if (slot->entry == 0) continue;
+    ++occupied;
+
+    size_t entry = slot->entry - 1;
+    if (entry >= map->size || seen[entry] ||
+        slot->hash != (uint32_t)map->entries[entry].hash) {
+      valid = false;
+      continue;
+    }
+    seen[entry] = true;
+
+    size_t distance = (idx - slot->hash) & mask;
+    if (distance == 0) continue;
+    HashMapSlot const *prev = &map->slots[(idx - 1) & mask];
+    if (prev->entry == 0 || ((idx - 1 - prev->hash) & mask) + 1 < distance)
+      valid = false;
+  }
+  free(seen);
+  return valid && occupied == map->size;
+}
+
+static void testHashMapGrowth(void) {
+  char **keys = keysCreate();
+  HashMap map;
+  hashMapInit(&map);
+
+  bool inserted = true;
+  size_t numGrowths = 0;
+  for (size_t idx = 0; idx < NUM_KEYS; ++idx) {
+    size_t capacity = map.capacity;
+    if (hashMapPut(&map, keys[idx], valueOf(idx)) != 0) inserted = false;
+    if (map.capacity != capacity) ++numGrowths;
+  }
+  test("hashMap puts new keys", inserted && map.size == NUM_KEYS);
+  test("hashMap grows several times", numGrowths >= 4);
+  test("hashMap index is valid after growing", indexValid(&map));
+
+  bool found = true;
+  for (size_t idx = 0; idx < NUM_KEYS; ++idx) {
+    if (hashMapGet(&map, keys[idx]) != valueOf(idx)) found = false;
+  }
+  test("hashMap finds every key after growing", found);
+
+  bool ordered = true;
+  for (size_t idx = 0; idx < NUM_KEYS; ++idx) {
+    if (map.entries[idx].key != keys[idx]) ordered = false;
+  }
+  test("hashMap keeps entries in insertion order", ordered);
+
+  // lookups are by contents, not by pointer
+  char *copy = format("key%d", 42);
+  test("hashMap finds a copy of a key", hashMapGet(&map, copy) == valueOf(42));
+  test("hashMap doesn't put an existing key",
+       hashMapPut(&map, copy, NULL) == -1 &&
+           hashMapGet(&map, keys[42]) == valueOf(42));
+  hashMapSet(&map, copy, valueOf(0));
+  test("hashMap sets an existing key",
+       hashMapGet(&map, keys[42]) == valueOf(0) && map.size == NUM_KEYS);
+  free(copy);
+  test("hashMap doesn't find a missing key",
+       hashMapGet(&map, "missing") == NULL);
+
+  hashMapUninit(&map, nullDtor);
+  keysFree(keys);
+}
+
+static void testHashMapRemove(void) {
+  char **keys = keysCreate();
+  HashMap map;
+  hashMapInit(&map);
+  for (size_t idx = 0; idx < NUM_KEYS; ++idx)
+    hashMapPut(&map, keys[idx], valueOf(idx));
+
+  // remove every third key, checking the index as clusters shift back
+  bool removed = true;
+  bool valid = true;
+  for (size_t idx = 0; idx < NUM_KEYS; idx += 3) {
+    if (hashMapRemove(&map, keys[idx]) != valueOf(idx)) removed = false;
+    if (idx % 300 == 0 && !indexValid(&map)) valid = false;
+  }
+  test("hashMap returns the removed values", removed);
+  test("hashMap index is valid after removals", valid && indexValid(&map));
+  test("hashMap size shrinks after removals",
+       map.size == NUM_KEYS - (NUM_KEYS + 2) / 3);
+
+  bool found = true;
+  for (size_t idx = 0; idx < NUM_KEYS; ++idx) {
+    void *expected = idx % 3 == 0 ? NULL : valueOf(idx);
+    if (hashMapGet(&map, keys[idx]) != expected) found = false;
+  }
+  test("hashMap finds exactly the remaining keys after removals", found);
+
+  bool ordered = true;
+  for (size_t idx = 1; idx < map.size; ++idx) {
+    if (map.entries[idx - 1].value >= map.entries[idx].value) ordered = false;
+  }
+  test("hashMap keeps insertion order after removals", ordered);
+
+  test("hashMap doesn't remove a missing key",
+       hashMapRemove(&map, keys[0]) == NULL &&
+           hashMapRemove(&map, "missing") == NULL);
+
+  bool reinserted = true;
+  for (size_t idx = 0; idx < NUM_KEYS; idx += 3) {
+    if (hashMapPut(&map, keys[idx], valueOf(idx)) != 0) reinserted = false;
+  }
+  found = true;
+  for (size_t idx = 0; idx < NUM_KEYS; ++idx) {
+    if (hashMapGet(&map, keys[idx]) != valueOf(idx)) found = false;
+  }
+  test("hashMap puts removed keys again",
+       reinserted && found && map.size == NUM_KEYS && indexValid(&map));
+
+  // empty the map entirely, in an order unrelated to the index
+  removed = true;
+  for (size_t idx = NUM_KEYS; idx-- > 0;) {
+    if (hashMapRemove(&map, keys[idx]) != valueOf(idx)) removed = false;
+  }
+  bool empty = true;
+  for (size_t idx = 0; idx < map.capacity; ++idx) {
+    if (map.slots[idx].entry != 0) empty = false;
+  }
+  test("hashMap empties after removing every key",
+       removed && empty && map.size == 0 &&
+           hashMapGet(&map, keys[0]) == NULL);
+
+  hashMapUninit(&map, nullDtor);
+  keysFree(keys);
+}
+
+void testHashMap(void) {
+  testHashMapGrowth();
+  testHashMapRemove();
+}
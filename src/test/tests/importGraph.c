@@ -0,0 +1,225 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not, see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * tests for the import graph, and scheduling over it
+ */
+
+#include "parser/importGraph.h"
+
+#include <assert.h>
+#include <dirent.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ast/ast.h"
+#include "engine.h"
+#include "fileList.h"
+#include "parser/parser.h"
+#include "tests.h"
+#include "util/filesystem.h"
+#include "util/format.h"
+#include "util/functional.h"
+#include "util/parallel.h"
+
+/** number of times the graph is scheduled, to try different interleavings */
+#define NUM_SCHEDULES 50
+
+/**
+ * finds the component a file is in
+ *
+ * @param graph graph to search
+ * @param name name of the file, without its directory
+ * @returns index of the component, or graph->size if there's no such file
+ */
+static size_t componentOf(ImportGraph const *graph, char const *name) {
+  for (size_t component = 0; component < graph->size; ++component) {
+    for (size_t idx = graph->fileStarts[component];
+         idx < graph->fileStarts[component + 1]; ++idx) {
+      char const *filename = fileList.entries[graph->files[idx]].inputFilename;
+      char const *basename = strrchr(filename, '/');
+      if (strcmp(basename == NULL ? filename : basename + 1, name) == 0)
+        return component;
+    }
+  }
+  return graph->size;
+}
+
+/**
+ * does a component import another one?
+ */
+static bool imports(ImportGraph const *graph, size_t importer,
+                    size_t imported) {
+  for (size_t idx = graph->importStarts[importer];
+       idx < graph->importStarts[importer + 1]; ++idx) {
+    if (graph->imports[idx] == imported) return true;
+  }
+  return false;
+}
+
+/**
+ * gets the number of components a component imports
+ */
+static size_t numImports(ImportGraph const *graph, size_t component) {
+  return graph->importStarts[component + 1] - graph->importStarts[component];
+}
+
+/** when each work item started and finished, in calls made */
+typedef struct {
+  atomic_size_t clock;
+  atomic_size_t *calls;
+  size_t *started;
+  size_t *finished;
+} Schedule;
+
+/**
+ * records when a work item ran
+ */
+static void recordCall(size_t idx, void *context) {
+  Schedule *schedule = context;
+  schedule->started[idx] = atomic_fetch_add(&schedule->clock, 1);
+  atomic_fetch_add(&schedule->calls[idx], 1);
+  schedule->finished[idx] = atomic_fetch_add(&schedule->clock, 1);
+}
+
+/**
+ * schedules the graph's components, and checks each ran once, after all of
+ * its imports finished
+ *
+ * @param graph graph to schedule
+ * @param numThreads number of threads to schedule on
+ * @returns whether the schedule was correct
+ */
+static bool scheduleCorrect(ImportGraph const *graph, size_t numThreads) {
+  Schedule schedule;
+  atomic_init(&schedule.clock, 0);
+  schedule.calls = malloc(sizeof(atomic_size_t) * graph->size);
+  schedule.started = malloc(sizeof(size_t) * graph->size);
+  schedule.finished = malloc(sizeof(size_t) * graph->size);
+  for (size_t idx = 0; idx < graph->size; ++idx)
+    atomic_init(&schedule.calls[idx], 0);
+
+  parallelForDag(numThreads, graph->size, graph->importStarts, graph->imports,
+                 recordCall, &schedule);
+
+  bool correct = true;
+  for (size_t component = 0; component < graph->size; ++component) {
+    if (atomic_load(&schedule.calls[component]) != 1) correct = false;
+    for (size_t idx = graph->importStarts[component];
+         idx < graph->importStarts[component + 1]; ++idx) {
+      if (schedule.finished[graph->imports[idx]] >=
+          schedule.started[component])
+        correct = false;
+    }
+  }
+
+  free(schedule.calls);
+  free(schedule.started);
+  free(schedule.finished);
+  return correct;
+}
+
+void testImportGraph(void) {
+  struct dirent **input;
+  int inputLen =
+      scandir("testFiles/importGraph", &input, noHiddenFilter, alphasort);
+  assert("couldn't open import graph files dir" && inputLen != -1);
+
+  FileListEntry *entries = malloc(sizeof(FileListEntry) * (size_t)inputLen);
+  char **names = malloc(sizeof(char *) * (size_t)inputLen);
+  for (int idx = 0; idx < inputLen; ++idx) {
+    names[idx] = format("testFiles/importGraph/%s", input[idx]->d_name);
+    size_t length = strlen(names[idx]);
+    fileListEntryInit(&entries[idx], names[idx],
+                      strcmp(names[idx] + length - 3, ".tc") == 0);
+    free(input[idx]);
+  }
+  free(input);
+  fileList.entries = entries;
+  fileList.size = (size_t)inputLen;
+
+  test("import graph files parse", parse() == 0);
+
+  ImportGraph graph;
+  importGraphInit(&graph);
+
+  // cycleA <-> cycleB, diamondTop -> diamondLeft, diamondRight ->
+  // diamondBottom, loneA (with a code file), and loneB
+  size_t cycleA = componentOf(&graph, "cycleA.td");
+  size_t cycleB = componentOf(&graph, "cycleB.td");
+  size_t top = componentOf(&graph, "diamondTop.td");
+  size_t left = componentOf(&graph, "diamondLeft.td");
+  size_t right = componentOf(&graph, "diamondRight.td");
+  size_t bottom = componentOf(&graph, "diamondBottom.td");
+  size_t loneADecl = componentOf(&graph, "loneA.td");
+  size_t loneACode = componentOf(&graph, "loneA.tc");
+  size_t loneB = componentOf(&graph, "loneB.td");
+
+  test("import graph has a component for each module, with cycles merged",
+       graph.size == 7);
+  test("import graph has every file once",
+       graph.fileStarts[graph.size] == (size_t)inputLen);
+  test("modules importing each other share a component",
+       cycleA != graph.size && cycleA == cycleB &&
+           graph.fileStarts[cycleA + 1] - graph.fileStarts[cycleA] == 2 &&
+           numImports(&graph, cycleA) == 0);
+  test("a module's code and declaration files share a component",
+       loneADecl != graph.size && loneADecl == loneACode);
+  test("independent modules have their own components",
+       loneB != graph.size && loneB != loneADecl &&
+           numImports(&graph, loneB) == 0 &&
+           numImports(&graph, loneADecl) == 0);
+  test("diamond components import exactly their imports",
+       top != graph.size && left != graph.size && right != graph.size &&
+           bottom != graph.size && numImports(&graph, top) == 2 &&
+           imports(&graph, top, left) && imports(&graph, top, right) &&
+           numImports(&graph, left) == 1 && imports(&graph, left, bottom) &&
+           numImports(&graph, right) == 1 &&
+           imports(&graph, right, bottom) && numImports(&graph, bottom) == 0);
+
+  bool topological = true;
+  for (size_t component = 0; component < graph.size; ++component) {
+    for (size_t idx = graph.importStarts[component];
+         idx < graph.importStarts[component + 1]; ++idx) {
+      if (graph.imports[idx] >= component) topological = false;
+    }
+  }
+  test("components only import earlier components", topological);
+
+  test("serial schedule runs components after their imports",
+       scheduleCorrect(&graph, 1));
+  bool parallelCorrect = true;
+  for (size_t count = 0; count < NUM_SCHEDULES; ++count) {
+    if (!scheduleCorrect(&graph, 4)) parallelCorrect = false;
+  }
+  test("parallel schedule runs components after their imports",
+       parallelCorrect);
+
+  importGraphUninit(&graph);
+  for (int idx = 0; idx < inputLen; ++idx) {
+    nodeFree(entries[idx].ast);
+    free(entries[idx].lineStarts);
+    vectorUninit(&entries[idx].irFrags, nullDtor);
+    free(names[idx]);
+  }
+  free(entries);
+  free(names);
+}
@@ -37,6 +37,7 @@ static void testAllTokens(void) {
   entry.inputFilename = "testFiles/lexer/allTokens.tc";
   entry.isCode = true;
   entry.errored = false;
+  entry.lineStarts = NULL;
 
   test("lexer initializes okay", lexerStateInit(&entry) == 0);
 
@@ -188,12 +189,15 @@ static void testAllTokens(void) {
       messageString = TOKEN_NAMES[token.type];
       break;
     }
-    if (token.character != TOKENS[idx].character) {
+    size_t line;
+    size_t character;
+    fileListEntryPosition(&entry, token.offset, &line, &character);
+    if (character != TOKENS[idx].character) {
       characterOK = false;
       messageString = TOKEN_NAMES[token.type];
       break;
     }
-    if (token.line != TOKENS[idx].line) {
+    if (line != TOKENS[idx].line) {
       lineOK = false;
       messageString = TOKEN_NAMES[token.type];
       break;
@@ -210,7 +214,7 @@ static void testAllTokens(void) {
       break;
     }
 
-    if (token.string != NULL) free(token.string);
+    tokenUninit(&token);
     entry.errored = false;
   }
   testDynamic(format("lex accepts token for %s", messageString), errorFlagOK);
@@ -223,6 +227,7 @@ static void testAllTokens(void) {
               additionalDataOK);
 
   lexerStateUninit(&entry);
+  free(entry.lineStarts);
 }
 
 static void testErrors(void) {
@@ -232,6 +237,7 @@ static void testErrors(void) {
   entry.inputFilename = "testFiles/lexer/errors.tc";
   entry.isCode = true;
   entry.errored = false;
+  entry.lineStarts = NULL;
 
   test("lexer initializes okay", lexerStateInit(&entry) == 0);
 
@@ -299,12 +305,15 @@ static void testErrors(void) {
       messageString = TOKEN_NAMES[token.type];
       break;
     }
-    if (token.character != TOKENS[idx].character) {
+    size_t line;
+    size_t character;
+    fileListEntryPosition(&entry, token.offset, &line, &character);
+    if (character != TOKENS[idx].character) {
       characterOK = false;
       messageString = TOKEN_NAMES[token.type];
       break;
     }
-    if (token.line != TOKENS[idx].line) {
+    if (line != TOKENS[idx].line) {
       lineOK = false;
       messageString = TOKEN_NAMES[token.type];
       break;
@@ -321,7 +330,7 @@ static void testErrors(void) {
       break;
     }
 
-    if (token.string != NULL) free(token.string);
+    tokenUninit(&token);
     entry.errored = false;
   }
   testDynamic(format("token has expected error flag for %s", messageString),
@@ -343,9 +352,11 @@ static void testErrors(void) {
   lex(&entry, &token);
   test("unterminated char literal is an error", entry.errored == true);
   test("unterminated char literal is bad char", token.type == TT_BAD_CHAR);
-  test("unterminated char literal is at expected character",
-       token.character == 1);
-  test("unterminated char literal is at expected line", token.line == 1);
+  size_t line;
+  size_t character;
+  fileListEntryPosition(&entry, token.offset, &line, &character);
+  test("unterminated char literal is at expected character", character == 1);
+  test("unterminated char literal is at expected line", line == 1);
   test("unterminated char literal has no additional data",
        token.string == NULL);
   entry.errored = false;
@@ -354,10 +365,10 @@ static void testErrors(void) {
   test("token after unterminated char literal is accepted",
        entry.errored == false);
   test("token after unterminated char literal is eof", token.type == TT_EOF);
+  fileListEntryPosition(&entry, token.offset, &line, &character);
   test("token after unterminated char literal is at expected character",
-       token.character == 2);
-  test("token after unterminated char literal is at expected line",
-       token.line == 1);
+       character == 2);
+  test("token after unterminated char literal is at expected line", line == 1);
 
   lexerStateUninit(&entry);
 
@@ -368,33 +379,31 @@ static void testErrors(void) {
   lex(&entry, &token);
   test("unterminated string literal is an error", entry.errored == true);
   test("unterminated string literal is string", token.type == TT_LIT_STRING);
-  test("unterminated string literal is at expected character",
-       token.character == 1);
-  test("unterminated string literal is at expected line", token.line == 1);
+  fileListEntryPosition(&entry, token.offset, &line, &character);
+  test("unterminated string literal is at expected character", character == 1);
+  test("unterminated string literal is at expected line", line == 1);
   test("unterminated string literal's additional data is correct",
        strcmp(token.string, "") == 0);
-  free(token.string);
+  tokenUninit(&token);
   entry.errored = false;
 
   lex(&entry, &token);
   test("token after unterminated string literal is accepted",
        entry.errored == false);
   test("token after unterminated string literal is eof", token.type == TT_EOF);
+  fileListEntryPosition(&entry, token.offset, &line, &character);
   test("token after unterminated string literal is at expected character",
-       token.character == 2);
+       character == 2);
   test("token after unterminated string literal is at expected line",
-       token.line == 1);
+       line == 1);
 
   lexerStateUninit(&entry);
+  free(entry.lineStarts);
 }
 
 void testLexer(void) {
   assert("can't bless lexer tests" && !status.bless);
 
-  lexerInitMaps();
-
   testAllTokens();
   testErrors();
-
-  lexerUninitMaps();
 }
\ No newline at end of file
@@ -0,0 +1,231 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not, see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * tests for the compile server
+ */
+
+#include "server.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "compile.h"
+#include "engine.h"
+#include "fileList.h"
+#include "options.h"
+#include "tests.h"
+#include "util/format.h"
+
+/**
+ * copies a file
+ *
+ * @returns whether the file was copied
+ */
+static bool copyFile(char const *from, char const *to) {
+  FILE *in = fopen(from, "rb");
+  if (in == NULL) return false;
+  FILE *out = fopen(to, "wb");
+  if (out == NULL) {
+    fclose(in);
+    return false;
+  }
+  char buffer[4096];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), in)) != 0)
+    fwrite(buffer, 1, length, out);
+  fclose(in);
+  return fclose(out) == 0;
+}
+
+/**
+ * reads a whole file
+ *
+ * @returns contents of the file (owning)
+ */
+static char *readFile(char const *filename) {
+  FILE *in = fopen(filename, "rb");
+  if (in == NULL) return format("%s", "");
+  fseek(in, 0, SEEK_END);
+  long length = ftell(in);
+  rewind(in);
+  char *contents = malloc((size_t)length + 1);
+  contents[fread(contents, 1, (size_t)length, in)] = '\0';
+  fclose(in);
+  return contents;
+}
+
+/**
+ * compiles in a child process, as tlc would with the given command line
+ *
+ * @param socketPath server to compile with, or NULL to compile directly
+ * @param outputFilename file to capture stdout and stderr in
+ * @param code output parameter for the exit code, or -1 if it didn't exit
+ * @returns stdout and stderr, interleaved (owning)
+ */
+static char *runTlc(char const *socketPath, char const *outputFilename,
+                    size_t argc, char const *const *argv, int *code) {
+  *code = -1;
+  fflush(stdout);
+  fflush(stderr);
+  pid_t child = fork();
+  if (child == 0) {
+    int fd = open(outputFilename, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1) _exit(-1);
+    dup2(fd, STDOUT_FILENO);
+    dup2(fd, STDERR_FILENO);
+    close(fd);
+
+    int retval;
+    size_t numFiles;
+    if (socketPath != NULL)
+      retval = serverConnect(socketPath, argc, argv);
+    else if (parseArgs(argc, argv, &numFiles) != 0)
+      retval = CODE_OPTION_ERROR;
+    else if (parseFiles(argc, argv, numFiles) != 0)
+      retval = CODE_FILE_ERROR;
+    else
+      retval = compile();
+    fflush(stdout);
+    fflush(stderr);
+    _exit(retval);
+  } else if (child == -1) {
+    return format("%s", "");
+  }
+
+  int status;
+  if (waitpid(child, &status, 0) == child && WIFEXITED(status))
+    *code = WEXITSTATUS(status);
+  return readFile(outputFilename);
+}
+
+/**
+ * compiles both with the server and directly
+ *
+ * @param code output parameter for the server's exit code
+ * @returns whether both gave the same output and exit code
+ */
+static bool sameAsDirect(char const *socketPath, char const *outputFilename,
+                         size_t argc, char const *const *argv, int *code) {
+  char *served = runTlc(socketPath, outputFilename, argc, argv, code);
+  int directCode;
+  char *direct = runTlc(NULL, outputFilename, argc, argv, &directCode);
+  bool same =
+      *code == directCode && *code != -1 && strcmp(served, direct) == 0;
+  free(served);
+  free(direct);
+  return same;
+}
+
+/**
+ * waits for the server to start listening
+ *
+ * @returns whether the server is listening
+ */
+static bool awaitServer(char const *socketPath) {
+  struct timespec delay = {0, 10000000};
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socketPath);
+  for (size_t tries = 0; tries < 500; ++tries) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) return false;
+    bool connected =
+        connect(fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+    close(fd);
+    if (connected) return true;
+    nanosleep(&delay, NULL);
+  }
+  return false;
+}
+
+void testServer(void) {
+  char dir[] = "/tmp/tlc-test-server-XXXXXX";
+  if (mkdtemp(dir) == NULL) {
+    test("server test dir can be created", false);
+    return;
+  }
+  char *socketPath = format("%s/socket", dir);
+  char *outputFilename = format("%s/output", dir);
+  char *declFilename = format("%s/shapes.td", dir);
+  char *codeFilename = format("%s/user.tc", dir);
+  bool copied =
+      copyFile("testFiles/server/before/shapes.td", declFilename) &&
+      copyFile("testFiles/server/user.tc", codeFilename);
+
+  fflush(stdout);
+  fflush(stderr);
+  pid_t server = fork();
+  if (server == 0) {
+    int fd = open("/dev/null", O_WRONLY);
+    if (fd != -1) {
+      dup2(fd, STDOUT_FILENO);
+      dup2(fd, STDERR_FILENO);
+      close(fd);
+    }
+    _exit(serverRun(socketPath));
+  }
+
+  if (server != -1 && copied && awaitServer(socketPath)) {
+    struct stat statbuf;
+    test("server socket is only accessible to its user",
+         stat(socketPath, &statbuf) == 0 && (statbuf.st_mode & 0777) == 0600);
+
+    char const *argv[] = {"tlc", declFilename, codeFilename};
+    size_t argc = sizeof(argv) / sizeof(argv[0]);
+
+    int code;
+    test("server compiles the same as a direct compilation",
+         sameAsDirect(socketPath, outputFilename, argc, argv, &code) &&
+             code == CODE_SUCCESS);
+    test("server reuses unchanged decl files correctly",
+         sameAsDirect(socketPath, outputFilename, argc, argv, &code) &&
+             code == CODE_SUCCESS);
+    test("server rebuilds a changed decl file",
+         copyFile("testFiles/server/after/shapes.td", declFilename) &&
+             sameAsDirect(socketPath, outputFilename, argc, argv, &code) &&
+             code == CODE_TYPECHECK_ERROR);
+  } else {
+    test("server starts listening", false);
+  }
+
+  if (server != -1) {
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+  }
+  unlink(outputFilename);
+  unlink(declFilename);
+  unlink(codeFilename);
+  unlink(socketPath);
+  rmdir(dir);
+  free(socketPath);
+  free(outputFilename);
+  free(declFilename);
+  free(codeFilename);
+}
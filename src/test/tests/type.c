@@ -0,0 +1,405 @@
+// Copyright 2021 Justin Hu
+//
+// This file is part of the T Language Compiler.
+//
+// The T Language Compiler is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The T Language Compiler is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// the T Language Compiler. If not, see <https://www.gnu.org/licenses/>.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/**
+ * @file
+ * tests for types
+ */
+
+#include "ast/type.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ast/ast.h"
+#include "ast/symbolTable.h"
+#include "engine.h"
+#include "fileList.h"
+#include "parser/parser.h"
+#include "tests.h"
+#include "typechecker/typechecker.h"
+#include "util/container/vector.h"
+#include "util/format.h"
+#include "util/functional.h"
+#include "util/intern.h"
+
+/** number of times two threads race to compute a layout */
+#define NUM_RACES 50
+/**
+ * number of fields in the raced struct - computing its layout should take long
+ * enough that a thread computing it is likely to be interrupted, even on a
+ * single processor
+ */
+#define NUM_RACED_FIELDS 100000
+
+/**
+ * interns a null terminated string
+ */
+static char const *id(char const *text) { return intern(text, strlen(text)); }
+
+/**
+ * creates a struct
+ *
+ * @param name name of the struct
+ * @param numFields number of fields
+ * @param names names of the fields
+ * @param types types of the fields
+ * @returns struct, to be freed with stabEntryFree
+ */
+static SymbolTableEntry *structCreate(char const *name, size_t numFields,
+                                      char const *const *names,
+                                      Type *const *types) {
+  SymbolTableEntry *entry = structStabEntryCreate(NULL, 0, id(name));
+  for (size_t idx = 0; idx < numFields; ++idx)
+    structAddField(entry, id(names[idx]), types[idx]);
+  return entry;
+}
+
+/**
+ * creates the struct two threads race to lay out - alternating byte and choice
+ * fields, named field0, field1, and so on
+ */
+static SymbolTableEntry *racedCreate(SymbolTableEntry *choice) {
+  SymbolTableEntry *entry = structStabEntryCreate(NULL, 0, id("Raced"));
+  for (size_t idx = 0; idx < NUM_RACED_FIELDS; ++idx) {
+    char *name = format("field%zu", idx);
+    structAddField(entry, id(name),
+                   idx % 2 == 0 ? keywordTypeCreate(TK_BYTE)
+                                : referenceTypeCreate(choice));
+    free(name);
+  }
+  return entry;
+}
+
+/** the start of a race, and what one thread found the layout to be */
+typedef struct {
+  SymbolTableEntry *entry;
+  atomic_size_t *ready; /**< number of threads waiting to start */
+  atomic_bool *start;
+  char const *last; /**< name of the last field */
+  size_t size;
+  size_t alignment;
+  size_t lastOffset;
+} RacedLayout;
+
+/**
+ * waits for the race to start, then reads the struct's layout
+ */
+static void *racedRead(void *rawResult) {
+  RacedLayout *result = rawResult;
+  atomic_fetch_add(result->ready, 1);
+  while (!atomic_load_explicit(result->start, memory_order_acquire))
+    sched_yield();
+  Type *type = referenceTypeCreate(result->entry);
+  result->size = typeSizeof(type);
+  result->alignment = typeAlignof(type);
+  result->lastOffset = structOffsetof(result->entry, result->last);
+  return NULL;
+}
+
+static void testLayout(void) {
+  // struct Padded { byte a; int b; byte c; };
+  char const *paddedNames[] = {"a", "b", "c"};
+  Type *paddedTypes[] = {
+      keywordTypeCreate(TK_BYTE),
+      keywordTypeCreate(TK_INT),
+      keywordTypeCreate(TK_BYTE),
+  };
+  SymbolTableEntry *padded =
+      structCreate("Padded", 3, paddedNames, paddedTypes);
+  Type *paddedType = referenceTypeCreate(padded);
+  test("struct layout isn't computed until needed",
+       atomic_load(&padded->data.structType.layout) == NULL);
+  test("struct size includes padding", typeSizeof(paddedType) == 12);
+  AggregateLayout *cached = atomic_load(&padded->data.structType.layout);
+  test("struct layout is cached once computed",
+       cached != NULL && typeSizeof(paddedType) == 12 &&
+           typeAlignof(paddedType) == 4 &&
+           atomic_load(&padded->data.structType.layout) == cached);
+  test("struct fields are aligned",
+       structOffsetof(padded, id("a")) == 0 &&
+           structOffsetof(padded, id("b")) == 4 &&
+           structOffsetof(padded, id("c")) == 8);
+
+  // struct Inner { short s; long l; };
+  char const *innerNames[] = {"s", "l"};
+  Type *innerTypes[] = {
+      keywordTypeCreate(TK_SHORT),
+      keywordTypeCreate(TK_LONG),
+  };
+  SymbolTableEntry *inner = structCreate("Inner", 2, innerNames, innerTypes);
+
+  // union Choice { byte b; Inner inner; int[3] ints; };
+  SymbolTableEntry *choice = unionStabEntryCreate(NULL, 0, id("Choice"));
+  unionAddOption(choice, id("b"), keywordTypeCreate(TK_BYTE));
+  unionAddOption(choice, id("inner"), referenceTypeCreate(inner));
+  unionAddOption(choice, id("ints"),
+                 arrayTypeCreate(3, keywordTypeCreate(TK_INT)));
+  Type *choiceType = referenceTypeCreate(choice);
+  test("union layout isn't computed until needed",
+       atomic_load(&choice->data.unionType.layout) == NULL);
+  test("union is as large and as aligned as its largest option",
+       typeSizeof(choiceType) == 16 && typeAlignof(choiceType) == 8);
+  cached = atomic_load(&choice->data.unionType.layout);
+  test("union layout is cached once computed",
+       cached != NULL && cached->offsets[0] == 0 && cached->offsets[1] == 0 &&
+           cached->offsets[2] == 0 && typeSizeof(choiceType) == 16 &&
+           atomic_load(&choice->data.unionType.layout) == cached);
+  test("nested struct layout is computed for its parent",
+       atomic_load(&inner->data.structType.layout) != NULL &&
+           structOffsetof(inner, id("l")) == 8);
+
+  // struct Outer { char c; Choice choice; Padded[2] padded; byte tail; };
+  char const *outerNames[] = {"c", "choice", "padded", "tail"};
+  Type *outerTypes[] = {
+      keywordTypeCreate(TK_CHAR),
+      choiceType,
+      arrayTypeCreate(2, paddedType),
+      keywordTypeCreate(TK_BYTE),
+  };
+  SymbolTableEntry *outer = structCreate("Outer", 4, outerNames, outerTypes);
+  Type *outerType = referenceTypeCreate(outer);
+  test("struct containing aggregates is padded to its alignment",
+       typeSizeof(outerType) == 56 && typeAlignof(outerType) == 8);
+  test("struct fields containing aggregates are aligned",
+       structOffsetof(outer, id("c")) == 0 &&
+           structOffsetof(outer, id("choice")) == 8 &&
+           structOffsetof(outer, id("padded")) == 24 &&
+           structOffsetof(outer, id("tail")) == 48);
+  test("qualified aggregates share their layout",
+       typeSizeof(qualifiedTypeCreate(outerType, true, false)) == 56 &&
+           typeAlignof(qualifiedTypeCreate(outerType, true, true)) == 8);
+
+  // two threads lay out the same struct at once - both must see the
+  // layout that was published. Each byte and choice pair takes 24 bytes
+  char *lastName = format("field%d", NUM_RACED_FIELDS - 1);
+  char const *last = id(lastName);
+  free(lastName);
+  size_t racedSize = NUM_RACED_FIELDS / 2 * 24;
+  size_t lastOffset = racedSize - 16;
+  SymbolTableEntry *raced = racedCreate(choice);
+  bool raceAgreed = true;
+  for (size_t race = 0; race < NUM_RACES; ++race) {
+    // forget the last race's layout
+    free(atomic_exchange(&raced->data.structType.layout, NULL));
+
+    atomic_size_t ready;
+    atomic_init(&ready, 0);
+    atomic_bool start;
+    atomic_init(&start, false);
+    RacedLayout results[2];
+    pthread_t threads[2];
+    size_t numStarted = 0;
+    for (; numStarted < 2; ++numStarted) {
+      results[numStarted].entry = raced;
+      results[numStarted].ready = &ready;
+      results[numStarted].start = &start;
+      results[numStarted].last = last;
+      if (pthread_create(&threads[numStarted], NULL, racedRead,
+                         &results[numStarted]) != 0)
+        break;
+    }
+    while (atomic_load(&ready) != numStarted) sched_yield();
+    atomic_store_explicit(&start, true, memory_order_release);
+    for (size_t idx = 0; idx < numStarted; ++idx)
+      pthread_join(threads[idx], NULL);
+
+    AggregateLayout *layout = atomic_load(&raced->data.structType.layout);
+    if (numStarted != 2 || layout == NULL || layout->size != racedSize ||
+        layout->alignment != 8 ||
+        layout->offsets[NUM_RACED_FIELDS - 1] != lastOffset)
+      raceAgreed = false;
+    for (size_t idx = 0; idx < numStarted; ++idx) {
+      if (results[idx].size != racedSize || results[idx].alignment != 8 ||
+          results[idx].lastOffset != lastOffset)
+        raceAgreed = false;
+    }
+  }
+  stabEntryFree(raced);
+  test("threads racing to lay out a struct agree on its layout", raceAgreed);
+
+  stabEntryFree(outer);
+  stabEntryFree(choice);
+  stabEntryFree(inner);
+  stabEntryFree(padded);
+}
+
+/**
+ * creates a function pointer type
+ *
+ * @param returnType return type
+ * @param numArgs number of arguments
+ * @param argTypes types of the arguments
+ */
+static Type *funPtrCreate(Type *returnType, size_t numArgs,
+                          Type *const *argTypes) {
+  Vector args;
+  vectorInit(&args);
+  for (size_t idx = 0; idx < numArgs; ++idx) vectorInsert(&args, argTypes[idx]);
+  return funPtrTypeCreate(returnType, &args);
+}
+
+static void testInterning(void) {
+  Type *intType = keywordTypeCreate(TK_INT);
+  Type *charType = keywordTypeCreate(TK_CHAR);
+  test("keyword types are interned", keywordTypeCreate(TK_INT) == intType);
+  test("structurally equal types are interned",
+       pointerTypeCreate(intType) == pointerTypeCreate(intType) &&
+           qualifiedTypeCreate(pointerTypeCreate(intType), true, false) ==
+               qualifiedTypeCreate(pointerTypeCreate(intType), true, false) &&
+           arrayTypeCreate(3, charType) == arrayTypeCreate(3, charType));
+  test("structurally different types aren't interned together",
+       pointerTypeCreate(intType) != pointerTypeCreate(charType) &&
+           qualifiedTypeCreate(intType, true, false) !=
+               qualifiedTypeCreate(intType, false, true) &&
+           arrayTypeCreate(3, charType) != arrayTypeCreate(4, charType) &&
+           !typeEqual(arrayTypeCreate(3, charType),
+                      arrayTypeCreate(4, charType)));
+
+  // types with vectors of children are interned by their children
+  Type *args[] = {intType, pointerTypeCreate(charType)};
+  Type *otherArgs[] = {intType, pointerTypeCreate(intType)};
+  test("function pointer types are interned by their arguments",
+       funPtrCreate(intType, 2, args) == funPtrCreate(intType, 2, args) &&
+           funPtrCreate(intType, 2, args) !=
+               funPtrCreate(intType, 2, otherArgs) &&
+           funPtrCreate(intType, 2, args) != funPtrCreate(intType, 1, args) &&
+           funPtrCreate(intType, 0, args) == funPtrCreate(intType, 0, args));
+  Vector types;
+  vectorInit(&types);
+  vectorInsert(&types, intType);
+  vectorInsert(&types, charType);
+  Type *aggregate = aggregateTypeCreate(&types);
+  vectorInit(&types);
+  vectorInsert(&types, intType);
+  vectorInsert(&types, charType);
+  test("aggregate init types are interned by their elements",
+       aggregateTypeCreate(&types) == aggregate);
+
+  // an opaque type and its definition are different entries, so different
+  // types, but are still equal
+  SymbolTableEntry *definition = structStabEntryCreate(NULL, 0, id("Defined"));
+  SymbolTableEntry *opaque = opaqueStabEntryCreate(NULL, 0, id("Defined"));
+  opaque->data.opaqueType.definition = definition;
+  SymbolTableEntry *other = structStabEntryCreate(NULL, 0, id("Other"));
+  Type *definitionType = referenceTypeCreate(definition);
+  Type *opaqueType = referenceTypeCreate(opaque);
+  test("reference types are interned by their entry",
+       referenceTypeCreate(definition) == definitionType &&
+           opaqueType != definitionType);
+  test("opaque types equal their definitions",
+       typeEqual(opaqueType, definitionType) &&
+           typeEqual(definitionType, opaqueType) &&
+           typeEqual(pointerTypeCreate(opaqueType),
+                     pointerTypeCreate(definitionType)) &&
+           typeEqual(qualifiedTypeCreate(opaqueType, true, false),
+                     qualifiedTypeCreate(definitionType, true, false)));
+  Type *opaqueArgs[] = {pointerTypeCreate(opaqueType)};
+  Type *definitionArgs[] = {pointerTypeCreate(definitionType)};
+  test("types containing opaque types equal those containing definitions",
+       typeEqual(funPtrCreate(intType, 1, opaqueArgs),
+                 funPtrCreate(intType, 1, definitionArgs)) &&
+           typeEqual(arrayTypeCreate(2, opaqueType),
+                     arrayTypeCreate(2, definitionType)));
+  test("opaque types differ from other types",
+       !typeEqual(opaqueType, referenceTypeCreate(other)) &&
+           !typeEqual(pointerTypeCreate(opaqueType),
+                      pointerTypeCreate(referenceTypeCreate(other))) &&
+           !typeEqual(qualifiedTypeCreate(opaqueType, true, false),
+                      qualifiedTypeCreate(definitionType, false, true)));
+
+  // an unresolved reference is filled in after types around it are created,
+  // so it can't be interned
+  Type *unresolved = unresolvedReferenceTypeCreate();
+  Type *otherUnresolved = unresolvedReferenceTypeCreate();
+  test("unresolved references aren't interned",
+       unresolved != otherUnresolved &&
+           pointerTypeCreate(unresolved) != pointerTypeCreate(otherUnresolved));
+  unresolved->data.reference.entry = definition;
+  otherUnresolved->data.reference.entry = other;
+  test("resolved references equal the types they resolved to",
+       pointerTypeCreate(unresolved) != pointerTypeCreate(definitionType) &&
+           typeEqual(pointerTypeCreate(unresolved),
+                     pointerTypeCreate(definitionType)) &&
+           typeEqual(pointerTypeCreate(unresolved),
+                     pointerTypeCreate(opaqueType)) &&
+           !typeEqual(pointerTypeCreate(unresolved),
+                      pointerTypeCreate(otherUnresolved)));
+
+  stabEntryFree(other);
+  stabEntryFree(opaque);
+  stabEntryFree(definition);
+}
+
+/**
+ * parses and type checks a file, and checks its global variables have the
+ * types they were declared with
+ *
+ * @returns whether the file was accepted, with the right types
+ */
+static bool compileInterned(void) {
+  FileListEntry entries[1];
+  fileListEntryInit(&entries[0], "testFiles/type/interned.tc", true);
+  fileList.entries = &entries[0];
+  fileList.size = 1;
+
+  bool accepted = parse() == 0 && typecheck() == 0;
+  if (accepted) {
+    HashMap *stab = entries[0].ast->data.file.stab;
+    SymbolTableEntry *node = hashMapGetId(stab, id("Node"));
+    SymbolTableEntry *head = hashMapGetId(stab, id("head"));
+    SymbolTableEntry *counts = hashMapGetId(stab, id("counts"));
+    SymbolTableEntry *visit = hashMapGetId(stab, id("visit"));
+    Type *intType = keywordTypeCreate(TK_INT);
+    Type *args[] = {intType, intType};
+    accepted =
+        node != NULL && head != NULL && counts != NULL && visit != NULL &&
+        typeEqual(head->data.variable.type,
+                  pointerTypeCreate(referenceTypeCreate(node))) &&
+        counts->data.variable.type == arrayTypeCreate(3, intType) &&
+        visit->data.variable.type == funPtrCreate(intType, 2, args);
+  }
+
+  nodeFree(entries[0].ast);
+  free(entries[0].lineStarts);
+  vectorUninit(&entries[0].irFrags, nullDtor);
+  return accepted;
+}
+
+static void testTypeTableClear(void) {
+  test("interned types are used by a compilation", compileInterned());
+
+  typeTableClear();
+  Type *intType = keywordTypeCreate(TK_INT);
+  test("types are interned again after clearing",
+       pointerTypeCreate(intType) == pointerTypeCreate(intType) &&
+           pointerTypeCreate(intType)->data.pointer.base == intType);
+  test("types are interned again by a compilation after clearing",
+       compileInterned());
+  typeTableClear();
+}
+
+void testType(void) {
+  testLayout();
+  testInterning();
+  testTypeTableClear();
+}
@@ -29,12 +29,45 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "engine.h"
 #include "fileList.h"
 #include "parser/parser.h"
 #include "tests.h"
 #include "util/format.h"
+#include "util/functional.h"
+
+/**
+ * parses and type checks the file list, capturing what's written to stderr
+ *
+ * name lookups in function bodies happen while parsing them, and the parser
+ * reports some diagnostics straight to stderr, so both are captured
+ *
+ * @param status output parameter for the type checker's status, or 0 if
+ * parsing failed
+ * @returns everything written to stderr (owning)
+ */
+static char *typecheckCaptured(int *status) {
+  *status = 0;
+  fflush(stderr);
+  FILE *captured = tmpfile();
+  assert("couldn't create temporary file" && captured != NULL);
+  int saved = dup(STDERR_FILENO);
+  dup2(fileno(captured), STDERR_FILENO);
+
+  if (parse() == 0) *status = typecheck();
+
+  fflush(stderr);
+  dup2(saved, STDERR_FILENO);
+  close(saved);
+  long length = ftell(captured);
+  rewind(captured);
+  char *text = malloc((size_t)length + 1);
+  text[fread(text, 1, (size_t)length, captured)] = '\0';
+  fclose(captured);
+  return text;
+}
 
 void testTypechecker(void) {
   assert("can't bless typechecker tests" && !status.bless);
@@ -54,6 +87,9 @@ void testTypechecker(void) {
     entries[0].inputFilename = name;
     entries[0].isCode = true;
     entries[0].errored = false;
+    entries[0].declIndex = NULL;
+    entries[0].preparsed = false;
+    entries[0].lineStarts = NULL;
 
     int parseStatus = parse();
     assert("couldn't parse file in testTypechecker's accepted file list" &&
@@ -61,6 +97,7 @@ void testTypechecker(void) {
     testDynamic(format("type checker accepts %s", entries[0].inputFilename),
                 typecheck() == 0);
     nodeFree(entries[0].ast);
+    free(entries[0].lineStarts);
     free(name);
   }
   closedir(accepted);
@@ -79,6 +116,9 @@ void testTypechecker(void) {
     entries[0].inputFilename = name;
     entries[0].isCode = true;
     entries[0].errored = false;
+    entries[0].declIndex = NULL;
+    entries[0].preparsed = false;
+    entries[0].lineStarts = NULL;
 
     int parseStatus = parse();
     assert("couldn't parse file in testTypechecker's rejected file list" &&
@@ -86,7 +126,43 @@ void testTypechecker(void) {
     testDynamic(format("type checker rejects %s", entries[0].inputFilename),
                 typecheck() != 0);
     nodeFree(entries[0].ast);
+    free(entries[0].lineStarts);
     free(name);
   }
   closedir(rejected);
+
+  // two imports declaring the same name - only a qualified use is unambiguous
+  char const *ambiguousNames[] = {
+      "testFiles/typechecker/ambiguous/first.td",
+      "testFiles/typechecker/ambiguous/second.td",
+      "testFiles/typechecker/ambiguous/user.tc",
+  };
+  size_t numAmbiguous = sizeof(ambiguousNames) / sizeof(ambiguousNames[0]);
+  FileListEntry ambiguousEntries[3];
+  for (size_t idx = 0; idx < numAmbiguous; ++idx)
+    fileListEntryInit(&ambiguousEntries[idx], ambiguousNames[idx],
+                      idx == numAmbiguous - 1);
+  fileList.entries = &ambiguousEntries[0];
+  fileList.size = numAmbiguous;
+
+  int typecheckStatus;
+  char *diagnostics = typecheckCaptured(&typecheckStatus);
+  test("type checker rejects a name declared by two imports",
+       typecheckStatus != 0 &&
+           strstr(diagnostics,
+                  "user.tc:7:10: error: 'value' declared in mutliple imported "
+                  "modules\n") != NULL);
+  test("type checker notes each import declaring an ambiguous name",
+       strstr(diagnostics, "first.td:3:5: note: declared here\n") != NULL &&
+           strstr(diagnostics, "second.td:3:5: note: declared here\n") !=
+               NULL);
+  test("type checker accepts a qualified use of an ambiguous name",
+       strstr(diagnostics, "user.tc:11:") == NULL);
+  free(diagnostics);
+
+  for (size_t idx = 0; idx < numAmbiguous; ++idx) {
+    nodeFree(ambiguousEntries[idx].ast);
+    free(ambiguousEntries[idx].lineStarts);
+    vectorUninit(&ambiguousEntries[idx].irFrags, nullDtor);
+  }
 }
\ No newline at end of file